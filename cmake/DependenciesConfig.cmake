@@ -8,6 +8,16 @@ set(ROR_USE_CURL         "TRUE" CACHE BOOL "use curl, required for communication
 set(ROR_USE_JSONCPP      "TRUE" CACHE BOOL "use jsoncpp")
 set(ROR_USE_CRASHRPT     "FALSE" CACHE BOOL "use crash report tool")
 
+# optimizations
+if(CMAKE_SYSTEM_PROCESSOR MATCHES "^(x86_64|AMD64|amd64|i.86|x86)$")
+  set(ROR_ENABLE_AVX2    "TRUE" CACHE BOOL "build the AVX2 beam and wave kernels, picked at runtime if the CPU supports it")
+else()
+  set(ROR_ENABLE_AVX2    "FALSE")
+endif()
+
+# tools
+set(ROR_BUILD_BENCHMARKS "FALSE" CACHE BOOL "build the physics benchmark (source/microbenchmarks/Bench_Physics.cpp), requires Google Benchmark")
+
 
 # some obsolete options:
 # disabled some options for now
@@ -81,6 +81,7 @@ static RoRFrameListener* g_sim_controller;
  GVarStr<50>              app_locale              ("app_locale",              "Language Short",            "en",                    "en");
  GVarPod<bool>            app_multithread         ("app_multithread",         "Multi-threading",           true,                    true);
  GVarStr<50>              app_screenshot_format   ("app_screenshot_format",   "Screenshot Format",         "jpg",                   "jpg");
+ GVarPod<bool>            app_headless            ("app_headless",            nullptr,                     false,                   false);
 
 // Simulation
  GVarEnum<SimState>       sim_state               ("sim_state",               nullptr,                     SimState::NONE,          SimState::NONE);
@@ -88,8 +89,15 @@ static RoRFrameListener* g_sim_controller;
  GVarPod<bool>            sim_replay_enabled      ("sim_replay_enabled",      "Replay mode",               false,                   false);
  GVarPod<int>             sim_replay_length       ("sim_replay_length",       "Replay length",             200,                     200);
  GVarPod<int>             sim_replay_stepping     ("sim_replay_stepping",     "Replay Steps per second",   1000,                    1000);
+ GVarPod<int>             sim_replay_memory       ("sim_replay_memory",       "Replay Memory (MB)",        64,                      64);
+ GVarPod<bool>            sim_replay_record       ("sim_replay_record",       "Replay Recording",          false,                   false);
  GVarPod<bool>            sim_position_storage    ("sim_position_storage",    "Position Storage",          false,                   false);
  GVarEnum<SimGearboxMode> sim_gearbox_mode        ("sim_gearbox_mode",        "GearboxMode",               SimGearboxMode::AUTO,    SimGearboxMode::AUTO);
+ GVarPod<bool>            sim_beam_simd           ("sim_beam_simd",           "SIMD Beams",                true,                    true);
+ GVarPod<bool>            sim_beam_parallel       ("sim_beam_parallel",       "Parallel Beams",            false,                   false);
+ GVarPod<bool>            sim_deterministic       ("sim_deterministic",       "Deterministic Physics",     false,                   false);
+ GVarPod<int>             sim_headless_rate       ("sim_headless_rate",       "Headless Update Rate",      50,                      50);
+ GVarStr<300>             sim_state_stream        ("sim_state_stream",        nullptr,                     "",                      "");
 
 // Multiplayer
  GVarEnum<MpState>        mp_state                ("mp_state",                nullptr,                     MpState::DISABLED,       MpState::DISABLED);
@@ -127,6 +135,7 @@ static RoRFrameListener* g_sim_controller;
  GVarStr<300>             sys_resources_dir       ("sys_resources_dir",       "Resources Path",            "",                      "");
  GVarStr<300>             sys_profiler_dir        ("sys_profiler_dir",        "Profiler output dir",       "",                      "");
  GVarStr<300>             sys_screenshot_dir      ("sys_screenshot_dir",      nullptr,                     "",                      "");
+ GVarStr<300>             sys_replays_dir         ("sys_replays_dir",         nullptr,                     "",                      "");
 
 // Input - Output
  GVarPod<bool>            io_ffb_enabled          ("io_ffb_enabled",          "Force Feedback",            false,                   false);
@@ -182,7 +191,7 @@ ContentManager*        GetContentManager     () { return g_content_manager;}
 OverlayWrapper*        GetOverlayWrapper     () { return g_overlay_wrapper;}
 SceneMouse*            GetSceneMouse         () { return g_scene_mouse;}
 GUIManager*            GetGuiManager         () { return g_gui_manager;}
-Console*               GetConsole            () { return g_gui_manager->GetConsole();}
+Console*               GetConsole            () { return (g_gui_manager != nullptr) ? g_gui_manager->GetConsole() : nullptr;}
 InputEngine*           GetInputEngine        () { return g_input_engine;}
 CacheSystem*           GetCacheSystem        () { return g_cache_system;}
 MainMenu*              GetMainMenu           () { return g_main_menu;}
@@ -196,7 +205,10 @@ void StartOgreSubsystem()
         throw std::runtime_error("[RoR] Failed to create OgreSubsystem");
     }
 
-    if (! g_ogre_subsystem->StartOgre("", ""))
+    const bool started = App::app_headless.GetActive()
+        ? g_ogre_subsystem->StartOgreHeadless()
+        : g_ogre_subsystem->StartOgre("", "");
+    if (! started)
     {
         throw std::runtime_error("[RoR] Failed to start up OGRE 3D engine");
     }
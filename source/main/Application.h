@@ -299,6 +299,7 @@ extern GVarStr<100>            app_language;
 extern GVarStr<50>             app_locale;
 extern GVarPod<bool>           app_multithread;
 extern GVarStr<50>             app_screenshot_format;
+extern GVarPod<bool>           app_headless;
 
 // Simulation
 extern GVarEnum<SimState>      sim_state;
@@ -306,8 +307,15 @@ extern GVarStr<200>            sim_terrain_name;
 extern GVarPod<bool>           sim_replay_enabled;
 extern GVarPod<int>            sim_replay_length;
 extern GVarPod<int>            sim_replay_stepping;
+extern GVarPod<int>            sim_replay_memory;
+extern GVarPod<bool>           sim_replay_record;
 extern GVarPod<bool>           sim_position_storage;
 extern GVarEnum<SimGearboxMode>sim_gearbox_mode;
+extern GVarPod<bool>           sim_beam_simd;
+extern GVarPod<bool>           sim_beam_parallel;
+extern GVarPod<bool>           sim_deterministic;
+extern GVarPod<int>            sim_headless_rate;
+extern GVarStr<300>            sim_state_stream;        //!< Headless mode: file or pipe to write the truck state to, see StateStreamFile.h
 
 // Multiplayer
 extern GVarEnum<MpState>       mp_state;
@@ -345,6 +353,7 @@ extern GVarStr<300>            sys_logs_dir;
 extern GVarStr<300>            sys_resources_dir;
 extern GVarStr<300>            sys_profiler_dir;
 extern GVarStr<300>            sys_screenshot_dir;
+extern GVarStr<300>            sys_replays_dir;
 
 // Input - Output
 extern GVarPod<bool>           io_ffb_enabled;
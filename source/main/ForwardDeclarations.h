@@ -84,6 +84,7 @@ namespace RoRnet
 }
 
 struct node_t;
+struct node_attr_t;
 struct beam_t;
 struct shock_t;
 struct eventsource_t;
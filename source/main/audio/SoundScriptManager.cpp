@@ -79,6 +79,12 @@ SoundScriptManager::SoundScriptManager() :
     // reset all states
     state_map.clear();
 
+    if (App::app_headless.GetActive())
+    {
+        LOG("SoundScriptManager: Headless mode, sound disabled");
+        return;
+    }
+
     sound_manager = new SoundManager();
 
     if (!sound_manager)
@@ -508,6 +514,9 @@ void SoundScriptManager::skipToNextOpenBrace(DataStreamPtr& stream)
 
 void SoundScriptManager::setEnabled(bool state)
 {
+    if (disabled)
+        return;
+
     if (state)
         sound_manager->resumeAllSounds();
     else
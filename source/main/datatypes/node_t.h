@@ -13,6 +13,9 @@
 
 /**
 * SIM-CORE; Node.
+*
+* Only the data touched by the per-substep loops (calcBeams, calcNodes, collisions, flexbody updates) lives here.
+* Attributes needed only at spawn or by particle effects are kept in the rig's cold table, see node_attr_t.
 */
 struct node_t
 {
@@ -26,28 +29,41 @@ struct node_t
     float collTestTimer;
     short iswheel; //!< 0=no, 1, 2=wheel1  3,4=wheel2, etc...
     short locked;  //!< {UNLOCKED | PRELOCK | LOCKED}
+    short pos;     //!< This node's index in rig_t::nodes array (and rig_t::node_attrs).
 
     bool contacted;
     bool contactless;
-    bool disable_particles;
-    bool disable_sparks;
 
     // <-- 64 Bytes -->
 
-    Ogre::Real buoyancy;
     Ogre::Real friction_coef;
     Ogre::Real surface_coef;
     Ogre::Real volume_coef;
 
-    float wettime; //!< Cumulative time this node has been wet. When wet, dripping particles are produced.
     short wheelid; //!< Wheel index
-    short lockgroup;
-    short pos;     //!< This node's index in rig_t::nodes array.
     short id;      //!< Numeric identifier assigned in rig-definition file (if used), or -1 if the node was generated dynamically.
     char wetstate; //!< {DRY | DRIPPING | WET}
     char collisionBoundingBoxID;
 
     bool contacter;
+};
+
+#if OGRE_DOUBLE_PRECISION == 0
+// 83 bytes of data, padded to 84. Anything added here is paid for on every substep - use node_attr_t if possible.
+static_assert(sizeof(node_t) == 84, "node_t layout changed; hot node data must stay compact");
+#endif
+
+/**
+* SIM-CORE; Cold node attributes, stored in a table parallel to rig_t::nodes (index = node_t::pos).
+*/
+struct node_attr_t
+{
+    Ogre::Real buoyancy;
+    float wettime; //!< Cumulative time this node has been wet. When wet, dripping particles are produced.
+    short lockgroup;
+
+    bool disable_particles;
+    bool disable_sparks;
     bool overrideMass;
     bool loadedMass;
     bool isHot;    //!< Makes this node emit vapour particles when in contact with water.
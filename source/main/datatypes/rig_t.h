@@ -14,26 +14,48 @@
 
 #include <OgrePrerequisites.h>
 
+/**
+* Sizes of the per-rig arrays in rig_t, calculated by RigSpawner from the rig definition.
+*/
+struct rig_capacity_t
+{
+    int nodes;
+    int beams;
+    int shocks;
+    int contacters;
+    int hydros;
+    int cabs;
+    int collcabs;
+    int buoycabs;
+    int pressure_beams;
+};
+
 /**
 * SIM-CORE; Represents a vehicle.
 */
 struct rig_t
 {
     // TODO: sort these a bit more ...
-    node_t nodes[MAX_NODES];
-    Ogre::Vector3 initial_node_pos[MAX_NODES];
-    bool node_mouse_grab_disabled[MAX_NODES];
+
+    // Arrays sized by 'capacity'; they all live in 'rig_arena', which is allocated by RigSpawner::InitializeRig()
+    rig_capacity_t capacity;
+    char* rig_arena;
+
+    node_t* nodes;
+    node_attr_t* node_attrs; //!< Cold per-node attributes, indexed like 'nodes'.
+    Ogre::Vector3* initial_node_pos;
+    bool* node_mouse_grab_disabled;
     int free_node;
 
-    beam_t beams[MAX_BEAMS];
-    Ogre::Real initial_beam_strength[MAX_BEAMS];
-    Ogre::Real default_beam_deform[MAX_BEAMS];
-    Ogre::Real default_beam_plastic_coef[MAX_BEAMS];
+    beam_t* beams;
+    Ogre::Real* initial_beam_strength;
+    Ogre::Real* default_beam_deform;
+    Ogre::Real* default_beam_plastic_coef;
     int free_beam;
 
     std::vector<beam_t*> interTruckBeams;
 
-    contacter_t contacters[MAX_CONTACTERS];
+    contacter_t* contacters;
     int free_contacter;
 
     rigidifier_t rigidifiers[MAX_RIGIDIFIERS];
@@ -63,7 +85,7 @@ struct rig_t
     prop_t *driverSeat;
     int free_prop;
 
-    shock_t shocks[MAX_SHOCKS];
+    shock_t* shocks;
     int free_shock;
     int free_active_shock; //!< this has no array associated with it. its just to determine if there are active shocks!
 
@@ -75,7 +97,7 @@ struct rig_t
     soundsource_t soundsources[MAX_SOUNDSCRIPTS_PER_TRUCK];
     int free_soundsource;
 
-    int pressure_beams[MAX_PRESSURE_BEAMS];
+    int* pressure_beams;
     int free_pressure_beam;
 
     AeroEngine *aeroengines[MAX_AEROENGINES];
@@ -84,19 +106,19 @@ struct rig_t
     Screwprop *screwprops[MAX_SCREWPROPS];
     int free_screwprop;
 
-    int cabs[MAX_CABS*3];
+    int* cabs; //!< 3 node indices per cab
     int free_cab;
 
-    int hydro[MAX_HYDROS];
+    int* hydro;
     int free_hydro;
 
-    int collcabs[MAX_CABS];
-    collcab_rate_t inter_collcabrate[MAX_CABS];
-    collcab_rate_t intra_collcabrate[MAX_CABS];
+    int* collcabs;
+    collcab_rate_t* inter_collcabrate;
+    collcab_rate_t* intra_collcabrate;
     int free_collcab;
 
-    int buoycabs[MAX_CABS];
-    int buoycabtypes[MAX_CABS];
+    int* buoycabs;
+    int* buoycabtypes;
     int free_buoycab;
 
     Airbrake *airbrakes[MAX_AIRBRAKES];
@@ -374,7 +374,7 @@ void BeamEngine::update(float dt, int doUpdate)
                 // anti lag
                 if (b_anti_lag && curAcc < 0.5)
                 {
-                    float f = frand();
+                    float f = frand(m_actor->frand_state);
                     if (curEngineRPM > minRPM_antilag && f > rnd_antilag_chance)
                     {
                         if (curTurboRPM[i] > maxTurboRPM * 0.35 && curTurboRPM[i] < maxTurboRPM)
@@ -77,7 +77,7 @@ void CharacterFactory::DeleteAllRemoteCharacters()
 }
 
 #ifdef USE_SOCKETW
-void CharacterFactory::handleStreamData(std::vector<RoR::Networking::recv_packet_t> packet_buffer)
+void CharacterFactory::handleStreamData(const std::vector<RoR::Networking::recv_packet_t>& packet_buffer)
 {
     for (auto packet : packet_buffer)
     {
@@ -34,7 +34,7 @@ void SendPrivateChat(Ogre::UTFString target_username, Ogre::UTFString chatline);
 void SendStreamSetup();
 
 #ifdef USE_SOCKETW
-void HandleStreamData(std::vector<RoR::Networking::recv_packet_t> packet);
+void HandleStreamData(const std::vector<RoR::Networking::recv_packet_t>& packet);
 #endif // USE_SOCKETW
 
 Ogre::UTFString GetColouredName(Ogre::UTFString nick, int colour_number);
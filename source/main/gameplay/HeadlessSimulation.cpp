@@ -0,0 +1,256 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "HeadlessSimulation.h"
+
+#include "Application.h"
+#include "Beam.h"
+#include "BeamEngine.h"
+#include "BeamFactory.h"
+#include "CacheSystem.h"
+#include "Collisions.h"
+#include "ContentManager.h"
+#include "GlobalEnvironment.h"
+#include "Language.h"
+#include "RoRFrameListener.h"
+#include "Scripting.h"
+#include "StateStreamFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace RoR {
+
+static volatile std::sig_atomic_t s_stop_requested = 0;
+
+static void RequestStop(int signal)
+{
+    s_stop_requested = 1;
+}
+
+static int GetUpdateRate()
+{
+    // BeamFactory::update() advances at most 1/20 s per call; less frequent updates would slow the simulation down
+    return std::max(20, App::sim_headless_rate.GetActive());
+}
+
+HeadlessSimulation::HeadlessSimulation()
+{
+}
+
+HeadlessSimulation::~HeadlessSimulation()
+{
+}
+
+bool HeadlessSimulation::Run()
+{
+    if (App::diag_preset_vehicle.IsActiveEmpty())
+    {
+        LOG("[RoR|Headless] No vehicle to simulate, use '-truck'");
+        return false;
+    }
+
+    if (App::mp_state.GetPending() == MpState::CONNECTED)
+    {
+        // The server's terrain can't be loaded without Ogre's terrain component, which needs a render system.
+        // On flat ground, the host's state would disagree with what every client simulates.
+        LOG("[RoR|Headless] '-joinserver' is not supported in headless mode: terrains can't be loaded without a render system");
+        return false;
+    }
+
+    this->Startup();
+    BeamFactory& factory = *this->GetBeamFactory();
+
+    Beam* truck = this->SpawnPresetVehicle(factory);
+    const bool ok = (truck != nullptr) && this->OpenStateStream(*truck);
+    if (ok)
+    {
+        this->RunLoop(factory, *truck);
+    }
+    m_state_stream.reset();
+
+    this->Shutdown();
+    return ok;
+}
+
+void HeadlessSimulation::Startup()
+{
+    App::app_headless.SetActive(true);
+    App::StartOgreSubsystem(); // Without render system, see OgreSubsystem::StartOgreHeadless()
+
+    this->SetupResources();
+
+    m_sim_controller.reset(new RoRFrameListener(nullptr, nullptr));
+    App::SetSimController(m_sim_controller.get());
+
+    // Terrains need Ogre's terrain component to load their collision geometry
+    gEnv->collisions = new Collisions(m_sim_controller.get());
+    gEnv->collisions->setHeightFinder(&m_ground);
+}
+
+void HeadlessSimulation::Shutdown()
+{
+    BeamFactory& factory = *this->GetBeamFactory();
+    factory.SyncWithSimThread();
+    factory.CleanUpAllTrucks();
+    App::SetSimController(nullptr);
+    delete gEnv->collisions;
+    gEnv->collisions = nullptr;
+    App::DestroyContentManager();
+    m_sim_controller.reset();
+}
+
+BeamFactory* HeadlessSimulation::GetBeamFactory()
+{
+    return m_sim_controller->GetBeamFactory();
+}
+
+void HeadlessSimulation::SetupResources()
+{
+    // Same order as main(), but only the content folders; no base resource packs, materials or GUI
+    App::CreateContentManager();
+    LanguageEngine::getSingleton().setup();
+
+    App::CreateCacheSystem();
+    App::GetContentManager()->InitHeadless();
+
+#ifdef USE_ANGELSCRIPT
+    new ScriptEngine(); // Init singleton. TODO: Move under Application
+#endif
+
+    App::GetCacheSystem()->Startup(); // Doesn't update the cache in headless mode
+}
+
+Beam* HeadlessSimulation::SpawnPresetVehicle(BeamFactory& factory)
+{
+    RoR::LogFormat("[RoR|Headless] Preselected Truck: %s", App::diag_preset_vehicle.GetActive());
+    const std::vector<Ogre::String> truck_config(1, App::diag_preset_veh_config.GetActive());
+
+    const Ogre::Vector3 pos(64.0f, 0.0f, 64.0f);
+    Beam* truck = factory.CreateLocalRigInstance(pos, Ogre::Quaternion::IDENTITY, App::diag_preset_vehicle.GetActive(), -1, nullptr, false, &truck_config);
+    if (truck == nullptr)
+    {
+        RoR::LogFormat("[RoR|Headless] Cannot spawn '%s'", App::diag_preset_vehicle.GetActive());
+        return nullptr;
+    }
+
+    if (truck->engine)
+    {
+        truck->engine->start();
+    }
+    factory.activateAllTrucks();
+    return truck;
+}
+
+bool HeadlessSimulation::OpenStateStream(Beam& truck)
+{
+    if (App::sim_state_stream.IsActiveEmpty())
+        return true;
+
+    StateStreamHeader header;
+    memset(&header, 0, sizeof(StateStreamHeader));
+    header.rate_hz = GetUpdateRate();
+    truck.FillStreamRegister(header.truck);
+
+    // Opening a named pipe blocks until the reader connects
+    RoR::LogFormat("[RoR|Headless] Opening state stream '%s'", App::sim_state_stream.GetActive());
+    m_state_stream.reset(new StateStreamWriter());
+    if (!m_state_stream->Open(App::sim_state_stream.GetActive(), header))
+    {
+        RoR::LogFormat("[RoR|Headless] Cannot open state stream '%s'", App::sim_state_stream.GetActive());
+        m_state_stream.reset();
+        return false;
+    }
+    return true;
+}
+
+void HeadlessSimulation::WriteStateStream(BeamFactory& factory, Beam& truck, uint32_t frame)
+{
+    factory.SyncWithSimThread(); // update() leaves the physics running in the background
+
+    std::vector<char> buffer(RORNET_MAX_MESSAGE_LENGTH);
+    // Legacy format: unlike the compact one, every record decodes without the ones before it
+    const size_t len = truck.PackStreamData(&buffer[0], buffer.size(), false, true);
+    if (len == 0)
+    {
+        LOG("[RoR|Headless] Truck is too big for the state stream, not writing it");
+        m_state_stream.reset();
+    }
+    else if (!m_state_stream->WriteRecord(frame, &buffer[0], len))
+    {
+        LOG("[RoR|Headless] Cannot write state stream (disk full or reader gone), not writing it anymore");
+        m_state_stream.reset();
+    }
+}
+
+void HeadlessSimulation::RunLoop(BeamFactory& factory, Beam& truck)
+{
+    using namespace std::chrono;
+
+    const int rate = GetUpdateRate();
+    const float dt = 1.0f / rate;
+    const steady_clock::duration tick = duration_cast<steady_clock::duration>(duration<double>(1.0 / rate));
+    RoR::LogFormat("[RoR|Headless] Simulating at %d Hz, stop with Ctrl+C", rate);
+
+    s_stop_requested = 0;
+    std::signal(SIGINT, RequestStop);
+    std::signal(SIGTERM, RequestStop);
+#ifndef _WIN32
+    std::signal(SIGPIPE, SIG_IGN); // A state stream reader going away fails the write instead
+#endif
+
+    steady_clock::time_point next_tick = steady_clock::now();
+    uint32_t frame = 0;
+    while (!s_stop_requested)
+    {
+        factory.update(dt);
+        if (m_state_stream)
+        {
+            this->WriteStateStream(factory, truck, frame);
+        }
+        frame++;
+
+        next_tick += tick;
+        const steady_clock::time_point now = steady_clock::now();
+        if (next_tick < now)
+        {
+            next_tick = now; // Overloaded: don't try to catch up, fall behind real time instead
+        }
+        else
+        {
+            std::this_thread::sleep_until(next_tick);
+        }
+    }
+
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+#ifndef _WIN32
+    std::signal(SIGPIPE, SIG_DFL);
+#endif
+    LOG("[RoR|Headless] Stopped");
+}
+
+} // namespace RoR
@@ -0,0 +1,74 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// @file
+/// @brief Dedicated-server mode (command line '-headless'): simulates trucks without rendering, sound or GUI.
+
+#pragma once
+
+#include "PhysicsBenchmark.h"
+#include "RoRPrerequisites.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace RoR {
+
+class StateStreamWriter;
+
+/// Runs the physics of the '-truck' vehicle at a fixed rate (sim_headless_rate) on flat ground.
+/// Ogre only provides resources; there is no scene manager, render window or GPU context.
+/// With '-statestream <file>', the truck's state is written every frame, see StateStreamFile.h.
+/// '-joinserver' is refused: without a render system, the server's terrain can't be loaded.
+/// Aircraft parts (wings, airbrakes, turbojets, turboprops, pistonprops) are built with their meshes,
+/// so RigSpawner skips them headless; aircraft don't fly here.
+class HeadlessSimulation
+{
+public:
+
+    HeadlessSimulation();
+    ~HeadlessSimulation();
+
+    /// Sets up, runs until SIGINT/SIGTERM or a network error, and cleans up.
+    /// @return False if setup failed.
+    bool Run();
+
+    /// Starts Ogre without render system, loads resources and creates the simulation with flat-ground collisions.
+    /// Run() calls it; the standalone physics benchmark uses it directly.
+    void Startup();
+    void Shutdown();
+
+    BeamFactory* GetBeamFactory();
+
+private:
+
+    void SetupResources();
+    Beam* SpawnPresetVehicle(BeamFactory& factory);
+    bool OpenStateStream(Beam& truck);
+    void WriteStateStream(BeamFactory& factory, Beam& truck, uint32_t frame);
+    void RunLoop(BeamFactory& factory, Beam& truck);
+
+    std::unique_ptr<RoRFrameListener>     m_sim_controller; //!< Never registered as frame listener; only owns the factories
+    std::unique_ptr<StateStreamWriter>    m_state_stream;   //!< Only with '-statestream'
+    FlatHeightFinder                      m_ground;
+};
+
+} // namespace RoR
@@ -20,36 +20,140 @@
 
 #include "Replay.h"
 #include <Ogre.h>
+#include "Application.h"
+#include "CacheSystem.h"
+#include "PlatformUtils.h"
 #include "Utils.h"
 #include "GUIManager.h"
 #include "Language.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+
 using namespace Ogre;
 
+// Quantization steps per unit; positions are quantized absolutely, so deltas never drift
+static const float POS_STEPS = 1024.0f;   // ~1 mm
+static const float VEL_STEPS = 128.0f;    // ~1 cm/s
+static const float FORCE_STEPS = 1.0f;    // 1 N
+static const float QUANT_LIMIT = (float)(1 << 30);
+
+static inline int32_t Quantize(float value, float steps)
+{
+    float q = std::floor(value * steps + 0.5f);
+    if (!(q == q))
+        return 0; // NaN
+    return (int32_t)std::max(-QUANT_LIMIT, std::min(QUANT_LIMIT, q));
+}
+
+static inline void PutVarint(std::vector<char>& out, uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        out.push_back((char)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((char)v);
+}
+
+static inline void PutSigned(std::vector<char>& out, int64_t v)
+{
+    PutVarint(out, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+// Blocks may come from a file, so reads stop at 'end'
+static inline uint64_t GetVarint(const char*& in, const char* end)
+{
+    uint64_t v = 0;
+    int shift = 0;
+    uint8_t byte = 0;
+    do
+    {
+        if (in >= end)
+            break;
+        byte = (uint8_t)*in++;
+        if (shift < 64)
+            v |= (uint64_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return v;
+}
+
+static inline int64_t GetSigned(const char*& in, const char* end)
+{
+    uint64_t v = GetVarint(in, end);
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
 Replay::Replay(Beam* b, int _numFrames)
 {
     numNodes = b->getNodeCount();
     numBeams = b->getBeamCount();
-    numFrames = _numFrames;
+    numFrames = std::max(_numFrames, 1);
+    memoryBudget = (size_t)std::max(RoR::App::sim_replay_memory.GetActive(), 1) * 1024 * 1024;
 
     replayTimer = new Timer();
 
     // DO NOT get memory here, get memory when we use it first time!
-    nodes = 0;
-    beams = 0;
-    times = 0;
+    staging.first_frame = 0;
+    staging.num_frames = 0;
+    blocksBytes = 0;
+    pendingBytes = 0;
+    encoderBehind = false;
+    cacheFirstFrame = -1;
 
     outOfMemory = false;
 
     unsigned long bsize = (numNodes * numFrames * sizeof(node_simple_t) + numBeams * numFrames * sizeof(beam_simple_t) + numFrames * sizeof(unsigned long)) / 1024.0f;
-    LOG("replay buffer size: " + TOSTRING(bsize) + " kB");
+    LOG("replay buffer size: " + TOSTRING(bsize) + " kB uncompressed, budget: " + TOSTRING(memoryBudget / 1024) + " kB");
 
     writeIndex = 0;
-    firstRun = 1;
 
     hidden = false;
     visible = false;
 
+    if (RoR::App::sim_replay_record.GetActive())
+    {
+        RoR::ReplayFileHeader header;
+        memset(&header, 0, sizeof(RoR::ReplayFileHeader));
+        header.num_nodes = numNodes;
+        header.num_beams = numBeams;
+        header.block_frames = BLOCK_FRAMES;
+        CacheEntry entry = RoR::App::GetCacheSystem()->getResourceInfo(b->realtruckfilename);
+        strncpy(header.truck_file, b->realtruckfilename.c_str(), sizeof(header.truck_file) - 1);
+        strncpy(header.truck_guid, entry.guid.c_str(), sizeof(header.truck_guid) - 1);
+        strncpy(header.truck_hash, entry.hash.c_str(), sizeof(header.truck_hash) - 1);
+        header.truck_version = entry.version;
+
+        char stamp[50] = "";
+        time_t now = time(nullptr);
+        strftime(stamp, sizeof(stamp), "%Y-%m-%d_%H-%M-%S", localtime(&now));
+        String basename, ext;
+        StringUtil::splitBaseFilename(b->realtruckfilename, basename, ext);
+        String path_base = String(RoR::App::sys_replays_dir.GetActive()) + PATH_SLASH + basename + "_" + stamp;
+        String path = path_base + ".rorreplay";
+        for (int i = 2; RoR::PlatformUtils::FileExists(path); i++)
+        {
+            path = path_base + "_" + TOSTRING(i) + ".rorreplay"; // Same rig spawned twice within a second
+        }
+
+        fileWriter = std::unique_ptr<RoR::ReplayFileWriter>(new RoR::ReplayFileWriter());
+        if (fileWriter->Open(path, header))
+        {
+            LOG("recording replay to: " + path);
+        }
+        else
+        {
+            LOG("cannot record replay, unable to create: " + path);
+            fileWriter.reset();
+        }
+    }
+
+    encoderStop = false;
+    encoder = std::thread(&Replay::encoderThread, this);
+
     // windowing
     int width = 300;
     int height = 60;
@@ -61,7 +165,7 @@ Replay::Replay(Beam* b, int _numFrames)
     panel->setAlpha(0.6);
 
     pr = panel->createWidget<MyGUI::Progress>("Progress", 10, 10, 280, 20, MyGUI::Align::Default);
-    pr->setProgressRange(_numFrames);
+    pr->setProgressRange(numFrames);
     pr->setProgressPosition(0);
 
     txt = panel->createWidget<MyGUI::StaticText>("StaticText", 10, 30, 280, 20, MyGUI::Align::Default);
@@ -72,15 +176,32 @@ Replay::Replay(Beam* b, int _numFrames)
 
 Replay::~Replay()
 {
-    if (nodes)
     {
-        free(nodes);
-        nodes = 0;
-        free(beams);
-        beams = 0;
-        free(times);
-        times = 0;
+        std::lock_guard<std::mutex> lock(mutex);
+        encoderStop = true;
     }
+    encoderWakeup.notify_one();
+    encoder.join();
+
+    if (fileWriter)
+    {
+        // the recording gets the frames which weren't encoded yet, too
+        if (staging.num_frames > 0)
+        {
+            pending.push_back(std::move(staging));
+        }
+        for (const raw_block_t& raw : pending)
+        {
+            encoded_block_t block;
+            this->encodeBlock(raw, block);
+            this->writeBlockToFile(block);
+        }
+        if (fileWriter && !fileWriter->Close())
+        {
+            LOG("error finishing replay file, recording deleted");
+        }
+    }
+
     delete replayTimer;
 }
 
@@ -88,95 +209,462 @@ void* Replay::getWriteBuffer(int type)
 {
     if (outOfMemory)
         return 0;
-    if (!nodes)
+    if (staging.nodes.empty())
     {
         // get memory
-        nodes = (node_simple_t*)calloc(numNodes * numFrames, sizeof(node_simple_t));
-        if (!nodes)
-        {
-            outOfMemory = true;
-            return 0;
-        }
-        beams = (beam_simple_t*)calloc(numBeams * numFrames, sizeof(beam_simple_t));
-        if (!beams)
+        try
         {
-            free(nodes);
-            nodes = 0;
-            outOfMemory = true;
-            return 0;
+            staging.nodes.resize(BLOCK_FRAMES * numNodes);
+            staging.beams.resize(BLOCK_FRAMES * numBeams);
+            staging.times.resize(BLOCK_FRAMES);
         }
-        times = (unsigned long*)calloc(numFrames, sizeof(unsigned long));
-        if (!times)
+        catch (std::bad_alloc&)
         {
-            free(nodes);
-            nodes = 0;
-            free(beams);
-            beams = 0;
             outOfMemory = true;
             return 0;
         }
     }
     void* ptr = 0;
-    times[writeIndex] = replayTimer->getMicroseconds();
+    staging.times[staging.num_frames] = replayTimer->getMicroseconds();
     if (type == 0)
     {
         // nodes
-        ptr = (void *)(nodes + (writeIndex * numNodes));
+        ptr = (void *)(&staging.nodes[staging.num_frames * numNodes]);
     }
     else if (type == 1)
     {
         // beams
-        ptr = (void *)(beams + (writeIndex * numBeams));
+        ptr = (void *)(staging.beams.data() + staging.num_frames * numBeams);
     }
     return ptr;
 }
 
 void Replay::writeDone()
 {
-    if (outOfMemory)
+    if (outOfMemory || staging.nodes.empty())
         return;
+    staging.num_frames++;
     writeIndex++;
-    if (writeIndex == numFrames)
+    if (staging.num_frames < BLOCK_FRAMES)
+        return;
+
+    // hand the full block to the encoder and continue with a recycled one
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingBytes += getRawBlockBytes(staging);
+        pending.push_back(std::move(staging));
+        if (!spare.empty())
+        {
+            staging = std::move(spare.back());
+            spare.pop_back();
+        }
+        else
+        {
+            staging = raw_block_t();
+        }
+    }
+    encoderWakeup.notify_one();
+
+    staging.first_frame = writeIndex;
+    staging.num_frames = 0;
+    try
+    {
+        staging.nodes.resize(BLOCK_FRAMES * numNodes);
+        staging.beams.resize(BLOCK_FRAMES * numBeams);
+        staging.times.resize(BLOCK_FRAMES);
+    }
+    catch (std::bad_alloc&)
+    {
+        outOfMemory = true;
+    }
+}
+
+void Replay::encoderThread()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        encoderWakeup.wait(lock, [this] { return encoderStop || !pending.empty(); });
+        if (encoderStop)
+            break;
+
+        // the front block stays in 'pending' (readable) while we encode it; the writer only appends
+        const raw_block_t& raw = pending.front();
+        encoded_block_t block;
+        lock.unlock();
+        this->encodeBlock(raw, block);
+        this->writeBlockToFile(block);
+        lock.lock();
+
+        blocksBytes += block.data.capacity();
+        blocks.push_back(std::move(block));
+        pendingBytes -= getRawBlockBytes(pending.front());
+        if (spare.size() < 2)
+        {
+            spare.push_back(std::move(pending.front()));
+        }
+        pending.pop_front();
+        this->evictBlocks();
+        this->dropPendingBlocks();
+    }
+}
+
+// Block layout; values are LEB128 varints, signed ones zigzag coded:
+//
+//  - keyframe: time, then per node position/velocity/forces quantized (9 values),
+//    then 2 bits (broken, disabled) per beam
+//  - each further frame: time delta, per node the 9 quantized values minus the previous frame's,
+//    then the number of beams which changed and for each '(index delta << 2) | state'
+void Replay::encodeBlock(const raw_block_t& raw, encoded_block_t& out)
+{
+    out.first_frame = raw.first_frame;
+    out.num_frames = raw.num_frames;
+    out.data.clear();
+    out.data.reserve(raw.num_frames * (numNodes * 9 + 8));
+    encodeState.resize(numNodes * 9);
+
+    for (int f = 0; f < raw.num_frames; f++)
+    {
+        const node_simple_t* n = &raw.nodes[f * numNodes];
+        const beam_simple_t* b = raw.beams.data() + f * numBeams;
+        const bool keyframe = (f == 0);
+
+        PutSigned(out.data, keyframe ? (int64_t)raw.times[f] : (int64_t)raw.times[f] - (int64_t)raw.times[f - 1]);
+
+        for (int i = 0; i < numNodes; i++)
+        {
+            int32_t q[9];
+            for (int a = 0; a < 3; a++)
+            {
+                q[a + 0] = Quantize(n[i].position[a], POS_STEPS);
+                q[a + 3] = Quantize(n[i].velocity[a], VEL_STEPS);
+                q[a + 6] = Quantize(n[i].forces[a], FORCE_STEPS);
+            }
+            int32_t* prev = &encodeState[i * 9];
+            for (int v = 0; v < 9; v++)
+            {
+                PutSigned(out.data, keyframe ? (int64_t)q[v] : (int64_t)q[v] - prev[v]);
+                prev[v] = q[v];
+            }
+        }
+
+        if (keyframe)
+        {
+            char bits = 0;
+            for (int i = 0; i < numBeams; i++)
+            {
+                bits |= (char)(((b[i].broken ? 1 : 0) | (b[i].disabled ? 2 : 0)) << ((i % 4) * 2));
+                if (i % 4 == 3 || i == numBeams - 1)
+                {
+                    out.data.push_back(bits);
+                    bits = 0;
+                }
+            }
+        }
+        else
+        {
+            const beam_simple_t* pb = b - numBeams;
+            int changed = 0;
+            for (int i = 0; i < numBeams; i++)
+            {
+                changed += (b[i].broken != pb[i].broken || b[i].disabled != pb[i].disabled);
+            }
+            PutVarint(out.data, changed);
+            int last = 0;
+            for (int i = 0; i < numBeams && changed > 0; i++)
+            {
+                if (b[i].broken != pb[i].broken || b[i].disabled != pb[i].disabled)
+                {
+                    PutVarint(out.data, ((uint64_t)(i - last) << 2) | (b[i].broken ? 1 : 0) | (b[i].disabled ? 2 : 0));
+                    last = i;
+                    changed--;
+                }
+            }
+        }
+    }
+    out.data.shrink_to_fit();
+}
+
+void Replay::writeBlockToFile(const encoded_block_t& block)
+{
+    if (!fileWriter)
+        return;
+
+    if (!fileWriter->WriteBlock(block.first_frame, block.num_frames, block.data.data(), block.data.size()))
+    {
+        LOG("error writing replay file, recording stopped");
+        if (!fileWriter->Close())
+        {
+            LOG("error finishing replay file, recording deleted");
+        }
+        fileWriter.reset();
+    }
+}
+
+void Replay::decodeBlock(int first_frame, int num_frames, const char* data, size_t size)
+{
+    num_frames = std::min(num_frames, (int)BLOCK_FRAMES);
+    cache.first_frame = first_frame;
+    cache.num_frames = num_frames;
+    cache.nodes.resize(BLOCK_FRAMES * numNodes);
+    cache.beams.resize(BLOCK_FRAMES * numBeams);
+    cache.times.resize(BLOCK_FRAMES);
+    decodeState.resize(numNodes * 9);
+
+    const char* in = data;
+    const char* end = data + size;
+    for (int f = 0; f < num_frames; f++)
+    {
+        node_simple_t* n = &cache.nodes[f * numNodes];
+        beam_simple_t* b = cache.beams.data() + f * numBeams;
+        const bool keyframe = (f == 0);
+
+        const int64_t t = GetSigned(in, end);
+        cache.times[f] = (unsigned long)(keyframe ? t : (int64_t)cache.times[f - 1] + t);
+
+        for (int i = 0; i < numNodes; i++)
+        {
+            int32_t* q = &decodeState[i * 9];
+            for (int v = 0; v < 9; v++)
+            {
+                const int64_t value = GetSigned(in, end);
+                q[v] = (int32_t)(keyframe ? value : q[v] + value);
+            }
+            for (int a = 0; a < 3; a++)
+            {
+                n[i].position[a] = q[a + 0] / POS_STEPS;
+                n[i].velocity[a] = q[a + 3] / VEL_STEPS;
+                n[i].forces[a] = q[a + 6] / FORCE_STEPS;
+            }
+        }
+
+        if (keyframe)
+        {
+            for (int i = 0; i < numBeams; i++)
+            {
+                const int bits = (in + i / 4 < end) ? ((uint8_t)in[i / 4] >> ((i % 4) * 2)) & 3 : 0;
+                b[i].broken = (bits & 1) != 0;
+                b[i].disabled = (bits & 2) != 0;
+            }
+            in = std::min(in + (numBeams + 3) / 4, end);
+        }
+        else
+        {
+            std::copy(b - numBeams, b, b);
+            uint64_t changed = GetVarint(in, end);
+            uint64_t index = 0;
+            while (changed-- > 0 && in < end)
+            {
+                const uint64_t v = GetVarint(in, end);
+                index += (v >> 2);
+                if (index >= (uint64_t)numBeams)
+                    break;
+                b[index].broken = (v & 1) != 0;
+                b[index].disabled = (v & 2) != 0;
+            }
+        }
+    }
+    cacheFirstFrame = first_frame;
+}
+
+void Replay::evictBlocks()
+{
+    // everything older than the replay length can't be read anymore
+    const int newest = blocks.back().first_frame + blocks.back().num_frames;
+    while (blocks.size() > 1)
+    {
+        const encoded_block_t& oldest = blocks.front();
+        if (oldest.first_frame + oldest.num_frames > newest - numFrames && blocksBytes + pendingBytes <= memoryBudget)
+            break;
+        blocksBytes -= oldest.data.capacity();
+        blocks.pop_front();
+    }
+}
+
+void Replay::dropPendingBlocks()
+{
+    // the encoder fell behind (slow CPU, huge rig) and raw blocks pile up; drop the oldest frames
+    // first, the readable history has to stay contiguous. The newest pending block is always kept.
+    while (blocksBytes + pendingBytes > memoryBudget && pending.size() > 1)
     {
-        firstRun = 0;
-        writeIndex = 0;
+        if (!blocks.empty())
+        {
+            blocksBytes -= blocks.front().data.capacity();
+            blocks.pop_front();
+            continue;
+        }
+
+        if (!encoderBehind)
+        {
+            LOG("replay encoder can't keep up with the simulation, dropping the oldest frames");
+            encoderBehind = true;
+        }
+        if (fileWriter)
+        {
+            // the dropped frames would leave a gap in the recording, finish it with what we have
+            LOG(fileWriter->Close() ? "replay recording stopped early" : "error finishing replay file, recording deleted");
+            fileWriter.reset();
+        }
+        pendingBytes -= getRawBlockBytes(pending.front());
+        if (spare.size() < 2)
+        {
+            spare.push_back(std::move(pending.front()));
+        }
+        pending.pop_front();
     }
 }
 
+size_t Replay::getRawBlockBytes(const raw_block_t& raw)
+{
+    return raw.nodes.capacity() * sizeof(node_simple_t)
+        + raw.beams.capacity() * sizeof(beam_simple_t)
+        + raw.times.capacity() * sizeof(unsigned long);
+}
+
+int Replay::getOldestFrame()
+{
+    int oldest = staging.first_frame;
+    if (!pending.empty())
+        oldest = pending.front().first_frame;
+    if (!blocks.empty())
+        oldest = blocks.front().first_frame;
+    return std::max(oldest, writeIndex - numFrames);
+}
+
 //we take negative offsets only
 void* Replay::getReadBuffer(int offset, int type, unsigned long& time)
 {
+    const int num_frames = this->getNumFrames();
     if (offset >= 0)
         offset = -1;
-    if (offset <= -numFrames)
-        offset = -numFrames + 1;
-
-    int delta = writeIndex + offset;
-    if (delta < 0)
-        if (firstRun && type == 0)
-            return (void *)(nodes);
-        else if (firstRun && type == 1)
-            return (void *)(beams);
-        else
-            delta += numFrames;
+    if (offset <= -num_frames)
+        offset = -num_frames + 1;
+
+    if (outOfMemory || (writeIndex == 0 && !fileReader))
+        return 0;
+
+    // the simulation doesn't run while we're replaying, only the encoder does
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const int end_frame = fileReader ? fileReader->GetEndFrame() : writeIndex;
+    const int first_frame = fileReader ? fileReader->GetFirstFrame() : this->getOldestFrame();
+    const int frame = std::max(end_frame + offset, first_frame);
+
+    node_simple_t* frame_nodes = 0;
+    beam_simple_t* frame_beams = 0;
+
+    if (!fileReader && frame >= staging.first_frame)
+    {
+        const int index = frame - staging.first_frame;
+        frame_nodes = &staging.nodes[index * numNodes];
+        frame_beams = staging.beams.data() + index * numBeams;
+        time = staging.times[index];
+    }
+    else
+    {
+        const bool cached = (cacheFirstFrame >= 0 && frame >= cacheFirstFrame && frame < cacheFirstFrame + cache.num_frames);
+        if (!cached && fileReader)
+        {
+            // keyframe index of the file; only the pages of this block get read
+            const RoR::ReplayFileIndexEntry* entry = fileReader->FindBlock(frame);
+            if (entry)
+            {
+                this->decodeBlock(entry->block.first_frame, entry->block.num_frames, fileReader->GetBlockData(*entry), entry->block.size);
+            }
+        }
+        else if (!cached)
+        {
+            for (const raw_block_t& raw : pending)
+            {
+                if (frame >= raw.first_frame && frame < raw.first_frame + raw.num_frames)
+                {
+                    // copy, the encoder recycles the block once it's done with it
+                    const int index = frame - raw.first_frame;
+                    readNodes.assign(raw.nodes.begin() + index * numNodes, raw.nodes.begin() + (index + 1) * numNodes);
+                    readBeams.assign(raw.beams.begin() + index * numBeams, raw.beams.begin() + (index + 1) * numBeams);
+                    frame_nodes = readNodes.data();
+                    frame_beams = readBeams.data();
+                    time = raw.times[index];
+                    break;
+                }
+            }
+
+            if (!frame_nodes && !blocks.empty())
+            {
+                // keyframe index: blocks are sorted by their first frame
+                auto itor = std::upper_bound(blocks.begin(), blocks.end(), frame,
+                    [](int f, const encoded_block_t& block) { return f < block.first_frame; });
+                if (itor != blocks.begin())
+                {
+                    --itor;
+                }
+                this->decodeBlock(itor->first_frame, itor->num_frames, itor->data.data(), itor->data.size());
+            }
+        }
+
+        if (!frame_nodes && cacheFirstFrame >= 0)
+        {
+            const int index = std::max(0, std::min(frame - cacheFirstFrame, cache.num_frames - 1));
+            frame_nodes = &cache.nodes[index * numNodes];
+            frame_beams = cache.beams.data() + index * numBeams;
+            time = cache.times[index];
+        }
+    }
+
+    if (!frame_nodes)
+        return 0;
 
     // set the time
-    time = times[delta];
     curFrameTime = time;
-    curOffset = offset;
+    curOffset = frame - end_frame;
     updateGUI();
 
-    if (outOfMemory)
-        return 0;
-
     // return buffer pointer
     if (type == 0)
-        return (void *)(nodes + delta * numNodes);
+        return (void *)frame_nodes;
     else if (type == 1)
-        return (void *)(beams + delta * numBeams);
+        return (void *)frame_beams;
     return 0;
 }
 
+bool Replay::loadFile(const Ogre::String& path, Ogre::String& error)
+{
+    std::unique_ptr<RoR::ReplayFileReader> reader(new RoR::ReplayFileReader());
+    if (!reader->Open(path, error))
+        return false;
+
+    const RoR::ReplayFileHeader& header = reader->GetHeader();
+    if ((int)header.num_nodes != numNodes || (int)header.num_beams != numBeams)
+    {
+        error = "recorded with a different rig: " + String(header.truck_file);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    fileReader = std::move(reader);
+    cacheFirstFrame = -1;
+    pr->setProgressRange(this->getNumFrames());
+    LOG("playing back replay file: " + path + " (" + TOSTRING(this->getNumFrames()) + " frames of '" + String(header.truck_file) + "')");
+    return true;
+}
+
+void Replay::closeFile()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!fileReader)
+        return;
+    fileReader.reset();
+    cacheFirstFrame = -1;
+    pr->setProgressRange(numFrames);
+}
+
+int Replay::getNumFrames()
+{
+    if (fileReader)
+        return std::max(fileReader->GetEndFrame() - fileReader->GetFirstFrame(), 1);
+    return numFrames;
+}
+
 void Replay::updateGUI()
 {
     if (outOfMemory)
@@ -189,7 +677,7 @@ void Replay::updateGUI()
         wchar_t tmp[128] = L"";
         unsigned long t = curFrameTime;
         UTFString format = _L("Position: %0.6f s, frame %i / %i");
-        swprintf(tmp, 128, format.asWStr_c_str(), ((float)t) / 1000000.0f, curOffset, numFrames);
+        swprintf(tmp, 128, format.asWStr_c_str(), ((float)t) / 1000000.0f, curOffset, this->getNumFrames());
         txt->setCaption(convertToMyGUIString(tmp, 128));
         pr->setProgressPosition(abs(curOffset));
     }
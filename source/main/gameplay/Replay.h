@@ -26,6 +26,14 @@
 
 #include "RoRPrerequisites.h"
 #include "Beam.h"
+#include "ReplayFile.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 struct node_simple_t
 {
@@ -40,17 +48,34 @@ struct beam_simple_t
     bool disabled;
 };
 
+/// Ring buffer of the last 'nframes' simulation frames of a truck.
+///
+/// Frames are recorded uncompressed into a staging block. Full blocks are encoded by a background
+/// thread into one keyframe plus deltas of quantized node states, and the oldest encoded blocks are
+/// dropped when the frame count or the memory budget (sim_replay_memory) is exceeded.
+/// Full blocks still waiting for the encoder count against the budget too; if the encoder can't keep up,
+/// the oldest of them are dropped unencoded (and a recording to file is finished, it can't have gaps).
+/// Reading a frame decodes its whole block once, so stepping back and forth within it is free.
+/// With sim_replay_record, encoded blocks are also streamed to a file (see ReplayFile.h),
+/// which loadFile() can later map for playback instead of the recorded frames.
 class Replay : public ZeroedMemoryAllocator
 {
 public:
     Replay(Beam* b, int nframes);
     ~Replay();
 
+    /// @param type 0 = node_simple_t[numNodes], 1 = beam_simple_t[numBeams]
     void* getWriteBuffer(int type);
+    /// @param offset Negative: -1 is the latest frame
     void* getReadBuffer(int offset, int type, unsigned long& time);
     unsigned long getLastReadTime();
     void writeDone();
 
+    /// Plays back a recording of this rig until closeFile()
+    bool loadFile(const Ogre::String& path, Ogre::String& error);
+    void closeFile();
+    int getNumFrames();
+
     void setHidden(bool value);
 
     void setVisible(bool value);
@@ -58,24 +83,74 @@ public:
 
     bool isValid() { return !outOfMemory; };
 protected:
+
+    static const int BLOCK_FRAMES = 32;          //!< Frames per keyframe
+
+    /// Uncompressed frames
+    struct raw_block_t
+    {
+        int first_frame;
+        int num_frames;
+        std::vector<node_simple_t> nodes;
+        std::vector<beam_simple_t> beams;
+        std::vector<unsigned long> times;
+    };
+
+    /// Keyframe plus deltas, see encodeBlock()
+    struct encoded_block_t
+    {
+        int first_frame;
+        int num_frames;
+        std::vector<char> data;
+    };
+
+    void encoderThread();
+    void encodeBlock(const raw_block_t& raw, encoded_block_t& out);
+    void decodeBlock(int first_frame, int num_frames, const char* data, size_t size);
+    void writeBlockToFile(const encoded_block_t& block);
+    void evictBlocks();
+    void dropPendingBlocks();
+    static size_t getRawBlockBytes(const raw_block_t& raw);
+    int getOldestFrame();
+
     Ogre::Timer* replayTimer;
     int numNodes;
     int numBeams;
     int numFrames;
+    size_t memoryBudget;
     bool outOfMemory;
 
     bool hidden;
     bool visible;
 
-    int writeIndex;
-    int firstRun;
+    int writeIndex;                              //!< Frames recorded so far
     unsigned long curFrameTime;
     int curOffset;
 
-    // malloc'ed
-    node_simple_t* nodes;
-    beam_simple_t* beams;
-    unsigned long* times;
+    // recording; only touched by the simulation
+    raw_block_t staging;
+
+    // guarded by 'mutex'
+    std::mutex mutex;
+    std::condition_variable encoderWakeup;
+    std::deque<raw_block_t> pending;             //!< Full blocks waiting for the encoder; the front one is being encoded
+    size_t pendingBytes;
+    std::vector<raw_block_t> spare;              //!< Encoded raw blocks for reuse
+    std::deque<encoded_block_t> blocks;          //!< Oldest first; also the keyframe index
+    size_t blocksBytes;
+    bool encoderBehind;                          //!< Pending blocks were dropped, logged once
+    bool encoderStop;
+    std::thread encoder;
+    std::unique_ptr<RoR::ReplayFileWriter> fileWriter;   //!< Encoder thread only
+    std::unique_ptr<RoR::ReplayFileReader> fileReader;   //!< Set while playing back a file
+
+    // reading
+    int cacheFirstFrame;                         //!< Block decoded into 'cache', or -1
+    raw_block_t cache;
+    std::vector<int32_t> decodeState;            //!< decodeBlock() scratch
+    std::vector<int32_t> encodeState;            //!< encodeBlock() scratch, encoder thread only
+    std::vector<node_simple_t> readNodes;        //!< A frame copied out of 'pending'
+    std::vector<beam_simple_t> readBeams;
 
     // windowing
     MyGUI::WidgetPtr panel;
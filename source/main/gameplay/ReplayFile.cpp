@@ -0,0 +1,308 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ReplayFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+using namespace RoR;
+
+// ---------------------------------------- Writer ----------------------------------------
+
+ReplayFileWriter::ReplayFileWriter()
+    : m_file(nullptr)
+    , m_offset(0)
+{
+    memset(&m_header, 0, sizeof(ReplayFileHeader));
+}
+
+ReplayFileWriter::~ReplayFileWriter()
+{
+    this->Close();
+}
+
+bool ReplayFileWriter::Open(const std::string& path, const ReplayFileHeader& header)
+{
+    this->Close();
+
+    m_file = fopen(path.c_str(), "wb");
+    if (m_file == nullptr)
+        return false;
+
+    m_path = path;
+    m_header = header;
+    memcpy(m_header.magic, REPLAY_FILE_MAGIC, sizeof(m_header.magic));
+    m_header.version = REPLAY_FILE_VERSION;
+    m_header.num_blocks = 0;
+    m_header.index_offset = 0;
+    m_index.clear();
+
+    if (fwrite(&m_header, sizeof(ReplayFileHeader), 1, m_file) != 1)
+    {
+        fclose(m_file);
+        m_file = nullptr;
+        return false;
+    }
+    m_offset = sizeof(ReplayFileHeader);
+    return true;
+}
+
+bool ReplayFileWriter::WriteBlock(int first_frame, int num_frames, const char* data, size_t size)
+{
+    if (m_file == nullptr)
+        return false;
+
+    ReplayFileIndexEntry entry;
+    entry.block.first_frame = first_frame;
+    entry.block.num_frames = num_frames;
+    entry.block.size = (uint32_t)size;
+    entry.offset = m_offset + sizeof(ReplayFileBlock);
+
+    if (fwrite(&entry.block, sizeof(ReplayFileBlock), 1, m_file) != 1 ||
+        (size > 0 && fwrite(data, size, 1, m_file) != 1))
+    {
+        return false;
+    }
+    m_offset = entry.offset + size;
+    m_index.push_back(entry);
+    return true;
+}
+
+bool ReplayFileWriter::Close()
+{
+    if (m_file == nullptr)
+        return true;
+
+    if (m_index.empty())
+    {
+        // Nothing was recorded (the rig never moved), don't leave an empty file behind
+        fclose(m_file);
+        m_file = nullptr;
+        remove(m_path.c_str());
+        return true;
+    }
+
+    m_header.num_blocks = (uint32_t)m_index.size();
+    m_header.index_offset = m_offset;
+    bool ok = fwrite(m_index.data(), sizeof(ReplayFileIndexEntry), m_index.size(), m_file) == m_index.size();
+    ok = ok && fseek(m_file, 0, SEEK_SET) == 0;
+    ok = ok && fwrite(&m_header, sizeof(ReplayFileHeader), 1, m_file) == 1;
+    ok = (fclose(m_file) == 0) && ok; // Buffered data is flushed here, so this can fail too
+    m_file = nullptr;
+    m_index.clear();
+
+    if (!ok)
+    {
+        remove(m_path.c_str());
+    }
+    return ok;
+}
+
+// ---------------------------------------- Reader ----------------------------------------
+
+ReplayFileReader::ReplayFileReader()
+    : m_data(nullptr)
+    , m_size(0)
+#ifdef _WIN32
+    , m_file_handle(INVALID_HANDLE_VALUE)
+    , m_mapping(nullptr)
+#else
+    , m_fd(-1)
+#endif
+{
+    memset(&m_header, 0, sizeof(ReplayFileHeader));
+}
+
+ReplayFileReader::~ReplayFileReader()
+{
+    this->Close();
+}
+
+bool ReplayFileReader::Open(const std::string& path, std::string& error)
+{
+    this->Close();
+
+#ifdef _WIN32
+    m_file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_file_handle == INVALID_HANDLE_VALUE)
+    {
+        error = "cannot open file";
+        return false;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(m_file_handle, &size);
+    m_size = (size_t)size.QuadPart;
+    if (m_size >= sizeof(ReplayFileHeader))
+    {
+        m_mapping = CreateFileMappingA(m_file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (m_mapping != nullptr)
+        {
+            m_data = (const char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+        }
+    }
+#else
+    m_fd = open(path.c_str(), O_RDONLY);
+    if (m_fd < 0)
+    {
+        error = "cannot open file";
+        return false;
+    }
+    struct stat st;
+    fstat(m_fd, &st);
+    m_size = (size_t)st.st_size;
+    if (m_size >= sizeof(ReplayFileHeader))
+    {
+        void* addr = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+        if (addr != MAP_FAILED)
+        {
+            m_data = (const char*)addr;
+            // Scrubbing jumps around; don't let the kernel read ahead whole chunks of the file
+            madvise(addr, m_size, MADV_RANDOM);
+        }
+    }
+#endif
+
+    if (m_data == nullptr)
+    {
+        error = (m_size < sizeof(ReplayFileHeader)) ? "file too small" : "cannot map file";
+        this->Close();
+        return false;
+    }
+
+    memcpy(&m_header, m_data, sizeof(ReplayFileHeader));
+    if (memcmp(m_header.magic, REPLAY_FILE_MAGIC, sizeof(m_header.magic)) != 0)
+    {
+        error = "not a replay file";
+        this->Close();
+        return false;
+    }
+    if (m_header.version != REPLAY_FILE_VERSION)
+    {
+        error = "unsupported replay file version " + std::to_string(m_header.version);
+        this->Close();
+        return false;
+    }
+    m_header.truck_file[sizeof(m_header.truck_file) - 1] = 0;
+    m_header.truck_guid[sizeof(m_header.truck_guid) - 1] = 0;
+    m_header.truck_hash[sizeof(m_header.truck_hash) - 1] = 0;
+
+    const uint64_t index_size = (uint64_t)m_header.num_blocks * sizeof(ReplayFileIndexEntry);
+    if (m_header.num_blocks > 0 && m_header.index_offset + index_size <= m_size)
+    {
+        m_index.resize(m_header.num_blocks);
+        memcpy(m_index.data(), m_data + m_header.index_offset, (size_t)index_size);
+    }
+    else if (!this->RecoverIndex())
+    {
+        error = "no frames recorded";
+        this->Close();
+        return false;
+    }
+
+    // Blocks pointing outside the file would be read past the mapping
+    for (const ReplayFileIndexEntry& entry : m_index)
+    {
+        if (entry.offset + entry.block.size > m_size || entry.block.num_frames < 1 ||
+            (uint32_t)entry.block.num_frames > m_header.block_frames)
+        {
+            error = "corrupted block index";
+            this->Close();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ReplayFileReader::RecoverIndex()
+{
+    m_index.clear();
+    uint64_t offset = sizeof(ReplayFileHeader);
+    while (offset + sizeof(ReplayFileBlock) <= m_size)
+    {
+        ReplayFileIndexEntry entry;
+        memcpy(&entry.block, m_data + offset, sizeof(ReplayFileBlock));
+        entry.offset = offset + sizeof(ReplayFileBlock);
+        if (entry.offset + entry.block.size > m_size || entry.block.num_frames < 1 ||
+            (!m_index.empty() && entry.block.first_frame != m_index.back().block.first_frame + m_index.back().block.num_frames))
+        {
+            break; // Cut off mid-write
+        }
+        m_index.push_back(entry);
+        offset = entry.offset + entry.block.size;
+    }
+    return !m_index.empty();
+}
+
+void ReplayFileReader::Close()
+{
+#ifdef _WIN32
+    if (m_data != nullptr)
+        UnmapViewOfFile(m_data);
+    if (m_mapping != nullptr)
+        CloseHandle(m_mapping);
+    if (m_file_handle != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file_handle);
+    m_mapping = nullptr;
+    m_file_handle = INVALID_HANDLE_VALUE;
+#else
+    if (m_data != nullptr)
+        munmap((void*)m_data, m_size);
+    if (m_fd >= 0)
+        close(m_fd);
+    m_fd = -1;
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_index.clear();
+}
+
+int ReplayFileReader::GetFirstFrame() const
+{
+    return m_index.empty() ? 0 : m_index.front().block.first_frame;
+}
+
+int ReplayFileReader::GetEndFrame() const
+{
+    return m_index.empty() ? 0 : m_index.back().block.first_frame + m_index.back().block.num_frames;
+}
+
+const ReplayFileIndexEntry* ReplayFileReader::FindBlock(int frame) const
+{
+    if (m_index.empty())
+        return nullptr;
+
+    // Blocks are sorted by their first frame
+    auto itor = std::upper_bound(m_index.begin(), m_index.end(), frame,
+        [](int f, const ReplayFileIndexEntry& entry) { return f < entry.block.first_frame; });
+    if (itor != m_index.begin())
+        --itor;
+    return &(*itor);
+}
@@ -0,0 +1,133 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// @file
+/// @brief On-disk replay recordings: the blocks encoded by Replay, streamed to a file while
+///        recording and memory-mapped for playback.
+///
+/// Layout: ReplayFileHeader, then per block a ReplayFileBlock followed by its data,
+/// then the index (one ReplayFileIndexEntry per block) at 'header.index_offset'.
+/// The index and the block count are written when recording ends; if that didn't happen
+/// (crash), the reader recovers the index by walking the blocks.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace RoR {
+
+static const char     REPLAY_FILE_MAGIC[8] = { 'R', 'o', 'R', 'R', 'p', 'l', 'y', 0 };
+static const uint32_t REPLAY_FILE_VERSION = 1;
+
+#pragma pack(push, 1)
+
+struct ReplayFileHeader
+{
+    char     magic[8];            //!< REPLAY_FILE_MAGIC
+    uint32_t version;             //!< REPLAY_FILE_VERSION; also covers the block encoding, see Replay::encodeBlock()
+    uint32_t num_nodes;
+    uint32_t num_beams;
+    uint32_t block_frames;        //!< Max. frames per block
+    uint32_t num_blocks;          //!< 0 if the recording wasn't finished
+    uint64_t index_offset;
+    // Rig identity, from the cache entry
+    char     truck_file[256];
+    char     truck_guid[128];
+    char     truck_hash[64];
+    int32_t  truck_version;
+};
+
+struct ReplayFileBlock
+{
+    int32_t  first_frame;
+    int32_t  num_frames;
+    uint32_t size;                //!< Bytes of data following
+};
+
+struct ReplayFileIndexEntry
+{
+    ReplayFileBlock block;
+    uint64_t offset;              //!< File offset of the block data
+};
+
+#pragma pack(pop)
+
+/// Appends blocks as they're encoded; not thread safe.
+class ReplayFileWriter
+{
+public:
+    ReplayFileWriter();
+    ~ReplayFileWriter();
+
+    bool Open(const std::string& path, const ReplayFileHeader& header);
+    bool WriteBlock(int first_frame, int num_frames, const char* data, size_t size);
+    /// Writes the index and completes the header; deletes the file if no blocks were written
+    /// @return False if finishing the file failed; the incomplete file is deleted in that case
+    bool Close();
+
+    bool IsOpen() const { return m_file != nullptr; }
+
+private:
+    FILE*                             m_file;
+    std::string                       m_path;
+    ReplayFileHeader                  m_header;
+    std::vector<ReplayFileIndexEntry> m_index;
+    uint64_t                          m_offset;
+};
+
+/// Maps a recording into memory; blocks are read in place, so only the pages of the blocks
+/// actually decoded are loaded from disk.
+class ReplayFileReader
+{
+public:
+    ReplayFileReader();
+    ~ReplayFileReader();
+
+    bool Open(const std::string& path, std::string& error);
+    void Close();
+
+    const ReplayFileHeader& GetHeader() const { return m_header; }
+    int GetFirstFrame() const;
+    int GetEndFrame() const;          //!< One past the last frame
+
+    /// The block holding 'frame', looked up in the index; nullptr if there are no blocks.
+    const ReplayFileIndexEntry* FindBlock(int frame) const;
+    const char* GetBlockData(const ReplayFileIndexEntry& entry) const { return m_data + entry.offset; }
+
+private:
+    bool RecoverIndex();
+
+    ReplayFileHeader                  m_header;
+    std::vector<ReplayFileIndexEntry> m_index;
+    const char*                       m_data;
+    size_t                            m_size;
+#ifdef _WIN32
+    void*                             m_file_handle;
+    void*                             m_mapping;
+#else
+    int                               m_fd;
+#endif
+};
+
+} // namespace RoR
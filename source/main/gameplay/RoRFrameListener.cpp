@@ -168,11 +168,11 @@ void RoRFrameListener::UpdateForceFeedback(float dt)
         int cameranodedir = 0;
         int cameranoderoll = 0;
 
-        if (current_truck->cameranodepos[0] >= 0 && current_truck->cameranodepos[0] < MAX_NODES)
+        if (current_truck->cameranodepos[0] >= 0 && current_truck->cameranodepos[0] < current_truck->free_node)
             cameranodepos = current_truck->cameranodepos[0];
-        if (current_truck->cameranodedir[0] >= 0 && current_truck->cameranodedir[0] < MAX_NODES)
+        if (current_truck->cameranodedir[0] >= 0 && current_truck->cameranodedir[0] < current_truck->free_node)
             cameranodedir = current_truck->cameranodedir[0];
-        if (current_truck->cameranoderoll[0] >= 0 && current_truck->cameranoderoll[0] < MAX_NODES)
+        if (current_truck->cameranoderoll[0] >= 0 && current_truck->cameranoderoll[0] < current_truck->free_node)
             cameranoderoll = current_truck->cameranoderoll[0];
 
         Vector3 udir = current_truck->nodes[cameranodepos].RelPosition - current_truck->nodes[cameranodedir].RelPosition;
@@ -1561,7 +1561,7 @@ bool RoRFrameListener::frameStarted(const FrameEvent& evt)
 #ifdef USE_SOCKETW
     if (mp_connected)
     {
-        std::vector<Networking::recv_packet_t> packets = RoR::Networking::GetIncomingStreamData();
+        const std::vector<Networking::recv_packet_t>& packets = RoR::Networking::GetIncomingStreamData();
 
         RoR::ChatSystem::HandleStreamData(packets);
         m_beam_factory.handleStreamData(packets);
@@ -0,0 +1,147 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "StateStreamFile.h"
+
+#include <cstring>
+
+using namespace RoR;
+
+// ---------------------------------------- Writer ----------------------------------------
+
+StateStreamWriter::StateStreamWriter()
+    : m_file(nullptr)
+{
+}
+
+StateStreamWriter::~StateStreamWriter()
+{
+    this->Close();
+}
+
+bool StateStreamWriter::Open(const std::string& path, const StateStreamHeader& header)
+{
+    this->Close();
+
+    m_file = fopen(path.c_str(), "wb");
+    if (m_file == nullptr)
+        return false;
+
+    StateStreamHeader out = header;
+    memcpy(out.magic, STATE_STREAM_MAGIC, sizeof(out.magic));
+    out.version = STATE_STREAM_VERSION;
+
+    if (fwrite(&out, sizeof(StateStreamHeader), 1, m_file) != 1 || fflush(m_file) != 0)
+    {
+        fclose(m_file);
+        m_file = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool StateStreamWriter::WriteRecord(uint32_t frame, const char* data, size_t size)
+{
+    if (m_file == nullptr)
+        return false;
+
+    StateStreamRecord record;
+    record.frame = frame;
+    record.size = (uint32_t)size;
+
+    return fwrite(&record, sizeof(StateStreamRecord), 1, m_file) == 1 &&
+        (size == 0 || fwrite(data, size, 1, m_file) == 1) &&
+        fflush(m_file) == 0; // A reader on the other end of a pipe waits for whole frames
+}
+
+bool StateStreamWriter::Close()
+{
+    if (m_file == nullptr)
+        return true;
+
+    // Unlike replays, a partial stream is still valid up to its last complete record; keep it
+    const bool ok = (fclose(m_file) == 0);
+    m_file = nullptr;
+    return ok;
+}
+
+// ---------------------------------------- Reader ----------------------------------------
+
+StateStreamReader::StateStreamReader()
+    : m_file(nullptr)
+{
+    memset(&m_header, 0, sizeof(StateStreamHeader));
+}
+
+StateStreamReader::~StateStreamReader()
+{
+    this->Close();
+}
+
+bool StateStreamReader::Open(const std::string& path, std::string& error)
+{
+    this->Close();
+
+    m_file = fopen(path.c_str(), "rb");
+    if (m_file == nullptr)
+    {
+        error = "cannot open file";
+        return false;
+    }
+
+    if (fread(&m_header, sizeof(StateStreamHeader), 1, m_file) != 1)
+    {
+        error = "file too small";
+    }
+    else if (memcmp(m_header.magic, STATE_STREAM_MAGIC, sizeof(m_header.magic)) != 0)
+    {
+        error = "not a state stream";
+    }
+    else if (m_header.version != STATE_STREAM_VERSION)
+    {
+        error = "unsupported version";
+    }
+    else
+    {
+        return true;
+    }
+
+    this->Close();
+    return false;
+}
+
+void StateStreamReader::Close()
+{
+    if (m_file != nullptr)
+    {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+bool StateStreamReader::ReadRecord(StateStreamRecord& record, std::vector<char>& data)
+{
+    if (m_file == nullptr || fread(&record, sizeof(StateStreamRecord), 1, m_file) != 1)
+        return false;
+
+    data.resize(record.size);
+    return record.size == 0 || fread(&data[0], record.size, 1, m_file) == 1;
+}
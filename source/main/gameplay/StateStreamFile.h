@@ -0,0 +1,101 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// @file
+/// @brief State stream of the headless host (command line '-statestream <file>'): the truck's
+///        RoRnet stream registration, then its state once per simulated frame.
+///
+/// Layout: StateStreamHeader, then per frame a StateStreamRecord followed by 'size' bytes of
+/// MSG2_STREAM_DATA payload, packed by Beam::PackStreamData() in the legacy (uncompressed)
+/// format: a RoRnet::TruckState, then the nodes as in Beam::receiveStreamData().
+/// Every record stands on its own and the file is only ever appended to, so it can be read
+/// while it grows, or be a named pipe.
+
+#pragma once
+
+#include "RoRnet.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace RoR {
+
+static const char     STATE_STREAM_MAGIC[8] = { 'R', 'o', 'R', 'S', 't', 'a', 't', 0 };
+static const uint32_t STATE_STREAM_VERSION = 1;
+
+#pragma pack(push, 1)
+
+struct StateStreamHeader
+{
+    char     magic[8];            //!< STATE_STREAM_MAGIC
+    uint32_t version;             //!< STATE_STREAM_VERSION
+    uint32_t rate_hz;             //!< Simulated frames per second
+    RoRnet::TruckStreamRegister truck; //!< As sent to a multiplayer server; 'bufferSize' is the node data size
+};
+
+struct StateStreamRecord
+{
+    uint32_t frame;
+    uint32_t size;                //!< Bytes of data following
+};
+
+#pragma pack(pop)
+
+/// Appends one record per frame and flushes it, so readers see complete frames; not thread safe.
+class StateStreamWriter
+{
+public:
+    StateStreamWriter();
+    ~StateStreamWriter();
+
+    bool Open(const std::string& path, const StateStreamHeader& header);
+    bool WriteRecord(uint32_t frame, const char* data, size_t size);
+    bool Close();
+
+    bool IsOpen() const { return m_file != nullptr; }
+
+private:
+    FILE*       m_file;
+};
+
+/// Reads the records in order; works on pipes, nothing is seeked.
+class StateStreamReader
+{
+public:
+    StateStreamReader();
+    ~StateStreamReader();
+
+    bool Open(const std::string& path, std::string& error);
+    void Close();
+
+    const StateStreamHeader& GetHeader() const { return m_header; }
+
+    /// @return False at the end of the stream or if the record is incomplete
+    bool ReadRecord(StateStreamRecord& record, std::vector<char>& data);
+
+private:
+    StateStreamHeader m_header;
+    FILE*             m_file;
+};
+
+} // namespace RoR
@@ -21,6 +21,7 @@
 #include "DustPool.h"
 
 #include <Ogre.h>
+#include <algorithm>
 
 #include "RoRPrerequisites.h"
 #include "TerrainManager.h"
@@ -28,16 +29,55 @@
 
 using namespace Ogre;
 
-#ifndef _WIN32
-// This definitions is needed because the variable is declared but not defined in DustPool
-  const int DustPool::MAX_DUSTS;
-#endif // !_WIN32
+const float DustPool::COALESCE_DISTANCE = 1.0f;
+
+namespace {
+
+std::atomic<unsigned long long> g_used_producer_slots(0);
+
+/// Index of a thread's event buffer in every DustPool; released when the thread exits
+struct ProducerSlot
+{
+    int index;
+
+    ProducerSlot(): index(-1)
+    {
+        unsigned long long used = g_used_producer_slots.load(std::memory_order_relaxed);
+        while (used != ~0ull)
+        {
+            int free_slot = 0;
+            while (used & (1ull << free_slot))
+                free_slot++;
+            if (g_used_producer_slots.compare_exchange_weak(used, used | (1ull << free_slot), std::memory_order_acquire))
+            {
+                index = free_slot;
+                break;
+            }
+        }
+    }
+
+    ~ProducerSlot()
+    {
+        if (index >= 0)
+            g_used_producer_slots.fetch_and(~(1ull << index), std::memory_order_release);
+    }
+};
+
+} // namespace
 
 DustPool::DustPool(Ogre::SceneManager* sm, const char* dname, int dsize):
-	allocated(0),
-	size(std::min(dsize, static_cast<int>(MAX_DUSTS))),
+	size(std::max(dsize, 0)),
 	m_is_discarded(false)
 {
+    static_assert(MAX_PRODUCERS <= 64, "Producer slots are tracked in a 64-bit mask");
+
+    for (int i = 0; i < MAX_PRODUCERS; i++)
+    {
+        m_event_buffers[i] = nullptr;
+    }
+
+    pss.resize(size, nullptr);
+    sns.resize(size, nullptr);
     for (int i = 0; i < size; i++)
     {
         char dename[256];
@@ -76,6 +116,10 @@ void DustPool::Discard(Ogre::SceneManager* sm)
 			pss[i] = nullptr;
 		}
 	}
+	for (int i = 0; i < MAX_PRODUCERS; i++)
+	{
+		delete m_event_buffers[i].exchange(nullptr);
+	}
 	m_is_discarded = true;
 }
 
@@ -87,47 +131,57 @@ void DustPool::setVisible(bool s)
     }
 }
 
-//Dust
-void DustPool::malloc(Vector3 pos, Vector3 vel, ColourValue col)
+void DustPool::push(const dust_event_t& ev)
 {
-    std::lock_guard<std::mutex> lock(m_allocation_mutex);
-    if (allocated < size)
+    static thread_local ProducerSlot slot;
+    if (slot.index < 0)
+        return; // too many emitting threads
+
+    event_queue_t* buf = m_event_buffers[slot.index].load(std::memory_order_acquire);
+    if (buf == nullptr)
     {
-        positions[allocated] = pos;
-        velocities[allocated] = vel;
-        colours[allocated] = col;
-        types[allocated] = DUST_NORMAL;
-        allocated++;
+        // only this thread ever installs a buffer into its slot
+        buf = new event_queue_t(EVENT_BUFFER_SIZE);
+        m_event_buffers[slot.index].store(buf, std::memory_order_release);
     }
+
+    buf->push(ev); // fails once the budget of this frame is exhausted
+}
+
+//Dust
+void DustPool::malloc(Vector3 pos, Vector3 vel, ColourValue col)
+{
+    dust_event_t ev;
+    ev.position = pos;
+    ev.velocity = vel;
+    ev.colour = col;
+    ev.rate = 0.f;
+    ev.type = DUST_NORMAL;
+    push(ev);
 }
 
 //Clumps
 void DustPool::allocClump(Vector3 pos, Vector3 vel, ColourValue col)
 {
-    std::lock_guard<std::mutex> lock(m_allocation_mutex);
-    if (allocated < size)
-    {
-        positions[allocated] = pos;
-        velocities[allocated] = vel;
-        colours[allocated] = col;
-        types[allocated] = DUST_CLUMP;
-        //visible[allocated]=true;
-        allocated++;
-    }
+    dust_event_t ev;
+    ev.position = pos;
+    ev.velocity = vel;
+    ev.colour = col;
+    ev.rate = 0.f;
+    ev.type = DUST_CLUMP;
+    push(ev);
 }
 
 //Rubber smoke
 void DustPool::allocSmoke(Vector3 pos, Vector3 vel)
 {
-    std::lock_guard<std::mutex> lock(m_allocation_mutex);
-    if (allocated < size)
-    {
-        positions[allocated] = pos;
-        velocities[allocated] = vel;
-        types[allocated] = DUST_RUBBER;
-        //visible[allocated]=true;
-        allocated++;
-    }
+    dust_event_t ev;
+    ev.position = pos;
+    ev.velocity = vel;
+    ev.colour = ColourValue::White;
+    ev.rate = 0.f;
+    ev.type = DUST_RUBBER;
+    push(ev);
 }
 
 //
@@ -135,81 +189,137 @@ void DustPool::allocSparks(Vector3 pos, Vector3 vel)
 {
     if (vel.length() < 0.1)
         return; // try to prevent emitting sparks while standing
-    std::lock_guard<std::mutex> lock(m_allocation_mutex);
-    if (allocated < size)
-    {
-        positions[allocated] = pos;
-        velocities[allocated] = vel;
-        types[allocated] = DUST_SPARKS;
-        //visible[allocated]=true;
-        allocated++;
-    }
+    dust_event_t ev;
+    ev.position = pos;
+    ev.velocity = vel;
+    ev.colour = ColourValue::White;
+    ev.rate = 0.f;
+    ev.type = DUST_SPARKS;
+    push(ev);
 }
 
 //Water vapour
 void DustPool::allocVapour(Vector3 pos, Vector3 vel, float time)
 {
-    std::lock_guard<std::mutex> lock(m_allocation_mutex);
-    if (allocated < size)
-    {
-        positions[allocated] = pos;
-        velocities[allocated] = vel;
-        types[allocated] = DUST_VAPOUR;
-        rates[allocated] = 5.0 - time;
-        //visible[allocated]=true;
-        allocated++;
-    }
+    dust_event_t ev;
+    ev.position = pos;
+    ev.velocity = vel;
+    ev.colour = ColourValue::White;
+    ev.rate = 5.0 - time;
+    ev.type = DUST_VAPOUR;
+    push(ev);
 }
 
 void DustPool::allocDrip(Vector3 pos, Vector3 vel, float time)
 {
-    std::lock_guard<std::mutex> lock(m_allocation_mutex);
-    if (allocated < size)
-    {
-        positions[allocated] = pos;
-        velocities[allocated] = vel;
-        types[allocated] = DUST_DRIP;
-        rates[allocated] = 5.0 - time;
-        //visible[allocated]=true;
-        allocated++;
-    }
+    dust_event_t ev;
+    ev.position = pos;
+    ev.velocity = vel;
+    ev.colour = ColourValue::White;
+    ev.rate = 5.0 - time;
+    ev.type = DUST_DRIP;
+    push(ev);
 }
 
 void DustPool::allocSplash(Vector3 pos, Vector3 vel)
 {
-    std::lock_guard<std::mutex> lock(m_allocation_mutex);
-    if (allocated < size)
-    {
-        positions[allocated] = pos;
-        velocities[allocated] = vel;
-        types[allocated] = DUST_SPLASH;
-        //visible[allocated]=true;
-        allocated++;
-    }
+    dust_event_t ev;
+    ev.position = pos;
+    ev.velocity = vel;
+    ev.colour = ColourValue::White;
+    ev.rate = 0.f;
+    ev.type = DUST_SPLASH;
+    push(ev);
 }
 
 void DustPool::allocRipple(Vector3 pos, Vector3 vel)
 {
-    std::lock_guard<std::mutex> lock(m_allocation_mutex);
-    if (allocated < size)
-    {
-        positions[allocated] = pos;
-        velocities[allocated] = vel;
-        types[allocated] = DUST_RIPPLE;
-        //visible[allocated]=true;
-        allocated++;
-    }
+    dust_event_t ev;
+    ev.position = pos;
+    ev.velocity = vel;
+    ev.colour = ColourValue::White;
+    ev.rate = 0.f;
+    ev.type = DUST_RIPPLE;
+    push(ev);
+}
+
+bool DustPool::dust_cell_t::operator<(const dust_cell_t& other) const
+{
+    if (type != other.type)
+        return type < other.type;
+    if (x != other.x)
+        return x < other.x;
+    if (y != other.y)
+        return y < other.y;
+    return z < other.z;
 }
 
 void DustPool::update()
 {
-    std::lock_guard<std::mutex> lock(m_allocation_mutex);
-    for (int i = 0; i < allocated; i++)
+    // collect the requests of all threads
+    m_frame_events.clear();
+    for (int i = 0; i < MAX_PRODUCERS; i++)
+    {
+        event_queue_t* buf = m_event_buffers[i].load(std::memory_order_acquire);
+        if (buf != nullptr)
+        {
+            buf->pull(m_frame_events);
+        }
+    }
+
+    // merge requests of the same kind within one grid cell
+    m_frame_cells.clear();
+    for (int i = 0; i < (int)m_frame_events.size(); i++)
+    {
+        const Vector3& p = m_frame_events[i].position;
+        dust_cell_t cell;
+        cell.type = m_frame_events[i].type;
+        cell.x = (int)floor(p.x / COALESCE_DISTANCE);
+        cell.y = (int)floor(p.y / COALESCE_DISTANCE);
+        cell.z = (int)floor(p.z / COALESCE_DISTANCE);
+        cell.event = i;
+        m_frame_cells.push_back(cell);
+    }
+    std::sort(m_frame_cells.begin(), m_frame_cells.end());
+
+    emitting.clear();
+    for (size_t begin = 0; begin < m_frame_cells.size();)
+    {
+        size_t end = begin + 1;
+        dust_event_t merged = m_frame_events[m_frame_cells[begin].event];
+        while (end < m_frame_cells.size() && !(m_frame_cells[begin] < m_frame_cells[end]))
+        {
+            const dust_event_t& ev = m_frame_events[m_frame_cells[end].event];
+            merged.position += ev.position;
+            merged.velocity += ev.velocity;
+            merged.colour += ev.colour;
+            merged.rate = std::max(merged.rate, ev.rate);
+            end++;
+        }
+        const float count = (float)(end - begin);
+        merged.position /= count;
+        merged.velocity /= count;
+        merged.colour /= count;
+        emitting.push_back(merged);
+        begin = end;
+    }
+
+    // per-frame budget: one emitter per merged request, the fastest ones win
+    if ((int)emitting.size() > size)
+    {
+        std::nth_element(emitting.begin(), emitting.begin() + size, emitting.end(),
+            [](const dust_event_t& a, const dust_event_t& b) { return a.velocity.squaredLength() > b.velocity.squaredLength(); });
+        emitting.resize(size);
+    }
+
+    for (int i = 0; i < (int)emitting.size(); i++)
     {
         ParticleEmitter* emit = pss[i]->getEmitter(0);
-        Vector3 ndir = velocities[i];
+        Vector3 ndir = emitting[i].velocity;
         Real vel = ndir.length();
-        ColourValue col = colours[i];
+        ColourValue col = emitting[i].colour;
+        const float rate = emitting[i].rate;
+        const int type = emitting[i].type;
 
         if (vel == 0)
             vel += 0.0001;
@@ -217,14 +327,14 @@ void DustPool::update()
 
         emit->setEnabled(true);
 
-        if (types[i] != DUST_RIPPLE)
+        if (type != DUST_RIPPLE)
         {
             emit->setDirection(ndir);
             emit->setParticleVelocity(vel);
-            sns[i]->setPosition(positions[i]);
+            sns[i]->setPosition(emitting[i].position);
         }
 
-        if (types[i] == DUST_NORMAL)
+        if (type == DUST_NORMAL)
         {
             ndir.y = 0;
             ndir = ndir / 2.0;
@@ -232,7 +342,7 @@ void DustPool::update()
             col.a = vel * 0.05;
             emit->setTimeToLive(vel * 0.05 / 0.1);
         }
-        else if (types[i] == DUST_CLUMP)
+        else if (type == DUST_CLUMP)
         {
             ndir = ndir / 2.0;
             if (ndir.y < 0)
@@ -240,7 +350,7 @@ void DustPool::update()
 
             col.a = 1.0;
         }
-        else if (types[i] == DUST_RUBBER)
+        else if (type == DUST_RUBBER)
         {
             ndir.y = 0;
             ndir = ndir / 4.0;
@@ -252,26 +362,26 @@ void DustPool::update()
 
             emit->setTimeToLive(vel * 0.025 / 0.1);
         }
-        else if (types[i] == DUST_SPARKS)
+        else if (type == DUST_SPARKS)
         {
             //ugh
         }
-        else if (types[i] == DUST_VAPOUR)
+        else if (type == DUST_VAPOUR)
         {
             emit->setParticleVelocity(vel / 2.0);
 
-            col.a = rates[i] * 0.03;
+            col.a = rate * 0.03;
             col.b = 0.9;
             col.g = 0.9;
             col.r = 0.9;
 
-            emit->setTimeToLive(rates[i] * 0.03 / 0.1);
+            emit->setTimeToLive(rate * 0.03 / 0.1);
         }
-        else if (types[i] == DUST_DRIP)
+        else if (type == DUST_DRIP)
         {
-            emit->setEmissionRate(rates[i]);
+            emit->setEmissionRate(rate);
         }
-        else if (types[i] == DUST_SPLASH)
+        else if (type == DUST_SPLASH)
         {
             if (ndir.y < 0)
                 ndir.y = -ndir.y / 2.0;
@@ -285,10 +395,11 @@ void DustPool::update()
 
             emit->setTimeToLive(vel * 0.025 / 0.1);
         }
-        else if (types[i] == DUST_RIPPLE)
+        else if (type == DUST_RIPPLE)
         {
-            positions[i].y = gEnv->terrainManager->getWater()->getHeight() - 0.02;
-            sns[i]->setPosition(positions[i]);
+            Vector3 pos = emitting[i].position;
+            pos.y = gEnv->terrainManager->getWater()->getHeight() - 0.02;
+            sns[i]->setPosition(pos);
 
             col.a = vel * 0.04;
             col.b = 0.9;
@@ -300,9 +411,8 @@ void DustPool::update()
 
         emit->setColour(col);
     }
-    for (int i = allocated; i < size; i++)
+    for (int i = (int)emitting.size(); i < size; i++)
     {
         pss[i]->getEmitter(0)->setEnabled(false);
     }
-    allocated = 0;
 }
@@ -20,10 +20,18 @@
 
 #pragma once
 
+#include "LockFreeQueue.h"
 #include "RoRPrerequisites.h"
 
-#include <mutex>
+#include <atomic>
+#include <vector>
 
+/// Particle effects requested by the simulation.
+///
+/// The alloc*() functions may be called from any thread; each thread queues its requests into
+/// its own LockFreeQueue, so producers never contend. update() runs on the render thread once per frame: it drains the buffers,
+/// merges requests of the same kind which are close to each other and drives at most one
+/// emitter per merged request, strongest first, up to the pool size.
 class DustPool : public ZeroedMemoryAllocator
 {
 public:
@@ -55,7 +63,9 @@ public:
 
 protected:
 
-    static const int MAX_DUSTS = 100;
+    static const int MAX_PRODUCERS = 64;         //!< Threads which may emit at the same time
+    static const int EVENT_BUFFER_SIZE = 1024;   //!< Requests per thread and frame
+    static const float COALESCE_DISTANCE;        //!< Grid size for merging requests [m]
 
     enum DustTypes
     {
@@ -69,17 +79,36 @@ protected:
         DUST_CLUMP
     };
 
-    Ogre::ColourValue colours[MAX_DUSTS];
-    Ogre::ParticleSystem* pss[MAX_DUSTS];
-    Ogre::SceneNode* sns[MAX_DUSTS];
-    Ogre::Vector3 positions[MAX_DUSTS];
-    Ogre::Vector3 velocities[MAX_DUSTS];
-    bool visible[MAX_DUSTS];
-    float rates[MAX_DUSTS];
-    int allocated;
+    struct dust_event_t
+    {
+        Ogre::Vector3 position;
+        Ogre::Vector3 velocity;
+        Ogre::ColourValue colour;
+        float rate;
+        int type;
+    };
+
+    /// Requests of one thread; the render thread consumes
+    typedef LockFreeQueue<dust_event_t> event_queue_t;
+
+    /// Merged request, cell coordinates of the coalescing grid
+    struct dust_cell_t
+    {
+        int type, x, y, z;
+        int event;
+
+        bool operator<(const dust_cell_t& other) const;
+    };
+
+    void push(const dust_event_t& ev);
+
+    std::vector<Ogre::ParticleSystem*> pss;
+    std::vector<Ogre::SceneNode*> sns;
+    std::vector<dust_event_t> emitting; //!< Requests driving the emitters this frame
     int size;
-    int types[MAX_DUSTS];
 	bool m_is_discarded;
 
-    std::mutex m_allocation_mutex;
+    std::atomic<event_queue_t*> m_event_buffers[MAX_PRODUCERS]; //!< Indexed by producer slot, created on first use
+    std::vector<dust_event_t> m_frame_events;
+    std::vector<dust_cell_t> m_frame_cells;
 };
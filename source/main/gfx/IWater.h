@@ -38,6 +38,17 @@ public:
     virtual float getHeightWaves(Ogre::Vector3 pos) = 0;
     virtual Ogre::Vector3 getVelocity(Ogre::Vector3 pos) = 0;
 
+    /// getHeightWaves() and getVelocity() for many points at once; 'velocities' may be nullptr.
+    virtual void getWavesBatch(const Ogre::Vector3* positions, int count, float* heights, Ogre::Vector3* velocities)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            heights[i] = getHeightWaves(positions[i]);
+            if (velocities)
+                velocities[i] = getVelocity(positions[i]);
+        }
+    }
+
     virtual void setCamera(Ogre::Camera* cam) = 0;
     virtual void setFadeColour(Ogre::ColourValue ambient) = 0;
     virtual void setHeight(float value) = 0;
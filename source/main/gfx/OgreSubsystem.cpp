@@ -162,6 +162,17 @@ bool OgreSubsystem::StartOgre(Ogre::String const & hwnd, Ogre::String const & ma
     return true;
 }
 
+bool OgreSubsystem::StartOgreHeadless()
+{
+    std::string log_filepath = std::string(RoR::App::sys_logs_dir.GetActive()) + PATH_SLASH + "RoR.log";
+    m_ogre_root = new Ogre::Root("", "", log_filepath);
+
+    m_timer = new Ogre::Timer();
+    m_timer->reset();
+
+    return true;
+}
+
 
 void OgreSubsystem::WindowResized(Ogre::Vector2 const & size)
 {
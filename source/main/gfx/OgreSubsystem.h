@@ -41,6 +41,9 @@ public:
 
     bool StartOgre(Ogre::String const & hwnd, Ogre::String const & mainhwnd);
 
+    /// Resource and scene managers only: no plugins, render system, window or viewport.
+    bool StartOgreHeadless();
+
     void WindowResized(Ogre::Vector2 const & size);
 
     Ogre::String GetMainHWND() 
@@ -26,6 +26,7 @@
 #include "OgreSubsystem.h"
 #include "Settings.h"
 #include "TerrainManager.h"
+#include "WaveSimd.h"
 
 using namespace Ogre;
 using namespace RoR;
@@ -625,6 +626,64 @@ Vector3 Water::getVelocity(Vector3 pos)
     return result;
 }
 
+void Water::getWavesBatch(const Vector3* positions, int count, float* heights, Vector3* velocities)
+{
+    if (!RoR::App::gfx_water_waves.GetActive() || RoR::App::mp_state.GetActive() == RoR::MpState::CONNECTED)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            heights[i] = wHeight;
+            if (velocities)
+                velocities[i] = Vector3::ZERO;
+        }
+        return;
+    }
+
+    // the time dependent phase is reduced in double precision, mrTime keeps growing
+    RoR::WaveTrainParams trains[MAX_WAVETRAINS];
+    for (int t = 0; t < free_wavetrain; t++)
+    {
+        const double turns = (double)gEnv->mrTime * wavetrains[t].wavespeed / wavetrains[t].wavelength;
+        trains[t].amplitude = wavetrains[t].amplitude;
+        trains[t].maxheight = wavetrains[t].maxheight;
+        trains[t].phase = (float)(turns - floor(turns));
+        trains[t].fx = wavetrains[t].dir_sin / wavetrains[t].wavelength;
+        trains[t].fz = wavetrains[t].dir_cos / wavetrains[t].wavelength;
+        trains[t].speed = Math::TWO_PI * wavetrains[t].wavespeed / wavetrains[t].wavelength;
+        trains[t].dir_x = wavetrains[t].dir_sin;
+        trains[t].dir_z = wavetrains[t].dir_cos;
+    }
+
+    // structure-of-arrays chunks on the stack, this runs concurrently for many trucks
+    const int CHUNK = 64;
+    float x[CHUNK], z[CHUNK], factor[CHUNK], h[CHUNK], vx[CHUNK], vy[CHUNK], vz[CHUNK];
+    for (int begin = 0; begin < count; begin += CHUNK)
+    {
+        const int n = std::min(CHUNK, count - begin);
+        for (int i = 0; i < n; i++)
+        {
+            x[i] = positions[begin + i].x;
+            z[i] = positions[begin + i].z;
+            factor[i] = getWaveHeight(positions[begin + i]);
+            h[i] = wHeight;
+        }
+
+        if (velocities)
+            RoR::ComputeWaves(trains, free_wavetrain, x, z, factor, h, vx, vy, vz, n);
+        else
+            RoR::ComputeWaves(trains, free_wavetrain, x, z, factor, h, nullptr, nullptr, nullptr, n);
+
+        for (int i = 0; i < n; i++)
+        {
+            // uh, some upper limit?!
+            const bool above = positions[begin + i].y > wHeight + maxampl;
+            heights[begin + i] = above ? wHeight : h[i];
+            if (velocities)
+                velocities[begin + i] = above ? Vector3::ZERO : Vector3(vx[i], vy[i], vz[i]);
+        }
+    }
+}
+
 void Water::updateReflectionPlane(float h)
 {
     //Ray ra=gEnv->ogreCamera->getCameraToViewportRay(0.5,0.5);
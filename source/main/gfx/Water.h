@@ -37,6 +37,7 @@ public:
     float getHeight();
     float getHeightWaves(Ogre::Vector3 pos);
     Ogre::Vector3 getVelocity(Ogre::Vector3 pos);
+    void getWavesBatch(const Ogre::Vector3* positions, int count, float* heights, Ogre::Vector3* velocities);
 
     void setCamera(Ogre::Camera* cam);
     void setFadeColour(Ogre::ColourValue ambient);
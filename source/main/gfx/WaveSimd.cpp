@@ -0,0 +1,162 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "WaveSimd.h"
+
+#include "CpuFeatures.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define ROR_WAVE_SIMD_SSE2
+#   include <emmintrin.h>
+#endif
+
+namespace RoR {
+
+/// sin(2pi * turns)
+static inline float WaveLaneSin(const float turns)
+{
+    float f = turns - std::nearbyint(turns); // [-1/2, 1/2]
+    f = std::min(f, 0.5f - f);               // sin(pi - x) = sin(x)
+    f = std::max(f, -0.5f - f);
+    const float x = f * WAVE_TWO_PI;
+    const float x2 = x * x;
+    return x * (1.f + x2 * (WAVE_SIN_3 + x2 * (WAVE_SIN_5 + x2 * (WAVE_SIN_7 + x2 * WAVE_SIN_9))));
+}
+
+void ComputeWavesScalar(const WaveTrainParams* trains, int num_trains, const float* x, const float* z, const float* factor,
+    float* height, float* vel_x, float* vel_y, float* vel_z, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        float h = height[i];
+        float vx = 0.f, vy = 0.f, vz = 0.f;
+        for (int t = 0; t < num_trains; t++)
+        {
+            const WaveTrainParams& w = trains[t];
+            const float amp = std::min(w.amplitude * factor[i], w.maxheight);
+            const float turns = w.phase + w.fx * x[i] + w.fz * z[i];
+            const float s = WaveLaneSin(turns);
+            h += amp * s;
+            if (vel_x)
+            {
+                const float speed = amp * w.speed;
+                vy += speed * WaveLaneSin(turns + 0.25f);
+                vx += speed * w.dir_x * s;
+                vz += speed * w.dir_z * s;
+            }
+        }
+        height[i] = h;
+        if (vel_x)
+        {
+            vel_x[i] = vx;
+            vel_y[i] = vy;
+            vel_z[i] = vz;
+        }
+    }
+}
+
+#if defined(ROR_WAVE_SIMD_SSE2)
+
+static inline __m128 WaveSin4(const __m128 turns)
+{
+    __m128 f = _mm_sub_ps(turns, _mm_cvtepi32_ps(_mm_cvtps_epi32(turns))); // rounds to nearest
+    f = _mm_min_ps(f, _mm_sub_ps(_mm_set1_ps(0.5f), f));
+    f = _mm_max_ps(f, _mm_sub_ps(_mm_set1_ps(-0.5f), f));
+    const __m128 x = _mm_mul_ps(f, _mm_set1_ps(WAVE_TWO_PI));
+    const __m128 x2 = _mm_mul_ps(x, x);
+    __m128 p = _mm_add_ps(_mm_set1_ps(WAVE_SIN_7), _mm_mul_ps(x2, _mm_set1_ps(WAVE_SIN_9)));
+    p = _mm_add_ps(_mm_set1_ps(WAVE_SIN_5), _mm_mul_ps(x2, p));
+    p = _mm_add_ps(_mm_set1_ps(WAVE_SIN_3), _mm_mul_ps(x2, p));
+    p = _mm_add_ps(_mm_set1_ps(1.f), _mm_mul_ps(x2, p));
+    return _mm_mul_ps(x, p);
+}
+
+static void ComputeWavesSse2(const WaveTrainParams* trains, int num_trains, const float* x, const float* z, const float* factor,
+    float* height, float* vel_x, float* vel_y, float* vel_z, int count)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 px = _mm_loadu_ps(x + i);
+        const __m128 pz = _mm_loadu_ps(z + i);
+        const __m128 pf = _mm_loadu_ps(factor + i);
+        __m128 h = _mm_loadu_ps(height + i);
+        __m128 vx = _mm_setzero_ps();
+        __m128 vy = _mm_setzero_ps();
+        __m128 vz = _mm_setzero_ps();
+        for (int t = 0; t < num_trains; t++)
+        {
+            const WaveTrainParams& w = trains[t];
+            const __m128 amp = _mm_min_ps(_mm_mul_ps(_mm_set1_ps(w.amplitude), pf), _mm_set1_ps(w.maxheight));
+            const __m128 turns = _mm_add_ps(_mm_add_ps(_mm_set1_ps(w.phase), _mm_mul_ps(_mm_set1_ps(w.fx), px)), _mm_mul_ps(_mm_set1_ps(w.fz), pz));
+            const __m128 s = WaveSin4(turns);
+            h = _mm_add_ps(h, _mm_mul_ps(amp, s));
+            if (vel_x)
+            {
+                const __m128 speed = _mm_mul_ps(amp, _mm_set1_ps(w.speed));
+                const __m128 c = WaveSin4(_mm_add_ps(turns, _mm_set1_ps(0.25f)));
+                vy = _mm_add_ps(vy, _mm_mul_ps(speed, c));
+                vx = _mm_add_ps(vx, _mm_mul_ps(_mm_mul_ps(speed, _mm_set1_ps(w.dir_x)), s));
+                vz = _mm_add_ps(vz, _mm_mul_ps(_mm_mul_ps(speed, _mm_set1_ps(w.dir_z)), s));
+            }
+        }
+        _mm_storeu_ps(height + i, h);
+        if (vel_x)
+        {
+            _mm_storeu_ps(vel_x + i, vx);
+            _mm_storeu_ps(vel_y + i, vy);
+            _mm_storeu_ps(vel_z + i, vz);
+        }
+    }
+
+    ComputeWavesScalar(trains, num_trains, x + i, z + i, factor + i, height + i,
+        vel_x ? vel_x + i : nullptr, vel_y ? vel_y + i : nullptr, vel_z ? vel_z + i : nullptr, count - i);
+}
+
+#endif // ROR_WAVE_SIMD_SSE2
+
+typedef void (*WavesKernel)(const WaveTrainParams* trains, int num_trains, const float* x, const float* z, const float* factor,
+    float* height, float* vel_x, float* vel_y, float* vel_z, int count);
+
+static WavesKernel SelectWavesKernel()
+{
+#if defined(ROR_ENABLE_AVX2)
+    if (IsAvx2Supported())
+        return ComputeWavesAvx2;
+#endif
+#if defined(ROR_WAVE_SIMD_SSE2)
+    return ComputeWavesSse2;
+#else
+    return ComputeWavesScalar;
+#endif
+}
+
+void ComputeWaves(const WaveTrainParams* trains, int num_trains, const float* x, const float* z, const float* factor,
+    float* height, float* vel_x, float* vel_y, float* vel_z, int count)
+{
+    static const WavesKernel kernel = SelectWavesKernel(); // Thread-safe init, evaluated once
+    kernel(trains, num_trains, x, z, factor, height, vel_x, vel_y, vel_z, count);
+}
+
+} // namespace RoR
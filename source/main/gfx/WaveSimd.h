@@ -0,0 +1,76 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// @file
+/// @brief Vectorized evaluation of the sine wave trains of Water, for many points at once.
+///
+/// Sines are approximated by a polynomial after reducing the phase to [-1/4, 1/4] turns;
+/// the absolute error is below 4e-6 of the amplitude.
+///
+/// Like the beam kernel (see BeamSimd.h), SSE2 is the baseline and the AVX2 kernel lives in its
+/// own unit (WaveSimdAvx2.cpp, built with ROR_ENABLE_AVX2), picked at runtime if the CPU supports it.
+
+#pragma once
+
+namespace RoR {
+
+static const float WAVE_TWO_PI = 6.283185307f;
+
+// Taylor coefficients of sin(x), good enough on [-pi/2, pi/2]
+static const float WAVE_SIN_3 = -1.f / 6.f;
+static const float WAVE_SIN_5 = 1.f / 120.f;
+static const float WAVE_SIN_7 = -1.f / 5040.f;
+static const float WAVE_SIN_9 = 1.f / 362880.f;
+
+/// One wave train at a given time. At point (x, z), with amp = min(amplitude * factor, maxheight):
+///   turns     = phase + fx * x + fz * z
+///   height   += amp * sin(2pi * turns)
+///   velocity += amp * speed * (dir_x * sin, cos, dir_z * sin)
+struct WaveTrainParams
+{
+    float amplitude;
+    float maxheight;
+    float phase;  //!< time * wavespeed / wavelength, reduced to [0, 1)
+    float fx;     //!< dir_sin / wavelength
+    float fz;     //!< dir_cos / wavelength
+    float speed;  //!< 2pi * wavespeed / wavelength
+    float dir_x;  //!< dir_sin
+    float dir_z;  //!< dir_cos
+};
+
+/// Adds all wave trains to 'count' points, structure-of-arrays style.
+/// @param factor    Wave height factor of each point, see Water::getWaveHeight()
+/// @param height    In: base height; out: with waves added
+/// @param vel_x     Optional (all three or none): wave velocity out
+void ComputeWaves(const WaveTrainParams* trains, int num_trains, const float* x, const float* z, const float* factor,
+    float* height, float* vel_x, float* vel_y, float* vel_z, int count);
+
+/// Same math without intrinsics; reference for ComputeWaves().
+void ComputeWavesScalar(const WaveTrainParams* trains, int num_trains, const float* x, const float* z, const float* factor,
+    float* height, float* vel_x, float* vel_y, float* vel_z, int count);
+
+#if defined(ROR_ENABLE_AVX2)
+/// AVX2 kernel from WaveSimdAvx2.cpp; only call it through ComputeWaves(), which checks CPU support.
+void ComputeWavesAvx2(const WaveTrainParams* trains, int num_trains, const float* x, const float* z, const float* factor,
+    float* height, float* vel_x, float* vel_y, float* vel_z, int count);
+#endif
+
+} // namespace RoR
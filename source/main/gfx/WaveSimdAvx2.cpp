@@ -0,0 +1,94 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// @file
+/// @brief AVX2 variant of the wave kernel, see WaveSimd.h.
+///
+/// This unit is built with AVX2 code generation enabled (-mavx2 or /arch:AVX2).
+/// ComputeWaves() calls in only after checking the CPU, so keep everything else out of here.
+
+#include "WaveSimd.h"
+
+#include <immintrin.h>
+
+#if !defined(__AVX2__)
+#   error "WaveSimdAvx2.cpp must be compiled with AVX2 enabled"
+#endif
+
+namespace RoR {
+
+static inline __m256 WaveSin8(const __m256 turns)
+{
+    __m256 f = _mm256_sub_ps(turns, _mm256_round_ps(turns, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+    f = _mm256_min_ps(f, _mm256_sub_ps(_mm256_set1_ps(0.5f), f));
+    f = _mm256_max_ps(f, _mm256_sub_ps(_mm256_set1_ps(-0.5f), f));
+    const __m256 x = _mm256_mul_ps(f, _mm256_set1_ps(WAVE_TWO_PI));
+    const __m256 x2 = _mm256_mul_ps(x, x);
+    __m256 p = _mm256_add_ps(_mm256_set1_ps(WAVE_SIN_7), _mm256_mul_ps(x2, _mm256_set1_ps(WAVE_SIN_9)));
+    p = _mm256_add_ps(_mm256_set1_ps(WAVE_SIN_5), _mm256_mul_ps(x2, p));
+    p = _mm256_add_ps(_mm256_set1_ps(WAVE_SIN_3), _mm256_mul_ps(x2, p));
+    p = _mm256_add_ps(_mm256_set1_ps(1.f), _mm256_mul_ps(x2, p));
+    return _mm256_mul_ps(x, p);
+}
+
+void ComputeWavesAvx2(const WaveTrainParams* trains, int num_trains, const float* x, const float* z, const float* factor,
+    float* height, float* vel_x, float* vel_y, float* vel_z, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256 px = _mm256_loadu_ps(x + i);
+        const __m256 pz = _mm256_loadu_ps(z + i);
+        const __m256 pf = _mm256_loadu_ps(factor + i);
+        __m256 h = _mm256_loadu_ps(height + i);
+        __m256 vx = _mm256_setzero_ps();
+        __m256 vy = _mm256_setzero_ps();
+        __m256 vz = _mm256_setzero_ps();
+        for (int t = 0; t < num_trains; t++)
+        {
+            const WaveTrainParams& w = trains[t];
+            const __m256 amp = _mm256_min_ps(_mm256_mul_ps(_mm256_set1_ps(w.amplitude), pf), _mm256_set1_ps(w.maxheight));
+            const __m256 turns = _mm256_add_ps(_mm256_add_ps(_mm256_set1_ps(w.phase), _mm256_mul_ps(_mm256_set1_ps(w.fx), px)), _mm256_mul_ps(_mm256_set1_ps(w.fz), pz));
+            const __m256 s = WaveSin8(turns);
+            h = _mm256_add_ps(h, _mm256_mul_ps(amp, s));
+            if (vel_x)
+            {
+                const __m256 speed = _mm256_mul_ps(amp, _mm256_set1_ps(w.speed));
+                const __m256 c = WaveSin8(_mm256_add_ps(turns, _mm256_set1_ps(0.25f)));
+                vy = _mm256_add_ps(vy, _mm256_mul_ps(speed, c));
+                vx = _mm256_add_ps(vx, _mm256_mul_ps(_mm256_mul_ps(speed, _mm256_set1_ps(w.dir_x)), s));
+                vz = _mm256_add_ps(vz, _mm256_mul_ps(_mm256_mul_ps(speed, _mm256_set1_ps(w.dir_z)), s));
+            }
+        }
+        _mm256_storeu_ps(height + i, h);
+        if (vel_x)
+        {
+            _mm256_storeu_ps(vel_x + i, vx);
+            _mm256_storeu_ps(vel_y + i, vy);
+            _mm256_storeu_ps(vel_z + i, vz);
+        }
+    }
+
+    ComputeWavesScalar(trains, num_trains, x + i, z + i, factor + i, height + i,
+        vel_x ? vel_x + i : nullptr, vel_y ? vel_y + i : nullptr, vel_z ? vel_z + i : nullptr, count - i);
+}
+
+} // namespace RoR
@@ -33,6 +33,9 @@
 #include "MainMenu.h"
 #include "Network.h"
 #include "OverlayWrapper.h"
+#include "PhysicsBenchmark.h"
+#include "PlatformUtils.h"
+#include "Replay.h"
 #include "RoRFrameListener.h"
 #include "RoRVersion.h"
 #include "Scripting.h"
@@ -253,6 +256,10 @@ void Console::eventCommandAccept(MyGUI::Edit* _sender)
 
             putMessage(CONSOLE_MSGTYPE_INFO, CONSOLE_HELP, _L("/log - toggles log output on the console"), "table_save.png");
 
+            putMessage(CONSOLE_MSGTYPE_INFO, CONSOLE_HELP, _L("/replayload <file> - plays back a recorded replay of the current vehicle"), "table_save.png");
+
+            putMessage(CONSOLE_MSGTYPE_INFO, CONSOLE_HELP, _L("/benchmark <scenario file | truck> [truck counts] - times the physics stages with 1, 10 and 50 trucks (or as given)"), "table_save.png");
+
             putMessage(CONSOLE_MSGTYPE_INFO, CONSOLE_HELP, _L("/quit - exit Rigs of Rods"), "table_save.png");
 
 #ifdef USE_ANGELSCRIPT
@@ -370,6 +377,82 @@ void Console::eventCommandAccept(MyGUI::Edit* _sender)
 
             return;
         }
+        else if (args[0] == "/replayload" && (is_appstate_sim && !is_sim_select))
+        {
+            Beam* b = m_sim_controller->GetBeamFactory()->getCurrentTruck();
+            if (args.size() != 2)
+            {
+                putMessage(CONSOLE_MSGTYPE_INFO, CONSOLE_HELP, RoR::Color::CommandColour + _L("usage: /replayload <file>"), "information.png");
+                return;
+            }
+            if (!b || !b->getReplay())
+            {
+                putMessage(CONSOLE_MSGTYPE_INFO, CONSOLE_SYSTEM_ERROR, _L("Replay is not enabled for the current vehicle"), "error.png");
+                return;
+            }
+
+            String path = args[1];
+            if (!PlatformUtils::FileExists(path))
+            {
+                path = String(App::sys_replays_dir.GetActive()) + PATH_SLASH + args[1];
+            }
+
+            b->setReplayMode(false); // Leaves the live replay or a previously loaded file
+            String error;
+            if (!b->getReplay()->loadFile(path, error))
+            {
+                putMessage(CONSOLE_MSGTYPE_INFO, CONSOLE_SYSTEM_ERROR, _L("Cannot load replay: ") + error, "error.png");
+                return;
+            }
+            b->replaylen = b->getReplay()->getNumFrames();
+            b->setReplayMode(true);
+            putMessage(CONSOLE_MSGTYPE_INFO, CONSOLE_SYSTEM_REPLY, _L("Replay loaded, frames: ") + TOSTRING(b->replaylen), "information.png");
+            return;
+        }
+        else if (args[0] == "/benchmark" && (is_appstate_sim && !is_sim_select))
+        {
+            if (args.size() < 2)
+            {
+                putMessage(CONSOLE_MSGTYPE_INFO, CONSOLE_HELP, RoR::Color::CommandColour + _L("usage: /benchmark <scenario file | truck> [truck counts]"), "information.png");
+                return;
+            }
+
+            PhysicsBenchmarkScenario scenario;
+            String error;
+            if (PlatformUtils::FileExists(args[1]))
+            {
+                if (!scenario.LoadFile(args[1], error))
+                {
+                    putMessage(CONSOLE_MSGTYPE_INFO, CONSOLE_SYSTEM_ERROR, _L("Cannot load benchmark scenario: ") + error, "error.png");
+                    return;
+                }
+            }
+            else
+            {
+                scenario.truck = args[1];
+            }
+            if (args.size() > 2)
+            {
+                scenario.truck_counts.clear();
+                for (size_t i = 2; i < args.size(); i++)
+                {
+                    scenario.truck_counts.push_back(StringConverter::parseInt(args[i]));
+                }
+            }
+
+            auto results = PhysicsBenchmark::Run(*m_sim_controller->GetBeamFactory(), *gEnv->collisions, scenario, error);
+            const String report = PhysicsBenchmark::FormatReport(scenario, results);
+            LOG(report);
+            for (auto& line : StringUtil::split(report, "\n"))
+            {
+                putMessage(CONSOLE_MSGTYPE_INFO, CONSOLE_SYSTEM_REPLY, line, "information.png");
+            }
+            if (!error.empty())
+            {
+                putMessage(CONSOLE_MSGTYPE_INFO, CONSOLE_SYSTEM_ERROR, _L("Benchmark aborted: ") + error, "error.png");
+            }
+            return;
+        }
         else if (args[0] == "/ver")
         {
             putMessage(CONSOLE_MSGTYPE_INFO, CONSOLE_TITLE, "Rigs of Rods:", "information.png");
@@ -304,6 +304,57 @@ void RoR::GUI::TopMenubar::Update()
                 ImGui::EndTooltip();
             }
 
+            bool replay_record = App::sim_replay_record.GetActive();
+            if (ImGui::Checkbox("Record replays to disk", &replay_record))
+            {
+                App::sim_replay_record.SetActive(replay_record);
+            }
+            if (ImGui::IsItemHovered())
+            {
+                ImGui::BeginTooltip();
+                ImGui::Text("Stream replays of spawned vehicles to the 'replays' folder, for /replayload (config: \"Replay Recording\"; GVar: \"sim_replay_record\")");
+                ImGui::EndTooltip();
+            }
+
+            ImGui::Separator();
+            ImGui::TextColored(GRAY_HINT_TEXT, "Live physics options:");
+
+            bool beam_simd = App::sim_beam_simd.GetActive();
+            if (ImGui::Checkbox("Vectorized beams", &beam_simd))
+            {
+                App::sim_beam_simd.SetActive(beam_simd);
+            }
+            if (ImGui::IsItemHovered())
+            {
+                ImGui::BeginTooltip();
+                ImGui::Text("Uncheck to use the scalar reference code for beam forces (config: \"SIMD Beams\"; GVar: \"sim_beam_simd\")");
+                ImGui::EndTooltip();
+            }
+
+            bool beam_parallel = App::sim_beam_parallel.GetActive();
+            if (ImGui::Checkbox("Parallel beams (big rigs)", &beam_parallel))
+            {
+                App::sim_beam_parallel.SetActive(beam_parallel);
+            }
+            if (ImGui::IsItemHovered())
+            {
+                ImGui::BeginTooltip();
+                ImGui::Text("Split beam forces of rigs with many beams over the thread pool (config: \"Parallel Beams\"; GVar: \"sim_beam_parallel\")");
+                ImGui::EndTooltip();
+            }
+
+            bool deterministic = App::sim_deterministic.GetActive();
+            if (ImGui::Checkbox("Deterministic physics", &deterministic))
+            {
+                App::sim_deterministic.SetActive(deterministic);
+            }
+            if (ImGui::IsItemHovered())
+            {
+                ImGui::BeginTooltip();
+                ImGui::Text("Bit-identical results regardless of thread count, at some cost in speed (config: \"Deterministic Physics\"; GVar: \"sim_deterministic\")");
+                ImGui::EndTooltip();
+            }
+
             // TODO: Make the radio buttons visible only when there's active actor
             // NOTE: Currently there seems to be a bug in IMGUI - if the window is displayed first without the radiobuttons, 
             //       it remembers the size and the radiobuttons never become visible - they get clipped out.
@@ -48,6 +48,7 @@
 #include "GUI_MainSelector.h"
 #include "GUI_MultiplayerClientList.h"
 #include "GUI_MultiplayerSelector.h"
+#include "HeadlessSimulation.h"
 #include "Heathaze.h"
 #include "InputEngine.h"
 #include "Language.h"
@@ -135,6 +136,9 @@ int main(int argc, char *argv[])
         if (!PlatformUtils::FolderExists(App::sys_cache_dir.GetActive()))
             PlatformUtils::CreateFolder(App::sys_cache_dir.GetActive());
 
+        if (!PlatformUtils::FolderExists(App::sys_replays_dir.GetActive()))
+            PlatformUtils::CreateFolder(App::sys_replays_dir.GetActive());
+
         // ### Process command-line arguments ###
 
 #if OGRE_PLATFORM != OGRE_PLATFORM_APPLE //MacOSX adds an extra argument in the form of -psn_0_XXXXXX when the app is double clicked
@@ -152,6 +156,11 @@ int main(int argc, char *argv[])
             return 0;
         }
 
+        if (App::app_headless.GetActive()) // Dedicated server: no window, sound or GUI
+        {
+            return HeadlessSimulation().Run() ? 0 : -1;
+        }
+
 #ifdef USE_CRASHRPT
         InstallCrashRpt();
 #endif //USE_CRASHRPT
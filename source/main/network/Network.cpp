@@ -31,6 +31,7 @@
 #include "GUIManager.h"
 #include "GUI_TopMenubar.h"
 #include "Language.h"
+#include "PacketRing.h"
 #include "RoRVersion.h"
 #include "SHA1.h"
 #include "ScriptEngine.h"
@@ -45,8 +46,11 @@
 #include <chrono>
 #include <condition_variable>
 #include <mutex>
-#include <deque>
 #include <thread>
+#include <unordered_map>
+
+// Checks on every Connect() that a full send queue doesn't lose the last queued packet of a stream; logs to RoR.log
+//#define NETWORK_VALIDATE_SEND_QUEUE
 
 namespace RoR {
 namespace Networking {
@@ -86,12 +90,6 @@ static Ogre::ColourValue MP_COLORS[] = // Classic RoR multiplayer colors
 
 using namespace RoRnet;
 
-struct send_packet_t
-{
-    char buffer[RORNET_MAX_MESSAGE_LENGTH];
-    int size;
-};
-
 static RoRnet::ServerInfo m_server_settings;
 
 static Ogre::UTFString m_username; // Shadows gEnv->mp_player_name for multithreaded access.
@@ -116,15 +114,30 @@ static std::atomic<bool> m_recv_stopped;
 static std::mutex m_users_mutex;
 static std::mutex m_userdata_mutex;
 static std::mutex m_error_message_mutex;
-static std::mutex m_recv_packetqueue_mutex;
-static std::mutex m_send_packetqueue_mutex;
+static std::mutex m_send_wakeup_mutex;
 
 static std::condition_variable m_send_packet_available_cv;
 
-static std::vector<recv_packet_t> m_recv_packet_buffer;
-static std::deque <send_packet_t> m_send_packet_buffer;
-
-static const unsigned int m_packet_buffer_size = 20;
+static PacketRing m_send_ring(1 << 18);             // Game thread -> SendThread
+static PacketRing m_recv_ring(1 << 22);             // RecvThread -> game thread
+static std::vector<recv_packet_t> m_recv_packets;   // Game thread: views into m_recv_ring, see GetIncomingStreamData()
+
+// Only the newest queued MSG2_STREAM_DATA of a stream gets sent, older ones are skipped by SendThread.
+// Streams are told apart by stream ID and packet size, like the header comparison this replaces.
+static const int MAX_STREAM_SLOTS = 256;
+static std::atomic<uint32_t> m_stream_slot_seq[MAX_STREAM_SLOTS]; // Sequence number of the newest packet per slot
+static std::unordered_map<uint64_t, int> m_stream_slots;           // Game thread: stream key -> slot
+static uint32_t m_send_seq;                                        // Game thread
+
+static std::atomic<uint64_t> m_stat_sent;
+static std::atomic<uint64_t> m_stat_superseded;
+static std::atomic<uint64_t> m_stat_dropped;
+static std::atomic<uint64_t> m_stat_received;
+static std::atomic<uint64_t> m_stat_recv_stalls;
+static std::atomic<int64_t>  m_stat_send_latency_sum; // Nanoseconds
+static std::atomic<int64_t>  m_stat_send_latency_max;
+static std::atomic<int64_t>  m_stat_recv_latency_sum;
+static std::atomic<int64_t>  m_stat_recv_latency_max;
 
 static std::atomic<bool> m_net_fatal_error;
 static std::atomic<bool> m_socket_broken;
@@ -212,6 +225,108 @@ int GetUID()
     return m_uid;
 }
 
+static int64_t GetTimestampNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void RecordLatency(int64_t push_time, std::atomic<int64_t>& sum, std::atomic<int64_t>& max)
+{
+    // Each counter has a single writer thread
+    int64_t latency = GetTimestampNs() - push_time;
+    sum.store(sum.load(std::memory_order_relaxed) + latency, std::memory_order_relaxed);
+    if (latency > max.load(std::memory_order_relaxed))
+        max.store(latency, std::memory_order_relaxed);
+}
+
+static bool IsSuperseded(const PacketRing::Record* rec, const std::atomic<uint32_t>* slot_seq)
+{
+    return rec->slot >= 0 && slot_seq[rec->slot].load(std::memory_order_acquire) != rec->seq;
+}
+
+/// Queues a packet which supersedes the queued packets of its slot (if any)
+/// @return False if the ring is full; the slot then keeps pointing at the packet queued before
+static bool PushStreamData(PacketRing& ring, std::atomic<uint32_t>* slot_seq, const RoRnet::Header& head, const char* content, int slot, uint32_t seq)
+{
+    uint32_t prev_seq = 0;
+    if (slot >= 0)
+    {
+        // Announce before queueing, so SendThread never sees the packet as outdated
+        prev_seq = slot_seq[slot].exchange(seq, std::memory_order_acq_rel);
+    }
+
+    if (ring.Push(head, content, head.size, slot, seq, GetTimestampNs()))
+        return true;
+
+    if (slot >= 0)
+    {
+        // Dropped: un-announce it, or SendThread would skip the older packet as well.
+        // If SendThread already got to that one meanwhile, the stream's next update takes its place.
+        uint32_t expected = seq;
+        slot_seq[slot].compare_exchange_strong(expected, prev_seq, std::memory_order_acq_rel);
+    }
+    return false;
+}
+
+#ifdef NETWORK_VALIDATE_SEND_QUEUE
+static void ValidateSendQueue()
+{
+    PacketRing ring(1024);
+    std::atomic<uint32_t> slot_seq[1];
+    slot_seq[0] = 0;
+    RoRnet::Header head;
+    memset(&head, 0, sizeof(RoRnet::Header));
+    head.command = MSG2_STREAM_DATA;
+    head.size = 16;
+    char body[16] = {0};
+    uint32_t seq = 0;
+
+    bool ok = PushStreamData(ring, slot_seq, head, body, 0, ++seq);
+    while (PushStreamData(ring, slot_seq, head, body, -1, ++seq)) {} // Fill up with other packets
+    ok = ok && !PushStreamData(ring, slot_seq, head, body, 0, ++seq);
+
+    int stream_sent = 0;
+    for (PacketRing::Record* rec; (rec = ring.Front()) != nullptr; ring.Next())
+    {
+        if (rec->slot == 0 && !IsSuperseded(rec, slot_seq))
+            stream_sent++;
+    }
+    ring.Release();
+    ok = ok && (stream_sent == 1);
+
+    LOG(ok ? "[RoR|Networking] Send queue check passed"
+           : "[RoR|Networking] Send queue check FAILED: the stream's queued packet was lost with the dropped one");
+}
+#endif // NETWORK_VALIDATE_SEND_QUEUE
+
+static void ResetNetStats()
+{
+    m_stat_sent = 0;
+    m_stat_superseded = 0;
+    m_stat_dropped = 0;
+    m_stat_received = 0;
+    m_stat_recv_stalls = 0;
+    m_stat_send_latency_sum = 0;
+    m_stat_send_latency_max = 0;
+    m_stat_recv_latency_sum = 0;
+    m_stat_recv_latency_max = 0;
+}
+
+NetStats GetNetStats()
+{
+    NetStats stats;
+    stats.packets_sent       = m_stat_sent;
+    stats.packets_superseded = m_stat_superseded;
+    stats.packets_dropped    = m_stat_dropped;
+    stats.packets_received   = m_stat_received;
+    stats.recv_stalls        = m_stat_recv_stalls;
+    stats.send_latency_avg_ms = (stats.packets_sent > 0) ? (m_stat_send_latency_sum / (float)stats.packets_sent) * 1e-6f : 0.0f;
+    stats.send_latency_max_ms = m_stat_send_latency_max * 1e-6f;
+    stats.recv_latency_avg_ms = (stats.packets_received > 0) ? (m_stat_recv_latency_sum / (float)stats.packets_received) * 1e-6f : 0.0f;
+    stats.recv_latency_max_ms = m_stat_recv_latency_max * 1e-6f;
+    return stats;
+}
+
 bool SendMessageRaw(char *buffer, int msgsize)
 {
     SWBaseSocket::SWBaseError error;
@@ -256,19 +371,28 @@ bool SendNetMessage(int type, unsigned int streamid, int len, char* content)
 
 void QueueStreamData(RoRnet::Header &header, char *buffer, size_t buffer_len)
 {
-    recv_packet_t packet;
-    packet.header = header;
-    memcpy(packet.buffer, buffer, std::min(buffer_len, size_t(RORNET_MAX_MESSAGE_LENGTH)));
-
-    std::lock_guard<std::mutex> lock(m_recv_packetqueue_mutex);
-    m_recv_packet_buffer.push_back(packet);
+    size_t len = std::min(buffer_len, size_t(header.size));
+    bool stalled = false;
+    while (!m_recv_ring.Push(header, buffer, len, -1, 0, GetTimestampNs()))
+    {
+        // The game didn't pick up the packets yet (i.e. loading); wait, don't lose anything.
+        if (m_shutdown)
+            return;
+        if (!stalled)
+        {
+            m_stat_recv_stalls++;
+            stalled = true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    m_stat_received++;
 }
 
 int ReceiveMessage(RoRnet::Header *head, char* content, int bufferlen)
 {
     SWBaseSocket::SWBaseError error;
 
-    char buffer[RORNET_MAX_MESSAGE_LENGTH] = {0};
+    char buffer[RORNET_MAX_MESSAGE_LENGTH];
 
 #ifdef DEBUG
 	LOG_THREAD("[RoR|Networking] ReceiveMessage() waiting...");
@@ -325,7 +449,13 @@ int ReceiveMessage(RoRnet::Header *head, char* content, int bufferlen)
         }
     }
 
-    memcpy(content, buffer + sizeof(RoRnet::Header), bufferlen);
+    // Copy the payload only; callers rely on it being zero-terminated
+    int content_len = std::min<int>(head->size, bufferlen);
+    memcpy(content, buffer + sizeof(RoRnet::Header), content_len);
+    if (content_len < bufferlen)
+    {
+        content[content_len] = 0;
+    }
 
 #ifdef DEBUG
     LOG_THREAD("[RoR|Networking] ReceiveMessage() body received");
@@ -339,24 +469,28 @@ void SendThread()
     LOG("[RoR|Networking] SendThread started");
     while (!m_shutdown)
     {
-        std::unique_lock<std::mutex> queue_lock(m_send_packetqueue_mutex);
-        while (!m_shutdown && m_send_packet_buffer.empty())
         {
-            m_send_packet_available_cv.wait(queue_lock);
+            std::unique_lock<std::mutex> lock(m_send_wakeup_mutex);
+            m_send_packet_available_cv.wait(lock, []{ return m_shutdown || m_send_ring.Front() != nullptr; });
         }
 
-        while (!m_shutdown && !m_send_packet_buffer.empty())
+        PacketRing::Record* rec;
+        while (!m_shutdown && (rec = m_send_ring.Front()) != nullptr)
         {
-            send_packet_t packet = m_send_packet_buffer.front();
-            m_send_packet_buffer.pop_front();
-
-            queue_lock.unlock();
-            SendMessageRaw(packet.buffer, packet.size);
-            queue_lock.lock();
+            if (IsSuperseded(rec, m_stream_slot_seq))
+            {
+                m_stat_superseded++; // Newer data of this stream is queued
+            }
+            else
+            {
+                // Header and payload are stored back to back, send them straight from the queue
+                SendMessageRaw((char*)&rec->header, sizeof(RoRnet::Header) + rec->header.size);
+                RecordLatency(rec->push_time, m_stat_send_latency_sum, m_stat_send_latency_max);
+                m_stat_sent++;
+            }
+            m_send_ring.Next();
+            m_send_ring.Release();
         }
-        queue_lock.unlock();
-        std::this_thread::sleep_for(std::chrono::milliseconds(200));
-        queue_lock.lock();
     }
     LOG("[RoR|Networking] SendThread stopped");
 }
@@ -424,22 +558,27 @@ void RecvThread()
                 return;
             }
 
+            std::string utf8_line;
             { // Lock scope
                 std::lock_guard<std::mutex> lock(m_users_mutex);
                 auto user = std::find_if(m_users.begin(), m_users.end(), [header](const RoRnet::UserInfo u) { return static_cast<int>(u.uniqueid) == header.source; });
                 if (user != m_users.end())
                 {
                     Ogre::UTFString msg = RoR::ChatSystem::GetColouredName(user->username, user->colournum) + RoR::Color::CommandColour + _L(" left the game");
-                    const char *utf8_line = msg.asUTF8_c_str();
-                    RoRnet::Header head;
-                    head.command = MSG2_UTF8_CHAT;
-                    head.source  = -1;
-                    head.size    = (int)strlen(utf8_line);
-                    QueueStreamData(head, (char *)utf8_line, strlen(utf8_line) + 1);
+                    utf8_line = msg.asUTF8();
                     LOG_THREAD(Ogre::UTFString(user->username) + _L(" left the game"));
                     m_users.erase(user);
                 }
             }
+            if (!utf8_line.empty()) // Queued outside the lock, queueing may wait for the game thread
+            {
+                RoRnet::Header head;
+                head.command = MSG2_UTF8_CHAT;
+                head.source  = -1;
+                head.streamid = 0;
+                head.size    = (int)utf8_line.size();
+                QueueStreamData(head, (char *)utf8_line.c_str(), utf8_line.size() + 1);
+            }
             RoR::App::GetGuiManager()->GetTopMenubar()->triggerUpdateVehicleList();
         }
         else if (header.command == MSG2_USER_INFO || header.command == MSG2_USER_JOIN)
@@ -458,6 +597,7 @@ void RecvThread()
                 memcpy(&user_info, buffer, sizeof(RoRnet::UserInfo));
 
                 bool user_exists = false;
+                std::string utf8_line;
                 {
                     std::lock_guard<std::mutex> lock(m_users_mutex);
                     for (RoRnet::UserInfo &user : m_users)
@@ -473,15 +613,19 @@ void RecvThread()
                     {
                         m_users.push_back(user_info);
                         Ogre::UTFString msg = RoR::ChatSystem::GetColouredName(user_info.username, user_info.colournum) + RoR::Color::CommandColour + _L(" joined the game");
-                        const char *utf8_line = msg.asUTF8_c_str();
-                        RoRnet::Header head;
-                        head.command = MSG2_UTF8_CHAT;
-                        head.source  = -1;
-                        head.size    = (int)strlen(utf8_line);
-                        QueueStreamData(head, (char *)utf8_line, strlen(utf8_line) + 1);
+                        utf8_line = msg.asUTF8();
                         LOG(Ogre::UTFString(user_info.username) + _L(" joined the game"));
                     }
                 }
+                if (!utf8_line.empty()) // Queued outside the lock, queueing may wait for the game thread
+                {
+                    RoRnet::Header head;
+                    head.command = MSG2_UTF8_CHAT;
+                    head.source  = -1;
+                    head.streamid = 0;
+                    head.size    = (int)utf8_line.size();
+                    QueueStreamData(head, (char *)utf8_line.c_str(), utf8_line.size() + 1);
+                }
                 RoR::App::GetGuiManager()->GetTopMenubar()->triggerUpdateVehicleList();
             }
             continue;
@@ -495,7 +639,7 @@ void RecvThread()
         }
         //DebugPacket("receive-1", &header, buffer);
 
-        QueueStreamData(header, buffer, RORNET_MAX_MESSAGE_LENGTH);
+        QueueStreamData(header, buffer, header.size);
     }
 
     m_recv_stopped = true;
@@ -520,6 +664,10 @@ void CouldNotConnect(Ogre::UTFString const & msg, bool close_socket = true)
 
 bool Connect()
 {
+#ifdef NETWORK_VALIDATE_SEND_QUEUE
+    ValidateSendQueue();
+#endif
+
     // Temporary workaround for unrecoverable error
     if (m_socket_broken)
     {
@@ -683,6 +831,7 @@ bool Connect()
     memcpy(&m_userdata, buffer, std::min<int>(sizeof(RoRnet::UserInfo), header.size));
 
     m_shutdown = false;
+    ResetNetStats();
 
     LOG("[RoR|Networking] Connect(): Creating Send/Recv threads");
     m_send_thread = std::thread(SendThread);
@@ -699,6 +848,7 @@ void Disconnect()
     m_shutdown = true; // Instruct Send/Recv threads to shut down.
     m_recv_stopped = false;
 
+    { std::lock_guard<std::mutex> lock(m_send_wakeup_mutex); }
     m_send_packet_available_cv.notify_one();
 
     m_send_thread.join();
@@ -716,9 +866,19 @@ void Disconnect()
     socket.set_timeout(1, 1000);
     socket.disconnect();
 
+    NetStats stats = GetNetStats();
+    RoR::LogFormat("[RoR|Networking] Packets sent: %llu (superseded: %llu, dropped: %llu), queue latency avg/max: %.2f/%.2f ms",
+        (unsigned long long)stats.packets_sent, (unsigned long long)stats.packets_superseded, (unsigned long long)stats.packets_dropped,
+        stats.send_latency_avg_ms, stats.send_latency_max_ms);
+    RoR::LogFormat("[RoR|Networking] Packets received: %llu (stalls: %llu), queue latency avg/max: %.2f/%.2f ms",
+        (unsigned long long)stats.packets_received, (unsigned long long)stats.recv_stalls,
+        stats.recv_latency_avg_ms, stats.recv_latency_max_ms);
+
     m_users.clear();
-    m_recv_packet_buffer.clear();
-    m_send_packet_buffer.clear();
+    m_recv_packets.clear();
+    m_recv_ring.Reset();
+    m_send_ring.Reset();
+    m_stream_slots.clear();
 
     m_shutdown = false;
     App::mp_state.SetActive(RoR::MpState::DISABLED);
@@ -735,44 +895,52 @@ void AddPacket(int streamid, int type, int len, char *content)
         return;
     }
 
-    send_packet_t packet;
-    memset(&packet, 0, sizeof(send_packet_t));
-
-    char *buffer = (char*)(packet.buffer);
-
-    RoRnet::Header *head = (RoRnet::Header *)buffer;
-    head->command  = type;
-    head->source   = m_uid;
-    head->size     = len;
-    head->streamid = streamid;
-
-    // then copy the contents
-    char *bufferContent = (char *)(buffer + sizeof(RoRnet::Header));
-    memcpy(bufferContent, content, len);
+    RoRnet::Header head;
+    memset(&head, 0, sizeof(RoRnet::Header));
+    head.command  = type;
+    head.source   = m_uid;
+    head.size     = len;
+    head.streamid = streamid;
 
-    // record the packet size
-    packet.size = len + sizeof(RoRnet::Header);
+    int slot = -1;
+    uint32_t seq = ++m_send_seq;
+    if (type == MSG2_STREAM_DATA)
+    {
+        uint64_t key = ((uint64_t)(uint32_t)streamid << 32) | (uint32_t)len;
+        auto search = m_stream_slots.find(key);
+        if (search != m_stream_slots.end())
+        {
+            slot = search->second;
+        }
+        else if (m_stream_slots.size() < MAX_STREAM_SLOTS)
+        {
+            slot = (int)m_stream_slots.size();
+            m_stream_slots.insert(std::make_pair(key, slot));
+        }
 
-    { // Lock scope
-        std::lock_guard<std::mutex> lock(m_send_packetqueue_mutex);
-        if (type == MSG2_STREAM_DATA)
+        if (!PushStreamData(m_send_ring, m_stream_slot_seq, head, content, slot, seq))
         {
-            if (m_send_packet_buffer.size() > m_packet_buffer_size)
-            {
-                // buffer full, discard unimportant data packets
-                return;
-            }
-            auto search = std::find_if(m_send_packet_buffer.begin(), m_send_packet_buffer.end(), [packet](const send_packet_t& p) { return memcmp(packet.buffer, p.buffer, sizeof(RoRnet::Header)) == 0; });
-            if (search != m_send_packet_buffer.end())
+            // queue full, discard unimportant data packets
+            m_stat_dropped++;
+            return;
+        }
+    }
+    else
+    {
+        while (!m_send_ring.Push(head, content, len, slot, seq, GetTimestampNs()))
+        {
+            if (m_shutdown)
             {
-                // Found an older packet with the same header -> replace it
-                (*search) = packet;
+                m_stat_dropped++;
                 return;
             }
+            // Anything else must get through, wait for SendThread to make room
+            m_send_packet_available_cv.notify_one();
+            std::this_thread::yield();
         }
-        m_send_packet_buffer.push_back(packet);
     }
 
+    { std::lock_guard<std::mutex> lock(m_send_wakeup_mutex); } // Don't notify between SendThread's check and wait
     m_send_packet_available_cv.notify_one();
 }
 
@@ -788,12 +956,23 @@ void AddLocalStream(RoRnet::StreamRegister *reg, int size)
     m_stream_id++;
 }
 
-std::vector<recv_packet_t> GetIncomingStreamData()
+const std::vector<recv_packet_t>& GetIncomingStreamData()
 {
-    std::lock_guard<std::mutex> lock(m_recv_packetqueue_mutex);
-    std::vector<recv_packet_t> buf_copy = m_recv_packet_buffer;
-    m_recv_packet_buffer.clear();
-    return buf_copy;
+    // The previous batch was handled, let RecvThread reuse its memory
+    m_recv_ring.Release();
+    m_recv_packets.clear();
+
+    PacketRing::Record* rec;
+    while ((rec = m_recv_ring.Front()) != nullptr)
+    {
+        recv_packet_t packet;
+        packet.header = rec->header;
+        packet.buffer = rec->GetBody();
+        m_recv_packets.push_back(packet);
+        RecordLatency(rec->push_time, m_stat_recv_latency_sum, m_stat_recv_latency_max);
+        m_recv_ring.Next();
+    }
+    return m_recv_packets;
 }
 
 Ogre::String GetTerrainName()
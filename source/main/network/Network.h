@@ -64,15 +64,31 @@ struct CharacterMsgAttach
     int32_t position;
 };
 
+#pragma pack(pop)
+
+// ------------------------ End of network messages --------------------------
+
+/// Received packet. The payload lives in the receive queue; it's zero-terminated and stays valid
+/// until the next call to GetIncomingStreamData().
 struct recv_packet_t
 {
     RoRnet::Header header;
-    char buffer[RORNET_MAX_MESSAGE_LENGTH];
+    char* buffer;
 };
 
-#pragma pack(pop)
-
-// ------------------------ End of network messages --------------------------
+/// Packet counters since Connect()
+struct NetStats
+{
+    uint64_t packets_sent;
+    uint64_t packets_superseded;   //!< Stream data not sent because newer data of the stream was queued
+    uint64_t packets_dropped;      //!< Stream data not sent because the send queue was full
+    uint64_t packets_received;
+    uint64_t recv_stalls;          //!< Times the receive thread waited for the game to catch up
+    float    send_latency_avg_ms;  //!< Time in the send queue
+    float    send_latency_max_ms;
+    float    recv_latency_avg_ms;  //!< Time in the receive queue
+    float    recv_latency_max_ms;
+};
 
 bool Connect();
 void Disconnect();
@@ -80,7 +96,9 @@ void Disconnect();
 void AddPacket(int streamid, int type, int len, char *content);
 void AddLocalStream(RoRnet::StreamRegister *reg, int size);
 
-std::vector<recv_packet_t> GetIncomingStreamData();
+/// Packets received since the last call
+const std::vector<recv_packet_t>& GetIncomingStreamData();
+NetStats GetNetStats();
 
 int GetUID();
 int GetNetQuality();
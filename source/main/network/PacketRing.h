@@ -0,0 +1,188 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2013-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// @file
+/// @brief Lock-free queue of network packets between exactly one producer and one consumer thread.
+
+#pragma once
+
+#include "RoRnet.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace RoR {
+namespace Networking {
+
+/// Single-producer/single-consumer queue of variable-size packets, stored back to back in a
+/// preallocated byte ring. Packets are written once by the producer and read in place by the consumer;
+/// their memory is only recycled when the consumer calls Release().
+class PacketRing
+{
+public:
+
+    struct Record
+    {
+        uint32_t       record_size;  //!< Bytes up to the next record, including padding
+        int32_t        slot;         //!< Producer-defined tag; PADDING marks the unused tail of the ring
+        uint32_t       seq;          //!< Producer-defined sequence number
+        uint32_t       reserved;
+        int64_t        push_time;    //!< Producer-defined timestamp
+        RoRnet::Header header;
+        // followed by 'header.size' bytes of payload and a terminating zero
+
+        char* GetBody() { return reinterpret_cast<char*>(this + 1); }
+    };
+
+    static_assert(offsetof(Record, header) + sizeof(RoRnet::Header) == sizeof(Record), "Payload must directly follow the header");
+
+    static const int32_t PADDING = -2;
+
+    /// @param capacity Ring size in bytes, rounded up to a power of two
+    explicit PacketRing(size_t capacity)
+        : m_head(0)
+        , m_tail(0)
+        , m_read(0)
+    {
+        m_capacity = 1;
+        while (m_capacity < capacity)
+        {
+            m_capacity <<= 1;
+        }
+        m_mask = m_capacity - 1;
+        // Trailing zeros, so that readers which ignore 'header.size' never run past the allocation
+        m_buffer.resize(m_capacity + GUARD_BYTES, 0);
+    }
+
+    /// Producer: appends a packet.
+    /// @return False if the ring is full; nothing is written then.
+    bool Push(const RoRnet::Header& header, const char* body, size_t body_len, int32_t slot, uint32_t seq, int64_t push_time)
+    {
+        const size_t size = RecordSize(body_len);
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        const size_t offset = head & m_mask;
+        const size_t contiguous = m_capacity - offset;
+        const size_t needed = (contiguous < size) ? contiguous + size : size; // Records never wrap around
+
+        if (size > m_capacity || m_capacity - (head - tail) < needed)
+        {
+            return false;
+        }
+
+        size_t pos = head;
+        if (contiguous < size)
+        {
+            Record* pad = GetRecord(pos);
+            pad->record_size = (uint32_t)contiguous;
+            pad->slot = PADDING;
+            pos += contiguous;
+        }
+
+        Record* rec = GetRecord(pos);
+        rec->record_size = (uint32_t)size;
+        rec->slot = slot;
+        rec->seq = seq;
+        rec->reserved = 0;
+        rec->push_time = push_time;
+        rec->header = header;
+        char* dst = rec->GetBody();
+        if (body_len > 0)
+        {
+            memcpy(dst, body, body_len);
+        }
+        dst[body_len] = 0;
+
+        m_head.store(pos + size, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer: the next packet which wasn't read yet, or nullptr.
+    Record* Front()
+    {
+        const size_t head = m_head.load(std::memory_order_acquire);
+        while (m_read != head)
+        {
+            Record* rec = GetRecord(m_read);
+            if (rec->slot != PADDING)
+            {
+                return rec;
+            }
+            m_read += rec->record_size;
+        }
+        return nullptr;
+    }
+
+    /// Consumer: moves past the packet returned by Front(). It stays valid until Release().
+    void Next()
+    {
+        m_read += GetRecord(m_read)->record_size;
+    }
+
+    /// Consumer: hands the memory of all packets read so far back to the producer.
+    void Release()
+    {
+        m_tail.store(m_read, std::memory_order_release);
+    }
+
+    bool IsEmpty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+    /// Drops all packets; neither side may use the ring meanwhile.
+    void Reset()
+    {
+        m_head = 0;
+        m_tail = 0;
+        m_read = 0;
+    }
+
+private:
+
+    static const size_t ALIGNMENT = 8;
+    static const size_t GUARD_BYTES = 256;
+
+    static size_t RecordSize(size_t body_len)
+    {
+        return (sizeof(Record) + body_len + 1 + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    Record* GetRecord(size_t pos)
+    {
+        return reinterpret_cast<Record*>(&m_buffer[pos & m_mask]);
+    }
+
+    std::vector<char>   m_buffer;
+    size_t              m_capacity;
+    size_t              m_mask;
+
+    // Positions grow monotonically; the offset into the buffer is 'pos & m_mask'
+    alignas(64) std::atomic<size_t> m_head;   //!< Written by the producer
+    alignas(64) std::atomic<size_t> m_tail;   //!< Written by the consumer: everything before is free
+    alignas(64) size_t              m_read;   //!< Consumer only: read cursor, at or after m_tail
+};
+
+} // namespace Networking
+} // namespace RoR
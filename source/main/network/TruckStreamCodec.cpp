@@ -0,0 +1,358 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2013-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TruckStreamCodec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace RoR {
+
+const float TruckStreamCodec::QUANT_STEPS_PER_METER = 300.0f;
+
+// Quantized positions are clamped to +/- QUANT_LIMIT, so a delta (position - node 0 - keyframe position)
+// stays within +/- 3 * QUANT_LIMIT and its zigzag code within 31 bits, the most WIDTH_BITS can describe.
+static const int32_t QUANT_LIMIT = 1 << 28;
+static const int     WIDTH_BITS = 5;
+static const int     MAX_WIDTH = (1 << WIDTH_BITS) - 1;
+
+static_assert(2ll * 3 * QUANT_LIMIT <= (1ll << MAX_WIDTH), "Zigzag coded deltas must fit MAX_WIDTH bits");
+
+static inline uint32_t ZigZag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t UnZigZag(uint32_t v)
+{
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static inline int BitWidth(uint32_t v)
+{
+    int w = 0;
+    while (v)
+    {
+        w++;
+        v >>= 1;
+    }
+    return w;
+}
+
+class BitWriter
+{
+public:
+    BitWriter(char* out, size_t capacity): m_out(out), m_capacity(capacity), m_pos(0), m_acc(0), m_bits(0), m_overflow(false) {}
+
+    void Put(uint32_t value, int bits)
+    {
+        if (bits == 0)
+            return;
+        m_acc |= ((uint64_t)value & ((1ull << bits) - 1)) << m_bits;
+        m_bits += bits;
+        while (m_bits >= 8)
+        {
+            PutByte((char)(m_acc & 0xFF));
+            m_acc >>= 8;
+            m_bits -= 8;
+        }
+    }
+
+    /// @return Bytes written, or 0 on overflow
+    size_t Finish()
+    {
+        if (m_bits > 0)
+        {
+            PutByte((char)(m_acc & 0xFF));
+            m_acc = 0;
+            m_bits = 0;
+        }
+        return m_overflow ? 0 : m_pos;
+    }
+
+private:
+    void PutByte(char c)
+    {
+        if (m_pos < m_capacity)
+            m_out[m_pos++] = c;
+        else
+            m_overflow = true;
+    }
+
+    char*    m_out;
+    size_t   m_capacity;
+    size_t   m_pos;
+    uint64_t m_acc;
+    int      m_bits;
+    bool     m_overflow;
+};
+
+class BitReader
+{
+public:
+    BitReader(const char* in, size_t size): m_in(in), m_size(size), m_pos(0), m_acc(0), m_bits(0), m_overrun(false) {}
+
+    uint32_t Get(int bits)
+    {
+        if (bits == 0)
+            return 0;
+        while (m_bits < bits)
+        {
+            uint64_t byte = 0;
+            if (m_pos < m_size)
+                byte = (uint8_t)m_in[m_pos++];
+            else
+                m_overrun = true;
+            m_acc |= byte << m_bits;
+            m_bits += 8;
+        }
+        uint32_t value = (uint32_t)(m_acc & ((1ull << bits) - 1));
+        m_acc >>= bits;
+        m_bits -= bits;
+        return value;
+    }
+
+    bool Overrun() const { return m_overrun; }
+
+private:
+    const char* m_in;
+    size_t      m_size;
+    size_t      m_pos;
+    uint64_t    m_acc;
+    int         m_bits;
+    bool        m_overrun;
+};
+
+TruckStreamCodec::TruckStreamCodec()
+{
+    Reset(0, 0);
+}
+
+void TruckStreamCodec::Reset(int num_nodes, int num_wheels)
+{
+    m_num_nodes = num_nodes;
+    m_num_wheels = num_wheels;
+    m_frame = 0;
+    m_has_keyframe = false;
+    m_last_was_keyframe = false;
+    m_frames_since_keyframe = 0;
+    m_keyframe_size = 0;
+    m_key_frame = 0;
+    m_key_ref[0] = m_key_ref[1] = m_key_ref[2] = 0.0f;
+    m_key_q.assign(num_nodes * 3, 0);
+    m_q.assign(num_nodes * 3, 0);
+    m_values.assign(num_nodes * 3, 0);
+}
+
+void TruckStreamCodec::Quantize(const float* node_pos, const float* ref, std::vector<int32_t>& out) const
+{
+    for (int i = 0; i < m_num_nodes * 3; i++)
+    {
+        float steps = std::floor((node_pos[i] - ref[i % 3]) * QUANT_STEPS_PER_METER + 0.5f);
+        steps = std::max(-(float)QUANT_LIMIT, std::min((float)QUANT_LIMIT, steps));
+        out[i] = (int32_t)steps;
+    }
+}
+
+size_t TruckStreamCodec::Encode(const float* node_pos, const float* wheel_rp, bool keyframe, char* out, size_t out_capacity)
+{
+    if (m_num_nodes < 1)
+        return 0;
+
+    keyframe = keyframe || !m_has_keyframe || m_frames_since_keyframe >= KEYFRAME_INTERVAL;
+
+    size_t size = 0;
+    if (!keyframe)
+    {
+        Quantize(node_pos, m_key_ref, m_q);
+        for (int i = 1; i < m_num_nodes; i++)
+        {
+            for (int a = 0; a < 3; a++)
+            {
+                m_values[i * 3 + a] = (m_q[i * 3 + a] - m_q[a]) - m_key_q[i * 3 + a];
+            }
+        }
+        size = Write(false, wheel_rp, out, out_capacity);
+        // Once the truck moved or deformed so much that deltas got bigger than a keyframe, start over
+        keyframe = (size == 0 || size > m_keyframe_size);
+    }
+
+    if (keyframe)
+    {
+        m_key_ref[0] = node_pos[0];
+        m_key_ref[1] = node_pos[1];
+        m_key_ref[2] = node_pos[2];
+        Quantize(node_pos, m_key_ref, m_key_q);
+        std::copy(m_key_q.begin(), m_key_q.end(), m_values.begin());
+        m_key_frame = m_frame;
+        size = Write(true, wheel_rp, out, out_capacity);
+        if (size == 0)
+        {
+            m_has_keyframe = false;
+            return 0;
+        }
+        m_has_keyframe = true;
+        m_keyframe_size = size;
+        m_frames_since_keyframe = 0;
+    }
+    else
+    {
+        m_frames_since_keyframe++;
+    }
+
+    m_last_was_keyframe = keyframe;
+    m_frame++;
+    return size;
+}
+
+size_t TruckStreamCodec::Write(bool keyframe, const float* wheel_rp, char* out, size_t out_capacity)
+{
+    const size_t fixed_size = sizeof(TruckStreamHeader) + m_num_wheels * sizeof(float);
+    if (out_capacity < fixed_size)
+        return 0;
+
+    TruckStreamHeader header;
+    header.magic = TRUCK_STREAM_COMPACT_MAGIC;
+    header.frame = m_frame;
+    header.keyframe = keyframe ? m_frame : m_key_frame;
+    header.num_nodes = (uint16_t)m_num_nodes;
+    header.num_wheels = (uint16_t)m_num_wheels;
+    if (keyframe)
+    {
+        std::memcpy(header.ref_pos, m_key_ref, sizeof(header.ref_pos));
+    }
+    else
+    {
+        std::memcpy(header.ref_offset, &m_q[0], sizeof(header.ref_offset));
+    }
+    std::memcpy(out, &header, sizeof(TruckStreamHeader));
+    if (m_num_wheels > 0)
+    {
+        std::memcpy(out + sizeof(TruckStreamHeader), wheel_rp, m_num_wheels * sizeof(float));
+    }
+
+    // Node 0 is described by the header, the bit stream covers nodes 1..n-1
+    BitWriter bits(out + fixed_size, out_capacity - fixed_size);
+    for (int begin = 1; begin < m_num_nodes; begin += GROUP_SIZE)
+    {
+        const int end = std::min(begin + GROUP_SIZE, m_num_nodes);
+        for (int a = 0; a < 3; a++)
+        {
+            uint32_t all = 0;
+            for (int i = begin; i < end; i++)
+            {
+                all |= ZigZag(m_values[i * 3 + a]);
+            }
+            const int width = BitWidth(all);
+            if (width > MAX_WIDTH)
+                return 0; // Can't be described; Encode() falls back to a keyframe
+            bits.Put(width, WIDTH_BITS);
+            for (int i = begin; i < end; i++)
+            {
+                bits.Put(ZigZag(m_values[i * 3 + a]), width);
+            }
+        }
+    }
+    const size_t bits_size = bits.Finish();
+    if (bits_size == 0 && m_num_nodes > 1)
+        return 0;
+
+    return fixed_size + bits_size;
+}
+
+bool TruckStreamCodec::IsCompact(const char* data, size_t size)
+{
+    if (size < sizeof(TruckStreamHeader))
+        return false;
+    uint32_t magic;
+    std::memcpy(&magic, data, sizeof(magic));
+    return magic == TRUCK_STREAM_COMPACT_MAGIC;
+}
+
+bool TruckStreamCodec::Decode(const char* data, size_t size, float* node_pos, float* wheel_rp)
+{
+    if (!IsCompact(data, size))
+        return false;
+
+    TruckStreamHeader header;
+    std::memcpy(&header, data, sizeof(TruckStreamHeader));
+    const size_t fixed_size = sizeof(TruckStreamHeader) + header.num_wheels * sizeof(float);
+    if (header.num_nodes != m_num_nodes || header.num_wheels != m_num_wheels || size < fixed_size || m_num_nodes < 1)
+        return false;
+
+    const bool keyframe = (header.keyframe == header.frame);
+    if (!keyframe && (!m_has_keyframe || header.keyframe != m_key_frame))
+        return false; // We missed the keyframe; wait for the next one
+
+    // Unpack into scratch first, the keyframe is only replaced once the packet checks out
+    BitReader bits(data + fixed_size, size - fixed_size);
+    m_values[0] = m_values[1] = m_values[2] = 0;
+    for (int begin = 1; begin < m_num_nodes; begin += GROUP_SIZE)
+    {
+        const int end = std::min(begin + GROUP_SIZE, m_num_nodes);
+        for (int a = 0; a < 3; a++)
+        {
+            const int width = (int)bits.Get(WIDTH_BITS);
+            for (int i = begin; i < end; i++)
+            {
+                m_values[i * 3 + a] = UnZigZag(bits.Get(width));
+            }
+        }
+    }
+    if (bits.Overrun())
+        return false;
+
+    if (keyframe)
+    {
+        std::memcpy(m_key_ref, header.ref_pos, sizeof(m_key_ref));
+        m_key_q = m_values;
+        m_key_frame = header.frame;
+        m_has_keyframe = true;
+        for (int i = 0; i < m_num_nodes * 3; i++)
+        {
+            node_pos[i] = m_key_ref[i % 3] + m_key_q[i] / QUANT_STEPS_PER_METER;
+        }
+    }
+    else
+    {
+        for (int a = 0; a < 3; a++)
+        {
+            node_pos[a] = m_key_ref[a] + header.ref_offset[a] / QUANT_STEPS_PER_METER;
+        }
+        for (int i = 1; i < m_num_nodes; i++)
+        {
+            for (int a = 0; a < 3; a++)
+            {
+                const int32_t q = m_values[i * 3 + a] + m_key_q[i * 3 + a] + header.ref_offset[a];
+                node_pos[i * 3 + a] = m_key_ref[a] + q / QUANT_STEPS_PER_METER;
+            }
+        }
+    }
+
+    if (m_num_wheels > 0)
+    {
+        std::memcpy(wheel_rp, data + sizeof(TruckStreamHeader), m_num_wheels * sizeof(float));
+    }
+    return true;
+}
+
+} // namespace RoR
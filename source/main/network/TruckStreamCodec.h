@@ -0,0 +1,111 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2013-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// @file
+/// @brief Compact encoding of truck node positions for MSG2_STREAM_DATA.
+///
+/// The legacy format (see Beam::sendStreamData()) sends node 0 as 3 floats and every other node
+/// as 3 shorts relative to it, each update. The compact format sends keyframes and deltas:
+///
+///  - Positions are quantized with the legacy precision (1/300 m) relative to the last keyframe's node 0.
+///  - A keyframe carries all nodes relative to its node 0.
+///  - A delta carries, per node, how much its offset from node 0 changed since the keyframe.
+///    Receivers which missed the keyframe skip deltas until the next keyframe.
+///  - Values are zigzag coded and bit packed in groups of nodes; each group and axis uses
+///    the bit width its largest value needs.
+///
+/// Packet layout after RoRnet::TruckState: TruckStreamHeader, wheel rotations (floats), bit stream.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace RoR {
+
+/// Marks compact stream packets, and register results of clients which can decode them
+static const uint32_t TRUCK_STREAM_COMPACT_MAGIC = 0x31434E52; // "RNC1"
+
+#pragma pack(push, 1)
+
+struct TruckStreamHeader
+{
+    uint32_t magic;            //!< TRUCK_STREAM_COMPACT_MAGIC
+    uint16_t frame;            //!< Sequence number
+    uint16_t keyframe;         //!< Frame the positions are relative to; equals 'frame' for keyframes
+    uint16_t num_nodes;
+    uint16_t num_wheels;
+    union
+    {
+        float   ref_pos[3];    //!< Keyframes: position of node 0
+        int32_t ref_offset[3]; //!< Deltas: offset of node 0 from the keyframe's, in quantization steps
+    };
+};
+
+#pragma pack(pop)
+
+/// Encoder (sending side) or decoder (receiving side) of one truck stream; keeps the last keyframe.
+class TruckStreamCodec
+{
+public:
+
+    static const int   KEYFRAME_INTERVAL = 20;   //!< Max. deltas between two keyframes
+    static const int   GROUP_SIZE = 16;          //!< Nodes sharing one bit width per axis
+    static const float QUANT_STEPS_PER_METER;    //!< Same precision as the legacy format
+
+    TruckStreamCodec();
+
+    void Reset(int num_nodes, int num_wheels);
+
+    /// @param node_pos    'num_nodes' positions, xyz interleaved
+    /// @param wheel_rp    'num_wheels' wheel rotations
+    /// @param keyframe    Force a keyframe
+    /// @return Bytes written to 'out'; 0 if they don't fit into 'out_capacity'.
+    size_t Encode(const float* node_pos, const float* wheel_rp, bool keyframe, char* out, size_t out_capacity);
+
+    /// @return False if the packet is malformed or its keyframe is unknown; outputs are untouched then.
+    bool Decode(const char* data, size_t size, float* node_pos, float* wheel_rp);
+
+    static bool IsCompact(const char* data, size_t size);
+
+    bool WasKeyframe() const { return m_last_was_keyframe; }
+
+private:
+
+    void   Quantize(const float* node_pos, const float* ref, std::vector<int32_t>& out) const;
+    size_t Write(bool keyframe, const float* wheel_rp, char* out, size_t out_capacity);
+
+    int                  m_num_nodes;
+    int                  m_num_wheels;
+    uint16_t             m_frame;
+    bool                 m_has_keyframe;
+    bool                 m_last_was_keyframe;
+    int                  m_frames_since_keyframe;
+    size_t               m_keyframe_size;
+    uint16_t             m_key_frame;      //!< Frame number of the current keyframe
+    float                m_key_ref[3];     //!< Node 0 position of the keyframe
+    std::vector<int32_t> m_key_q;          //!< Keyframe: quantized node offsets from node 0
+    std::vector<int32_t> m_q;              //!< Scratch: quantized positions relative to m_key_ref
+    std::vector<int32_t> m_values;         //!< Scratch: values to pack
+};
+
+} // namespace RoR
@@ -25,42 +25,42 @@
 
 #include "RoRPrerequisites.h"
 
-static int mirand = 1;
+// State of the frand*() generators below. Each truck owns one, so that trucks simulated
+// on different threads neither race on a shared state nor depend on each other's draws.
+struct frand_state_t
+{
+    explicit frand_state_t(unsigned int seed = 1): mirand(seed | 1) {} // Must stay odd
+    unsigned int mirand;
+};
 
-// Returns a random number in the range [0, 1]
-inline float frand()
+// Returns a random number in the range [2, 4)
+inline float frand_24(frand_state_t& state)
 {
     unsigned int a;
 
-    mirand *= 16807;
+    state.mirand *= 16807;
 
-    a = (mirand&0x007fffff) | 0x40000000;
+    a = (state.mirand&0x007fffff) | 0x40000000;
 
-    return( *((float*)&a) - 2.0f )*0.5f;
+    return *((float*)&a);
 }
 
-// Returns a random number in the range [0, 2]
-inline float frand_02()
+// Returns a random number in the range [0, 1]
+inline float frand(frand_state_t& state)
 {
-    unsigned int a;
-
-    mirand *= 16807;
-
-    a = (mirand&0x007fffff) | 0x40000000;
+    return( frand_24(state) - 2.0f )*0.5f;
+}
 
-    return( *((float*)&a) - 2.0f );
+// Returns a random number in the range [0, 2]
+inline float frand_02(frand_state_t& state)
+{
+    return( frand_24(state) - 2.0f );
 }
 
 // Returns a random number in the range [-1, 1]
-inline float frand_11()
+inline float frand_11(frand_state_t& state)
 {
-    unsigned int a;
-
-    mirand *= 16807;
-
-    a = (mirand&0x007fffff) | 0x40000000;
-
-    return( *((float*)&a) - 3.0f );
+    return( frand_24(state) - 3.0f );
 }
 
 // Calculates approximate e^x.
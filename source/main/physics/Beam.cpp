@@ -38,6 +38,7 @@
 #include "BeamData.h"
 #include "BeamEngine.h"
 #include "BeamFactory.h"
+#include "BeamSimd.h"
 #include "BeamStats.h"
 #include "Buoyance.h"
 #include "CacheSystem.h"
@@ -50,7 +51,6 @@
 #include "DashBoardManager.h"
 #include "Differentials.h"
 #include "DynamicCollisions.h"
-#include "ErrorUtils.h"
 #include "FlexAirfoil.h"
 #include "FlexBody.h"
 #include "FlexMesh.h"
@@ -89,6 +89,7 @@
 
 #define LOAD_RIG_PROFILE_CHECKPOINT(ENTRY) rig_loading_profiler->Checkpoint(RoR::RigLoadingProfiler::ENTRY);
 
+#include "RigDef_FileCache.h"
 #include "RigDef_Parser.h"
 #include "RigDef_Validator.h"
 
@@ -354,6 +355,10 @@ Beam::~Beam()
         if (axles[i] != nullptr)
             delete (axles[i]);
     }
+
+    // nodes, beams, cabs... see RigSpawner::AllocateRigArrays()
+    free(rig_arena);
+    rig_arena = nullptr;
 }
 
 // This method scales trucks. Stresses should *NOT* be scaled, they describe
@@ -461,7 +466,7 @@ float Beam::getRotation()
 Vector3 Beam::getDirection()
 {
     Vector3 cur_dir = nodes[0].AbsPosition;
-    if (cameranodepos[0] != cameranodedir[0] && cameranodepos[0] >= 0 && cameranodepos[0] < MAX_NODES && cameranodedir[0] >= 0 && cameranodedir[0] < MAX_NODES)
+    if (cameranodepos[0] != cameranodedir[0] && cameranodepos[0] >= 0 && cameranodepos[0] < free_node && cameranodedir[0] >= 0 && cameranodedir[0] < free_node)
     {
         cur_dir = nodes[cameranodepos[0]].RelPosition - nodes[cameranodedir[0]].RelPosition;
     }
@@ -497,6 +502,9 @@ void Beam::pushNetwork(char* data, int size)
     if (!oob3)
         return;
 
+    // the node buffers hold absolute positions, whichever format they were sent in
+    float* node_pos = (float*)netb3;
+
     // check if the size of the data matches to what we expected
     if ((unsigned int)size == (netbuffersize + sizeof(RoRnet::TruckState)))
     {
@@ -507,8 +515,13 @@ void Beam::pushNetwork(char* data, int size)
         memcpy((char*)oob3, ptr, sizeof(RoRnet::TruckState));
         ptr += sizeof(RoRnet::TruckState);
 
-        // then copy the node data
-        memcpy((char*)netb3, ptr, nodebuffersize);
+        // then the node data: first node is uncompressed, all others are short ints relative to it
+        float* refpos = (float*)ptr;
+        short* sbuf = (short*)(ptr + sizeof(float) * 3);
+        for (int i = 0; i < first_wheel_node * 3; i++)
+        {
+            node_pos[i] = (i < 3) ? refpos[i] : refpos[i % 3] + (float)(sbuf[i - 3]) / 300.0f;
+        }
         ptr += nodebuffersize;
 
         // then take care of the wheel speeds
@@ -520,6 +533,22 @@ void Beam::pushNetwork(char* data, int size)
             ptr += sizeof(float);
         }
     }
+    else if ((unsigned int)size > sizeof(RoRnet::TruckState) &&
+        RoR::TruckStreamCodec::IsCompact(data + sizeof(RoRnet::TruckState), size - sizeof(RoRnet::TruckState)))
+    {
+        float* wheel_rp = m_net_wheel_rp.empty() ? nullptr : &m_net_wheel_rp[0];
+        if (!m_net_codec.Decode(data + sizeof(RoRnet::TruckState), size - sizeof(RoRnet::TruckState), node_pos, wheel_rp))
+        {
+            // delta to a keyframe we didn't get (joined late or it was dropped), wait for the next one
+            BES_GFX_STOP(BES_GFX_pushNetwork);
+            return;
+        }
+        memcpy((char*)oob3, data, sizeof(RoRnet::TruckState));
+        for (int i = 0; i < free_wheel; i++)
+        {
+            wheels[i].rp3 = m_net_wheel_rp[i];
+        }
+    }
     else
     {
         // TODO: show the user the problem in the GUI
@@ -586,43 +615,15 @@ void Beam::calcNetwork()
     }
     float tratio = (float)(rnow - oob1->time) / (float)(oob2->time - oob1->time);
 
-    short* sp1 = (short*)(netb1 + sizeof(float) * 3);
-    short* sp2 = (short*)(netb2 + sizeof(float) * 3);
-    Vector3 p1ref = Vector3::ZERO;
-    Vector3 p2ref = Vector3::ZERO;
+    const float* fp1 = (float*)netb1;
+    const float* fp2 = (float*)netb2;
     Vector3 apos = Vector3::ZERO;
-    Vector3 p1 = Vector3::ZERO;
-    Vector3 p2 = Vector3::ZERO;
 
     for (int i = 0; i < first_wheel_node; i++)
     {
-        if (i == 0)
-        {
-            // first node is uncompressed
-            p1.x = ((float*)netb1)[0];
-            p1.y = ((float*)netb1)[1];
-            p1.z = ((float*)netb1)[2];
-            p1ref = p1;
-
-            p2.x = ((float*)netb2)[0];
-            p2.y = ((float*)netb2)[1];
-            p2.z = ((float*)netb2)[2];
-            p2ref = p2;
-        }
-        else
-        {
-            // all other nodes are compressed:
-            // short int compared to previous node
-            p1.x = (float)(sp1[(i - 1) * 3 + 0]) / 300.0f;
-            p1.y = (float)(sp1[(i - 1) * 3 + 1]) / 300.0f;
-            p1.z = (float)(sp1[(i - 1) * 3 + 2]) / 300.0f;
-            p1 = p1 + p1ref;
-
-            p2.x = (float)(sp2[(i - 1) * 3 + 0]) / 300.0f;
-            p2.y = (float)(sp2[(i - 1) * 3 + 1]) / 300.0f;
-            p2.z = (float)(sp2[(i - 1) * 3 + 2]) / 300.0f;
-            p2 = p2 + p2ref;
-        }
+        // node positions were decoded in pushNetwork()
+        Vector3 p1(fp1[i * 3 + 0], fp1[i * 3 + 1], fp1[i * 3 + 2]);
+        Vector3 p2(fp2[i * 3 + 0], fp2[i * 3 + 1], fp2[i * 3 + 2]);
 
         // linear interpolation
         nodes[i].AbsPosition = p1 + tratio * (p2 - p1);
@@ -781,11 +782,11 @@ void Beam::calc_masses2(Real total, bool reCalc)
     {
         if (!nodes[i].iswheel)
         {
-            if (!nodes[i].loadedMass)
+            if (!node_attrs[i].loadedMass)
             {
                 nodes[i].mass = 0;
             }
-            else if (!nodes[i].overrideMass)
+            else if (!node_attrs[i].overrideMass)
             {
                 nodes[i].mass = loadmass / (float)masscount;
             }
@@ -853,9 +854,9 @@ void Beam::calc_masses2(Real total, bool reCalc)
         if (App::diag_truck_mass.GetActive())
         {
             String msg = "Node " + TOSTRING(i) + " : " + TOSTRING((int)nodes[i].mass) + " Kg";
-            if (nodes[i].loadedMass)
+            if (node_attrs[i].loadedMass)
             {
-                if (nodes[i].overrideMass)
+                if (node_attrs[i].overrideMass)
                     msg += " (overriden by node mass)";
                 else
                     msg += " (normal load node: " + TOSTRING(loadmass) + " Kg / " + TOSTRING(masscount) + " nodes)";
@@ -957,6 +958,91 @@ void Beam::calcNodeConnectivityGraph()
     BES_GFX_STOP(BES_GFX_calcNodeConnectivityGraph);
 }
 
+void Beam::calcBeamPartitions()
+{
+    m_plain_beams.clear();
+    m_beam_simd_force.assign(free_beam, Vector3::ZERO);
+    m_beam_simd_stress.assign(free_beam, 0.f);
+    m_beam_simd_ready.assign(free_beam, 0);
+
+    // Beams of hooks, ropes and ties get re-linked to other nodes at runtime, keep them on the scalar path
+    std::vector<char> relinkable(free_beam, 0);
+    for (hook_t& hook : hooks)
+        relinkable[hook.beam - beams] = 1;
+    for (rope_t& rope : ropes)
+        relinkable[rope.beam - beams] = 1;
+    for (tie_t& tie : ties)
+        relinkable[tie.beam - beams] = 1;
+
+    int num_bounded[ROPE + 1] = {};
+    for (int i = 0; i < free_beam; i++)
+    {
+        if (beams[i].bounded == NOSHOCK && !beams[i].p2truck && !relinkable[i] && beams[i].p1 != beams[i].p2)
+        {
+            m_plain_beams.push_back(i);
+        }
+        else if (beams[i].bounded >= 0 && beams[i].bounded <= ROPE)
+        {
+            num_bounded[beams[i].bounded]++;
+        }
+    }
+
+    LOG("BEAM: beam partitions: plain " + TOSTRING(m_plain_beams.size()) + " (" + RoR::GetBeamSimdName() + "), shock1 " + TOSTRING(num_bounded[SHOCK1])
+        + ", shock2 " + TOSTRING(num_bounded[SHOCK2]) + ", supportbeam " + TOSTRING(num_bounded[SUPPORTBEAM]) + ", rope " + TOSTRING(num_bounded[ROPE]));
+
+    // Plain beams by node, in ascending beam order (= the order calcBeamsSimd() adds their forces)
+    m_node_beam_offsets.assign(free_node + 1, 0);
+    for (int i : m_plain_beams)
+    {
+        m_node_beam_offsets[beams[i].p1->pos + 1]++;
+        m_node_beam_offsets[beams[i].p2->pos + 1]++;
+    }
+    for (int n = 0; n < free_node; n++)
+    {
+        m_node_beam_offsets[n + 1] += m_node_beam_offsets[n];
+    }
+    m_node_beam_refs.resize(m_node_beam_offsets[free_node]);
+    std::vector<int> fill(m_node_beam_offsets.begin(), m_node_beam_offsets.end() - 1);
+    for (int i : m_plain_beams)
+    {
+        m_node_beam_refs[fill[beams[i].p1->pos]++] = i;
+        m_node_beam_refs[fill[beams[i].p2->pos]++] = ~i;
+    }
+
+    // Cut the node graph into chunks of neighbouring nodes: breadth-first walk over
+    // each connected component, then split the resulting order into equal pieces.
+    m_node_chunk_nodes.clear();
+    m_node_chunk_offsets.clear();
+    std::vector<char> visited(free_node, 0);
+    for (int root = 0; root < free_node; root++)
+    {
+        if (visited[root])
+            continue;
+        visited[root] = 1;
+        size_t head = m_node_chunk_nodes.size();
+        m_node_chunk_nodes.push_back(root);
+        while (head < m_node_chunk_nodes.size())
+        {
+            const int n = m_node_chunk_nodes[head++];
+            if (n >= static_cast<int>(nodetonodeconnections.size()))
+                continue;
+            for (int neighbour : nodetonodeconnections[n])
+            {
+                if (!visited[neighbour])
+                {
+                    visited[neighbour] = 1;
+                    m_node_chunk_nodes.push_back(neighbour);
+                }
+            }
+        }
+    }
+    for (int start = 0; start < free_node; start += PARALLEL_BEAMS_CHUNK_NODES)
+    {
+        m_node_chunk_offsets.push_back(start);
+    }
+    m_node_chunk_offsets.push_back(free_node);
+}
+
 Vector3 Beam::calculateCollisionOffset(Vector3 direction)
 {
     if (direction == Vector3::ZERO)
@@ -1248,7 +1334,7 @@ void Beam::resetAngle(float rot)
     // Set origin of rotation to camera node
     Vector3 origin = nodes[0].AbsPosition;
 
-    if (cameranodepos[0] >= 0 && cameranodepos[0] < MAX_NODES)
+    if (cameranodepos[0] >= 0 && cameranodepos[0] < free_node)
     {
         origin = nodes[cameranodepos[0]].AbsPosition;
     }
@@ -1284,7 +1370,7 @@ void Beam::resetPosition(float px, float pz, bool setInitPosition, float miny)
 
     // vertical displacement
     float vertical_offset = -nodes[lowestcontactingnode].AbsPosition.y + miny;
-    if (gEnv->terrainManager->getWater())
+    if (gEnv->terrainManager && gEnv->terrainManager->getWater()) // No terrain in headless mode
     {
         vertical_offset += std::max(0.0f, gEnv->terrainManager->getWater()->getHeight() - (nodes[lowestcontactingnode].AbsPosition.y + vertical_offset));
     }
@@ -1292,7 +1378,7 @@ void Beam::resetPosition(float px, float pz, bool setInitPosition, float miny)
     {
         if (nodes[i].contactless)
             continue;
-        float terrainHeight = gEnv->terrainManager->getHeightFinder()->getHeightAt(nodes[i].AbsPosition.x, nodes[i].AbsPosition.z);
+        float terrainHeight = gEnv->collisions->getHeightFinder()->getHeightAt(nodes[i].AbsPosition.x, nodes[i].AbsPosition.z);
         vertical_offset += std::max(0.0f, terrainHeight - (nodes[i].AbsPosition.y + vertical_offset));
     }
     for (int i = 0; i < free_node; i++)
@@ -1513,7 +1599,7 @@ Ogre::Vector3 Beam::getRotationCenter()
     if (m_is_cinecam_rotation_center)
     {
         Vector3 cinecam = nodes[0].AbsPosition;
-        if (cameranodepos[0] >= 0 && cameranodepos[0] < MAX_NODES)
+        if (cameranodepos[0] >= 0 && cameranodepos[0] < free_node)
         {
             cinecam = nodes[cameranodepos[0]].AbsPosition;
         }
@@ -1732,6 +1818,18 @@ void Beam::handleResetRequests(float dt)
 void Beam::sendStreamSetup()
 {
     RoRnet::TruckStreamRegister reg;
+    this->FillStreamRegister(reg);
+
+#ifdef USE_SOCKETW
+    RoR::Networking::AddLocalStream((RoRnet::StreamRegister *)&reg, sizeof(RoRnet::TruckStreamRegister));
+#endif // USE_SOCKETW
+
+    m_source_id = reg.origin_sourceid;
+    m_stream_id = reg.origin_streamid;
+}
+
+void Beam::FillStreamRegister(RoRnet::TruckStreamRegister& reg)
+{
     memset(&reg, 0, sizeof(RoRnet::TruckStreamRegister));
     reg.status = 0;
     reg.type = 0;
@@ -1743,13 +1841,6 @@ void Beam::sendStreamSetup()
         for (int i = 0; i < std::min<int>((int)m_truck_config.size(), 10); i++)
             strncpy(reg.truckconfig[i], m_truck_config[i].c_str(), 60);
     }
-
-#ifdef USE_SOCKETW
-    RoR::Networking::AddLocalStream((RoRnet::StreamRegister *)&reg, sizeof(RoRnet::TruckStreamRegister));
-#endif // USE_SOCKETW
-
-    m_source_id = reg.origin_sourceid;
-    m_stream_id = reg.origin_streamid;
 }
 
 void Beam::sendStreamData()
@@ -1760,21 +1851,56 @@ void Beam::sendStreamData()
 #ifdef USE_SOCKETW
     lastNetUpdateTime = netTimer.getMilliseconds();
 
-    //look if the packet is too big first
-    int final_packet_size = sizeof(RoRnet::TruckState) + sizeof(float) * 3 + first_wheel_node * sizeof(float) * 3 + free_wheel * sizeof(float);
-    if (final_packet_size > 8192)
+    char send_buffer[RORNET_MAX_MESSAGE_LENGTH] = {0};
+    // what RoR::Networking::SendMessage() accepts, less a byte for the padding below
+    const size_t max_packet_len = RORNET_MAX_MESSAGE_LENGTH - sizeof(RoRnet::Header) - 2;
+
+    // the compact format is only sent once every remote client told us it can decode it
+    bool compact = true;
+    for (const RoRnet::UserInfo& user : RoR::Networking::GetUserInfos())
     {
-        ErrorUtils::ShowError(_L("Truck is too big to be send over the net."), _L("Network error!"));
-        exit(126);
+        auto itor = m_stream_compact.find((int)user.uniqueid);
+        compact = compact && (itor != m_stream_compact.end()) && itor->second;
     }
+    // keyframes when switching formats, and for the rare updates of sleeping trucks
+    const bool keyframe = (compact != m_net_compact) || (state != SIMULATED);
+    m_net_compact = compact;
+
+    const unsigned int packet_len = static_cast<unsigned int>(this->PackStreamData(send_buffer, max_packet_len, compact, keyframe));
 
-    char send_buffer[8192] = {0};
+    if (packet_len == 0)
+    {
+        if (!m_net_too_big_reported)
+        {
+            m_net_too_big_reported = true;
+            LOG("Truck '" + String(truckname) + "' is too big to be sent over the net (" + TOSTRING(first_wheel_node) + " nodes), not sending updates");
+            if (RoR::App::GetGuiManager())
+            {
+                RoR::App::GetGuiManager()->PushNotification(_L("Network error!"), _L("Truck is too big to be send over the net."));
+            }
+        }
+        BES_GFX_STOP(BES_GFX_sendStreamData);
+        return;
+    }
 
-    unsigned int packet_len = 0;
+    RoR::Networking::AddPacket(m_stream_id, MSG2_STREAM_DATA, packet_len, send_buffer);
+#endif //SOCKETW
+    BES_GFX_STOP(BES_GFX_sendStreamData);
+}
+
+size_t Beam::PackStreamData(char* buffer, size_t capacity, bool compact, bool keyframe)
+{
+    using namespace RoRnet;
+
+    if (capacity < sizeof(RoRnet::TruckState))
+        return 0;
+
+    size_t packet_len = 0;
 
     // RoRnet::TruckState is at the beginning of the buffer
     {
-        RoRnet::TruckState* send_oob = (RoRnet::TruckState *)send_buffer;
+        RoRnet::TruckState* send_oob = (RoRnet::TruckState *)buffer;
+        memset(send_oob, 0, sizeof(RoRnet::TruckState));
         packet_len += sizeof(RoRnet::TruckState);
 
         send_oob->flagmask = 0;
@@ -1857,9 +1983,41 @@ void Beam::sendStreamData()
 #endif //OPENAL
     }
 
-    // then process the contents
+    if (compact)
     {
-        char* ptr = send_buffer + sizeof(RoRnet::TruckState);
+        for (int i = 0; i < first_wheel_node; i++)
+        {
+            m_net_node_pos[i * 3 + 0] = nodes[i].AbsPosition.x;
+            m_net_node_pos[i * 3 + 1] = nodes[i].AbsPosition.y;
+            m_net_node_pos[i * 3 + 2] = nodes[i].AbsPosition.z;
+        }
+        for (int i = 0; i < free_wheel; i++)
+        {
+            m_net_wheel_rp[i] = wheels[i].rp;
+        }
+        const float* wheel_rp = m_net_wheel_rp.empty() ? nullptr : &m_net_wheel_rp[0];
+        size_t len = m_net_codec.Encode(&m_net_node_pos[0], wheel_rp, keyframe,
+            buffer + packet_len, capacity - packet_len);
+        if (len == 0)
+        {
+            packet_len = 0;
+        }
+        else
+        {
+            if (len == (size_t)netbuffersize)
+            {
+                len++; // receivers tell the formats apart by size first
+            }
+            packet_len += (unsigned int)len;
+        }
+    }
+    else if (sizeof(RoRnet::TruckState) + netbuffersize > capacity)
+    {
+        packet_len = 0;
+    }
+    else
+    {
+        char* ptr = buffer + sizeof(RoRnet::TruckState);
         float* send_nodes = (float *)ptr;
         packet_len += netbuffersize;
 
@@ -1894,9 +2052,7 @@ void Beam::sendStreamData()
         }
     }
 
-    RoR::Networking::AddPacket(m_stream_id, MSG2_STREAM_DATA, packet_len, send_buffer);
-#endif //SOCKETW
-    BES_GFX_STOP(BES_GFX_sendStreamData);
+    return packet_len;
 }
 
 void Beam::receiveStreamData(unsigned int type, int source, unsigned int streamid, char* buffer, unsigned int len)
@@ -2283,7 +2439,7 @@ void Beam::calcAnimators(const int flag_state, float& cstate, int& div, Real tim
     Vector3 cam_roll = nodes[0].RelPosition;
     Vector3 cam_dir = nodes[0].RelPosition;
 
-    if (cameranodepos[0] >= 0 && cameranodepos[0] < MAX_NODES)
+    if (cameranodepos[0] >= 0 && cameranodepos[0] < free_node)
     {
         cam_pos = nodes[cameranodepos[0]].RelPosition;
         cam_roll = nodes[cameranoderoll[0]].RelPosition;
@@ -3412,30 +3568,30 @@ void Beam::updateFlexbodiesPrepare()
             flexbody_prepare.set(i, flexbodies[i]->flexitPrepare());
         }
 
-        // Push tasks into thread pool
-        for (int i = 0; i < free_flexbody; i++)
-        {
-            if (flexbody_prepare[i])
-            {
-                auto func = std::function<void()>([this, i]()
-                    {
-                        flexbodies[i]->flexitCompute();
-                    });
-                auto task_handle = gEnv->threadPool->RunTask(func);
-                flexbody_tasks.push_back(task_handle);
-            }
-        }
-        for (int i = 0; i < free_wheel; i++)
+        // Run a single asynchronous task which spreads flexbodies and wheels over the thread pool.
+        // Indices [0, free_flexbody) are flexbodies, the rest are wheels.
+        if (flexbody_prepare.any() || flexmesh_prepare.any())
         {
-            if (flexmesh_prepare[i])
-            {
-                auto func = std::function<void()>([this, i]()
-                    {
-                        vwheels[i].fm->flexitCompute();
-                    });
-                auto task_handle = gEnv->threadPool->RunTask(func);
-                flexbody_tasks.push_back(task_handle);
-            }
+            auto func = std::function<void()>([this]()
+                {
+                    gEnv->threadPool->ParallelFor(0, free_flexbody + free_wheel, 1, [this](int begin, int end)
+                        {
+                            for (int i = begin; i < end; i++)
+                            {
+                                if (i < free_flexbody)
+                                {
+                                    if (flexbody_prepare[i])
+                                        flexbodies[i]->flexitCompute();
+                                }
+                                else if (flexmesh_prepare[i - free_flexbody])
+                                {
+                                    vwheels[i - free_flexbody].fm->flexitCompute();
+                                }
+                            }
+                        });
+                });
+            auto task_handle = gEnv->threadPool->RunTask(func);
+            flexbody_tasks.push_back(task_handle);
         }
     }
     else
@@ -4054,7 +4210,7 @@ void Beam::hookToggle(int group, hook_states mode, int node_number)
                     for (int i = 0; i < trucks[t]->free_node; i++)
                     {
                         // skip all nodes with lockgroup 9999 (deny lock)
-                        if (trucks[t]->nodes[i].lockgroup == 9999)
+                        if (trucks[t]->node_attrs[i].lockgroup == 9999)
                             continue;
 
                         // exclude this truck and its current hooknode from the locking search
@@ -4062,7 +4218,7 @@ void Beam::hookToggle(int group, hook_states mode, int node_number)
                             continue;
 
                         // a lockgroup for this hooknode is set -> skip all nodes that do not have the same lockgroup (-1 = default(all nodes))
-                        if (it->lockgroup != -1 && it->lockgroup != trucks[t]->nodes[i].lockgroup)
+                        if (it->lockgroup != -1 && it->lockgroup != trucks[t]->node_attrs[i].lockgroup)
                             continue;
 
                         // measure distance
@@ -4279,6 +4435,9 @@ void Beam::setReplayMode(bool rm)
     {
         replaypos = 0;
         oldreplaypos = -1;
+        // back to recording, drop a replay file loaded for playback
+        replay->closeFile();
+        replaylen = replay->getNumFrames();
     }
 
     replaymode = rm;
@@ -4536,7 +4695,7 @@ void Beam::updateDashBoards(float dt)
     dash->setFloat(DD_ENGINE_SPEEDO_MPH, speed_mph);
 
     // roll
-    if (cameranodepos[0] >= 0 && cameranodepos[0] < MAX_NODES)
+    if (cameranodepos[0] >= 0 && cameranodepos[0] < free_node)
     {
         dir = nodes[cameranodepos[0]].RelPosition - nodes[cameranoderoll[0]].RelPosition;
         dir.normalise();
@@ -4562,7 +4721,7 @@ void Beam::updateDashBoards(float dt)
     }
 
     // pitch
-    if (cameranodepos[0] >= 0 && cameranodepos[0] < MAX_NODES)
+    if (cameranodepos[0] >= 0 && cameranodepos[0] < free_node)
     {
         dir = nodes[cameranodepos[0]].RelPosition - nodes[cameranodedir[0]].RelPosition;
         dir.normalise();
@@ -4645,7 +4804,7 @@ void Beam::updateDashBoards(float dt)
         }
 
         // water depth display, only if we have a screw prop at least
-        if (cameranodepos[0] >= 0 && cameranodepos[0] < MAX_NODES)
+        if (cameranodepos[0] >= 0 && cameranodepos[0] < free_node)
         {
             // position
             Vector3 dir = nodes[cameranodepos[0]].RelPosition - nodes[cameranodedir[0]].RelPosition;
@@ -4661,7 +4820,7 @@ void Beam::updateDashBoards(float dt)
         }
 
         // water speed
-        if (cameranodepos[0] >= 0 && cameranodepos[0] < MAX_NODES)
+        if (cameranodepos[0] >= 0 && cameranodepos[0] < free_node)
         {
             Vector3 hdir = nodes[cameranodepos[0]].RelPosition - nodes[cameranodedir[0]].RelPosition;
             hdir.normalise();
@@ -4879,7 +5038,7 @@ void Beam::updateDashBoards(float dt)
 
 Vector3 Beam::getGForces()
 {
-    if (cameranodepos[0] >= 0 && cameranodepos[0] < MAX_NODES && cameranodedir[0] >= 0 && cameranodedir[0] < MAX_NODES && cameranoderoll[0] >= 0 && cameranoderoll[0] < MAX_NODES)
+    if (cameranodepos[0] >= 0 && cameranodepos[0] < free_node && cameranodedir[0] >= 0 && cameranodedir[0] < free_node && cameranoderoll[0] >= 0 && cameranoderoll[0] < free_node)
     {
         static Vector3 result = Vector3::ZERO;
 
@@ -4996,6 +5155,7 @@ Beam::Beam(
     , disableTruckTruckSelfCollisions(false)
     , elevator(0)
     , flap(0)
+    , frand_state(2654435761u * (truck_number + 1))
     , fusedrag(Ogre::Vector3::ZERO)
     , high_res_wheelnode_collisions(false)
     , hydroaileroncommand(0)
@@ -5095,7 +5255,8 @@ Beam::Beam(
         }
     }
 
-    Ogre::SceneNode* beams_parent = gEnv->sceneManager->getRootSceneNode()->createChildSceneNode();
+    const bool headless = App::app_headless.GetActive();
+    Ogre::SceneNode* beams_parent = (headless) ? nullptr : gEnv->sceneManager->getRootSceneNode()->createChildSceneNode();
 
     LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_CTOR_PREPARE_LOADTRUCK);
 
@@ -5160,15 +5321,27 @@ Beam::Beam(
     //
     nodebuffersize = sizeof(float) * 3 + (first_wheel_node - 1) * sizeof(short int) * 3;
     netbuffersize = nodebuffersize + free_wheel * sizeof(float);
-    updateFlexbodiesPrepare();
-    updateFlexbodiesFinal();
-    updateVisual();
+    // compact layout, see TruckStreamCodec.h
+    m_net_codec.Reset(first_wheel_node, free_wheel);
+    m_net_node_pos.resize(first_wheel_node * 3);
+    m_net_wheel_rp.resize(free_wheel);
+    m_net_compact = false;
+    m_net_too_big_reported = false;
+    if (!headless)
+    {
+        updateFlexbodiesPrepare();
+        updateFlexbodiesFinal();
+        updateVisual();
+    }
     // stop lights
     lightsToggle();
 
     mCamera = gEnv->mainCamera;
-    updateFlares(0);
-    updateProps();
+    if (!headless)
+    {
+        updateFlares(0);
+        updateProps();
+    }
     if (engine)
     {
         engine->offstart();
@@ -5186,9 +5359,9 @@ Beam::Beam(
         oob1 = (RoRnet::TruckState*)malloc(sizeof(RoRnet::TruckState));
         oob2 = (RoRnet::TruckState*)malloc(sizeof(RoRnet::TruckState));
         oob3 = (RoRnet::TruckState*)malloc(sizeof(RoRnet::TruckState));
-        netb1 = (char*)malloc(netbuffersize);
-        netb2 = (char*)malloc(netbuffersize);
-        netb3 = (char*)malloc(netbuffersize);
+        netb1 = (char*)malloc(first_wheel_node * sizeof(float) * 3);
+        netb2 = (char*)malloc(first_wheel_node * sizeof(float) * 3);
+        netb3 = (char*)malloc(first_wheel_node * sizeof(float) * 3);
         net_toffset = 0;
         netcounter = 0;
         if (engine)
@@ -5204,7 +5377,7 @@ Beam::Beam(
             sendStreamSetup();
         }
 
-        if (state == NETWORKED || !m_hide_own_net_label)
+        if (!headless && (state == NETWORKED || !m_hide_own_net_label))
         {
             char wname[256];
             sprintf(wname, "netlabel-%s", truckname);
@@ -5308,47 +5481,6 @@ bool Beam::LoadTruck(
         return false;
     }
 
-    /* PARSING */
-
-    LOG(" == Parsing vehicle file: " + file_name);
-
-    RigDef::Parser parser;
-    LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_LOADTRUCK_PARSER_CREATE);
-    parser.Prepare();
-    LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_LOADTRUCK_PARSER_PREPARE);
-    parser.ProcessOgreStream(ds.getPointer());
-    LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_LOADTRUCK_PARSER_RUN);
-    parser.Finalize();
-    LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_LOADTRUCK_PARSER_FINALIZE);
-
-    int report_num_errors = parser.GetMessagesNumErrors();
-    int report_num_warnings = parser.GetMessagesNumWarnings();
-    int report_num_other = parser.GetMessagesNumOther();
-    std::string report_text = parser.ProcessMessagesToString();
-    report_text += "\n\n";
-    LOG(report_text);
-
-    auto* importer = parser.GetSequentialImporter();
-    if (importer->IsEnabled() && App::diag_rig_log_messages.GetActive())
-    {
-        report_num_errors += importer->GetMessagesNumErrors();
-        report_num_warnings += importer->GetMessagesNumWarnings();
-        report_num_other += importer->GetMessagesNumOther();
-
-        std::string importer_report = importer->ProcessMessagesToString();
-        LOG(importer_report);
-
-        report_text += importer_report + "\n\n";
-    }
-
-    /* VALIDATING */
-    LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_LOADTRUCK_POST_PARSE);
-    LOG(" == Validating vehicle: " + parser.GetFile()->name);
-
-    RigDef::Validator validator;
-    validator.Setup(parser.GetFile());
-    LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_LOADTRUCK_VALIDATOR_INIT);
-
     // Workaround: Some terrains pre-load truckfiles with special purpose:
     //     "soundloads" = play sound effect at certain spot
     //     "fixes"      = structures of N/B fixed to the ground
@@ -5356,33 +5488,101 @@ bool Beam::LoadTruck(
     Ogre::String file_extension = file_name.substr(file_name.find_last_of('.'));
     Ogre::StringUtil::toLowerCase(file_extension);
     bool extension_matches = (file_extension == ".load") | (file_extension == ".fixed");
-    if (m_preloaded_with_terrain && extension_matches)
+    const bool check_beams = !(m_preloaded_with_terrain && extension_matches);
+
+    // Respawned vehicles and multiplayer vehicles seen before re-use the validated definition
+    const std::string file_content = ds->getAsString();
+    RigDef::FileCache& rigdef_cache = m_sim_controller->GetBeamFactory()->GetRigDefCache();
+    std::shared_ptr<const RigDef::FileCache::Entry> definition = rigdef_cache.Find(fixed_file_name, file_content, check_beams);
+    RigDef::Parser parser;
+    bool parsed_now = false;
+    if (definition == nullptr)
+    {
+        /* PARSING */
+
+        LOG(" == Parsing vehicle file: " + file_name);
+
+        LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_LOADTRUCK_PARSER_CREATE);
+        parser.Prepare();
+        LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_LOADTRUCK_PARSER_PREPARE);
+        Ogre::MemoryDataStream content_stream(const_cast<char*>(file_content.data()), file_content.size(), false, true);
+        parser.ProcessOgreStream(&content_stream);
+        LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_LOADTRUCK_PARSER_RUN);
+        parser.Finalize();
+        LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_LOADTRUCK_PARSER_FINALIZE);
+
+        int report_num_errors = parser.GetMessagesNumErrors();
+        int report_num_warnings = parser.GetMessagesNumWarnings();
+        int report_num_other = parser.GetMessagesNumOther();
+        std::string report_text = parser.ProcessMessagesToString();
+        report_text += "\n\n";
+        LOG(report_text);
+
+        auto* importer = parser.GetSequentialImporter();
+        if (importer->IsEnabled() && App::diag_rig_log_messages.GetActive())
+        {
+            report_num_errors += importer->GetMessagesNumErrors();
+            report_num_warnings += importer->GetMessagesNumWarnings();
+            report_num_other += importer->GetMessagesNumOther();
+
+            std::string importer_report = importer->ProcessMessagesToString();
+            LOG(importer_report);
+
+            report_text += importer_report + "\n\n";
+        }
+
+        /* VALIDATING */
+        LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_LOADTRUCK_POST_PARSE);
+        LOG(" == Validating vehicle: " + parser.GetFile()->name);
+
+        RigDef::Validator validator;
+        validator.Setup(parser.GetFile());
+        LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_LOADTRUCK_VALIDATOR_INIT);
+
+        validator.SetCheckBeams(check_beams);
+        bool valid = validator.Validate();
+        LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_LOADTRUCK_VALIDATOR_RUN);
+
+        report_num_errors += validator.GetMessagesNumErrors();
+        report_num_warnings += validator.GetMessagesNumWarnings();
+        report_num_other += validator.GetMessagesNumOther();
+        std::string validator_report = validator.ProcessMessagesToString();
+        LOG(validator_report);
+        report_text += validator_report;
+        report_text += "\n\n";
+        // Continue anyway...
+
+        std::shared_ptr<RigDef::FileCache::Entry> new_definition = std::make_shared<RigDef::FileCache::Entry>();
+        new_definition->file = parser.GetFile();
+        new_definition->report = report_text;
+        new_definition->num_errors = report_num_errors;
+        new_definition->num_warnings = report_num_warnings;
+        new_definition->num_other = report_num_other;
+        rigdef_cache.Add(fixed_file_name, file_content, check_beams, new_definition);
+        definition = new_definition;
+        parsed_now = true;
+    }
+    else
     {
-        validator.SetCheckBeams(false);
+        LOG(" == Using cached definition of vehicle: " + definition->file->name);
     }
-    bool valid = validator.Validate();
-    LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_LOADTRUCK_VALIDATOR_RUN);
 
-    report_num_errors += validator.GetMessagesNumErrors();
-    report_num_warnings += validator.GetMessagesNumWarnings();
-    report_num_other += validator.GetMessagesNumOther();
-    std::string validator_report = validator.ProcessMessagesToString();
-    LOG(validator_report);
-    report_text += validator_report;
-    report_text += "\n\n";
-    // Continue anyway...
+    int report_num_errors = definition->num_errors;
+    int report_num_warnings = definition->num_warnings;
+    int report_num_other = definition->num_other;
+    std::string report_text = definition->report;
     LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_LOADTRUCK_POST_VALIDATION);
 
     /* PROCESSING */
 
-    LOG(" == Spawning vehicle: " + parser.GetFile()->name);
+    LOG(" == Spawning vehicle: " + definition->file->name);
 
     RigSpawner spawner(m_sim_controller);
-    spawner.Setup(this, parser.GetFile(), parent_scene_node, spawn_position, cache_entry_number);
+    spawner.Setup(this, definition->file, parent_scene_node, spawn_position, cache_entry_number);
     LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_LOADTRUCK_SPAWNER_SETUP);
     /* Setup modules */
-    spawner.AddModule(parser.GetFile()->root_module);
-    if (parser.GetFile()->modules.size() > 0) /* The vehicle-selector may return selected modules even for vehicle with no modules defined! Hence this check. */
+    spawner.AddModule(definition->file->root_module);
+    if (definition->file->modules.size() > 0) /* The vehicle-selector may return selected modules even for vehicle with no modules defined! Hence this check. */
     {
         std::vector<Ogre::String>::iterator itor = m_truck_config.begin();
         for (; itor != m_truck_config.end(); itor++)
@@ -5400,7 +5600,8 @@ bool Beam::LoadTruck(
     report_text += spawner.ProcessMessagesToString() + "\n\n";
 
     // Extra information to RoR.log
-    if (importer->IsEnabled())
+    RigDef::SequentialImporter* importer = parser.GetSequentialImporter();
+    if (parsed_now && importer->IsEnabled())
     {
         if (App::diag_rig_log_node_stats.GetActive())
         {
@@ -5412,8 +5613,11 @@ bool Beam::LoadTruck(
         }
     }
 
-    RoR::App::GetGuiManager()->AddRigLoadingReport(parser.GetFile()->name, report_text, report_num_errors, report_num_warnings, report_num_other);
-    if (report_num_errors != 0)
+    if (RoR::App::GetGuiManager()) // Not present in headless mode
+    {
+        RoR::App::GetGuiManager()->AddRigLoadingReport(definition->file->name, report_text, report_num_errors, report_num_warnings, report_num_other);
+    }
+    if (report_num_errors != 0 && RoR::App::GetGuiManager())
     {
         if (BSETTING("AutoRigSpawnerReport", false))
         {
@@ -5421,6 +5625,12 @@ bool Beam::LoadTruck(
         }
     }
     LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_LOADTRUCK_SPAWNER_LOG);
+
+    if (spawner.WasCapacityExceeded())
+    {
+        LOG(" == Spawning vehicle failed, it doesn't fit its pre-computed arrays: " + definition->file->name);
+        return false;
+    }
     /* POST-PROCESSING (Old-spawn code from Beam::loadTruck2) */
 
     // Apply spawn position & spawn rotation
@@ -5431,7 +5641,7 @@ bool Beam::LoadTruck(
     };
 
     /* Place correctly */
-    if (! parser.GetFile()->HasFixes())
+    if (! definition->file->HasFixes())
     {
         Ogre::Vector3 vehicle_position = spawn_position;
 
@@ -5493,6 +5703,7 @@ bool Beam::LoadTruck(
 
     //compute node connectivity graph
     calcNodeConnectivityGraph();
+    calcBeamPartitions();
     LOAD_RIG_PROFILE_CHECKPOINT(ENTRY_BEAM_LOADTRUCK_CALC_NODE_CONNECT_GRAPH);
 
     RigSpawner::RecalculateBoundingBoxes(this);
@@ -5514,18 +5725,23 @@ bool Beam::LoadTruck(
 
     tmpmem = free_beam * sizeof(beam_t);
     mem += tmpmem;
-    memr += MAX_BEAMS * sizeof(beam_t);
-    LOG("BEAM: beam memory: " + TOSTRING(tmpmem) + " B (" + TOSTRING(free_beam) + " x " + TOSTRING(sizeof(beam_t)) + " B) / " + TOSTRING(MAX_BEAMS * sizeof(beam_t)));
+    memr += capacity.beams * sizeof(beam_t);
+    LOG("BEAM: beam memory: " + TOSTRING(tmpmem) + " B (" + TOSTRING(free_beam) + " x " + TOSTRING(sizeof(beam_t)) + " B) / " + TOSTRING(capacity.beams * sizeof(beam_t)));
 
     tmpmem = free_node * sizeof(node_t);
     mem += tmpmem;
-    memr += MAX_NODES * sizeof(beam_t);
-    LOG("BEAM: node memory: " + TOSTRING(tmpmem) + " B (" + TOSTRING(free_node) + " x " + TOSTRING(sizeof(node_t)) + " B) / " + TOSTRING(MAX_NODES * sizeof(node_t)));
+    memr += capacity.nodes * sizeof(node_t);
+    LOG("BEAM: node memory: " + TOSTRING(tmpmem) + " B (" + TOSTRING(free_node) + " x " + TOSTRING(sizeof(node_t)) + " B) / " + TOSTRING(capacity.nodes * sizeof(node_t)));
+
+    tmpmem = free_node * sizeof(node_attr_t);
+    mem += tmpmem;
+    memr += capacity.nodes * sizeof(node_attr_t);
+    LOG("BEAM: node attribute memory: " + TOSTRING(tmpmem) + " B (" + TOSTRING(free_node) + " x " + TOSTRING(sizeof(node_attr_t)) + " B) / " + TOSTRING(capacity.nodes * sizeof(node_attr_t)));
 
     tmpmem = free_shock * sizeof(shock_t);
     mem += tmpmem;
-    memr += MAX_SHOCKS * sizeof(beam_t);
-    LOG("BEAM: shock memory: " + TOSTRING(tmpmem) + " B (" + TOSTRING(free_shock) + " x " + TOSTRING(sizeof(shock_t)) + " B) / " + TOSTRING(MAX_SHOCKS * sizeof(shock_t)));
+    memr += capacity.shocks * sizeof(shock_t);
+    LOG("BEAM: shock memory: " + TOSTRING(tmpmem) + " B (" + TOSTRING(free_shock) + " x " + TOSTRING(sizeof(shock_t)) + " B) / " + TOSTRING(capacity.shocks * sizeof(shock_t)));
 
     tmpmem = free_prop * sizeof(prop_t);
     mem += tmpmem;
@@ -5655,7 +5871,7 @@ bool Beam::LoadTruck(
         default_beam_plastic_coef[i] = beams[i].plastic_coef;
     }
 
-    if (cameranodepos[0] != cameranodedir[0] && cameranodepos[0] >= 0 && cameranodepos[0] < MAX_NODES && cameranodedir[0] >= 0 && cameranodedir[0] < MAX_NODES)
+    if (cameranodepos[0] != cameranodedir[0] && cameranodepos[0] >= 0 && cameranodepos[0] < free_node && cameranodedir[0] >= 0 && cameranodedir[0] < free_node)
     {
         Vector3 cur_dir = nodes[cameranodepos[0]].RelPosition - nodes[cameranodedir[0]].RelPosition;
         m_spawn_rotation = atan2(cur_dir.dotProduct(Vector3::UNIT_X), cur_dir.dotProduct(-Vector3::UNIT_Z));
@@ -5678,7 +5894,7 @@ bool Beam::LoadTruck(
     }
 
     Vector3 cinecam = nodes[0].AbsPosition;
-    if (cameranodepos[0] >= 0 && cameranodepos[0] < MAX_NODES)
+    if (cameranodepos[0] >= 0 && cameranodepos[0] < free_node)
     {
         cinecam = nodes[cameranodepos[0]].AbsPosition;
     }
@@ -5864,6 +6080,26 @@ Vector3 Beam::getNodePosition(int nodeNumber)
     }
 }
 
+uint64_t Beam::calcPhysicsChecksum() const
+{
+    // FNV-1a over the raw bits, so that any divergence shows up, even in the last bit
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](const Ogre::Vector3& v)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(v.ptr());
+        for (size_t i = 0; i < 3 * sizeof(Ogre::Real); i++)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    for (int i = 0; i < free_node; i++)
+    {
+        add(nodes[i].AbsPosition);
+        add(nodes[i].Velocity);
+    }
+    return hash;
+}
+
 void Beam::UpdatePropAnimations(const float dt)
 {
     BES_START(BES_CORE_AnimatedProps);
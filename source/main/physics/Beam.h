@@ -21,11 +21,14 @@
 
 #pragma once
 
+#include "ApproxMath.h"
 #include "BeamData.h"
 #include "GfxActor.h"
 #include "PerVehicleCameraContext.h"
+#include "PhysicsBenchmark.h"
 #include "RigDef_Prerequisites.h"
 #include "RoRPrerequisites.h"
+#include "TruckStreamCodec.h"
 
 #include <OgrePrerequisites.h>
 #include <OgreTimer.h>
@@ -326,7 +329,7 @@ public:
 
     //! @{ helper routines
 
-    void calcBeam(beam_t& beam, bool doUpdate, Ogre::Real dt, int& increased_accuracy);
+    void calcBeam(int beam_i, int doUpdate, Ogre::Real dt); //!< Scalar spring/damper, deformation and breaking of a single beam.
     //! @}
 
 
@@ -398,7 +401,7 @@ public:
 
     int wheel_node_count;
     int first_wheel_node;
-    int netbuffersize;
+    int netbuffersize;   //!< Legacy stream data size, without RoRnet::TruckState
     int nodebuffersize;
     Ogre::SceneNode *netLabelNode;
 
@@ -470,6 +473,7 @@ public:
     int m_source_id;
     int m_stream_id;
     std::map<int, int> m_stream_results;
+    std::map<int, bool> m_stream_compact; //!< Remote clients which can decode RoR::TruckStreamCodec packets
 
     Ogre::Timer netTimer;
     unsigned long lastNetUpdateTime;
@@ -506,6 +510,11 @@ public:
 
     bool getSlideNodesLockInstant();
     void sendStreamData();
+    /// Fills the stream registration sent ahead of the stream data; see sendStreamSetup()
+    void FillStreamRegister(RoRnet::TruckStreamRegister& reg);
+    /// Packs the current state like sendStreamData() does (RoRnet::TruckState + nodes), without sending it
+    /// @return Packet length, 0 if the truck does not fit in 'capacity'
+    size_t PackStreamData(char* buffer, size_t capacity, bool compact, bool keyframe);
     bool isTied();
     bool isLocked();
 
@@ -542,6 +551,15 @@ public:
     */
     void calcForcesEulerFinal(int doUpdate, Ogre::Real dt, int step = 0, int maxsteps = 1);
 
+    /**
+    * Hash of all node positions and velocities, bit exact; equal hashes mean equal simulation states.
+    */
+    uint64_t calcPhysicsChecksum() const;
+
+    frand_state_t frand_state; //!< Random numbers for this truck's physics; seeded from the truck number
+
+    double stage_time[RoR::PHYSICS_STAGE_COUNT]; //!< Seconds per stage, accumulated only while a RoR::PhysicsBenchmark runs
+
         // TODO may be removed soon
     PointColDetector* IntraPointCD() { return intraPointCD; }
     PointColDetector* InterPointCD() { return interPointCD; }
@@ -557,6 +575,26 @@ protected:
     */
     void calcBeams(int doUpdate, Ogre::Real dt, int step, int maxsteps);
 
+    /**
+    * TIGHT LOOP; Physics & sound - vectorized path of calcBeams(), see BeamSimd.h
+    */
+    void calcBeamsSimd(int doUpdate, Ogre::Real dt);
+
+    /**
+    * TIGHT LOOP; Physics & sound - calcBeamsSimd() spread over the thread pool, for rigs with many beams
+    */
+    void calcBeamsParallel(int doUpdate, Ogre::Real dt);
+
+    /**
+    * Computes plain beam lanes [begin_batch, end_batch) of m_plain_beams; results go to m_beam_simd_*.
+    */
+    void calcBeamSimdBatches(int begin_batch, int end_batch);
+
+    /**
+    * Sorts beams by kind for calcBeamsSimd() and cuts the node graph into chunks for calcBeamsParallel(); called at spawn.
+    */
+    void calcBeamPartitions();
+
     /**
     * TIGHT LOOP; Physics & sound - only beams between multiple truck (noshock or ropes)
     */
@@ -600,6 +638,20 @@ protected:
 
     void calc_masses2(Ogre::Real total, bool reCalc=false);
     void calcNodeConnectivityGraph();
+
+    // vectorized beams (see calcBeamsSimd())
+    std::vector<int> m_plain_beams;              //!< Indices of NOSHOCK intra-truck beams
+    std::vector<Ogre::Vector3> m_beam_simd_force; //!< Per beam; force computed in the vectorized pass
+    std::vector<float> m_beam_simd_stress;       //!< Per beam; stress computed in the vectorized pass
+    std::vector<char> m_beam_simd_ready;         //!< Per beam; 1 if the vectorized result can be applied as-is
+
+    // parallel beams (see calcBeamsParallel())
+    std::vector<int> m_node_chunk_nodes;         //!< Node indices in breadth-first order; consecutive nodes form a chunk
+    std::vector<int> m_node_chunk_offsets;       //!< Start of each chunk in m_node_chunk_nodes, plus end sentinel
+    std::vector<int> m_node_beam_offsets;        //!< Per node; start of its entries in m_node_beam_refs, plus end sentinel
+    std::vector<int> m_node_beam_refs;           //!< Plain beams by node, ascending; 'i' if the node is p1, '~i' if it's p2
+
+    std::vector<node_collision_t> m_node_collisions; //!< Nodes due for terrain collision testing in the current substep, ascending
     void moveOrigin(Ogre::Vector3 offset); //move physics origin
 
     Ogre::Vector3 position; // average node position
@@ -668,6 +720,11 @@ protected:
     char *netb1; //!< Network; Triple buffer for incoming data
     char *netb2; //!< Network; Triple buffer for incoming data
     char *netb3; //!< Network; Triple buffer for incoming data
+    RoR::TruckStreamCodec m_net_codec;     //!< Network; encodes our stream or decodes the remote one
+    bool m_net_compact;                    //!< Network; sending with m_net_codec
+    bool m_net_too_big_reported;
+    std::vector<float> m_net_node_pos;     //!< Network; scratch for m_net_codec
+    std::vector<float> m_net_wheel_rp;     //!< Network; scratch for m_net_codec
     int net_toffset;
     int netcounter;
     Ogre::MovableText *netMT; //, *netDist;
@@ -20,16 +20,10 @@
 /* maximum limits */
 static const int   MAX_TRUCKS                 = 5000;            //!< maximum number of trucks for the engine
 
-static const int   MAX_NODES                  = 1000;            //!< maximum number of nodes per truck
-static const int   MAX_BEAMS                  = 5000;            //!< maximum number of beams per truck
 static const int   MAX_ROTATORS               = 20;              //!< maximum number of rotators per truck
-static const int   MAX_CONTACTERS             = 2000;            //!< maximum number of contacters per truck
-static const int   MAX_HYDROS                 = 1000;            //!< maximum number of hydros per truck
 static const int   MAX_WHEELS                 = 64;              //!< maximum number of wheels per truck
 static const int   MAX_SUBMESHES              = 500;             //!< maximum number of submeshes per truck
 static const int   MAX_TEXCOORDS              = 3000;            //!< maximum number of texture coordinates per truck
-static const int   MAX_CABS                   = 3000;            //!< maximum number of cabs per truck
-static const int   MAX_SHOCKS                 = MAX_BEAMS;       //!< maximum number of shocks per truck
 static const int   MAX_ROPES                  = 64;              //!< maximum number of ropes per truck
 static const int   MAX_ROPABLES               = 64;              //!< maximum number of ropables per truck
 static const int   MAX_TIES                   = 64;              //!< maximum number of ties per truck
@@ -44,13 +38,14 @@ static const int   MAX_AIRBRAKES              = 20;              //!< maximum nu
 static const int   MAX_SOUNDSCRIPTS_PER_TRUCK = 128;             //!< maximum number of soundsscripts per truck
 static const int   MAX_WINGS                  = 40;              //!< maximum number of wings per truck
 static const int   MAX_CPARTICLES             = 10;              //!< maximum number of custom particles per truck
-static const int   MAX_PRESSURE_BEAMS         = 4000;            //!< maximum number of pressure beams per truck
 static const int   MAX_CAMERARAIL             = 50;              //!< maximum number of camera rail points
 
 static const float RAD_PER_SEC_TO_RPM         = 9.5492965855137f; //!< Convert radian/second to RPM (60/2*PI)
 
 /* other global static definitions */
 static const int   TRUCKFILEFORMATVERSION     = 3;               //!< truck file format version number
+static const int   PARALLEL_BEAMS_MIN_COUNT   = 1500;            //!< minimum number of beams for a truck to spread its beam forces over the thread pool
+static const int   PARALLEL_BEAMS_CHUNK_NODES = 128;             //!< nodes per chunk in the parallel beam force reduction
 
 /* physics defaults */
 static const float DEFAULT_RIGIDIFIER_SPRING    = 1000000.0f;
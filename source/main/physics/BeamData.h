@@ -504,6 +504,18 @@ struct ground_model_t
     float fx_particle_ttl;
 };
 
+/// Node due for terrain collision testing, see Collisions::nodeCollisions()
+struct node_collision_t
+{
+    node_t* node;
+    float dt;                       //!< time since the node's last collision test
+
+    // results
+    ground_model_t* gm;             //!< ground model of the contact, if any
+    float ns;                       //!< slip velocity
+    bool contacted;                 //!< touches the ground, a collision box or a collision tri
+};
+
 struct authorinfo_t
 {
     int id;
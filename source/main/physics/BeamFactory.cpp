@@ -45,6 +45,7 @@
 #include "Settings.h"
 #include "SoundScriptManager.h"
 #include "ThreadPool.h"
+#include "TruckStreamCodec.h"
 #include "Utils.h"
 #include "VehicleAI.h"
 
@@ -145,8 +146,11 @@ unsigned int getNumberOfCPUCores()
 
 using namespace RoR;
 
+const float BeamFactory::SLEEP_GRID_CELL_SIZE = 16.0f;
+
 BeamFactory::BeamFactory(RoRFrameListener* sim_controller)
-    : m_current_truck(-1)
+    : m_activation_frame(0)
+    , m_current_truck(-1)
     , m_dt_remainder(0.0f)
     , m_forced_active(false)
     , m_free_truck(0)
@@ -159,6 +163,10 @@ BeamFactory::BeamFactory(RoRFrameListener* sim_controller)
     , m_sim_controller(sim_controller)
 {
     memset(m_trucks, 0, MAX_TRUCKS * sizeof(void*));
+    m_awake_trucks.reserve(MAX_TRUCKS);
+    m_simulated_trucks.reserve(MAX_TRUCKS);
+    m_broadphase_order.reserve(MAX_TRUCKS);
+    m_broadphase_listed.reserve(MAX_TRUCKS);
 
     if (RoR::App::app_multithread.GetActive())
     {
@@ -264,7 +272,10 @@ Beam* BeamFactory::CreateLocalRigInstance(
         b->toggleSlideNodeLock();
     }
 
-    RoR::App::GetGuiManager()->GetTopMenubar()->triggerUpdateVehicleList();
+    if (RoR::App::GetGuiManager()) // Not present in headless mode
+    {
+        RoR::App::GetGuiManager()->GetTopMenubar()->triggerUpdateVehicleList();
+    }
 
     // add own username to truck
     if (RoR::App::mp_state.GetActive() == RoR::MpState::CONNECTED)
@@ -293,7 +304,10 @@ int BeamFactory::CreateRemoteInstance(RoRnet::TruckStreamRegister* reg)
     RoR::Networking::GetUserInfo(reg->origin_sourceid, info);
 
     UTFString message = RoR::ChatSystem::GetColouredName(info.username, info.colournum) + RoR::Color::CommandColour + _L(" spawned a new vehicle: ") + RoR::Color::NormalColour + reg->name;
-    RoR::App::GetGuiManager()->pushMessageChatBox(message);
+    if (RoR::App::GetGuiManager())
+    {
+        RoR::App::GetGuiManager()->pushMessageChatBox(message);
+    }
 #endif // USE_SOCKETW
 
     // check if we got this truck installed
@@ -352,7 +366,10 @@ int BeamFactory::CreateRemoteInstance(RoRnet::TruckStreamRegister* reg)
     b->updateNetworkInfo();
 
 
-    RoR::App::GetGuiManager()->GetTopMenubar()->triggerUpdateVehicleList();
+    if (RoR::App::GetGuiManager())
+    {
+        RoR::App::GetGuiManager()->GetTopMenubar()->triggerUpdateVehicleList();
+    }
 
 
     return 1;
@@ -377,17 +394,24 @@ void BeamFactory::RemoveStreamSource(int sourceid)
 }
 
 #ifdef USE_SOCKETW
-void BeamFactory::handleStreamData(std::vector<RoR::Networking::recv_packet_t> packet_buffer)
+void BeamFactory::handleStreamData(const std::vector<RoR::Networking::recv_packet_t>& packet_buffer)
 {
-    for (auto packet : packet_buffer)
+    for (const auto& packet : packet_buffer)
     {
         if (packet.header.command == RoRnet::MSG2_STREAM_REGISTER)
         {
             RoRnet::StreamRegister* reg = (RoRnet::StreamRegister *)packet.buffer;
             if (reg->type == 0)
             {
-                reg->status = this->CreateRemoteInstance((RoRnet::TruckStreamRegister *)packet.buffer);
-                RoR::Networking::AddPacket(0, RoRnet::MSG2_STREAM_REGISTER_RESULT, sizeof(RoRnet::StreamRegister), (char *)reg);
+                // the packet may be shorter than RoRnet::StreamRegister, answer with a full-size copy
+                RoRnet::StreamRegister result;
+                memset(&result, 0, sizeof(RoRnet::StreamRegister));
+                memcpy(&result, packet.buffer, std::min<size_t>(packet.header.size, sizeof(RoRnet::StreamRegister)));
+                result.status = this->CreateRemoteInstance((RoRnet::TruckStreamRegister *)packet.buffer);
+                // tell the sender we can decode compact stream data; older clients leave zeros here
+                const uint32_t compact_magic = RoR::TRUCK_STREAM_COMPACT_MAGIC;
+                memcpy(result.data + sizeof(result.data) - sizeof(compact_magic), &compact_magic, sizeof(compact_magic));
+                RoR::Networking::AddPacket(0, RoRnet::MSG2_STREAM_REGISTER_RESULT, sizeof(RoRnet::StreamRegister), (char *)&result);
             }
         }
         else if (packet.header.command == RoRnet::MSG2_STREAM_REGISTER_RESULT)
@@ -404,6 +428,13 @@ void BeamFactory::handleStreamData(std::vector<RoR::Networking::recv_packet_t> p
                     int sourceid = packet.header.source;
                     m_trucks[t]->m_stream_results[sourceid] = reg->status;
 
+                    uint32_t compact_magic = 0;
+                    if (packet.header.size >= sizeof(RoRnet::StreamRegister))
+                    {
+                        memcpy(&compact_magic, reg->data + sizeof(reg->data) - sizeof(compact_magic), sizeof(compact_magic));
+                    }
+                    m_trucks[t]->m_stream_compact[sourceid] = (compact_magic == RoR::TRUCK_STREAM_COMPACT_MAGIC);
+
                     if (reg->status == 1)
                     LOG("Client " + TOSTRING(sourceid) + " successfully loaded stream " + TOSTRING(reg->origin_streamid) + " with name '" + reg->name + "', result code: " + TOSTRING(reg->status));
                     else
@@ -595,29 +626,138 @@ bool BeamFactory::predictTruckIntersectionCollAABB(int a, int b, float scale)
     return false;
 }
 
-void BeamFactory::RecursiveActivation(int j, std::bitset<MAX_TRUCKS>& visited)
+Ogre::AxisAlignedBox BeamFactory::GetSleepGridBox(int t)
 {
-    if (visited[j] || !m_trucks[j] || m_trucks[j]->state != SIMULATED)
+    // Bounding box scaled like in truckIntersectionCollAABB(..., 1.2f), plus the predicted one
+    Ogre::AxisAlignedBox box = m_trucks[t]->boundingBox;
+    if (box.isFinite())
+    {
+        const Vector3 center = box.getCenter();
+        const Vector3 half_size = box.getHalfSize() * 1.2f;
+        box.setExtents(center - half_size, center + half_size);
+    }
+    box.merge(m_trucks[t]->predictedBoundingBox);
+    return box;
+}
+
+static inline uint64_t SleepGridKey(int x, int z)
+{
+    return (uint64_t(uint32_t(x)) << 32) | uint32_t(z);
+}
+
+void BeamFactory::RemoveFromSleepGrid(int t)
+{
+    if (t >= static_cast<int>(m_sleep_grid_ranges.size()))
         return;
 
-    visited.set(j, true);
+    sleep_grid_range_t& range = m_sleep_grid_ranges[t];
+    if (range.oversized)
+    {
+        m_sleep_grid_oversized.erase(std::remove(m_sleep_grid_oversized.begin(), m_sleep_grid_oversized.end(), t), m_sleep_grid_oversized.end());
+    }
+    else
+    {
+        for (int x = range.x0; x <= range.x1; x++)
+        {
+            for (int z = range.z0; z <= range.z1; z++)
+            {
+                auto cell = m_sleep_grid.find(SleepGridKey(x, z));
+                if (cell == m_sleep_grid.end())
+                    continue;
+                cell->second.erase(std::remove(cell->second.begin(), cell->second.end(), t), cell->second.end());
+                if (cell->second.empty())
+                    m_sleep_grid.erase(cell);
+            }
+        }
+    }
+    range.x0 = range.z0 = 0;
+    range.x1 = range.z1 = -1;
+    range.oversized = false;
+}
+
+void BeamFactory::UpdateSleepGrid()
+{
+    const sleep_grid_range_t not_listed = { 0, 0, -1, -1, false };
+    if (static_cast<int>(m_sleep_grid_ranges.size()) < m_free_truck)
+    {
+        m_sleep_grid_ranges.resize(m_free_truck, not_listed);
+    }
 
     for (int t = 0; t < m_free_truck; t++)
     {
-        if (t == j || !m_trucks[t] || visited[t])
+        if (!m_trucks[t])
+        {
+            this->RemoveFromSleepGrid(t);
             continue;
-        if (m_trucks[t]->state == SIMULATED && truckIntersectionCollAABB(t, j, 1.2f))
+        }
+
+        sleep_grid_range_t range = not_listed;
+        const Ogre::AxisAlignedBox box = this->GetSleepGridBox(t);
+        if (box.isFinite())
         {
-            m_trucks[t]->sleeptime = 0.0f;
-            this->RecursiveActivation(t, visited);
+            range.x0 = static_cast<int>(std::floor(box.getMinimum().x / SLEEP_GRID_CELL_SIZE));
+            range.z0 = static_cast<int>(std::floor(box.getMinimum().z / SLEEP_GRID_CELL_SIZE));
+            range.x1 = static_cast<int>(std::floor(box.getMaximum().x / SLEEP_GRID_CELL_SIZE));
+            range.z1 = static_cast<int>(std::floor(box.getMaximum().z / SLEEP_GRID_CELL_SIZE));
+            range.oversized = (range.x1 - range.x0 >= SLEEP_GRID_MAX_CELLS) || (range.z1 - range.z0 >= SLEEP_GRID_MAX_CELLS);
         }
-        if (m_trucks[t]->state == SLEEPING && predictTruckIntersectionCollAABB(t, j))
+        else if (box.isInfinite())
         {
-            m_trucks[t]->sleeptime = 0.0f;
-            m_trucks[t]->state = SIMULATED;
-            this->RecursiveActivation(t, visited);
+            range.oversized = true;
+        }
+
+        const sleep_grid_range_t& listed = m_sleep_grid_ranges[t];
+        if (listed.x0 == range.x0 && listed.z0 == range.z0 && listed.x1 == range.x1 && listed.z1 == range.z1 && listed.oversized == range.oversized)
+            continue; // Parked trucks end up here
+
+        this->RemoveFromSleepGrid(t);
+        if (range.oversized)
+        {
+            m_sleep_grid_oversized.push_back(t);
+        }
+        else
+        {
+            for (int x = range.x0; x <= range.x1; x++)
+            {
+                for (int z = range.z0; z <= range.z1; z++)
+                {
+                    m_sleep_grid[SleepGridKey(x, z)].push_back(t);
+                }
+            }
+        }
+        m_sleep_grid_ranges[t] = range;
+    }
+}
+
+void BeamFactory::QuerySleepGrid(int t, std::vector<int>& out)
+{
+    out.clear();
+    const sleep_grid_range_t& range = m_sleep_grid_ranges[t];
+    if (range.oversized)
+    {
+        // Test against everything
+        for (int i = 0; i < m_free_truck; i++)
+        {
+            if (m_trucks[i])
+                out.push_back(i);
+        }
+        return;
+    }
+
+    for (int x = range.x0; x <= range.x1; x++)
+    {
+        for (int z = range.z0; z <= range.z1; z++)
+        {
+            auto cell = m_sleep_grid.find(SleepGridKey(x, z));
+            if (cell != m_sleep_grid.end())
+            {
+                out.insert(out.end(), cell->second.begin(), cell->second.end());
+            }
         }
     }
+    out.insert(out.end(), m_sleep_grid_oversized.begin(), m_sleep_grid_oversized.end());
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
 }
 
 void BeamFactory::UpdateSleepingState(float dt)
@@ -648,18 +788,56 @@ void BeamFactory::UpdateSleepingState(float dt)
         current_truck->state = SIMULATED;
     }
 
-    std::bitset<MAX_TRUCKS> visited;
-    // Recursivly activate all trucks which can be reached from current_truck
+    this->UpdateSleepGrid();
+
+    // Visited trucks are marked with the current frame number, nothing to reset
+    m_activation_stamps.resize(m_free_truck, 0);
+    if (++m_activation_frame == 0)
+    {
+        std::fill(m_activation_stamps.begin(), m_activation_stamps.end(), 0);
+        m_activation_frame = 1;
+    }
+    m_activation_queue.clear();
+    auto visit = [this](int t)
+    {
+        m_activation_stamps[t] = m_activation_frame;
+        m_activation_queue.push_back(t);
+    };
+
+    // Activate all trucks which can be reached from current_truck
     if (current_truck && current_truck->state == SIMULATED)
     {
         current_truck->sleeptime = 0.0f;
-        this->RecursiveActivation(m_current_truck, visited);
+        visit(m_current_truck);
     }
     // Snowball effect (activate all trucks which might soon get hit by a moving truck)
     for (int t = 0; t < m_free_truck; t++)
     {
-        if (m_trucks[t] && m_trucks[t]->state == SIMULATED && m_trucks[t]->sleeptime == 0.0f)
-            this->RecursiveActivation(t, visited);
+        if (m_trucks[t] && m_trucks[t]->state == SIMULATED && m_trucks[t]->sleeptime == 0.0f && m_activation_stamps[t] != m_activation_frame)
+            visit(t);
+    }
+
+    // Breadth-first walk through the contact island(s) of the moving trucks
+    for (size_t q = 0; q < m_activation_queue.size(); q++)
+    {
+        const int j = m_activation_queue[q];
+        this->QuerySleepGrid(j, m_activation_candidates);
+        for (int t : m_activation_candidates)
+        {
+            if (t == j || !m_trucks[t] || m_activation_stamps[t] == m_activation_frame)
+                continue;
+            if (m_trucks[t]->state == SIMULATED && truckIntersectionCollAABB(t, j, 1.2f))
+            {
+                m_trucks[t]->sleeptime = 0.0f;
+                visit(t);
+            }
+            else if (m_trucks[t]->state == SLEEPING && predictTruckIntersectionCollAABB(t, j))
+            {
+                m_trucks[t]->sleeptime = 0.0f;
+                m_trucks[t]->state = SIMULATED;
+                visit(t);
+            }
+        }
     }
 }
 
@@ -837,11 +1015,15 @@ void BeamFactory::DeleteTruck(Beam* b)
     if (m_current_truck == b->trucknum)
         setCurrentTruck(-1);
 
+    this->RemoveFromSleepGrid(b->trucknum);
     m_trucks[b->trucknum] = 0;
     delete b;
 
 
-    RoR::App::GetGuiManager()->GetTopMenubar()->triggerUpdateVehicleList();
+    if (RoR::App::GetGuiManager())
+    {
+        RoR::App::GetGuiManager()->GetTopMenubar()->triggerUpdateVehicleList();
+    }
 
 }
 
@@ -1160,139 +1342,138 @@ Beam* BeamFactory::getTruck(int number)
 
 void BeamFactory::UpdatePhysicsSimulation()
 {
+    // Sleeping trucks are left out of the substep loops entirely
+    m_awake_trucks.clear();
     for (int t = 0; t < m_free_truck; t++)
     {
         if (!m_trucks[t])
             continue;
         m_trucks[t]->preUpdatePhysics(m_physics_steps * PHYSICS_DT);
+        if (m_trucks[t]->state < SLEEPING)
+            m_awake_trucks.push_back(t);
+        else
+            m_trucks[t]->simulated = false;
     }
+    const bool deterministic = App::sim_deterministic.GetActive();
+    m_physics_checksums.clear();
     if (gEnv->threadPool)
     {
         for (int i = 0; i < m_physics_steps; i++)
         {
-            int num_simulated_trucks = 0;
+            std::vector<int>& simulated_trucks = m_simulated_trucks;
+            simulated_trucks.clear();
+            for (int t : m_awake_trucks)
             {
-                std::vector<std::function<void()>> tasks;
-                for (int t = 0; t < m_free_truck; t++)
+                if ((m_trucks[t]->simulated = m_trucks[t]->calcForcesEulerPrepare(i == 0, PHYSICS_DT, i, m_physics_steps)))
                 {
-                    if (m_trucks[t] && (m_trucks[t]->simulated = m_trucks[t]->calcForcesEulerPrepare(i == 0, PHYSICS_DT, i, m_physics_steps)))
-                    {
-                        num_simulated_trucks++;
-                        auto func = std::function<void()>([this, i, t]()
-                            {
-                                m_trucks[t]->calcForcesEulerCompute(i == 0, PHYSICS_DT, i, m_physics_steps);
-                                if (!m_trucks[t]->disableTruckTruckSelfCollisions)
-                                {
-                                    m_trucks[t]->IntraPointCD()->update(m_trucks[t]);
-                                    intraTruckCollisions(PHYSICS_DT,
-                                        *(m_trucks[t]->IntraPointCD()),
-                                        m_trucks[t]->free_collcab,
-                                        m_trucks[t]->collcabs,
-                                        m_trucks[t]->cabs,
-                                        m_trucks[t]->intra_collcabrate,
-                                        m_trucks[t]->nodes,
-                                        m_trucks[t]->collrange,
-                                        *(m_trucks[t]->submesh_ground_model));
-                                }
-                            });
-                        tasks.push_back(func);
-                    }
+                    simulated_trucks.push_back(t);
                 }
-                gEnv->threadPool->Parallelize(tasks);
             }
+            const int num_simulated_trucks = static_cast<int>(simulated_trucks.size());
 
-            for (int t = 0; t < m_free_truck; t++)
+            // One truck per chunk; idle workers steal the remaining trucks
+            gEnv->threadPool->ParallelFor(0, num_simulated_trucks, 1, [this, i, &simulated_trucks](int begin, int end)
+                {
+                    for (int s = begin; s < end; s++)
+                    {
+                        const int t = simulated_trucks[s];
+                        m_trucks[t]->calcForcesEulerCompute(i == 0, PHYSICS_DT, i, m_physics_steps);
+                        if (!m_trucks[t]->disableTruckTruckSelfCollisions)
+                        {
+                            this->ResolveIntraTruckCollisions(t);
+                        }
+                    }
+                });
+
+            for (int t : simulated_trucks)
             {
-                if (m_trucks[t] && m_trucks[t]->simulated)
-                    m_trucks[t]->calcForcesEulerFinal(i == 0, PHYSICS_DT, i, m_physics_steps);
+                m_trucks[t]->calcForcesEulerFinal(i == 0, PHYSICS_DT, i, m_physics_steps);
             }
 
             if (num_simulated_trucks > 1)
             {
-                std::vector<std::function<void()>> tasks;
-                for (int t = 0; t < m_free_truck; t++)
-                {
-                    if (m_trucks[t] && m_trucks[t]->simulated && !m_trucks[t]->disableTruckTruckCollisions)
+                this->UpdateCollisionPairs();
+                // Collision forces are also applied to the other truck's nodes, which makes the
+                // result depend on thread timing. Deterministic mode resolves them in truck order.
+                gEnv->threadPool->ParallelFor(0, num_simulated_trucks, 1, [this, deterministic, &simulated_trucks](int begin, int end)
                     {
-                        auto func = std::function<void()>([this, t]()
+                        for (int s = begin; s < end; s++)
+                        {
+                            const int t = simulated_trucks[s];
+                            if (m_trucks[t]->disableTruckTruckCollisions)
+                                continue;
+                            this->UpdateInterTruckPointCD(t);
+                            if (!deterministic && m_trucks[t]->collisionRelevant)
                             {
-                                m_trucks[t]->InterPointCD()->update(m_trucks[t], m_trucks, m_free_truck);
-                                if (m_trucks[t]->collisionRelevant)
-                                {
-                                    interTruckCollisions(PHYSICS_DT,
-                                        *(m_trucks[t]->InterPointCD()),
-                                        m_trucks[t]->free_collcab,
-                                        m_trucks[t]->collcabs,
-                                        m_trucks[t]->cabs,
-                                        m_trucks[t]->inter_collcabrate,
-                                        m_trucks[t]->nodes,
-                                        m_trucks[t]->collrange,
-                                        m_trucks, m_free_truck,
-                                        *(m_trucks[t]->submesh_ground_model));
-                                }
-                            });
-                        tasks.push_back(func);
+                                this->ResolveInterTruckCollisions(t);
+                            }
+                        }
+                    });
+                if (deterministic)
+                {
+                    for (int t : simulated_trucks)
+                    {
+                        if (!m_trucks[t]->disableTruckTruckCollisions && m_trucks[t]->collisionRelevant)
+                            this->ResolveInterTruckCollisions(t);
                     }
                 }
-                gEnv->threadPool->Parallelize(tasks);
             }
+
+            if (deterministic)
+                this->AddPhysicsChecksum(simulated_trucks);
         }
     }
     else
     {
+        std::vector<int>& simulated_trucks = m_simulated_trucks;
         for (int i = 0; i < m_physics_steps; i++)
         {
-            int num_simulated_trucks = 0;
+            simulated_trucks.clear();
 
-            for (int t = 0; t < m_free_truck; t++)
+            // Same stage order as the thread pool path: calcForcesEulerPrepare() applies ties, ropes
+            // and hooks to other trucks' nodes, so every truck must be prepared before any is integrated.
+            for (int t : m_awake_trucks)
             {
-                if (m_trucks[t] && (m_trucks[t]->simulated = m_trucks[t]->calcForcesEulerPrepare(i == 0, PHYSICS_DT, i, m_physics_steps)))
+                if ((m_trucks[t]->simulated = m_trucks[t]->calcForcesEulerPrepare(i == 0, PHYSICS_DT, i, m_physics_steps)))
                 {
-                    num_simulated_trucks++;
-                    m_trucks[t]->calcForcesEulerCompute(i == 0, PHYSICS_DT, i, m_physics_steps);
-                    m_trucks[t]->calcForcesEulerFinal(i == 0, PHYSICS_DT, i, m_physics_steps);
-                    if (!m_trucks[t]->disableTruckTruckSelfCollisions)
-                    {
-                        m_trucks[t]->IntraPointCD()->update(m_trucks[t]);
-                        intraTruckCollisions(PHYSICS_DT,
-                            *(m_trucks[t]->IntraPointCD()),
-                            m_trucks[t]->free_collcab,
-                            m_trucks[t]->collcabs,
-                            m_trucks[t]->cabs,
-                            m_trucks[t]->intra_collcabrate,
-                            m_trucks[t]->nodes,
-                            m_trucks[t]->collrange,
-                            *(m_trucks[t]->submesh_ground_model));
-                    }
+                    simulated_trucks.push_back(t);
                 }
             }
 
-            if (num_simulated_trucks > 1)
+            for (int t : simulated_trucks)
+            {
+                m_trucks[t]->calcForcesEulerCompute(i == 0, PHYSICS_DT, i, m_physics_steps);
+                if (!m_trucks[t]->disableTruckTruckSelfCollisions)
+                {
+                    this->ResolveIntraTruckCollisions(t);
+                }
+            }
+
+            for (int t : simulated_trucks)
+            {
+                m_trucks[t]->calcForcesEulerFinal(i == 0, PHYSICS_DT, i, m_physics_steps);
+            }
+
+            if (simulated_trucks.size() > 1)
             {
                 BES_START(BES_CORE_Contacters);
-                for (int t = 0; t < m_free_truck; t++)
+                this->UpdateCollisionPairs();
+                for (int t : simulated_trucks)
                 {
-                    if (m_trucks[t] && m_trucks[t]->simulated && !m_trucks[t]->disableTruckTruckCollisions)
+                    if (!m_trucks[t]->disableTruckTruckCollisions)
                     {
-                        m_trucks[t]->InterPointCD()->update(m_trucks[t], m_trucks, m_free_truck);
+                        this->UpdateInterTruckPointCD(t);
                         if (m_trucks[t]->collisionRelevant)
                         {
-                            interTruckCollisions(
-                                PHYSICS_DT,
-                                *(m_trucks[t]->InterPointCD()),
-                                m_trucks[t]->free_collcab,
-                                m_trucks[t]->collcabs,
-                                m_trucks[t]->cabs,
-                                m_trucks[t]->inter_collcabrate,
-                                m_trucks[t]->nodes,
-                                m_trucks[t]->collrange,
-                                m_trucks, m_free_truck,
-                                *(m_trucks[t]->submesh_ground_model));
+                            this->ResolveInterTruckCollisions(t);
                         }
                     }
                 }
                 BES_STOP(BES_CORE_Contacters);
             }
+
+            if (deterministic)
+                this->AddPhysicsChecksum(simulated_trucks);
         }
     }
     for (int t = 0; t < m_free_truck; t++)
@@ -1305,8 +1486,127 @@ void BeamFactory::UpdatePhysicsSimulation()
     }
 }
 
+void BeamFactory::ResolveIntraTruckCollisions(int t)
+{
+    PhysicsStageTimer timer(m_trucks[t]->stage_time[PHYSICS_STAGE_INTRA_COLLISIONS]);
+    m_trucks[t]->IntraPointCD()->update(m_trucks[t]);
+    intraTruckCollisions(PHYSICS_DT,
+        *(m_trucks[t]->IntraPointCD()),
+        m_trucks[t]->free_collcab,
+        m_trucks[t]->collcabs,
+        m_trucks[t]->cabs,
+        m_trucks[t]->intra_collcabrate,
+        m_trucks[t]->nodes,
+        m_trucks[t]->collrange,
+        *(m_trucks[t]->submesh_ground_model));
+}
+
+void BeamFactory::UpdateInterTruckPointCD(int t)
+{
+    PhysicsStageTimer timer(m_trucks[t]->stage_time[PHYSICS_STAGE_INTER_COLLISIONS]);
+    m_trucks[t]->InterPointCD()->update(m_trucks[t], m_trucks, m_collision_partners[t]);
+}
+
+void BeamFactory::ResolveInterTruckCollisions(int t)
+{
+    PhysicsStageTimer timer(m_trucks[t]->stage_time[PHYSICS_STAGE_INTER_COLLISIONS]);
+    interTruckCollisions(PHYSICS_DT,
+        *(m_trucks[t]->InterPointCD()),
+        m_trucks[t]->free_collcab,
+        m_trucks[t]->collcabs,
+        m_trucks[t]->cabs,
+        m_trucks[t]->inter_collcabrate,
+        m_trucks[t]->nodes,
+        m_trucks[t]->collrange,
+        m_trucks, m_free_truck,
+        *(m_trucks[t]->submesh_ground_model));
+}
+
+void BeamFactory::AddPhysicsChecksum(const std::vector<int>& trucks)
+{
+    uint64_t hash = 0;
+    for (int t : trucks)
+    {
+        hash = hash * 31 + m_trucks[t]->calcPhysicsChecksum();
+    }
+    m_physics_checksums.push_back(hash);
+}
+
+void BeamFactory::UpdateCollisionPairs()
+{
+    auto is_awake = [this](int t) { return t < m_free_truck && m_trucks[t] && m_trucks[t]->state < SLEEPING; };
+    auto min_x = [this](int t) { return m_trucks[t]->boundingBox.getMinimum().x; };
+
+    // Keep the awake trucks sorted by the lower X bound of their bounding box.
+    // The order barely changes between substeps, so insertion sort runs in near-linear time.
+    m_broadphase_order.erase(std::remove_if(m_broadphase_order.begin(), m_broadphase_order.end(),
+        [&is_awake](int t) { return !is_awake(t); }), m_broadphase_order.end());
+    m_broadphase_listed.assign(m_free_truck, false);
+    for (int t : m_broadphase_order)
+        m_broadphase_listed[t] = true;
+    for (int t : m_awake_trucks)
+    {
+        if (!m_broadphase_listed[t] && is_awake(t))
+            m_broadphase_order.push_back(t);
+    }
+    for (size_t i = 1; i < m_broadphase_order.size(); i++)
+    {
+        const int t = m_broadphase_order[i];
+        const float x = min_x(t);
+        size_t j = i;
+        for (; j > 0 && min_x(m_broadphase_order[j - 1]) > x; j--)
+        {
+            m_broadphase_order[j] = m_broadphase_order[j - 1];
+        }
+        m_broadphase_order[j] = t;
+    }
+
+    m_collision_partners.resize(m_free_truck);
+    for (int t : m_broadphase_order)
+        m_collision_partners[t].clear();
+
+    // Sweep: only trucks whose X ranges overlap need the full box test
+    for (size_t a = 0; a < m_broadphase_order.size(); a++)
+    {
+        Beam* truck_a = m_trucks[m_broadphase_order[a]];
+        const float max_x = truck_a->boundingBox.getMaximum().x;
+        for (size_t b = a + 1; b < m_broadphase_order.size() && min_x(m_broadphase_order[b]) <= max_x; b++)
+        {
+            Beam* truck_b = m_trucks[m_broadphase_order[b]];
+            if (!truck_a->boundingBox.intersects(truck_b->boundingBox))
+                continue;
+
+            m_collision_partners[truck_a->trucknum].push_back(truck_b->trucknum);
+            m_collision_partners[truck_b->trucknum].push_back(truck_a->trucknum);
+
+            // Trucks approaching fast: test all collision triangles of both from now on
+            const bool tested = (truck_a->simulated && !truck_a->disableTruckTruckCollisions)
+                             || (truck_b->simulated && !truck_b->disableTruckTruckCollisions);
+            if (tested && truck_a->nodes[0].Velocity.squaredDistance(truck_b->nodes[0].Velocity) > 25)
+            {
+                for (Beam* truck : { truck_a, truck_b })
+                {
+                    for (int i = 0; i < truck->free_collcab; i++)
+                    {
+                        truck->intra_collcabrate[i].rate = 0;
+                        truck->inter_collcabrate[i].rate = 0;
+                    }
+                }
+            }
+        }
+    }
+
+    for (int t : m_broadphase_order)
+        std::sort(m_collision_partners[t].begin(), m_collision_partners[t].end());
+}
+
 void BeamFactory::SyncWithSimThread()
 {
     if (m_sim_task)
         m_sim_task->join();
 }
+
+bool BeamFactory::IsSimTaskRunning() const
+{
+    return m_sim_task && !m_sim_task->is_finished();
+}
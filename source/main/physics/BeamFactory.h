@@ -29,8 +29,11 @@
 #include "Beam.h"
 #include "DustManager.h" // Particle systems manager
 #include "Network.h"
+#include "RigDef_FileCache.h"
 #include "Singleton.h"
 
+#include <unordered_map>
+
 #define PHYSICS_DT 0.0005 // fixed dt of 0.5 ms
 
 class ThreadPool;
@@ -64,7 +67,7 @@ public:
     void update(float dt);
 
 #ifdef USE_SOCKETW
-    void handleStreamData(std::vector<RoR::Networking::recv_packet_t> packet);
+    void handleStreamData(const std::vector<RoR::Networking::recv_packet_t>& packet);
 #endif // USE_SOCKETW
     int checkStreamsOK(int sourceid);
     int checkStreamsRemoteOK(int sourceid);
@@ -108,6 +111,11 @@ public:
 
     void UpdatePhysicsSimulation();
 
+    /// Deterministic mode only (App::sim_deterministic): one hash over all simulated trucks per substep of the
+    /// last physics frame (read it after SyncWithSimThread()). Runs with the same input must produce the same values;
+    /// the first mismatch shows where they diverged.
+    const std::vector<uint64_t>& GetPhysicsChecksums() const { return m_physics_checksums; }
+
     inline unsigned long getPhysFrame() { return m_physics_frames; };
     inline bool          AreTrucksForcedActive() const { return m_forced_active; }
 
@@ -133,9 +141,12 @@ public:
 #endif
 
     void SyncWithSimThread();
+    bool IsSimTaskRunning() const; //!< Whether a physics task is in flight, i.e. SyncWithSimThread() would wait
 
     DustManager& GetParticleManager() { return m_particle_manager; }
 
+    RigDef::FileCache& GetRigDefCache() { return m_rigdef_cache; }
+
     // A list of all beams interconnecting two trucks
     std::map<beam_t*, std::pair<Beam*, Beam*>> interTruckLinks;
 
@@ -162,9 +173,17 @@ protected:
     void LogParserMessages();
     void LogSpawnerMessages();
 
-    void RecursiveActivation(int j, std::bitset<MAX_TRUCKS>& visited);
+    /// Wakes up trucks touched by a moving truck, and those touched by them etc. Only visits trucks near a moving one.
     void UpdateSleepingState(float dt);
 
+    /// Moves trucks to the grid cells of their current bounding box; cheap for trucks which didn't move.
+    void UpdateSleepGrid();
+    void RemoveFromSleepGrid(int t);
+    /// Fills 'out' with the trucks whose grid cells overlap those of truck 't' (including 't'), ascending.
+    void QuerySleepGrid(int t, std::vector<int>& out);
+    /// The box used to find wake-up candidates; covers the (scaled) boxes tested in UpdateSleepingState().
+    Ogre::AxisAlignedBox GetSleepGridBox(int t);
+
     int GetMostRecentTruckSlot();
 
     int GetFreeTruckSlot();
@@ -172,6 +191,19 @@ protected:
 
     void DeleteTruck(Beam* b);
 
+    /// Broad phase for truck-truck collisions; fills m_collision_partners. Called once per substep.
+    void UpdateCollisionPairs();
+
+    /// Self collisions of one truck.
+    void ResolveIntraTruckCollisions(int t);
+
+    /// Narrow phase for truck-truck collisions of one truck; see UpdateCollisionPairs().
+    void UpdateInterTruckPointCD(int t);
+    void ResolveInterTruckCollisions(int t);
+
+    /// Deterministic mode: appends the hash of the given trucks to m_physics_checksums.
+    void AddPhysicsChecksum(const std::vector<int>& trucks);
+
     // ---------- variables ---------- //
 
     /// Networking: A list of streams without a corresponding truck in the truck array for each stream source
@@ -192,6 +224,31 @@ protected:
     float           m_dt_remainder;     ///< Keeps track of the rounding error in the time step calculation
     float           m_simulation_speed; ///< slow motion < 1.0 < fast motion
     DustManager     m_particle_manager;
+    RigDef::FileCache m_rigdef_cache;    ///< Recently spawned truck definitions
+
+    std::vector<int>              m_awake_trucks;        ///< Trucks not SLEEPING this frame; the only ones visited per substep
+    std::vector<int>              m_simulated_trucks;    ///< Awake trucks simulated in the current substep; reused to avoid per-substep allocations
+    std::vector<int>              m_broadphase_order;    ///< Awake trucks sorted by bounding box minimum X (sweep and prune)
+    std::vector<bool>             m_broadphase_listed;   ///< Scratch for UpdateCollisionPairs(); per truck, true if in m_broadphase_order
+    std::vector<std::vector<int>> m_collision_partners;  ///< Per truck; indices of trucks whose bounding boxes overlap, ascending
+    std::vector<uint64_t>         m_physics_checksums;   ///< See GetPhysicsChecksums()
+
+    struct sleep_grid_range_t
+    {
+        int x0, z0, x1, z1;   ///< Covered cells (inclusive); x0 > x1 if the truck isn't in the grid
+        bool oversized;       ///< Too big for the grid, listed in m_sleep_grid_oversized instead
+    };
+
+    static const float SLEEP_GRID_CELL_SIZE;
+    static const int   SLEEP_GRID_MAX_CELLS = 16;        ///< Max. cells per axis, bigger trucks are tested against everything
+
+    std::unordered_map<uint64_t, std::vector<int>> m_sleep_grid; ///< Trucks by XZ cell of their GetSleepGridBox()
+    std::vector<sleep_grid_range_t> m_sleep_grid_ranges;         ///< Per truck
+    std::vector<int>                m_sleep_grid_oversized;
+    std::vector<unsigned int>       m_activation_stamps;         ///< Per truck; equals m_activation_frame once visited
+    unsigned int                    m_activation_frame;
+    std::vector<int>                m_activation_queue;
+    std::vector<int>                m_activation_candidates;
 };
 
 } // namespace RoR
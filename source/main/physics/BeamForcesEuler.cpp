@@ -28,6 +28,7 @@
 #include "Beam.h"
 #include "BeamEngine.h"
 #include "BeamFactory.h"
+#include "BeamSimd.h"
 #include "BeamStats.h"
 #include "Buoyance.h"
 #include "CmdKeyInertia.h"
@@ -42,6 +43,7 @@
 #include "SoundScriptManager.h"
 #include "Water.h"
 #include "TerrainManager.h"
+#include "ThreadPool.h"
 #include "VehicleAI.h"
 
 using namespace Ogre;
@@ -63,7 +65,10 @@ void Beam::calcForcesEulerCompute(int doUpdate, Real dt, int step, int maxsteps)
     }
     //if (doUpdate) mWindow->setDebugText(engine->status);
 
-    calcBeams(doUpdate, dt, step, maxsteps);
+    {
+        RoR::PhysicsStageTimer timer(stage_time[RoR::PHYSICS_STAGE_BEAMS]);
+        calcBeams(doUpdate, dt, step, maxsteps);
+    }
 
     if (doUpdate)
     {
@@ -114,7 +119,10 @@ void Beam::calcForcesEulerCompute(int doUpdate, Real dt, int step, int maxsteps)
 
     watercontact = false;
 
-    calcNodes(doUpdate, dt, step, maxsteps);
+    {
+        RoR::PhysicsStageTimer timer(stage_time[RoR::PHYSICS_STAGE_NODES]);
+        calcNodes(doUpdate, dt, step, maxsteps);
+    }
 
     AxisAlignedBox tBoundingBox(nodes[0].AbsPosition, nodes[0].AbsPosition);
 
@@ -245,11 +253,7 @@ void Beam::calcForcesEulerCompute(int doUpdate, Real dt, int step, int maxsteps)
     //water buoyance
     if (free_buoycab && water)
     {
-        for (int i = 0; i < free_buoycab; i++)
-        {
-            int tmpv = buoycabs[i] * 3;
-            buoyance->computeNodeForce(&nodes[cabs[tmpv]], &nodes[cabs[tmpv + 1]], &nodes[cabs[tmpv + 2]], doUpdate == 1, buoycabtypes[i]);
-        }
+        buoyance->computeNodeForces(nodes, cabs, buoycabs, buoycabtypes, free_buoycab, doUpdate == 1);
     }
 
     BES_STOP(BES_CORE_Buoyance);
@@ -1316,239 +1320,399 @@ void Beam::calcForcesEulerFinal(int doUpdate, Ogre::Real dt, int step, int maxst
 void Beam::calcBeams(int doUpdate, Ogre::Real dt, int step, int maxsteps)
 {
     BES_START(BES_CORE_Beams);
-    // Springs
-    for (int i = 0; i < free_beam; i++)
+    // Deterministic mode keeps the parallel summation order even without a thread pool
+    const bool parallel = gEnv->threadPool || App::sim_deterministic.GetActive();
+    if (App::sim_beam_parallel.GetActive() && parallel && free_beam >= PARALLEL_BEAMS_MIN_COUNT)
     {
-        if (!beams[i].disabled && !beams[i].p2truck)
+        calcBeamsParallel(doUpdate, dt);
+    }
+    else if (App::sim_beam_simd.GetActive())
+    {
+        calcBeamsSimd(doUpdate, dt);
+    }
+    else
+    {
+        // Scalar reference path
+        for (int i = 0; i < free_beam; i++)
         {
-            // Calculate beam length
-            Vector3 dis = beams[i].p1->RelPosition - beams[i].p2->RelPosition;
-
-            Real dislen = dis.squaredLength();
-            Real inverted_dislen = fast_invSqrt(dislen);
+            if (!beams[i].disabled && !beams[i].p2truck)
+            {
+                calcBeam(i, doUpdate, dt);
+            }
+        }
+    }
+    BES_STOP(BES_CORE_Beams);
+}
 
-            dislen *= inverted_dislen;
+void Beam::calcBeamsSimd(int doUpdate, Ogre::Real dt)
+{
+    using namespace RoR;
 
-            // Calculate beam's deviation from normal
-            Real difftoBeamL = dislen - beams[i].L;
+    // Pass 1: springs/dampers of plain beams, 4 (SSE2) or 8 (AVX2) at a time.
+    // Results are parked per beam, the forces are applied in pass 2.
+    if (static_cast<int>(m_beam_simd_ready.size()) != free_beam)
+    {
+        calcBeamPartitions();
+    }
 
-            Real k = beams[i].k;
-            Real d = beams[i].d;
+    const int num_batches = (static_cast<int>(m_plain_beams.size()) + BeamSimdLanes::WIDTH - 1) / BeamSimdLanes::WIDTH;
+    calcBeamSimdBatches(0, num_batches);
 
-            switch (beams[i].bounded)
+    // Pass 2: apply forces in the original beam order, so the result is identical to the scalar path.
+    for (int i = 0; i < free_beam; i++)
+    {
+        if (!beams[i].disabled && !beams[i].p2truck)
+        {
+            if (m_beam_simd_ready[i])
             {
-            case SHOCK1:
-                {
-                    float interp_ratio;
+                beams[i].stress = m_beam_simd_stress[i];
+                beams[i].p1->Forces += m_beam_simd_force[i];
+                beams[i].p2->Forces -= m_beam_simd_force[i];
+            }
+            else
+            {
+                calcBeam(i, doUpdate, dt);
+            }
+        }
+    }
+}
 
-                    // Following code interpolates between defined beam parameters and default beam parameters
-                    if (difftoBeamL > beams[i].longbound * beams[i].L)
-                        interp_ratio = difftoBeamL - beams[i].longbound * beams[i].L;
-                    else if (difftoBeamL < -beams[i].shortbound * beams[i].L)
-                        interp_ratio = -difftoBeamL - beams[i].shortbound * beams[i].L;
-                    else
-                        break;
+void Beam::calcBeamsParallel(int doUpdate, Ogre::Real dt)
+{
+    using namespace RoR;
 
-                    // Hard (normal) shock bump
-                    float tspring = DEFAULT_SPRING;
-                    float tdamp = DEFAULT_DAMP;
+    if (static_cast<int>(m_beam_simd_ready.size()) != free_beam)
+    {
+        calcBeamPartitions();
+    }
 
-                    // Skip camera, wheels or any other shocks which are not generated in a shocks or shocks2 section
-                    if (beams[i].type == BEAM_HYDRO || beams[i].type == BEAM_INVISIBLE_HYDRO)
-                    {
-                        tspring = beams[i].shock->sbd_spring;
-                        tdamp = beams[i].shock->sbd_damp;
-                    }
+    // Pass 1: springs/dampers of plain beams, as in calcBeamsSimd(). Every batch only writes its own beams' results.
+    const int num_batches = (static_cast<int>(m_plain_beams.size()) + BeamSimdLanes::WIDTH - 1) / BeamSimdLanes::WIDTH;
+    auto parallel_for = [](int begin, int end, int grain, const std::function<void(int, int)>& body)
+    {
+        if (gEnv->threadPool)
+            gEnv->threadPool->ParallelFor(begin, end, grain, body);
+        else
+            body(begin, end);
+    };
 
-                    k += (tspring - k) * interp_ratio;
-                    d += (tdamp - d) * interp_ratio;
-                }
-                break;
+    parallel_for(0, num_batches, 32, [this](int begin, int end)
+        {
+            calcBeamSimdBatches(begin, end);
+        });
 
-            case SHOCK2:
-                calcShocks2(i, difftoBeamL, k, d, dt, doUpdate);
-                break;
+    // Pass 2: beams which need the full treatment (shocks, deformation, breaking, detachers) in beam order, on this thread.
+    for (int i = 0; i < free_beam; i++)
+    {
+        if (!beams[i].disabled && !beams[i].p2truck && !m_beam_simd_ready[i])
+        {
+            calcBeam(i, doUpdate, dt);
+        }
+    }
 
-            case SUPPORTBEAM:
-                if (difftoBeamL > 0.0f)
+    // Pass 3: each chunk sums the plain beam forces of its own nodes, so no two threads write the same node.
+    // Per node, forces are added in ascending beam order; the result doesn't depend on chunking or thread count.
+    const int num_chunks = static_cast<int>(m_node_chunk_offsets.size()) - 1;
+    parallel_for(0, num_chunks, 1, [this](int begin, int end)
+        {
+            for (int c = begin; c < end; c++)
+            {
+                for (int k = m_node_chunk_offsets[c]; k < m_node_chunk_offsets[c + 1]; k++)
                 {
-                    k = 0.0f;
-                    d *= 0.1f;
-                    float break_limit = SUPPORT_BEAM_LIMIT_DEFAULT;
-                    if (beams[i].longbound > 0.0f)
+                    const int n = m_node_chunk_nodes[k];
+                    for (int r = m_node_beam_offsets[n]; r < m_node_beam_offsets[n + 1]; r++)
                     {
-                        // This is a supportbeam with a user set break limit, get the user set limit
-                        break_limit = beams[i].longbound;
-                    }
-
-                    // If support beam is extended the originallength * break_limit, break and disable it
-                    if (difftoBeamL > beams[i].L * break_limit)
-                    {
-                        beams[i].broken = true;
-                        beams[i].disabled = true;
-                        if (beambreakdebug)
+                        const int ref = m_node_beam_refs[r];
+                        const int i = (ref >= 0) ? ref : ~ref;
+                        if (beams[i].disabled || !m_beam_simd_ready[i])
+                            continue;
+                        if (ref >= 0)
+                        {
+                            beams[i].stress = m_beam_simd_stress[i];
+                            nodes[n].Forces += m_beam_simd_force[i];
+                        }
+                        else
                         {
-                            LOG(" XXX Support-Beam " + TOSTRING(i) + " limit extended and broke. Length: " + TOSTRING(difftoBeamL) +
-                                " / max. Length: " + TOSTRING(beams[i].L*break_limit) + ". It was between nodes " + TOSTRING(beams[i].p1->id) + " and " + TOSTRING(beams[i].p2->id) + ".");
+                            nodes[n].Forces -= m_beam_simd_force[i];
                         }
                     }
                 }
+            }
+        });
+}
+
+void Beam::calcBeamSimdBatches(int begin_batch, int end_batch)
+{
+    using namespace RoR;
+
+    BeamSimdLanes lanes;
+    const int width = BeamSimdLanes::WIDTH;
+    const int num_plain = static_cast<int>(m_plain_beams.size());
+    for (int base = begin_batch * width; base < std::min(num_plain, end_batch * width); base += width)
+    {
+        const int count = std::min(width, num_plain - base);
+        for (int l = 0; l < width; l++)
+        {
+            // Unused lanes of the last batch just repeat the first beam
+            beam_t& beam = beams[m_plain_beams[base + ((l < count) ? l : 0)]];
+            lanes.p1x[l] = beam.p1->RelPosition.x;
+            lanes.p1y[l] = beam.p1->RelPosition.y;
+            lanes.p1z[l] = beam.p1->RelPosition.z;
+            lanes.p2x[l] = beam.p2->RelPosition.x;
+            lanes.p2y[l] = beam.p2->RelPosition.y;
+            lanes.p2z[l] = beam.p2->RelPosition.z;
+            lanes.v1x[l] = beam.p1->Velocity.x;
+            lanes.v1y[l] = beam.p1->Velocity.y;
+            lanes.v1z[l] = beam.p1->Velocity.z;
+            lanes.v2x[l] = beam.p2->Velocity.x;
+            lanes.v2y[l] = beam.p2->Velocity.y;
+            lanes.v2z[l] = beam.p2->Velocity.z;
+            lanes.L[l] = beam.L;
+            lanes.k[l] = beam.k;
+            lanes.d[l] = beam.d;
+            lanes.minmaxposnegstress[l] = beam.minmaxposnegstress;
+        }
+
+        const int slow_mask = ComputeBeamLanes(lanes);
+
+        for (int l = 0; l < count; l++)
+        {
+            const int i = m_plain_beams[base + l];
+            // Beams which deform/break, or were re-purposed at runtime, take the scalar path
+            m_beam_simd_ready[i] = !(slow_mask & (1 << l)) && beams[i].bounded == NOSHOCK && !beams[i].p2truck;
+            m_beam_simd_stress[i] = lanes.stress[l];
+            m_beam_simd_force[i] = Vector3(lanes.fx[l], lanes.fy[l], lanes.fz[l]);
+        }
+    }
+}
+
+void Beam::calcBeam(int i, int doUpdate, Ogre::Real dt)
+{
+    // Calculate beam length
+    Vector3 dis = beams[i].p1->RelPosition - beams[i].p2->RelPosition;
+
+    Real dislen = dis.squaredLength();
+    Real inverted_dislen = fast_invSqrt(dislen);
+
+    dislen *= inverted_dislen;
+
+    // Calculate beam's deviation from normal
+    Real difftoBeamL = dislen - beams[i].L;
+
+    Real k = beams[i].k;
+    Real d = beams[i].d;
+
+    switch (beams[i].bounded)
+    {
+    case SHOCK1:
+        {
+            float interp_ratio;
+
+            // Following code interpolates between defined beam parameters and default beam parameters
+            if (difftoBeamL > beams[i].longbound * beams[i].L)
+                interp_ratio = difftoBeamL - beams[i].longbound * beams[i].L;
+            else if (difftoBeamL < -beams[i].shortbound * beams[i].L)
+                interp_ratio = -difftoBeamL - beams[i].shortbound * beams[i].L;
+            else
                 break;
 
-            case ROPE:
-                if (difftoBeamL < 0.0f)
+            // Hard (normal) shock bump
+            float tspring = DEFAULT_SPRING;
+            float tdamp = DEFAULT_DAMP;
+
+            // Skip camera, wheels or any other shocks which are not generated in a shocks or shocks2 section
+            if (beams[i].type == BEAM_HYDRO || beams[i].type == BEAM_INVISIBLE_HYDRO)
+            {
+                tspring = beams[i].shock->sbd_spring;
+                tdamp = beams[i].shock->sbd_damp;
+            }
+
+            k += (tspring - k) * interp_ratio;
+            d += (tdamp - d) * interp_ratio;
+        }
+        break;
+
+    case SHOCK2:
+        calcShocks2(i, difftoBeamL, k, d, dt, doUpdate);
+        break;
+
+    case SUPPORTBEAM:
+        if (difftoBeamL > 0.0f)
+        {
+            k = 0.0f;
+            d *= 0.1f;
+            float break_limit = SUPPORT_BEAM_LIMIT_DEFAULT;
+            if (beams[i].longbound > 0.0f)
+            {
+                // This is a supportbeam with a user set break limit, get the user set limit
+                break_limit = beams[i].longbound;
+            }
+
+            // If support beam is extended the originallength * break_limit, break and disable it
+            if (difftoBeamL > beams[i].L * break_limit)
+            {
+                beams[i].broken = true;
+                beams[i].disabled = true;
+                if (beambreakdebug)
                 {
-                    k = 0.0f;
-                    d *= 0.1f;
+                    LOG(" XXX Support-Beam " + TOSTRING(i) + " limit extended and broke. Length: " + TOSTRING(difftoBeamL) +
+                        " / max. Length: " + TOSTRING(beams[i].L*break_limit) + ". It was between nodes " + TOSTRING(beams[i].p1->id) + " and " + TOSTRING(beams[i].p2->id) + ".");
                 }
-                break;
             }
+        }
+        break;
 
-            // Calculate beam's rate of change
-            Vector3 v = beams[i].p1->Velocity - beams[i].p2->Velocity;
+    case ROPE:
+        if (difftoBeamL < 0.0f)
+        {
+            k = 0.0f;
+            d *= 0.1f;
+        }
+        break;
+    }
 
-            float slen = -k * (difftoBeamL) - d * v.dotProduct(dis) * inverted_dislen;
-            beams[i].stress = slen;
+    // Calculate beam's rate of change
+    Vector3 v = beams[i].p1->Velocity - beams[i].p2->Velocity;
 
-            // Fast test for deformation
-            float len = std::abs(slen);
-            if (len > beams[i].minmaxposnegstress)
+    float slen = -k * (difftoBeamL) - d * v.dotProduct(dis) * inverted_dislen;
+    beams[i].stress = slen;
+
+    // Fast test for deformation
+    float len = std::abs(slen);
+    if (len > beams[i].minmaxposnegstress)
+    {
+        if ((beams[i].type == BEAM_NORMAL || beams[i].type == BEAM_INVISIBLE) && beams[i].bounded != SHOCK1 && k != 0.0f)
+        {
+            // Actual deformation tests
+            if (slen > beams[i].maxposstress && difftoBeamL < 0.0f) // compression
             {
-                if ((beams[i].type == BEAM_NORMAL || beams[i].type == BEAM_INVISIBLE) && beams[i].bounded != SHOCK1 && k != 0.0f)
+                increased_accuracy = true;
+                Real yield_length = beams[i].maxposstress / k;
+                Real deform = difftoBeamL + yield_length * (1.0f - beams[i].plastic_coef);
+                Real Lold = beams[i].L;
+                beams[i].L += deform;
+                beams[i].L = std::max(MIN_BEAM_LENGTH, beams[i].L);
+                slen = slen - (slen - beams[i].maxposstress) * 0.5f;
+                len = slen;
+                if (beams[i].L > 0.0f && Lold > beams[i].L)
                 {
-                    // Actual deformation tests
-                    if (slen > beams[i].maxposstress && difftoBeamL < 0.0f) // compression
-                    {
-                        increased_accuracy = true;
-                        Real yield_length = beams[i].maxposstress / k;
-                        Real deform = difftoBeamL + yield_length * (1.0f - beams[i].plastic_coef);
-                        Real Lold = beams[i].L;
-                        beams[i].L += deform;
-                        beams[i].L = std::max(MIN_BEAM_LENGTH, beams[i].L);
-                        slen = slen - (slen - beams[i].maxposstress) * 0.5f;
-                        len = slen;
-                        if (beams[i].L > 0.0f && Lold > beams[i].L)
-                        {
-                            beams[i].maxposstress *= Lold / beams[i].L;
-                            beams[i].minmaxposnegstress = std::min(beams[i].maxposstress, -beams[i].maxnegstress);
-                            beams[i].minmaxposnegstress = std::min(beams[i].minmaxposnegstress, beams[i].strength);
-                        }
-                        // For the compression case we do not remove any of the beam's
-                        // strength for structure stability reasons
-                        //beams[i].strength += deform * k * 0.5f;
-                        if (beamdeformdebug)
-                        {
-                            LOG(" YYY Beam " + TOSTRING(i) + " just deformed with extension force " + TOSTRING(len) +
-                                " / " + TOSTRING(beams[i].strength) + ". It was between nodes " + TOSTRING(beams[i].p1->id) + " and " + TOSTRING(beams[i].p2->id) + ".");
-                        }
-                    }
-                    else if (slen < beams[i].maxnegstress && difftoBeamL > 0.0f) // expansion
-                    {
-                        increased_accuracy = true;
-                        Real yield_length = beams[i].maxnegstress / k;
-                        Real deform = difftoBeamL + yield_length * (1.0f - beams[i].plastic_coef);
-                        Real Lold = beams[i].L;
-                        beams[i].L += deform;
-                        slen = slen - (slen - beams[i].maxnegstress) * 0.5f;
-                        len = -slen;
-                        if (Lold > 0.0f && beams[i].L > Lold)
-                        {
-                            beams[i].maxnegstress *= beams[i].L / Lold;
-                            beams[i].minmaxposnegstress = std::min(beams[i].maxposstress, -beams[i].maxnegstress);
-                            beams[i].minmaxposnegstress = std::min(beams[i].minmaxposnegstress, beams[i].strength);
-                        }
-                        beams[i].strength -= deform * k;
-                        if (beamdeformdebug)
-                        {
-                            LOG(" YYY Beam " + TOSTRING(i) + " just deformed with extension force " + TOSTRING(len) +
-                                " / " + TOSTRING(beams[i].strength) + ". It was between nodes " + TOSTRING(beams[i].p1->id) + " and " + TOSTRING(beams[i].p2->id) + ".");
-                        }
-                    }
+                    beams[i].maxposstress *= Lold / beams[i].L;
+                    beams[i].minmaxposnegstress = std::min(beams[i].maxposstress, -beams[i].maxnegstress);
+                    beams[i].minmaxposnegstress = std::min(beams[i].minmaxposnegstress, beams[i].strength);
                 }
-
-                // Test if the beam should break
-                if (len > beams[i].strength)
+                // For the compression case we do not remove any of the beam's
+                // strength for structure stability reasons
+                //beams[i].strength += deform * k * 0.5f;
+                if (beamdeformdebug)
                 {
-                    // Sound effect.
-                    // Sound volume depends on springs stored energy
+                    LOG(" YYY Beam " + TOSTRING(i) + " just deformed with extension force " + TOSTRING(len) +
+                        " / " + TOSTRING(beams[i].strength) + ". It was between nodes " + TOSTRING(beams[i].p1->id) + " and " + TOSTRING(beams[i].p2->id) + ".");
+                }
+            }
+            else if (slen < beams[i].maxnegstress && difftoBeamL > 0.0f) // expansion
+            {
+                increased_accuracy = true;
+                Real yield_length = beams[i].maxnegstress / k;
+                Real deform = difftoBeamL + yield_length * (1.0f - beams[i].plastic_coef);
+                Real Lold = beams[i].L;
+                beams[i].L += deform;
+                slen = slen - (slen - beams[i].maxnegstress) * 0.5f;
+                len = -slen;
+                if (Lold > 0.0f && beams[i].L > Lold)
+                {
+                    beams[i].maxnegstress *= beams[i].L / Lold;
+                    beams[i].minmaxposnegstress = std::min(beams[i].maxposstress, -beams[i].maxnegstress);
+                    beams[i].minmaxposnegstress = std::min(beams[i].minmaxposnegstress, beams[i].strength);
+                }
+                beams[i].strength -= deform * k;
+                if (beamdeformdebug)
+                {
+                    LOG(" YYY Beam " + TOSTRING(i) + " just deformed with extension force " + TOSTRING(len) +
+                        " / " + TOSTRING(beams[i].strength) + ". It was between nodes " + TOSTRING(beams[i].p1->id) + " and " + TOSTRING(beams[i].p2->id) + ".");
+                }
+            }
+        }
+
+        // Test if the beam should break
+        if (len > beams[i].strength)
+        {
+            // Sound effect.
+            // Sound volume depends on springs stored energy
 #ifdef USE_OPENAL
-                    SoundScriptManager::getSingleton().modulate(trucknum, SS_MOD_BREAK, 0.5 * k * difftoBeamL * difftoBeamL);
-                    SoundScriptManager::getSingleton().trigOnce(trucknum, SS_TRIG_BREAK);
+            SoundScriptManager::getSingleton().modulate(trucknum, SS_MOD_BREAK, 0.5 * k * difftoBeamL * difftoBeamL);
+            SoundScriptManager::getSingleton().trigOnce(trucknum, SS_TRIG_BREAK);
 #endif //OPENAL
-                    increased_accuracy = true;
+            increased_accuracy = true;
 
-                    //Break the beam only when it is not connected to a node
-                    //which is a part of a collision triangle and has 2 "live" beams or less
-                    //connected to it.
-                    if (!((beams[i].p1->contacter && nodeBeamConnections(beams[i].p1->pos) < 3) || (beams[i].p2->contacter && nodeBeamConnections(beams[i].p2->pos) < 3)))
-                    {
-                        slen = 0.0f;
-                        beams[i].broken = true;
-                        beams[i].disabled = true;
+            //Break the beam only when it is not connected to a node
+            //which is a part of a collision triangle and has 2 "live" beams or less
+            //connected to it.
+            if (!((beams[i].p1->contacter && nodeBeamConnections(beams[i].p1->pos) < 3) || (beams[i].p2->contacter && nodeBeamConnections(beams[i].p2->pos) < 3)))
+            {
+                slen = 0.0f;
+                beams[i].broken = true;
+                beams[i].disabled = true;
 
-                        if (beambreakdebug)
-                        {
-                            LOG(" XXX Beam " + TOSTRING(i) + " just broke with force " + TOSTRING(len) +
-                                " / " + TOSTRING(beams[i].strength) + ". It was between nodes " + TOSTRING(beams[i].p1->id) + " and " + TOSTRING(beams[i].p2->id) + ".");
-                        }
+                if (beambreakdebug)
+                {
+                    LOG(" XXX Beam " + TOSTRING(i) + " just broke with force " + TOSTRING(len) +
+                        " / " + TOSTRING(beams[i].strength) + ". It was between nodes " + TOSTRING(beams[i].p1->id) + " and " + TOSTRING(beams[i].p2->id) + ".");
+                }
 
-                        // detachergroup check: beam[i] is already broken, check detacher group# == 0/default skip the check ( performance bypass for beams with default setting )
-                        // only perform this check if this is a master detacher beams (positive detacher group id > 0)
-                        if (beams[i].detacher_group > 0)
+                // detachergroup check: beam[i] is already broken, check detacher group# == 0/default skip the check ( performance bypass for beams with default setting )
+                // only perform this check if this is a master detacher beams (positive detacher group id > 0)
+                if (beams[i].detacher_group > 0)
+                {
+                    // cycle once through the other beams
+                    for (int j = 0; j < free_beam; j++)
+                    {
+                        // beam[i] detacher group# == checked beams detacher group# -> delete & disable checked beam
+                        // do this with all master(positive id) and minor(negative id) beams of this detacher group
+                        if (abs(beams[j].detacher_group) == beams[i].detacher_group)
                         {
-                            // cycle once through the other beams
-                            for (int j = 0; j < free_beam; j++)
-                            {
-                                // beam[i] detacher group# == checked beams detacher group# -> delete & disable checked beam
-                                // do this with all master(positive id) and minor(negative id) beams of this detacher group
-                                if (abs(beams[j].detacher_group) == beams[i].detacher_group)
-                                {
-                                    beams[j].broken = true;
-                                    beams[j].disabled = true;
-                                    if (beambreakdebug)
-                                    {
-                                        LOG("Deleting Detacher BeamID: " + TOSTRING(j) + ", Detacher Group: " + TOSTRING(beams[i].detacher_group)+ ", trucknum: " + TOSTRING(trucknum));
-                                    }
-                                }
-                            }
-                            // cycle once through all wheels
-                            for (int j = 0; j < free_wheel; j++)
+                            beams[j].broken = true;
+                            beams[j].disabled = true;
+                            if (beambreakdebug)
                             {
-                                if (wheels[j].detacher_group == beams[i].detacher_group)
-                                {
-                                    wheels[j].detached = true;
-                                }
+                                LOG("Deleting Detacher BeamID: " + TOSTRING(j) + ", Detacher Group: " + TOSTRING(beams[i].detacher_group)+ ", trucknum: " + TOSTRING(trucknum));
                             }
                         }
                     }
-                    else
-                    {
-                        beams[i].strength = 2.0f * beams[i].minmaxposnegstress;
-                    }
-
-                    // something broke, check buoyant hull
-                    for (int mk = 0; mk < free_buoycab; mk++)
+                    // cycle once through all wheels
+                    for (int j = 0; j < free_wheel; j++)
                     {
-                        int tmpv = buoycabs[mk] * 3;
-                        if (buoycabtypes[mk] == Buoyance::BUOY_DRAGONLY)
-                            continue;
-                        if ((beams[i].p1 == &nodes[cabs[tmpv]] || beams[i].p1 == &nodes[cabs[tmpv + 1]] || beams[i].p1 == &nodes[cabs[tmpv + 2]]) &&
-                            (beams[i].p2 == &nodes[cabs[tmpv]] || beams[i].p2 == &nodes[cabs[tmpv + 1]] || beams[i].p2 == &nodes[cabs[tmpv + 2]]))
+                        if (wheels[j].detacher_group == beams[i].detacher_group)
                         {
-                            buoyance->setsink(1);
+                            wheels[j].detached = true;
                         }
                     }
                 }
             }
+            else
+            {
+                beams[i].strength = 2.0f * beams[i].minmaxposnegstress;
+            }
 
-            // At last update the beam forces
-            Vector3 f = dis;
-            f *= (slen * inverted_dislen);
-            beams[i].p1->Forces += f;
-            beams[i].p2->Forces -= f;
+            // something broke, check buoyant hull
+            for (int mk = 0; mk < free_buoycab; mk++)
+            {
+                int tmpv = buoycabs[mk] * 3;
+                if (buoycabtypes[mk] == Buoyance::BUOY_DRAGONLY)
+                    continue;
+                if ((beams[i].p1 == &nodes[cabs[tmpv]] || beams[i].p1 == &nodes[cabs[tmpv + 1]] || beams[i].p1 == &nodes[cabs[tmpv + 2]]) &&
+                    (beams[i].p2 == &nodes[cabs[tmpv]] || beams[i].p2 == &nodes[cabs[tmpv + 1]] || beams[i].p2 == &nodes[cabs[tmpv + 2]]))
+                {
+                    buoyance->setsink(1);
+                }
+            }
         }
     }
-    BES_STOP(BES_CORE_Beams);
+
+    // At last update the beam forces
+    Vector3 f = dis;
+    f *= (slen * inverted_dislen);
+    beams[i].p1->Forces += f;
+    beams[i].p2->Forces -= f;
 }
 
 void Beam::calcBeamsInterTruck(int doUpdate, Ogre::Real dt, int step, int maxsteps)
@@ -1688,109 +1852,123 @@ void Beam::calcNodes(int doUpdate, Ogre::Real dt, int step, int maxsteps)
         gravity = gEnv->terrainManager->getGravity();
     }
 
+    // gather the nodes due for collision testing and test them in one batch
+    m_node_collisions.clear();
+    for (int i = 0; i < free_node; i++)
+    {
+        if (!nodes[i].contactless)
+        {
+            nodes[i].collTestTimer += dt;
+            if (nodes[i].contacted || nodes[i].collTestTimer > 0.005 || ((nodes[i].iswheel || nodes[i].wheelid != -1) && (high_res_wheelnode_collisions || nodes[i].collTestTimer > 0.0025)) || increased_accuracy)
+            {
+                node_collision_t nc;
+                nc.node = &nodes[i];
+                nc.dt = nodes[i].collTestTimer;
+                m_node_collisions.push_back(nc);
+                nodes[i].collTestTimer = 0.0;
+            }
+        }
+    }
+    gEnv->collisions->nodeCollisions(m_node_collisions.data(), (int)m_node_collisions.size());
+    auto node_collision = m_node_collisions.begin();
+
     for (int i = 0; i < free_node; i++)
     {
         // wetness
         if (doUpdate)
         {
-            if (nodes[i].wetstate == DRIPPING && !nodes[i].contactless && !nodes[i].disable_particles)
+            if (nodes[i].wetstate == DRIPPING && !nodes[i].contactless && !node_attrs[i].disable_particles)
             {
-                nodes[i].wettime += dt * maxsteps;
-                if (nodes[i].wettime > 5.0)
+                node_attrs[i].wettime += dt * maxsteps;
+                if (node_attrs[i].wettime > 5.0)
                 {
                     nodes[i].wetstate = DRY;
                 }
                 else
                 {
                     if (!nodes[i].iswheel && dripp)
-                        dripp->allocDrip(nodes[i].AbsPosition, nodes[i].Velocity, nodes[i].wettime);
-                    if (nodes[i].isHot && dustp)
-                        dustp->allocVapour(nodes[i].AbsPosition, nodes[i].Velocity, nodes[i].wettime);
+                        dripp->allocDrip(nodes[i].AbsPosition, nodes[i].Velocity, node_attrs[i].wettime);
+                    if (node_attrs[i].isHot && dustp)
+                        dustp->allocVapour(nodes[i].AbsPosition, nodes[i].Velocity, node_attrs[i].wettime);
                 }
             }
         }
 
         // COLLISION
-        if (!nodes[i].contactless)
+        if (node_collision != m_node_collisions.end() && node_collision->node == &nodes[i])
         {
-            nodes[i].collTestTimer += dt;
-            if (nodes[i].contacted || nodes[i].collTestTimer > 0.005 || ((nodes[i].iswheel || nodes[i].wheelid != -1) && (high_res_wheelnode_collisions || nodes[i].collTestTimer > 0.0025)) || increased_accuracy)
+            float ns = node_collision->ns;
+            ground_model_t* gm = node_collision->gm;
+            if (node_collision->contacted)
             {
-                float ns = 0;
-                ground_model_t* gm = 0; // this is used as result storage, so we can use it later on
-                bool contacted = gEnv->collisions->groundCollision(&nodes[i], nodes[i].collTestTimer, &gm, &ns);
-                // reverted this construct to the old form, don't mess with it, the binary operator is intentionally!
-                if (contacted | gEnv->collisions->nodeCollision(&nodes[i], contacted, nodes[i].collTestTimer, &ns, &gm))
+                // FX
+                if (gm && doUpdate && !node_attrs[i].disable_particles)
                 {
-                    // FX
-                    if (gm && doUpdate && !nodes[i].disable_particles)
+                    float thresold = 10.0f;
+
+                    switch (gm->fx_type)
                     {
-                        float thresold = 10.0f;
+                    case Collisions::FX_DUSTY:
+                        if (dustp)
+                            dustp->malloc(nodes[i].AbsPosition, nodes[i].Velocity / 2.0, gm->fx_colour);
+                        break;
 
-                        switch (gm->fx_type)
+                    case Collisions::FX_HARD:
+                        // smokey
+                        if (nodes[i].iswheel && ns > thresold)
                         {
-                        case Collisions::FX_DUSTY:
                             if (dustp)
-                                dustp->malloc(nodes[i].AbsPosition, nodes[i].Velocity / 2.0, gm->fx_colour);
-                            break;
-
-                        case Collisions::FX_HARD:
-                            // smokey
-                            if (nodes[i].iswheel && ns > thresold)
-                            {
-                                if (dustp)
-                                    dustp->allocSmoke(nodes[i].AbsPosition, nodes[i].Velocity);
+                                dustp->allocSmoke(nodes[i].AbsPosition, nodes[i].Velocity);
 #ifdef USE_OPENAL
-                                SoundScriptManager::getSingleton().modulate(trucknum, SS_MOD_SCREETCH, (ns - thresold) / thresold);
-                                SoundScriptManager::getSingleton().trigOnce(trucknum, SS_TRIG_SCREETCH);
+                            SoundScriptManager::getSingleton().modulate(trucknum, SS_MOD_SCREETCH, (ns - thresold) / thresold);
+                            SoundScriptManager::getSingleton().trigOnce(trucknum, SS_TRIG_SCREETCH);
 #endif //USE_OPENAL
-                                //Shouldn't skidmarks be activated from here?
-                                if (useSkidmarks)
-                                {
-                                    wheels[nodes[i].wheelid].isSkiding = true;
-                                    if (!(nodes[i].iswheel % 2))
-                                        wheels[nodes[i].wheelid].lastContactInner = nodes[i].AbsPosition;
-                                    else
-                                        wheels[nodes[i].wheelid].lastContactOuter = nodes[i].AbsPosition;
-
-                                    wheels[nodes[i].wheelid].lastContactType = (nodes[i].iswheel % 2);
-                                    wheels[nodes[i].wheelid].lastSlip = ns;
-                                    wheels[nodes[i].wheelid].lastGroundModel = gm;
-                                }
-                            }
-                            // sparks
-                            if (!nodes[i].iswheel && ns > 1.0 && !nodes[i].disable_sparks)
+                            //Shouldn't skidmarks be activated from here?
+                            if (useSkidmarks)
                             {
-                                // friction < 10 will remove the 'f' nodes from the spark generation nodes
-                                if (sparksp)
-                                    sparksp->allocSparks(nodes[i].AbsPosition, nodes[i].Velocity);
+                                wheels[nodes[i].wheelid].isSkiding = true;
+                                if (!(nodes[i].iswheel % 2))
+                                    wheels[nodes[i].wheelid].lastContactInner = nodes[i].AbsPosition;
+                                else
+                                    wheels[nodes[i].wheelid].lastContactOuter = nodes[i].AbsPosition;
+
+                                wheels[nodes[i].wheelid].lastContactType = (nodes[i].iswheel % 2);
+                                wheels[nodes[i].wheelid].lastSlip = ns;
+                                wheels[nodes[i].wheelid].lastGroundModel = gm;
                             }
-                            if (nodes[i].iswheel && ns < thresold)
+                        }
+                        // sparks
+                        if (!nodes[i].iswheel && ns > 1.0 && !node_attrs[i].disable_sparks)
+                        {
+                            // friction < 10 will remove the 'f' nodes from the spark generation nodes
+                            if (sparksp)
+                                sparksp->allocSparks(nodes[i].AbsPosition, nodes[i].Velocity);
+                        }
+                        if (nodes[i].iswheel && ns < thresold)
+                        {
+                            if (useSkidmarks)
                             {
-                                if (useSkidmarks)
-                                {
-                                    wheels[nodes[i].wheelid].isSkiding = false;
-                                }
+                                wheels[nodes[i].wheelid].isSkiding = false;
                             }
-                            break;
+                        }
+                        break;
 
-                        case Collisions::FX_CLUMPY:
-                            if (nodes[i].Velocity.squaredLength() > 1.0)
-                            {
-                                if (clumpp)
-                                    clumpp->allocClump(nodes[i].AbsPosition, nodes[i].Velocity / 2.0, gm->fx_colour);
-                            }
-                            break;
-                        default:
-                            //Useless for the moment
-                            break;
+                    case Collisions::FX_CLUMPY:
+                        if (nodes[i].Velocity.squaredLength() > 1.0)
+                        {
+                            if (clumpp)
+                                clumpp->allocClump(nodes[i].AbsPosition, nodes[i].Velocity / 2.0, gm->fx_colour);
                         }
+                        break;
+                    default:
+                        //Useless for the moment
+                        break;
                     }
-
-                    lastFuzzyGroundModel = gm;
                 }
-                nodes[i].collTestTimer = 0.0;
+
+                lastFuzzyGroundModel = gm;
             }
+            ++node_collision;
         }
 
         // record g forces on cameras
@@ -1827,7 +2005,7 @@ void Beam::calcNodes(int doUpdate, Ogre::Real dt, int step, int maxsteps)
             Vector3 drag = -defdragxspeed * nodes[i].Velocity;
             // plus: turbulences
             Real maxtur = defdragxspeed * speed * 0.005f;
-            drag += maxtur * Vector3(frand_11(), frand_11(), frand_11());
+            drag += maxtur * Vector3(frand_11(frand_state), frand_11(frand_state), frand_11(frand_state));
             nodes[i].Forces += drag;
         }
 
@@ -1842,9 +2020,9 @@ void Beam::calcNodes(int doUpdate, Ogre::Real dt, int step, int maxsteps)
                     Real speed = approx_sqrt(nodes[i].Velocity.squaredLength()); //we will (not) reuse this
                     nodes[i].Forces -= (DEFAULT_WATERDRAG * speed) * nodes[i].Velocity;
                     // basic buoyance
-                    nodes[i].Forces += nodes[i].buoyancy * Vector3::UNIT_Y;
+                    nodes[i].Forces += node_attrs[i].buoyancy * Vector3::UNIT_Y;
                     // basic splashing
-                    if (doUpdate && water->getHeight() - nodes[i].AbsPosition.y < 0.2 && nodes[i].Velocity.squaredLength() > 4.0 && !nodes[i].disable_particles)
+                    if (doUpdate && water->getHeight() - nodes[i].AbsPosition.y < 0.2 && nodes[i].Velocity.squaredLength() > 4.0 && !node_attrs[i].disable_particles)
                     {
                         if (splashp)
                             splashp->allocSplash(nodes[i].AbsPosition, nodes[i].Velocity);
@@ -1862,7 +2040,7 @@ void Beam::calcNodes(int doUpdate, Ogre::Real dt, int step, int maxsteps)
             else if (nodes[i].wetstate == WET)
             {
                 nodes[i].wetstate = DRIPPING;
-                nodes[i].wettime = 0.0f;
+                node_attrs[i].wettime = 0.0f;
             }
         }
     }
@@ -1960,7 +2138,8 @@ void Beam::calcHooks()
                             else
                             {
                                 //force exceeded reset the hook node
-                                it->beam->mSceneNode->detachAllObjects();
+                                if (it->beam->mSceneNode) // No visuals in headless mode
+                                    it->beam->mSceneNode->detachAllObjects();
                                 it->locked = UNLOCKED;
                                 it->lockNode = 0;
                                 it->lockTruck = 0;
@@ -0,0 +1,168 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "BeamSimd.h"
+
+#include "CpuFeatures.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define ROR_BEAM_SIMD_SSE2
+#   include <emmintrin.h>
+#endif
+
+namespace RoR {
+
+// Lane-wise copy of fast_invSqrt() from ApproxMath.h (not included to keep this unit free of Ogre).
+static inline float BeamLaneInvSqrt(const float v)
+{
+    int i;
+    std::memcpy(&i, &v, sizeof(float));
+    i = 0x5f3759df - (i >> 1);
+    float y;
+    std::memcpy(&y, &i, sizeof(float));
+
+    y *= (1.5f - (0.5f * v * y * y));
+    return y;
+}
+
+int ComputeBeamLanesScalar(BeamSimdLanes& lanes)
+{
+    int slow_mask = 0;
+    for (int l = 0; l < BeamSimdLanes::WIDTH; l++)
+    {
+        const float dx = lanes.p1x[l] - lanes.p2x[l];
+        const float dy = lanes.p1y[l] - lanes.p2y[l];
+        const float dz = lanes.p1z[l] - lanes.p2z[l];
+
+        float dislen = dx * dx + dy * dy + dz * dz;
+        const float inverted_dislen = BeamLaneInvSqrt(dislen);
+        dislen *= inverted_dislen;
+
+        const float difftoBeamL = dislen - lanes.L[l];
+
+        const float vx = lanes.v1x[l] - lanes.v2x[l];
+        const float vy = lanes.v1y[l] - lanes.v2y[l];
+        const float vz = lanes.v1z[l] - lanes.v2z[l];
+        const float dot = vx * dx + vy * dy + vz * dz;
+
+        const float slen = -lanes.k[l] * (difftoBeamL) - lanes.d[l] * dot * inverted_dislen;
+        lanes.stress[l] = slen;
+
+        const float scale = slen * inverted_dislen;
+        lanes.fx[l] = dx * scale;
+        lanes.fy[l] = dy * scale;
+        lanes.fz[l] = dz * scale;
+
+        if (std::abs(slen) > lanes.minmaxposnegstress[l])
+        {
+            slow_mask |= (1 << l);
+        }
+    }
+    return slow_mask;
+}
+
+#if defined(ROR_BEAM_SIMD_SSE2)
+
+static int ComputeBeamLanesSse2Half(BeamSimdLanes& lanes, const int o)
+{
+    const __m128 dx = _mm_sub_ps(_mm_load_ps(lanes.p1x + o), _mm_load_ps(lanes.p2x + o));
+    const __m128 dy = _mm_sub_ps(_mm_load_ps(lanes.p1y + o), _mm_load_ps(lanes.p2y + o));
+    const __m128 dz = _mm_sub_ps(_mm_load_ps(lanes.p1z + o), _mm_load_ps(lanes.p2z + o));
+
+    __m128 dislen = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+    // fast_invSqrt()
+    const __m128i magic = _mm_sub_epi32(_mm_set1_epi32(0x5f3759df), _mm_srai_epi32(_mm_castps_si128(dislen), 1));
+    __m128 inv = _mm_castsi128_ps(magic);
+    const __m128 half_v = _mm_mul_ps(_mm_set1_ps(0.5f), dislen);
+    inv = _mm_mul_ps(inv, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(half_v, inv), inv)));
+
+    dislen = _mm_mul_ps(dislen, inv);
+    const __m128 difftoBeamL = _mm_sub_ps(dislen, _mm_load_ps(lanes.L + o));
+
+    const __m128 vx = _mm_sub_ps(_mm_load_ps(lanes.v1x + o), _mm_load_ps(lanes.v2x + o));
+    const __m128 vy = _mm_sub_ps(_mm_load_ps(lanes.v1y + o), _mm_load_ps(lanes.v2y + o));
+    const __m128 vz = _mm_sub_ps(_mm_load_ps(lanes.v1z + o), _mm_load_ps(lanes.v2z + o));
+    const __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, dx), _mm_mul_ps(vy, dy)), _mm_mul_ps(vz, dz));
+
+    const __m128 neg_k = _mm_xor_ps(_mm_load_ps(lanes.k + o), _mm_set1_ps(-0.0f));
+    const __m128 spring = _mm_mul_ps(neg_k, difftoBeamL);
+    const __m128 damp = _mm_mul_ps(_mm_mul_ps(_mm_load_ps(lanes.d + o), dot), inv);
+    const __m128 slen = _mm_sub_ps(spring, damp);
+    _mm_store_ps(lanes.stress + o, slen);
+
+    const __m128 scale = _mm_mul_ps(slen, inv);
+    _mm_store_ps(lanes.fx + o, _mm_mul_ps(dx, scale));
+    _mm_store_ps(lanes.fy + o, _mm_mul_ps(dy, scale));
+    _mm_store_ps(lanes.fz + o, _mm_mul_ps(dz, scale));
+
+    const __m128 abs_slen = _mm_andnot_ps(_mm_set1_ps(-0.0f), slen);
+    return _mm_movemask_ps(_mm_cmpgt_ps(abs_slen, _mm_load_ps(lanes.minmaxposnegstress + o)));
+}
+
+static int ComputeBeamLanesSse2(BeamSimdLanes& lanes)
+{
+    return ComputeBeamLanesSse2Half(lanes, 0) | (ComputeBeamLanesSse2Half(lanes, 4) << 4);
+}
+
+#endif // ROR_BEAM_SIMD_SSE2
+
+typedef int (*BeamLanesKernel)(BeamSimdLanes&);
+
+struct BeamLanesDispatch
+{
+    BeamLanesKernel kernel;
+    const char*     name;
+};
+
+static BeamLanesDispatch SelectBeamLanesKernel()
+{
+#if defined(ROR_ENABLE_AVX2)
+    if (IsAvx2Supported())
+        return BeamLanesDispatch{ ComputeBeamLanesAvx2, "AVX2" };
+#endif
+#if defined(ROR_BEAM_SIMD_SSE2)
+    return BeamLanesDispatch{ ComputeBeamLanesSse2, "SSE2" };
+#else
+    return BeamLanesDispatch{ ComputeBeamLanesScalar, "none" };
+#endif
+}
+
+static const BeamLanesDispatch& GetBeamLanesDispatch()
+{
+    static const BeamLanesDispatch dispatch = SelectBeamLanesKernel(); // Thread-safe init, evaluated once
+    return dispatch;
+}
+
+int ComputeBeamLanes(BeamSimdLanes& lanes)
+{
+    return GetBeamLanesDispatch().kernel(lanes);
+}
+
+const char* GetBeamSimdName()
+{
+    return GetBeamLanesDispatch().name;
+}
+
+} // namespace RoR
@@ -0,0 +1,83 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// @file
+/// @brief Vectorized spring/damper kernel for plain (NOSHOCK) beams.
+///
+/// The kernel reproduces the scalar math of Beam::calcBeam() operation by operation
+/// (including fast_invSqrt()). Both paths yield identical floats only as long as the
+/// compiler neither reassociates nor contracts (FMA) float operations, so CMakeLists.txt
+/// builds this kernel and BeamForcesEuler.cpp without fast-math and with FP contraction off.
+///
+/// The SSE2 kernel is the baseline. With ROR_ENABLE_AVX2, an AVX2 kernel is built in its own
+/// unit (BeamSimdAvx2.cpp, the only one compiled with AVX2 enabled) and picked at runtime
+/// when the CPU and OS support it.
+
+#pragma once
+
+namespace RoR {
+
+/// Plain beams gathered into lanes, structure-of-arrays style.
+struct BeamSimdLanes
+{
+    static const int WIDTH = 8; //!< One AVX2 register; the SSE2 kernel processes two halves.
+
+    // Input
+    alignas(32) float p1x[WIDTH]; //!< beam_t::p1 RelPosition
+    alignas(32) float p1y[WIDTH];
+    alignas(32) float p1z[WIDTH];
+    alignas(32) float p2x[WIDTH]; //!< beam_t::p2 RelPosition
+    alignas(32) float p2y[WIDTH];
+    alignas(32) float p2z[WIDTH];
+    alignas(32) float v1x[WIDTH]; //!< beam_t::p1 Velocity
+    alignas(32) float v1y[WIDTH];
+    alignas(32) float v1z[WIDTH];
+    alignas(32) float v2x[WIDTH]; //!< beam_t::p2 Velocity
+    alignas(32) float v2y[WIDTH];
+    alignas(32) float v2z[WIDTH];
+    alignas(32) float L[WIDTH];
+    alignas(32) float k[WIDTH];
+    alignas(32) float d[WIDTH];
+    alignas(32) float minmaxposnegstress[WIDTH];
+
+    // Output
+    alignas(32) float fx[WIDTH];  //!< Force to add to p1 (and subtract from p2)
+    alignas(32) float fy[WIDTH];
+    alignas(32) float fz[WIDTH];
+    alignas(32) float stress[WIDTH];
+};
+
+/// Computes length, stress and force for all lanes at once, using the best kernel the CPU supports.
+/// @return Bitmask of lanes whose stress exceeds 'minmaxposnegstress'; those need the scalar deformation/breaking path.
+int ComputeBeamLanes(BeamSimdLanes& lanes);
+
+/// Same math without intrinsics; reference for ComputeBeamLanes().
+int ComputeBeamLanesScalar(BeamSimdLanes& lanes);
+
+#if defined(ROR_ENABLE_AVX2)
+/// AVX2 kernel from BeamSimdAvx2.cpp; only call it through ComputeBeamLanes(), which checks CPU support.
+int ComputeBeamLanesAvx2(BeamSimdLanes& lanes);
+#endif
+
+/// Human-readable name of the instruction set selected at runtime.
+const char* GetBeamSimdName();
+
+} // namespace RoR
@@ -0,0 +1,75 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// @file
+/// @brief AVX2 variant of the plain beam kernel, see BeamSimd.h.
+///
+/// This is the only unit built with AVX2 code generation enabled (-mavx2 or /arch:AVX2).
+/// ComputeBeamLanes() calls in only after checking the CPU, so keep everything else out of here.
+
+#include "BeamSimd.h"
+
+#include <immintrin.h>
+
+#if !defined(__AVX2__)
+#   error "BeamSimdAvx2.cpp must be compiled with AVX2 enabled"
+#endif
+
+namespace RoR {
+
+int ComputeBeamLanesAvx2(BeamSimdLanes& lanes)
+{
+    const __m256 dx = _mm256_sub_ps(_mm256_load_ps(lanes.p1x), _mm256_load_ps(lanes.p2x));
+    const __m256 dy = _mm256_sub_ps(_mm256_load_ps(lanes.p1y), _mm256_load_ps(lanes.p2y));
+    const __m256 dz = _mm256_sub_ps(_mm256_load_ps(lanes.p1z), _mm256_load_ps(lanes.p2z));
+
+    __m256 dislen = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+
+    // fast_invSqrt()
+    const __m256i magic = _mm256_sub_epi32(_mm256_set1_epi32(0x5f3759df), _mm256_srai_epi32(_mm256_castps_si256(dislen), 1));
+    __m256 inv = _mm256_castsi256_ps(magic);
+    const __m256 half_v = _mm256_mul_ps(_mm256_set1_ps(0.5f), dislen);
+    inv = _mm256_mul_ps(inv, _mm256_sub_ps(_mm256_set1_ps(1.5f), _mm256_mul_ps(_mm256_mul_ps(half_v, inv), inv)));
+
+    dislen = _mm256_mul_ps(dislen, inv);
+    const __m256 difftoBeamL = _mm256_sub_ps(dislen, _mm256_load_ps(lanes.L));
+
+    const __m256 vx = _mm256_sub_ps(_mm256_load_ps(lanes.v1x), _mm256_load_ps(lanes.v2x));
+    const __m256 vy = _mm256_sub_ps(_mm256_load_ps(lanes.v1y), _mm256_load_ps(lanes.v2y));
+    const __m256 vz = _mm256_sub_ps(_mm256_load_ps(lanes.v1z), _mm256_load_ps(lanes.v2z));
+    const __m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vx, dx), _mm256_mul_ps(vy, dy)), _mm256_mul_ps(vz, dz));
+
+    const __m256 neg_k = _mm256_xor_ps(_mm256_load_ps(lanes.k), _mm256_set1_ps(-0.0f));
+    const __m256 spring = _mm256_mul_ps(neg_k, difftoBeamL);
+    const __m256 damp = _mm256_mul_ps(_mm256_mul_ps(_mm256_load_ps(lanes.d), dot), inv);
+    const __m256 slen = _mm256_sub_ps(spring, damp);
+    _mm256_store_ps(lanes.stress, slen);
+
+    const __m256 scale = _mm256_mul_ps(slen, inv);
+    _mm256_store_ps(lanes.fx, _mm256_mul_ps(dx, scale));
+    _mm256_store_ps(lanes.fy, _mm256_mul_ps(dy, scale));
+    _mm256_store_ps(lanes.fz, _mm256_mul_ps(dz, scale));
+
+    const __m256 abs_slen = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), slen);
+    return _mm256_movemask_ps(_mm256_cmp_ps(abs_slen, _mm256_load_ps(lanes.minmaxposnegstress), _CMP_GT_OQ));
+}
+
+} // namespace RoR
@@ -0,0 +1,341 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PhysicsBenchmark.h"
+
+#include "Application.h"
+#include "Beam.h"
+#include "BeamFactory.h"
+#include "Collisions.h"
+
+#include <OgreStringConverter.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+namespace RoR {
+
+std::atomic<bool> PhysicsBenchmark::s_running(false);
+
+PhysicsStageTimer::PhysicsStageTimer(double& seconds)
+    : m_seconds(PhysicsBenchmark::IsRunning() ? &seconds : nullptr)
+{
+    if (m_seconds)
+        m_start = std::chrono::steady_clock::now();
+}
+
+PhysicsStageTimer::~PhysicsStageTimer()
+{
+    if (m_seconds)
+        *m_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+}
+
+HeightmapHeightFinder::HeightmapHeightFinder(int size, float spacing, float amplitude)
+    : m_size(size)
+    , m_spacing(spacing)
+{
+    m_heights.resize(size * size);
+    for (int z = 0; z < size; z++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            const float fx = x * spacing;
+            const float fz = z * spacing;
+            m_heights[z * size + x] = amplitude * (std::sin(fx * 0.05f) * std::cos(fz * 0.07f) + 0.5f * std::sin(fx * 0.13f + fz * 0.11f));
+        }
+    }
+}
+
+float HeightmapHeightFinder::getHeightAt(float x, float z)
+{
+    const float gx = std::max(0.0f, std::min(x / m_spacing, m_size - 1.001f));
+    const float gz = std::max(0.0f, std::min(z / m_spacing, m_size - 1.001f));
+    const int ix = static_cast<int>(gx);
+    const int iz = static_cast<int>(gz);
+    const float tx = gx - ix;
+    const float tz = gz - iz;
+    const float* row0 = &m_heights[iz * m_size + ix];
+    const float* row1 = row0 + m_size;
+    const float h0 = row0[0] + (row0[1] - row0[0]) * tx;
+    const float h1 = row1[0] + (row1[1] - row1[0]) * tx;
+    return h0 + (h1 - h0) * tz;
+}
+
+Ogre::Vector3 HeightmapHeightFinder::getNormalAt(float x, float y, float z, float precision)
+{
+    // Same as TerrainGeometryManager::getNormalAt()
+    Ogre::Vector3 left(-precision, getHeightAt(x - precision, z) - y, 0.0f);
+    Ogre::Vector3 down(0.0f, getHeightAt(x, z + precision) - y, precision);
+    down = left.crossProduct(down);
+    down.normalise();
+    return down;
+}
+
+PhysicsBenchmarkScenario::PhysicsBenchmarkScenario()
+    : truck_counts({1, 10, 50})
+    , frames(500)
+    , frame_time(0.02f)
+    , spacing(15.0f)
+    , heightmap(false)
+{
+}
+
+bool PhysicsBenchmarkScenario::LoadFile(std::string const& path, std::string& error)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        error = "Cannot open '" + path + "'";
+        return false;
+    }
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line))
+    {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+        Ogre::StringUtil::trim(line);
+        if (line.empty())
+            continue;
+
+        const size_t eq = line.find('=');
+        if (eq == std::string::npos)
+        {
+            error = path + ":" + TOSTRING(line_number) + ": expected 'key = value'";
+            return false;
+        }
+        std::string key = line.substr(0, eq);
+        std::string value = line.substr(eq + 1);
+        Ogre::StringUtil::trim(key);
+        Ogre::StringUtil::trim(value);
+
+        if (key == "truck")
+        {
+            truck = value;
+        }
+        else if (key == "truck_counts")
+        {
+            truck_counts.clear();
+            for (auto& count : Ogre::StringUtil::split(value, ", "))
+            {
+                truck_counts.push_back(Ogre::StringConverter::parseInt(count));
+            }
+        }
+        else if (key == "frames")
+        {
+            frames = Ogre::StringConverter::parseInt(value);
+        }
+        else if (key == "frame_time")
+        {
+            frame_time = Ogre::StringConverter::parseReal(value);
+        }
+        else if (key == "spacing")
+        {
+            spacing = Ogre::StringConverter::parseReal(value);
+        }
+        else if (key == "heightmap")
+        {
+            heightmap = Ogre::StringConverter::parseBool(value);
+        }
+        else
+        {
+            error = path + ":" + TOSTRING(line_number) + ": unknown key '" + key + "'";
+            return false;
+        }
+    }
+
+    if (truck.empty())
+    {
+        error = path + ": no truck specified";
+        return false;
+    }
+    return true;
+}
+
+std::vector<PhysicsBenchmark::Result> PhysicsBenchmark::Run(BeamFactory& factory, Collisions& collisions, PhysicsBenchmarkScenario const& scenario, std::string& error)
+{
+    std::vector<Result> results;
+    error.clear();
+
+    // Let the frame in progress finish first
+    factory.joinFlexbodyTasks();
+    factory.SyncWithSimThread();
+
+    std::unique_ptr<IHeightFinder> ground;
+    if (scenario.heightmap)
+        ground.reset(new HeightmapHeightFinder());
+    else
+        ground.reset(new FlatHeightFinder());
+    IHeightFinder* prev_ground = collisions.getHeightFinder();
+    const bool prev_forced_active = factory.AreTrucksForcedActive();
+    collisions.setHeightFinder(ground.get());
+    factory.setTrucksForcedActive(true); // Nothing may fall asleep during the measurement
+
+    for (int num_trucks : scenario.truck_counts)
+    {
+        std::vector<Beam*> trucks;
+        if (PhysicsBenchmark::SpawnTrucks(factory, *ground, scenario, num_trucks, trucks, error))
+        {
+            Result result;
+            std::memset(&result, 0, sizeof(Result));
+            result.num_trucks = num_trucks;
+            result.frames = scenario.frames;
+
+            PhysicsBenchmark::SimulateFrames(factory, scenario.frame_time, scenario.frames, result);
+            PhysicsBenchmark::CollectStageTimes(trucks, result);
+            if (App::sim_deterministic.GetActive() && !factory.GetPhysicsChecksums().empty())
+            {
+                result.checksum = factory.GetPhysicsChecksums().back();
+            }
+            results.push_back(result);
+        }
+
+        PhysicsBenchmark::RemoveTrucks(factory, trucks);
+        if (!error.empty())
+            break;
+    }
+
+    collisions.setHeightFinder(prev_ground);
+    factory.setTrucksForcedActive(prev_forced_active);
+    return results;
+}
+
+bool PhysicsBenchmark::SpawnTrucks(BeamFactory& factory, IHeightFinder& ground, PhysicsBenchmarkScenario const& scenario, int num_trucks, std::vector<Beam*>& trucks, std::string& error)
+{
+    // Trucks are spawned in a square grid, away from the heightmap's border
+    const int columns = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<float>(num_trucks)))));
+    const float origin = 64.0f;
+    for (int i = 0; i < num_trucks; i++)
+    {
+        Ogre::Vector3 pos(origin + (i % columns) * scenario.spacing, 0.0f, origin + (i / columns) * scenario.spacing);
+        pos.y = ground.getHeightAt(pos.x, pos.z);
+        Beam* truck = factory.CreateLocalRigInstance(pos, Ogre::Quaternion::IDENTITY, scenario.truck);
+        if (!truck)
+        {
+            error = "Cannot spawn '" + scenario.truck + "'";
+            return false;
+        }
+        std::memset(truck->stage_time, 0, sizeof(truck->stage_time));
+        trucks.push_back(truck);
+    }
+
+    factory.activateAllTrucks();
+    return true;
+}
+
+void PhysicsBenchmark::SimulateFrames(BeamFactory& factory, float frame_time, int frames, Result& result)
+{
+    s_running.store(true);
+    const auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; f++)
+    {
+        {
+            PhysicsStageTimer timer(result.stages[PHYSICS_STAGE_FLEXBODIES]);
+            factory.updateFlexbodiesPrepare();
+            factory.joinFlexbodyTasks();
+        }
+        factory.update(frame_time);
+        factory.SyncWithSimThread();
+        {
+            PhysicsStageTimer timer(result.stages[PHYSICS_STAGE_FLEXBODIES]);
+            factory.updateFlexbodiesFinal();
+        }
+    }
+    result.total += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    s_running.store(false);
+}
+
+void PhysicsBenchmark::CollectStageTimes(std::vector<Beam*> const& trucks, Result& result)
+{
+    for (Beam* truck : trucks)
+    {
+        for (int s = 0; s < PHYSICS_STAGE_COUNT; s++)
+        {
+            result.stages[s] += truck->stage_time[s];
+            truck->stage_time[s] = 0.0;
+        }
+    }
+}
+
+void PhysicsBenchmark::RemoveTrucks(BeamFactory& factory, std::vector<Beam*>& trucks)
+{
+    for (Beam* truck : trucks)
+    {
+        factory.removeTruck(truck->trucknum);
+    }
+    trucks.clear();
+}
+
+const char* PhysicsBenchmark::GetStageName(PhysicsStage stage)
+{
+    switch (stage)
+    {
+    case PHYSICS_STAGE_BEAMS:            return "beams";
+    case PHYSICS_STAGE_NODES:            return "nodes";
+    case PHYSICS_STAGE_INTRA_COLLISIONS: return "intra";
+    case PHYSICS_STAGE_INTER_COLLISIONS: return "inter";
+    case PHYSICS_STAGE_FLEXBODIES:       return "flexbodies";
+    default:                             return "";
+    }
+}
+
+std::string PhysicsBenchmark::FormatReport(PhysicsBenchmarkScenario const& scenario, std::vector<Result> const& results)
+{
+    char buf[300];
+    std::snprintf(buf, sizeof(buf), "Physics benchmark: '%s', %d frames of %.4f s, %s terrain\n",
+        scenario.truck.c_str(), scenario.frames, scenario.frame_time, scenario.heightmap ? "heightmap" : "flat");
+    std::string report = buf;
+
+    // Stages are CPU time summed over all threads, so with the thread pool they may add up to more than the total
+    report += "trucks   total";
+    for (int s = 0; s < PHYSICS_STAGE_COUNT; s++)
+    {
+        std::snprintf(buf, sizeof(buf), " %10s", GetStageName(static_cast<PhysicsStage>(s)));
+        report += buf;
+    }
+    report += "   (ms per frame)\n";
+
+    for (Result const& result : results)
+    {
+        const double to_ms = 1000.0 / std::max(1, result.frames);
+        std::snprintf(buf, sizeof(buf), "%6d %7.3f", result.num_trucks, result.total * to_ms);
+        report += buf;
+        for (int s = 0; s < PHYSICS_STAGE_COUNT; s++)
+        {
+            std::snprintf(buf, sizeof(buf), " %10.3f", result.stages[s] * to_ms);
+            report += buf;
+        }
+        if (result.checksum != 0)
+        {
+            std::snprintf(buf, sizeof(buf), "   checksum %016llx", static_cast<unsigned long long>(result.checksum));
+            report += buf;
+        }
+        report += "\n";
+    }
+    return report;
+}
+
+} // namespace RoR
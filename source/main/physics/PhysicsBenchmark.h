@@ -0,0 +1,148 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// @file
+/// @brief Physics benchmark: spawns copies of a truck on stub terrain, runs a fixed number of
+///        physics frames and reports the time spent per stage (beams, nodes, collisions, flexbodies).
+
+#pragma once
+
+#include "ForwardDeclarations.h"
+#include "IHeightFinder.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace RoR {
+
+enum PhysicsStage
+{
+    PHYSICS_STAGE_BEAMS,
+    PHYSICS_STAGE_NODES,
+    PHYSICS_STAGE_INTRA_COLLISIONS,
+    PHYSICS_STAGE_INTER_COLLISIONS,
+    PHYSICS_STAGE_FLEXBODIES,
+    PHYSICS_STAGE_COUNT
+};
+
+/// Adds its own lifetime to 'seconds' while a PhysicsBenchmark runs; otherwise it only costs a branch.
+class PhysicsStageTimer
+{
+public:
+    explicit PhysicsStageTimer(double& seconds);
+    ~PhysicsStageTimer();
+
+private:
+    double*                               m_seconds;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+/// Level ground.
+class FlatHeightFinder : public IHeightFinder
+{
+public:
+    explicit FlatHeightFinder(float height = 0.0f): m_height(height) {}
+
+    float getHeightAt(float x, float z) override { return m_height; }
+    Ogre::Vector3 getNormalAt(float x, float y, float z, float precision = 0.1f) override { return Ogre::Vector3::UNIT_Y; }
+
+private:
+    float m_height;
+};
+
+/// Rolling hills sampled into a grid and looked up bilinearly, at about the cost of a real terrain heightmap.
+class HeightmapHeightFinder : public IHeightFinder
+{
+public:
+    HeightmapHeightFinder(int size = 1025, float spacing = 1.0f, float amplitude = 2.0f);
+
+    float getHeightAt(float x, float z) override;
+    Ogre::Vector3 getNormalAt(float x, float y, float z, float precision = 0.1f) override;
+
+private:
+    std::vector<float> m_heights;
+    int                m_size;
+    float              m_spacing;
+};
+
+struct PhysicsBenchmarkScenario
+{
+    PhysicsBenchmarkScenario();
+
+    /// Reads 'key = value' lines; keys are the member names below, 'truck_counts' is comma separated. '#' starts a comment.
+    bool LoadFile(std::string const& path, std::string& error);
+
+    std::string      truck;         //!< Truck file name, as listed in the mod cache
+    std::vector<int> truck_counts;  //!< One run per entry
+    int              frames;        //!< Physics frames per run
+    float            frame_time;    //!< Seconds per frame; BeamFactory::update() clamps it to 1/20
+    float            spacing;       //!< Distance between neighbouring trucks, meters; small values make them collide
+    bool             heightmap;     //!< HeightmapHeightFinder instead of FlatHeightFinder
+};
+
+class PhysicsBenchmark
+{
+public:
+
+    struct Result
+    {
+        int      num_trucks;
+        int      frames;
+        double   total;                          //!< Wall time of all frames, seconds
+        double   stages[PHYSICS_STAGE_COUNT];    //!< Seconds summed over all trucks and threads
+        uint64_t checksum;                       //!< Deterministic mode only: hash of the last substep, see BeamFactory::GetPhysicsChecksums()
+    };
+
+    /// For each entry of 'truck_counts': spawns the trucks in a grid, simulates them, removes them again.
+    /// The terrain is replaced by a stub height finder meanwhile. Runs on the calling thread until done.
+    static std::vector<Result> Run(BeamFactory& factory, Collisions& collisions, PhysicsBenchmarkScenario const& scenario, std::string& error);
+
+    // Building blocks of Run(), also used by the standalone benchmark (source/microbenchmarks/Bench_Physics.cpp)
+
+    /// Spawns 'num_trucks' copies of the scenario's truck in a square grid on 'ground' and wakes them up.
+    /// On failure, the trucks spawned so far are left in 'trucks'.
+    static bool SpawnTrucks(BeamFactory& factory, IHeightFinder& ground, PhysicsBenchmarkScenario const& scenario, int num_trucks, std::vector<Beam*>& trucks, std::string& error);
+
+    /// Simulates 'frames' frames; adds the wall time to 'result.total' and the flexbody time to its stages.
+    /// The other stages are collected on the trucks, see CollectStageTimes().
+    static void SimulateFrames(BeamFactory& factory, float frame_time, int frames, Result& result);
+
+    /// Adds the stage times of the trucks to 'result' and resets them.
+    static void CollectStageTimes(std::vector<Beam*> const& trucks, Result& result);
+
+    static void RemoveTrucks(BeamFactory& factory, std::vector<Beam*>& trucks);
+
+    static std::string FormatReport(PhysicsBenchmarkScenario const& scenario, std::vector<Result> const& results);
+
+    static const char* GetStageName(PhysicsStage stage);
+
+    /// Read by PhysicsStageTimer on the physics threads.
+    static bool IsRunning() { return s_running.load(std::memory_order_relaxed); }
+
+private:
+
+    static std::atomic<bool> s_running;
+};
+
+} // namespace RoR
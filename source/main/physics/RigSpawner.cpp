@@ -75,6 +75,8 @@
 #include <OgreParticleSystem.h>
 #include <OgreEntity.h>
 
+#include <limits>
+
 static const char* ACTOR_ID_TOKEN = "@Actor_"; // Appended to material name, followed by actor ID (aka 'trucknum')
 
 using namespace RoR;
@@ -100,6 +102,8 @@ void RigSpawner::Setup(
     m_spawn_position = spawn_position;
     m_current_keyword = RigDef::File::KEYWORD_INVALID;
     m_enable_background_loading = BSETTING("Background Loading", false);
+    m_headless = App::app_headless.GetActive();
+    m_capacity_exceeded = false;
     m_wing_area = 0.f;
     m_fuse_z_min = 1000.0f;
     m_fuse_z_max = -1000.0f;
@@ -135,17 +139,157 @@ void RigSpawner::Setup(
     m_messages_num_other = 0;
 }
 
+rig_capacity_t RigSpawner::CalcRigCapacity()
+{
+    SPAWNER_PROFILE_SCOPED();
+
+    // Upper bounds; must match what the Process*() functions generate
+    rig_capacity_t cap;
+    memset(&cap, 0, sizeof(rig_capacity_t));
+    int num_cab_triangles = 0;
+    for (auto& module: m_selected_modules)
+    {
+        cap.nodes += static_cast<int>(module->nodes.size() + module->cinecam.size());
+        cap.beams += static_cast<int>(module->beams.size() + module->ropes.size() + module->ties.size()
+            + module->commands_2.size() + module->animators.size() + module->hydros.size()
+            + module->shocks.size() + module->shocks_2.size() + module->triggers.size()
+            + module->cinecam.size() * 8);
+        for (RigDef::Node& node: module->nodes)
+        {
+            // Hook beam; same merged flags as ProcessNode()
+            if (BITMASK_IS_1(node.options | node.node_defaults->options, RigDef::Node::OPTION_h_HOOK_POINT))
+                cap.beams++;
+        }
+        cap.shocks += static_cast<int>(module->shocks.size() + module->shocks_2.size() + module->triggers.size());
+        cap.hydros += static_cast<int>(module->hydros.size() + module->animators.size());
+        cap.contacters += static_cast<int>(module->contacters.size());
+
+        // Wheels: 2 ring nodes per ray, 4 with tyre; beams per ray as in BuildWheelBeams(), AddWheel2() and ProcessFlexBodyWheel()
+        for (RigDef::Wheel& wheel: module->wheels)
+        {
+            cap.nodes += wheel.num_rays * 2;
+            cap.beams += wheel.num_rays * 9;
+        }
+        for (RigDef::MeshWheel& wheel: module->mesh_wheels)
+        {
+            cap.nodes += wheel.num_rays * 2;
+            cap.beams += wheel.num_rays * 9;
+        }
+        for (RigDef::Wheel2& wheel: module->wheels_2)
+        {
+            cap.nodes += wheel.num_rays * 4;
+            cap.beams += wheel.num_rays * 26;
+            cap.pressure_beams += wheel.num_rays * 14;
+        }
+        for (RigDef::FlexBodyWheel& wheel: module->flex_body_wheels)
+        {
+            cap.nodes += wheel.num_rays * 4;
+            cap.beams += wheel.num_rays * 26;
+        }
+
+        for (RigDef::Submesh& submesh: module->submeshes)
+        {
+            const int num_triangles = static_cast<int>(submesh.cab_triangles.size());
+            num_cab_triangles += num_triangles;
+            cap.cabs += (submesh.backmesh) ? (num_triangles * 3) : num_triangles; // Backmesh duplicates the cabs twice
+        }
+    }
+    cap.contacters += cap.nodes; // Wheel nodes are contacters, too
+    cap.collcabs = num_cab_triangles * 4; // Options 'c', 'p', 'u' and one of 'D', 'F', 'S'
+    cap.buoycabs = num_cab_triangles * 4; // Options 'b', 'r', 's' and one of 'D', 'F', 'S'
+
+    // Keep at least one element, some code reads element 0 unconditionally
+    cap.nodes          = std::max(cap.nodes, 1);
+    cap.beams          = std::max(cap.beams, 1);
+    cap.shocks         = std::max(cap.shocks, 1);
+    cap.contacters     = std::max(cap.contacters, 1);
+    cap.hydros         = std::max(cap.hydros, 1);
+    cap.cabs           = std::max(cap.cabs, 1);
+    cap.collcabs       = std::max(cap.collcabs, 1);
+    cap.buoycabs       = std::max(cap.buoycabs, 1);
+    cap.pressure_beams = std::max(cap.pressure_beams, 1);
+
+    if (cap.nodes > std::numeric_limits<short>::max())
+    {
+        std::stringstream msg;
+        msg << "Too many nodes (" << cap.nodes << "), node indices are limited to " << std::numeric_limits<short>::max();
+        AddMessage(Message::TYPE_ERROR, msg.str());
+    }
+    return cap;
+}
+
+/// Reserves space for 'count' elements of T in the arena and returns their offset.
+template <typename T>
+static size_t ArenaReserve(size_t& arena_size, int count)
+{
+    const size_t align = 16;
+    const size_t offset = (arena_size + align - 1) & ~(align - 1);
+    arena_size = offset + sizeof(T) * count;
+    return offset;
+}
+
+void RigSpawner::AllocateRigArrays(rig_capacity_t const & cap)
+{
+    SPAWNER_PROFILE_SCOPED();
+
+    size_t size = 0;
+    const size_t nodes_offset              = ArenaReserve<node_t>        (size, cap.nodes);
+    const size_t node_attrs_offset         = ArenaReserve<node_attr_t>   (size, cap.nodes);
+    const size_t initial_node_pos_offset   = ArenaReserve<Ogre::Vector3> (size, cap.nodes);
+    const size_t mouse_grab_offset         = ArenaReserve<bool>          (size, cap.nodes);
+    const size_t beams_offset              = ArenaReserve<beam_t>        (size, cap.beams);
+    const size_t beam_strength_offset      = ArenaReserve<Ogre::Real>    (size, cap.beams);
+    const size_t beam_deform_offset        = ArenaReserve<Ogre::Real>    (size, cap.beams);
+    const size_t beam_plastic_coef_offset  = ArenaReserve<Ogre::Real>    (size, cap.beams);
+    const size_t shocks_offset             = ArenaReserve<shock_t>       (size, cap.shocks);
+    const size_t contacters_offset         = ArenaReserve<contacter_t>   (size, cap.contacters);
+    const size_t hydro_offset              = ArenaReserve<int>           (size, cap.hydros);
+    const size_t cabs_offset               = ArenaReserve<int>           (size, cap.cabs * 3);
+    const size_t collcabs_offset           = ArenaReserve<int>           (size, cap.collcabs);
+    const size_t inter_collcabrate_offset  = ArenaReserve<collcab_rate_t>(size, cap.collcabs);
+    const size_t intra_collcabrate_offset  = ArenaReserve<collcab_rate_t>(size, cap.collcabs);
+    const size_t buoycabs_offset           = ArenaReserve<int>           (size, cap.buoycabs);
+    const size_t buoycabtypes_offset       = ArenaReserve<int>           (size, cap.buoycabs);
+    const size_t pressure_beams_offset     = ArenaReserve<int>           (size, cap.pressure_beams);
+
+    free(m_rig->rig_arena);
+    char* arena = static_cast<char*>(calloc(size, 1));
+    m_rig->rig_arena = arena;
+    m_rig->capacity = cap;
+
+    m_rig->nodes                     = reinterpret_cast<node_t*>        (arena + nodes_offset);
+    m_rig->node_attrs                = reinterpret_cast<node_attr_t*>   (arena + node_attrs_offset);
+    m_rig->initial_node_pos          = reinterpret_cast<Ogre::Vector3*> (arena + initial_node_pos_offset);
+    m_rig->node_mouse_grab_disabled  = reinterpret_cast<bool*>          (arena + mouse_grab_offset);
+    m_rig->beams                     = reinterpret_cast<beam_t*>        (arena + beams_offset);
+    m_rig->initial_beam_strength     = reinterpret_cast<Ogre::Real*>    (arena + beam_strength_offset);
+    m_rig->default_beam_deform       = reinterpret_cast<Ogre::Real*>    (arena + beam_deform_offset);
+    m_rig->default_beam_plastic_coef = reinterpret_cast<Ogre::Real*>    (arena + beam_plastic_coef_offset);
+    m_rig->shocks                    = reinterpret_cast<shock_t*>       (arena + shocks_offset);
+    m_rig->contacters                = reinterpret_cast<contacter_t*>   (arena + contacters_offset);
+    m_rig->hydro                     = reinterpret_cast<int*>           (arena + hydro_offset);
+    m_rig->cabs                      = reinterpret_cast<int*>           (arena + cabs_offset);
+    m_rig->collcabs                  = reinterpret_cast<int*>           (arena + collcabs_offset);
+    m_rig->inter_collcabrate         = reinterpret_cast<collcab_rate_t*>(arena + inter_collcabrate_offset);
+    m_rig->intra_collcabrate         = reinterpret_cast<collcab_rate_t*>(arena + intra_collcabrate_offset);
+    m_rig->buoycabs                  = reinterpret_cast<int*>           (arena + buoycabs_offset);
+    m_rig->buoycabtypes              = reinterpret_cast<int*>           (arena + buoycabtypes_offset);
+    m_rig->pressure_beams            = reinterpret_cast<int*>           (arena + pressure_beams_offset);
+
+    std::stringstream msg;
+    msg << "Rig arrays: " << cap.nodes << " nodes, " << cap.beams << " beams, " << cap.cabs << " cabs; " << size / 1024 << " KiB";
+    LOG(" == RigSpawner: " + msg.str());
+}
+
 void RigSpawner::InitializeRig()
 {
     SPAWNER_PROFILE_SCOPED();
 
     m_rig->mCamera = nullptr;
     // clear rig parent structure
-    memset(m_rig->nodes, 0, sizeof(node_t) * MAX_NODES);
+    AllocateRigArrays(CalcRigCapacity()); // Zeroed
     m_rig->free_node = 0;
-    memset(m_rig->beams, 0, sizeof(beam_t) * MAX_BEAMS);
     m_rig->free_beam = 0;
-    memset(m_rig->contacters, 0, sizeof(contacter_t) * MAX_CONTACTERS);
     m_rig->free_contacter = 0;
     memset(m_rig->rigidifiers, 0, sizeof(rigidifier_t) * MAX_RIGIDIFIERS);
     m_rig->free_rigidifier = 0;
@@ -174,7 +318,6 @@ void RigSpawner::InitializeRig()
     m_rig->free_flare = 0;
     memset(m_rig->props, 0, sizeof(prop_t) * MAX_PROPS);
     m_rig->free_prop = 0;
-    memset(m_rig->shocks, 0, sizeof(shock_t) * MAX_SHOCKS);
     m_rig->free_shock = 0;
     m_rig->free_active_shock = 0;
     m_rig->exhausts.clear();
@@ -182,21 +325,13 @@ void RigSpawner::InitializeRig()
     m_rig->free_cparticle = 0;
     memset(m_rig->soundsources, 0, sizeof(soundsource_t) * MAX_SOUNDSCRIPTS_PER_TRUCK);
     m_rig->free_soundsource = 0;
-    memset(m_rig->pressure_beams, 0, sizeof(int) * MAX_PRESSURE_BEAMS);
     m_rig->free_pressure_beam = 0;
     memset(m_rig->aeroengines, 0, sizeof(AeroEngine *) * MAX_AEROENGINES);
     m_rig->free_aeroengine = 0;
-    memset(m_rig->cabs, 0, sizeof(int) * (MAX_CABS*3));
     m_rig->free_cab = 0;
-    memset(m_rig->hydro, 0, sizeof(int) * MAX_HYDROS);
     m_rig->free_hydro = 0;
-    memset(m_rig->collcabs, 0, sizeof(int) * MAX_CABS);
-    memset(m_rig->inter_collcabrate, 0, sizeof(collcab_rate_t) * MAX_CABS);
     m_rig->free_collcab = 0;
-    memset(m_rig->intra_collcabrate, 0, sizeof(collcab_rate_t) * MAX_CABS);
-    memset(m_rig->buoycabs, 0, sizeof(int) * MAX_CABS);
     m_rig->free_buoycab = 0;
-    memset(m_rig->buoycabtypes, 0, sizeof(int) * MAX_CABS);
     memset(m_rig->airbrakes, 0, sizeof(Airbrake *) * MAX_AIRBRAKES);
     m_rig->free_airbrake = 0;
     memset(m_rig->skidtrails, 0, sizeof(Skidmark *) * (MAX_WHEELS*2));
@@ -501,7 +636,7 @@ void RigSpawner::FinalizeRig()
         WashCalculator();
     }
     //add the cab visual
-    if (!m_oldstyle_cab_texcoords.empty() && m_rig->free_cab>0)
+    if (!m_headless && !m_oldstyle_cab_texcoords.empty() && m_rig->free_cab>0)
     {
         //the cab materials are as follow:
         //texname: base texture with emissive(2 pass) or without emissive if none available(1 pass), alpha cutting
@@ -662,6 +797,12 @@ void RigSpawner::ProcessTurbojet(RigDef::Turbojet & def)
 {
     SPAWNER_PROFILE_SCOPED();
 
+    if (m_headless) // Aerial parts are built together with their meshes
+    {
+        this->AddMessage(Message::TYPE_WARNING, "Not supported in headless mode, skipping");
+        return;
+    }
+
     int front,back,ref;
     front = GetNodeIndexOrThrow(def.front_node);
     back  = GetNodeIndexOrThrow(def.back_node);
@@ -849,6 +990,12 @@ void RigSpawner::ProcessTurboprop2(RigDef::Turboprop2 & def)
 {
     SPAWNER_PROFILE_SCOPED();
 
+    if (m_headless) // Aerial parts are built together with their meshes
+    {
+        this->AddMessage(Message::TYPE_WARNING, "Not supported in headless mode, skipping");
+        return;
+    }
+
     int p3_node_index = (def.blade_tip_nodes[2].IsValidAnyState()) ? GetNodeIndexOrThrow(def.blade_tip_nodes[2]) : -1;
     int p4_node_index = (def.blade_tip_nodes[3].IsValidAnyState()) ? GetNodeIndexOrThrow(def.blade_tip_nodes[3]) : -1;
     int couple_node_index = (def.couple_node.IsValidAnyState()) ? GetNodeIndexOrThrow(def.couple_node) : -1;
@@ -872,6 +1019,12 @@ void RigSpawner::ProcessPistonprop(RigDef::Pistonprop & def)
 {
     SPAWNER_PROFILE_SCOPED();
 
+    if (m_headless) // Aerial parts are built together with their meshes
+    {
+        this->AddMessage(Message::TYPE_WARNING, "Not supported in headless mode, skipping");
+        return;
+    }
+
     int p3_node_index = (def.blade_tip_nodes[2].IsValidAnyState()) ? GetNodeIndexOrThrow(def.blade_tip_nodes[2]) : -1;
     int p4_node_index = (def.blade_tip_nodes[3].IsValidAnyState()) ? GetNodeIndexOrThrow(def.blade_tip_nodes[3]) : -1;
     int couple_node_index = (def.couple_node.IsValidAnyState()) ? GetNodeIndexOrThrow(def.couple_node) : -1;
@@ -895,6 +1048,12 @@ void RigSpawner::ProcessAirbrake(RigDef::Airbrake & def)
 {
     SPAWNER_PROFILE_SCOPED();
 
+    if (m_headless) // Aerial parts are built together with their meshes
+    {
+        this->AddMessage(Message::TYPE_WARNING, "Not supported in headless mode, skipping");
+        return;
+    }
+
     if (! CheckAirBrakeLimit(1))
     {
         return;
@@ -925,6 +1084,12 @@ void RigSpawner::ProcessWing(RigDef::Wing & def)
 {
     SPAWNER_PROFILE_SCOPED();
 
+    if (m_headless) // Aerial parts are built together with their meshes
+    {
+        this->AddMessage(Message::TYPE_WARNING, "Not supported in headless mode, skipping");
+        return;
+    }
+
     // Perform checks
     if (! this->CheckWingLimit(1)) { return; }
 
@@ -1392,8 +1557,8 @@ void RigSpawner::ProcessExhaust(RigDef::Exhaust & def)
     exhaust.smokeNode->attachObject(exhaust.smoker);
     exhaust.smokeNode->setPosition(m_rig->nodes[exhaust.emitterNode].AbsPosition);
     
-    ref_node.isHot=true;
-    dir_node.isHot=true;
+    GetNodeAttr(ref_node).isHot=true;
+    GetNodeAttr(dir_node).isHot=true;
     m_rig->exhausts.push_back(exhaust);
 }
 
@@ -1453,10 +1618,10 @@ void RigSpawner::ProcessSubmesh(RigDef::Submesh & def)
         {
             return;
         }
-        else if (m_rig->free_collcab >= MAX_CABS)
+        else if (m_rig->free_collcab >= m_rig->capacity.collcabs)
         {
             std::stringstream msg;
-            msg << "Collcab limit (" << MAX_CABS << ") exceeded";
+            msg << "Collcab limit (" << m_rig->capacity.collcabs << ") exceeded";
             AddMessage(Message::TYPE_ERROR, msg.str());
             return;
         }
@@ -1522,17 +1687,17 @@ void RigSpawner::ProcessSubmesh(RigDef::Submesh & def)
         if (collcabs_type != -1)
         {
 
-            if (m_rig->free_collcab >= MAX_CABS)
+            if (m_rig->free_collcab >= m_rig->capacity.collcabs)
             {
                 std::stringstream msg;
-                msg << "Collcab limit (" << MAX_CABS << ") exceeded";
+                msg << "Collcab limit (" << m_rig->capacity.collcabs << ") exceeded";
                 AddMessage(Message::TYPE_ERROR, msg.str());
                 return;
             }
-            else if (m_rig->free_buoycab >= MAX_CABS)
+            else if (m_rig->free_buoycab >= m_rig->capacity.buoycabs)
             {
                 std::stringstream msg;
-                msg << "Buoycab limit (" << MAX_CABS << ") exceeded";
+                msg << "Buoycab limit (" << m_rig->capacity.buoycabs << ") exceeded";
                 AddMessage(Message::TYPE_ERROR, msg.str());
                 return;
             }
@@ -1565,8 +1730,10 @@ void RigSpawner::ProcessSubmesh(RigDef::Submesh & def)
     if (def.backmesh)
     {
 
-        // Check limit
-        if (! CheckCabLimit(1))
+        // Check limit; the front and back copies each duplicate all cabs of the current submesh
+        const int submesh_cab_start = (m_oldstyle_cab_submeshes.size()==1) ? 0 : static_cast<int>((m_oldstyle_cab_submeshes.rbegin()+1)->cabs_pos);
+        const int num_submesh_cabs = m_rig->free_cab - submesh_cab_start;
+        if (! CheckCabLimit(num_submesh_cabs * 2))
         {
             return;
         }
@@ -3081,7 +3248,7 @@ void RigSpawner::ProcessLockgroup(RigDef::Lockgroup & lockgroup)
     auto end  = lockgroup.nodes.end();
     for (; itor != end; ++itor)
     {
-        GetNodeOrThrow(*itor).lockgroup = lockgroup.number;
+        GetNodeAttr(GetNodeOrThrow(*itor)).lockgroup = lockgroup.number;
     }
 }
 
@@ -3261,8 +3428,7 @@ void RigSpawner::ProcessContacter(RigDef::Node::Ref & node_ref)
     SPAWNER_PROFILE_SCOPED();
 
     unsigned int node_index = GetNodeIndexOrThrow(node_ref);
-    m_rig->contacters[m_rig->free_contacter].nodeid = node_index;
-    m_rig->free_contacter++;
+    GetFreeContacter().nodeid = node_index;
 };
 
 void RigSpawner::ProcessRotator(RigDef::Rotator & def)
@@ -4064,9 +4230,8 @@ void RigSpawner::ProcessFlexBodyWheel(RigDef::FlexBodyWheel & def)
         outer_node.iswheel       = WHEEL_FLEXBODY;
         AdjustNodeBuoyancy(outer_node, def.node_defaults);
 
-        contacter_t & outer_contacter = m_rig->contacters[m_rig->free_contacter];
+        contacter_t & outer_contacter = GetFreeContacter();
         outer_contacter.nodeid        = outer_node.pos; /* Node index */
-        m_rig->free_contacter++;
 
         /* Inner ring */
         ray_point = axis_node_2->RelPosition + tyre_ray_vector;
@@ -4083,9 +4248,8 @@ void RigSpawner::ProcessFlexBodyWheel(RigDef::FlexBodyWheel & def)
         inner_node.iswheel       = WHEEL_FLEXBODY;
         AdjustNodeBuoyancy(inner_node, def.node_defaults);
 
-        contacter_t & inner_contacter = m_rig->contacters[m_rig->free_contacter];
+        contacter_t & inner_contacter = GetFreeContacter();
         inner_contacter.nodeid        = inner_node.pos; /* Node index */
-        m_rig->free_contacter++;
 
         /* Wheel object */
         wheel.nodes[i * 2] = & outer_node;
@@ -4239,6 +4403,12 @@ void RigSpawner::ProcessFlexBodyWheel(RigDef::FlexBodyWheel & def)
         def.side != RigDef::MeshWheel::SIDE_RIGHT
         );
 
+    if (m_headless) // The tyre flexbody is only a visual
+    {
+        m_rig->free_wheel++;
+        return;
+    }
+
     const std::string flexwheel_name = this->ComposeName("FlexBodyWheel", m_rig->free_flexbody);
 
     int num_nodes = def.num_rays * 4;
@@ -4438,6 +4608,9 @@ void RigSpawner::BuildMeshWheelVisuals(
 {
     SPAWNER_PROFILE_SCOPED();
 
+    if (m_headless)
+        return;
+
     try
     {
         FlexMeshWheel* flexmesh_wheel = m_flex_factory.CreateFlexMeshWheel(
@@ -4546,9 +4719,8 @@ unsigned int RigSpawner::BuildWheelObjectAndNodes(
         outer_node.wheelid = m_rig->free_wheel;
         AdjustNodeBuoyancy(outer_node, node_defaults);
 
-        contacter_t & outer_contacter = m_rig->contacters[m_rig->free_contacter];
+        contacter_t & outer_contacter = GetFreeContacter();
         outer_contacter.nodeid        = outer_node.pos; /* Node index */
-        m_rig->free_contacter++;
 
         /* Inner ring */
         ray_point = axis_node_2->RelPosition + ray_vector;
@@ -4562,9 +4734,8 @@ unsigned int RigSpawner::BuildWheelObjectAndNodes(
         inner_node.wheelid = m_rig->free_wheel; 
         AdjustNodeBuoyancy(inner_node, node_defaults);
 
-        contacter_t & contacter = m_rig->contacters[m_rig->free_contacter];
+        contacter_t & contacter = GetFreeContacter();
         contacter.nodeid        = inner_node.pos; /* Node index */
-        m_rig->free_contacter++;
 
         /* Wheel object */
         wheel.nodes[i * 2] = & outer_node;
@@ -4598,14 +4769,14 @@ void RigSpawner::AdjustNodeBuoyancy(node_t & node, RigDef::Node & node_def, std:
     SPAWNER_PROFILE_SCOPED();
 
     unsigned int options = (defaults->options | node_def.options); // Merge flags
-    node.buoyancy = BITMASK_IS_1(options, RigDef::Node::OPTION_b_EXTRA_BUOYANCY) ? 10000.f : m_rig->truckmass/15.f;
+    GetNodeAttr(node).buoyancy = BITMASK_IS_1(options, RigDef::Node::OPTION_b_EXTRA_BUOYANCY) ? 10000.f : m_rig->truckmass/15.f;
 }
 
 void RigSpawner::AdjustNodeBuoyancy(node_t & node, std::shared_ptr<RigDef::NodeDefaults> defaults)
 {
     SPAWNER_PROFILE_SCOPED();
 
-    node.buoyancy = BITMASK_IS_1(defaults->options, RigDef::Node::OPTION_b_EXTRA_BUOYANCY) ? 10000.f : m_rig->truckmass/15.f;
+    GetNodeAttr(node).buoyancy = BITMASK_IS_1(defaults->options, RigDef::Node::OPTION_b_EXTRA_BUOYANCY) ? 10000.f : m_rig->truckmass/15.f;
 }
 
 int RigSpawner::FindLowestNodeInRig()
@@ -4811,6 +4982,9 @@ unsigned int RigSpawner::AddWheel(RigDef::Wheel & wheel_def)
 
 void RigSpawner::CreateWheelSkidmarks(unsigned int wheel_index)
 {
+    if (m_headless)
+        return;
+
     // Always create, even if disabled by config
     m_rig->skidtrails[wheel_index] = new RoR::Skidmark(
         m_sim_controller->GetSkidmarkConf(), m_sim_controller, &m_rig->wheels[wheel_index], m_rig->beamsRoot, 300, 20);
@@ -4860,9 +5034,8 @@ unsigned int RigSpawner::AddWheel(RigDef::Wheel & wheel_def)
         outer_node.id      = -1; // Orig: hardcoded (BTS_WHEELS)
         outer_node.wheelid = m_rig->free_wheel;
 
-        contacter_t & contacter = m_rig->contacters[m_rig->free_contacter];
+        contacter_t & contacter = GetFreeContacter();
         contacter.nodeid        = outer_node.pos; /* Node index */
-        m_rig->free_contacter++;
 
         /* Inner ring */
         ray_point = axis_node_2.RelPosition + ray_vector;
@@ -4875,9 +5048,8 @@ unsigned int RigSpawner::AddWheel(RigDef::Wheel & wheel_def)
         inner_node.id      = -1; // Orig: hardcoded (BTS_WHEELS)
         inner_node.wheelid = m_rig->free_wheel; 
 
-        contacter_t & contacter = m_rig->contacters[m_rig->free_contacter];
+        contacter_t & contacter = GetFreeContacter();
         contacter.nodeid        = inner_node.pos; /* Node index */
-        m_rig->free_contacter++;
 
         /* Wheel object */
         wheel.nodes[i * 2] = & outer_node;
@@ -5051,9 +5223,8 @@ unsigned int RigSpawner::AddWheel2(RigDef::Wheel2 & wheel_2_def)
         outer_node.volume_coef   = wheel_2_def.node_defaults->volume;
         outer_node.surface_coef  = wheel_2_def.node_defaults->surface;
 
-        contacter_t & contacter = m_rig->contacters[m_rig->free_contacter];
+        contacter_t & contacter = GetFreeContacter();
         contacter.nodeid        = outer_node.pos; /* Node index */
-        m_rig->free_contacter++;
 
         /* Inner ring */
         ray_point = axis_node_2->RelPosition + tyre_ray_vector;
@@ -5068,9 +5239,8 @@ unsigned int RigSpawner::AddWheel2(RigDef::Wheel2 & wheel_2_def)
         inner_node.volume_coef   = wheel_2_def.node_defaults->volume;
         inner_node.surface_coef  = wheel_2_def.node_defaults->surface;
 
-        contacter_t & inner_contacter = m_rig->contacters[m_rig->free_contacter];
+        contacter_t & inner_contacter = GetFreeContacter();
         inner_contacter.nodeid        = inner_node.pos; /* Node index */
-        m_rig->free_contacter++;
 
         /* Wheel object */
         wheel.nodes[i * 2] = & outer_node;
@@ -5221,6 +5391,9 @@ void RigSpawner::CreateWheelVisuals(
 {
     SPAWNER_PROFILE_SCOPED();
 
+    if (m_headless)
+        return;
+
     wheel_t & wheel = m_rig->wheels[wheel_index];
     vwheel_t & visual_wheel = m_rig->vwheels[wheel_index];
 
@@ -5309,6 +5482,10 @@ unsigned int RigSpawner::AddTyreBeam(RigDef::Wheel2 & wheel_2_def, node_t *node_
     beam.k = wheel_2_def.tyre_springiness;
     beam.d = wheel_2_def.tyre_damping;
 
+    if (m_rig->free_pressure_beam >= m_rig->capacity.pressure_beams)
+    {
+        this->ThrowCapacityExceeded("Pressure beam", m_rig->capacity.pressure_beams);
+    }
     m_rig->pressure_beams[m_rig->free_pressure_beam] = beam_index;
     m_rig->free_pressure_beam++;
 
@@ -5895,6 +6072,9 @@ void RigSpawner::CreateBeamVisuals(beam_t & beam, int beam_index, std::shared_pt
 {
     SPAWNER_PROFILE_SCOPED();
 
+    if (m_headless)
+        return;
+
     std::stringstream beam_name;
     beam_name << "beam-" << m_rig->truckname << "-" << beam_index;
     try
@@ -6061,11 +6241,12 @@ std::pair<unsigned int, bool> RigSpawner::AddNode(RigDef::Node::Id & id)
         this->AddMessage(Message::TYPE_ERROR, msg.str());
         return std::make_pair(0, false);
     }
-    if ((m_rig->free_node + 1) > MAX_NODES)
+    if ((m_rig->free_node + 1) > m_rig->capacity.nodes)
     {
         std::stringstream msg;
-        msg << "Node limit (" << MAX_NODES << ") exceeded with node: " << id.ToString();
+        msg << "Node limit (" << m_rig->capacity.nodes << ") exceeded with node: " << id.ToString();
         this->AddMessage(Message::TYPE_ERROR, msg.str());
+        m_capacity_exceeded = true;
         return std::make_pair(0, false);
     }
     if (id.IsTypeNamed())
@@ -6110,6 +6291,7 @@ void RigSpawner::ProcessNode(RigDef::Node & def)
 
     node_t & node = m_rig->nodes[inserted_node.first];
     node.pos = inserted_node.first; /* Node index */
+    node_attr_t & node_attr = m_rig->node_attrs[inserted_node.first];
     node.id = static_cast<int>(def.id.Num());
 
     /* Positioning */
@@ -6130,26 +6312,26 @@ void RigSpawner::ProcessNode(RigDef::Node & def)
     {
         // orig = further override of hardcoded default.
         node.mass = def.node_defaults->load_weight; 
-        node.overrideMass = true;
-        node.loadedMass = true;
+        node_attr.overrideMass = true;
+        node_attr.loadedMass = true;
     }
     else
     {
         node.mass = 10; // Hardcoded in original (bts_nodes, call to init_node())
-        node.loadedMass = false;
+        node_attr.loadedMass = false;
     }
 
     /* Lockgroup */
-    node.lockgroup = (m_file->lockgroup_default_nolock) ? RigDef::Lockgroup::LOCKGROUP_NOLOCK : RigDef::Lockgroup::LOCKGROUP_DEFAULT;
+    node_attr.lockgroup = (m_file->lockgroup_default_nolock) ? RigDef::Lockgroup::LOCKGROUP_NOLOCK : RigDef::Lockgroup::LOCKGROUP_DEFAULT;
 
     /* Options */
     unsigned int options = def.options | def.node_defaults->options; /* Merge bit flags */
     if (BITMASK_IS_1(options, RigDef::Node::OPTION_l_LOAD_WEIGHT))
     {
-        node.loadedMass = true;
+        node_attr.loadedMass = true;
         if (def._has_load_weight_override)
         {
-            node.overrideMass = true;
+            node_attr.overrideMass = true;
             node.mass = def.load_weight_override;
         }
         else
@@ -6211,8 +6393,8 @@ void RigSpawner::ProcessNode(RigDef::Node & def)
     }
     AdjustNodeBuoyancy(node, def, def.node_defaults);
     node.contactless       = BITMASK_IS_1(options, RigDef::Node::OPTION_c_NO_GROUND_CONTACT);
-    node.disable_particles = BITMASK_IS_1(options, RigDef::Node::OPTION_p_NO_PARTICLES);
-    node.disable_sparks    = BITMASK_IS_1(options, RigDef::Node::OPTION_f_NO_SPARKS);
+    node_attr.disable_particles = BITMASK_IS_1(options, RigDef::Node::OPTION_p_NO_PARTICLES);
+    node_attr.disable_sparks    = BITMASK_IS_1(options, RigDef::Node::OPTION_f_NO_SPARKS);
         
     m_rig->smokeRef        = BITMASK_IS_1(options, RigDef::Node::OPTION_y_EXHAUST_DIRECTION) ? node.pos : 0;
     m_rig->smokeId         = BITMASK_IS_1(options, RigDef::Node::OPTION_x_EXHAUST_POINT) ? node.pos : 0;
@@ -6286,8 +6468,8 @@ void RigSpawner::AddExhaust(
     exhaust.smokeNode->attachObject(exhaust.smoker);
     exhaust.smokeNode->setPosition(m_rig->nodes[exhaust.emitterNode].AbsPosition);
 
-    m_rig->nodes[emitter_node_idx].isHot = true;
-    m_rig->nodes[emitter_node_idx].isHot = true;
+    m_rig->node_attrs[emitter_node_idx].isHot = true;
+    m_rig->node_attrs[emitter_node_idx].isHot = true;
 
     m_rig->exhausts.push_back(exhaust);
 }
@@ -6313,7 +6495,7 @@ void RigSpawner::ProcessCinecam(RigDef::Cinecam & def)
 {
     SPAWNER_PROFILE_SCOPED();
 
-    if (! CheckNodeLimit(1) && ! CheckBeamLimit(8))
+    if (! CheckNodeLimit(1) || ! CheckBeamLimit(8))
     {
         return;
     }
@@ -6406,10 +6588,10 @@ bool RigSpawner::CheckNodeLimit(unsigned int count)
 {
     SPAWNER_PROFILE_SCOPED();
 
-    if ((m_rig->free_node + count) > MAX_NODES)
+    if ((m_rig->free_node + count) > m_rig->capacity.nodes)
     {
         std::stringstream msg;
-        msg << "Node limit (" << MAX_NODES << ") exceeded";
+        msg << "Node limit (" << m_rig->capacity.nodes << ") exceeded";
         AddMessage(Message::TYPE_ERROR, msg.str());
         return false;
     }
@@ -6420,10 +6602,10 @@ bool RigSpawner::CheckBeamLimit(unsigned int count)
 {
     SPAWNER_PROFILE_SCOPED();
 
-    if ((m_rig->free_beam + count) > MAX_BEAMS)
+    if ((m_rig->free_beam + count) > m_rig->capacity.beams)
     {
         std::stringstream msg;
-        msg << "Beam limit (" << MAX_BEAMS << ") exceeded";
+        msg << "Beam limit (" << m_rig->capacity.beams << ") exceeded";
         AddMessage(Message::TYPE_ERROR, msg.str());
         return false;
     }
@@ -6434,10 +6616,10 @@ bool RigSpawner::CheckShockLimit(unsigned int count)
 {
     SPAWNER_PROFILE_SCOPED();
 
-    if ((m_rig->free_shock + count) > MAX_SHOCKS)
+    if ((m_rig->free_shock + count) > m_rig->capacity.shocks)
     {
         std::stringstream msg;
-        msg << "Shock limit (" << MAX_SHOCKS << ") exceeded";
+        msg << "Shock limit (" << m_rig->capacity.shocks << ") exceeded";
         AddMessage(Message::TYPE_ERROR, msg.str());
         return false;
     }
@@ -6462,10 +6644,10 @@ bool RigSpawner::CheckHydroLimit(unsigned int count)
 {
     SPAWNER_PROFILE_SCOPED();
 
-    if ((m_rig->free_shock + count) > MAX_HYDROS)
+    if ((m_rig->free_hydro + count) > m_rig->capacity.hydros)
     {
         std::stringstream msg;
-        msg << "Hydro limit (" << MAX_HYDROS << ") exceeded";
+        msg << "Hydro limit (" << m_rig->capacity.hydros << ") exceeded";
         AddMessage(Message::TYPE_ERROR, msg.str());
         return false;
     }
@@ -6591,10 +6773,10 @@ bool RigSpawner::CheckCabLimit(unsigned int count)
 {
     SPAWNER_PROFILE_SCOPED();
 
-    if ((m_rig->free_cab + count) > MAX_CABS)
+    if ((m_rig->free_cab + count) > m_rig->capacity.cabs)
     {
         std::stringstream msg;
-        msg << "Cab limit (" << MAX_CABS << ") exceeded";
+        msg << "Cab limit (" << m_rig->capacity.cabs << ") exceeded";
         AddMessage(Message::TYPE_ERROR, msg.str());
         return false;
     }
@@ -6676,6 +6858,11 @@ node_t &RigSpawner:: GetNode(unsigned int node_index)
     return m_rig->nodes[node_index];
 }
 
+node_attr_t & RigSpawner::GetNodeAttr(node_t & node)
+{
+    return m_rig->node_attrs[node.pos];
+}
+
 void RigSpawner::InitNode(unsigned int node_index, Ogre::Vector3 const & position)
 {
     SPAWNER_PROFILE_SCOPED();
@@ -6688,11 +6875,23 @@ beam_t & RigSpawner::GetBeam(unsigned int index)
     return m_rig->beams[index];
 }
 
+void RigSpawner::ThrowCapacityExceeded(const char* element, int capacity)
+{
+    // The rig arrays are sized exactly by CalcRigCapacity(); never write past them, fail the spawn instead.
+    m_capacity_exceeded = true;
+    std::stringstream msg;
+    msg << element << " limit (" << capacity << ") exceeded, vehicle can't be spawned";
+    throw Exception(msg.str());
+}
+
 node_t & RigSpawner::GetFreeNode()
 {
     SPAWNER_PROFILE_SCOPED();
 
-    CheckNodeLimit(1);
+    if (m_rig->free_node >= m_rig->capacity.nodes)
+    {
+        this->ThrowCapacityExceeded("Node", m_rig->capacity.nodes);
+    }
     node_t & node = m_rig->nodes[m_rig->free_node];
     node.pos = m_rig->free_node;
     m_rig->free_node++;
@@ -6703,7 +6902,10 @@ beam_t & RigSpawner::GetFreeBeam()
 {
     SPAWNER_PROFILE_SCOPED();
 
-    CheckBeamLimit(1);
+    if (m_rig->free_beam >= m_rig->capacity.beams)
+    {
+        this->ThrowCapacityExceeded("Beam", m_rig->capacity.beams);
+    }
     beam_t & beam = m_rig->beams[m_rig->free_beam];
     m_rig->free_beam++;
     return beam;
@@ -6713,11 +6915,28 @@ shock_t & RigSpawner::GetFreeShock()
 {
     SPAWNER_PROFILE_SCOPED();
 
+    if (m_rig->free_shock >= m_rig->capacity.shocks)
+    {
+        this->ThrowCapacityExceeded("Shock", m_rig->capacity.shocks);
+    }
     shock_t & shock = m_rig->shocks[m_rig->free_shock];
     m_rig->free_shock++;
     return shock;
 }
 
+contacter_t & RigSpawner::GetFreeContacter()
+{
+    SPAWNER_PROFILE_SCOPED();
+
+    if (m_rig->free_contacter >= m_rig->capacity.contacters)
+    {
+        this->ThrowCapacityExceeded("Contacter", m_rig->capacity.contacters);
+    }
+    contacter_t & contacter = m_rig->contacters[m_rig->free_contacter];
+    m_rig->free_contacter++;
+    return contacter;
+}
+
 beam_t & RigSpawner::GetAndInitFreeBeam(node_t & node_1, node_t & node_2)
 {
     SPAWNER_PROFILE_SCOPED();
@@ -148,6 +148,7 @@ public:
     int GetMessagesNumErrors()   const { return m_messages_num_errors;   }
     int GetMessagesNumWarnings() const { return m_messages_num_warnings; }
     int GetMessagesNumOther()    const { return m_messages_num_other;    }
+    bool WasCapacityExceeded()   const { return m_capacity_exceeded;     }
 
     static bool CheckSoundScriptLimit(Beam *vehicle, unsigned int count);
 
@@ -776,6 +777,11 @@ private:
     */
     node_t & GetNode(unsigned int node_index);
 
+    /**
+    * Gets the cold attributes of an existing node.
+    */
+    node_attr_t & GetNodeAttr(node_t & node);
+
     /**
     * Sets up defaults & position of a node.
     */
@@ -840,6 +846,13 @@ private:
 
     shock_t & GetFreeShock();
 
+    contacter_t & GetFreeContacter();
+
+    /**
+    * Marks the spawn as failed and throws; called when an array sized by CalcRigCapacity() is full.
+    */
+    void ThrowCapacityExceeded(const char* element, int capacity);
+
     /**
     * Sets up nodes & length of a beam.
     */
@@ -1064,6 +1077,16 @@ private:
     */
     void InitializeRig();
 
+    /**
+    * Counts how many nodes, beams etc. the selected modules will generate at most.
+    */
+    rig_capacity_t CalcRigCapacity();
+
+    /**
+    * Allocates zeroed per-rig arrays (rig_t::nodes, rig_t::beams...) in one block.
+    */
+    void AllocateRigArrays(rig_capacity_t const & capacity);
+
     std::shared_ptr<RigDef::File> m_file; //!< The parsed input file.
     int m_cache_entry_number;
     Beam *m_rig; //!< The output rig.
@@ -1072,6 +1095,8 @@ private:
 
     bool m_enable_background_loading;
     bool m_apply_simple_materials;
+    bool m_headless; //!< Physics only: no meshes, particles, lights or skidmarks
+    bool m_capacity_exceeded; //!< An array sized by CalcRigCapacity() was too small; the rig is incomplete and must not be used
     Ogre::MaterialPtr m_simple_material_base;
 
     // Logging
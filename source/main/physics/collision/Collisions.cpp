@@ -34,6 +34,10 @@
 #include "Settings.h"
 #include "TerrainManager.h"
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
 // some gcc fixes
 #if OGRE_PLATFORM == OGRE_PLATFORM_LINUX
 #pragma GCC diagnostic ignored "-Wfloat-equal"
@@ -121,25 +125,19 @@ Collisions::Collisions(RoRFrameListener* sim_controller)
     , free_collision_tri(0)
     , free_eventsource(0)
     , hashmask(0)
+    , hashtable_used(0)
+    , cell_elements_unused(0)
+    , lookup_ns(0.0f)
     , landuse(0)
     , largest_cellcount(0)
     , last_called_cbox(0)
     , last_used_ground_model(0)
     , max_col_tris(MAX_COLLISION_TRIS)
 {
-    hFinder = gEnv->terrainManager->getHeightFinder();
+    hFinder = (gEnv->terrainManager) ? gEnv->terrainManager->getHeightFinder() : nullptr; // Headless mode sets its own, see setHeightFinder()
 
-    debugMode = RoR::App::diag_collisions.GetActive(); // TODO: make interactive - do not copy the value, use GVar directly
-    for (int i=0; i < HASH_POWER; i++)
-    {
-        hashmask = hashmask << 1;
-        hashmask++;
-    }
-
-    for (int i=0; i < HASH_SIZE; i++)
-    {
-        hashtable[i].cellid = UNUSED_CELLID; // conversion from 'const int' to 'unsigned int', signed/unsigned mismatch!
-    }
+    debugMode = RoR::App::diag_collisions.GetActive() && !RoR::App::app_headless.GetActive(); // TODO: make interactive - do not copy the value, use GVar directly
+    hash_rebuild(HASH_INITIAL_SIZE);
 
     collision_tris = (collision_tri_t*)malloc(sizeof(collision_tri_t) * MAX_COLLISION_TRIS);
 
@@ -156,10 +154,32 @@ Collisions::Collisions(RoRFrameListener* sim_controller)
 
 Collisions::~Collisions()
 {
+#ifdef USE_ANGELSCRIPT
+    // Queued callbacks point into 'eventsources'
+    ScriptEngine::getSingleton().discardCallbacks();
+#endif //USE_ANGELSCRIPT
+}
+
+void Collisions::syncWithSimThread()
+{
+    // The physics task reads the cell table, boxes and tris without locking. Everything that
+    // modifies them runs on the main thread and waits for the task first; while no task is
+    // in flight (e.g. during terrain load) this returns immediately.
+    if (m_sim_controller)
+    {
+        m_sim_controller->GetBeamFactory()->SyncWithSimThread();
+    }
+}
+
+bool Collisions::isSimTaskRunning()
+{
+    return m_sim_controller && m_sim_controller->GetBeamFactory()->IsSimTaskRunning();
 }
 
 void Collisions::resizeMemory(long newSize)
 {
+    this->syncWithSimThread();
+
     if (collision_tris)
     {
         free(collision_tris);
@@ -401,6 +421,8 @@ int Collisions::removeCollisionTri(int number)
 {
     if (number > free_collision_tri) return -1;
 
+    this->syncWithSimThread();
+
     Vector3 p1 = collision_tris[number].a;
     Vector3 p2 = collision_tris[number].b;
     Vector3 p3 = collision_tris[number].c;
@@ -432,20 +454,29 @@ int Collisions::removeCollisionTri(int number)
 
 void Collisions::hash_free(int cell_x, int cell_z, int value)
 {
+    assert(!this->isSimTaskRunning() && "hash_free(): the physics task reads the cell table, see syncWithSimThread()");
+
     unsigned int cellid = (cell_x << 16) + cell_z;
     unsigned int pos    = hashfunc(cellid);
 
-    // set cell to free state
-    if (hashtable[pos].cellid != UNUSED_CELLID)
+    // find the cell
+    while (hashtable[pos].cellid != UNUSED_CELLID && hashtable[pos].cellid != cellid)
+    {
+        pos = (pos + 1) & hashmask;
+    }
+
+    if (hashtable[pos].cellid == cellid)
     {
-        cell_t *cell = hashtable[pos].cell;
+        hash_t& slot = hashtable[pos];
+        int* elements = &cell_elements[slot.begin];
         // cell has content, search it
-        for (unsigned int i=0; i < cell->size(); i++)
+        for (unsigned int i=0; i < slot.count; i++)
         {
-            if ((*cell)[i] == value)
+            if (elements[i] == value)
             {
-                // remove that element
-                cell->erase(cell->begin() + i);
+                // remove that element, keeping the order of the others
+                std::copy(elements + i + 1, elements + slot.count, elements + i);
+                slot.count--;
                 break;
             }
         }
@@ -454,69 +485,124 @@ void Collisions::hash_free(int cell_x, int cell_z, int value)
 
 void Collisions::hash_add(int cell_x, int cell_z, int value)
 {
+    assert(!this->isSimTaskRunning() && "hash_add(): the physics task reads the cell table, see syncWithSimThread()");
+
+    // keep the table at most half full, so probe sequences stay short
+    if ((hashtable_used + 1) * 2 > (int)hashtable.size())
+    {
+        hash_rebuild(hashtable.size() * 2);
+    }
+
     unsigned int cellid = (cell_x << 16) + cell_z;
     unsigned int pos    = hashfunc(cellid);
 
-    // Cycle through hashtable: start at pos
-    for (unsigned int i=0; i < HASH_SIZE; i++)
+    while (hashtable[pos].cellid != UNUSED_CELLID && hashtable[pos].cellid != cellid)
     {
-        if (hashtable[pos].cellid == UNUSED_CELLID || hashtable[pos].cellid == cellid)
-            break;
-
-        pos++;
-        if (pos >= HASH_SIZE) pos = 0;
+        pos = (pos + 1) & hashmask;
     }
 
-    if (hashtable[pos].cellid == UNUSED_CELLID)
+    hash_t& slot = hashtable[pos];
+    if (slot.cellid == UNUSED_CELLID)
     {
-        // create a new cell
-        cell_t* newcell = new cell_t;
-        
-        hashtable[pos].cellid = cellid;
-        hashtable[pos].cell = newcell;
-        newcell->push_back(value);
-        cells.push_back(newcell);
+        // create a new cell at the end of the pool
+        slot.cellid = cellid;
+        slot.begin = (unsigned int)cell_elements.size();
+        slot.count = 0;
+        slot.capacity = 1;
+        cell_elements.push_back(0);
+        hashtable_used++;
         if (pos != hashfunc(cellid))
         {
             collision_count++;
         }
-        largest_cellcount = std::max(largest_cellcount, (int)newcell->size());
-    } else if (hashtable[pos].cellid == cellid)
-    {
-        // there is already a cell ready
-        hashtable[pos].cell->push_back(value);
-        largest_cellcount = std::max(largest_cellcount, (int)hashtable[pos].cell->size());
-    } else
+    }
+    else if (slot.count == slot.capacity)
     {
-        LOG("COLL: The hashtable is full.");
+        // cell is full, move it to the end of the pool with room to grow
+        unsigned int new_begin = (unsigned int)cell_elements.size();
+        cell_elements.resize(cell_elements.size() + slot.capacity * 2);
+        std::copy(cell_elements.begin() + slot.begin, cell_elements.begin() + slot.begin + slot.count, cell_elements.begin() + new_begin);
+        cell_elements_unused += slot.capacity;
+        slot.begin = new_begin;
+        slot.capacity *= 2;
     }
+
+    cell_elements[slot.begin + slot.count] = value;
+    slot.count++;
+    largest_cellcount = std::max(largest_cellcount, (int)slot.count);
 }
 
-cell_t *Collisions::hash_find(int cell_x, int cell_z)
+bool Collisions::hash_find(int cell_x, int cell_z, cell_t& cell)
 {
     unsigned int cellid = (cell_x << 16) + cell_z;
     unsigned int pos    = hashfunc(cellid);
 
-    // Cycle through hashtable: start at pos
-    for (unsigned int i=0; i < HASH_SIZE; i++)
+    // the table always has free slots, so this terminates
+    while (hashtable[pos].cellid != cellid)
     {
         if (hashtable[pos].cellid == UNUSED_CELLID)
-            return NULL;
+            return false;
+        pos = (pos + 1) & hashmask;
+    }
 
-        if (hashtable[pos].cellid == cellid)
-            return hashtable[pos].cell;
+    cell.elements = cell_elements.data() + hashtable[pos].begin;
+    cell.count = hashtable[pos].count;
+    return true;
+}
 
-        pos++;
-        if (pos >= HASH_SIZE) pos = 0;
-    }
+void Collisions::hash_rebuild(size_t table_size)
+{
+    assert(!this->isSimTaskRunning() && "hash_rebuild(): the physics task reads the cell table, see syncWithSimThread()");
+
+    // Re-insert all cells into a table of the given size, ordered by cell id so that
+    // neighbouring cells end up next to each other in the pool, and drop unused slots.
+    std::vector<hash_t> old_table;
+    old_table.swap(hashtable);
+    std::sort(old_table.begin(), old_table.end(), [](const hash_t& a, const hash_t& b) { return a.cellid < b.cellid; });
+
+    hash_t unused_slot = { (unsigned int)UNUSED_CELLID, 0, 0, 0 };
+    hashtable.assign(table_size, unused_slot);
+    hashmask = (unsigned int)table_size - 1;
+    collision_count = 0;
+
+    std::vector<int> elements;
+    elements.reserve(cell_elements.size() - cell_elements_unused);
+    for (const hash_t& old_slot : old_table)
+    {
+        if (old_slot.cellid == UNUSED_CELLID)
+            continue;
 
-    return NULL;
+        unsigned int pos = hashfunc(old_slot.cellid);
+        while (hashtable[pos].cellid != UNUSED_CELLID)
+        {
+            pos = (pos + 1) & hashmask;
+        }
+        if (pos != hashfunc(old_slot.cellid))
+        {
+            collision_count++;
+        }
+
+        hash_t& slot = hashtable[pos];
+        slot.cellid = old_slot.cellid;
+        slot.begin = (unsigned int)elements.size();
+        slot.count = old_slot.count;
+        slot.capacity = std::max(1u, old_slot.count);
+        elements.insert(elements.end(), cell_elements.begin() + old_slot.begin, cell_elements.begin() + old_slot.begin + old_slot.count);
+        if (old_slot.count == 0)
+        {
+            elements.push_back(0);
+        }
+    }
+    cell_elements.swap(elements);
+    cell_elements_unused = 0;
 }
 
 int Collisions::addCollisionBox(SceneNode *tenode, bool rotating, bool virt, Vector3 pos, Ogre::Vector3 rot, Ogre::Vector3 l, Ogre::Vector3 h, Ogre::Vector3 sr, const Ogre::String &eventname, const Ogre::String &instancename, bool forcecam, Ogre::Vector3 campos, Ogre::Vector3 sc /* = Vector3::UNIT_SCALE */, Ogre::Vector3 dr /* = Vector3::ZERO */, int event_filter /* = EVENT_ALL */, int scripthandler /* = -1 */)
 {
     Quaternion rotation  = Quaternion(Degree(rot.x), Vector3::UNIT_X) * Quaternion(Degree(rot.y), Vector3::UNIT_Y) * Quaternion(Degree(rot.z), Vector3::UNIT_Z);
     Quaternion direction = Quaternion(Degree(dr.x), Vector3::UNIT_X) * Quaternion(Degree(dr.y), Vector3::UNIT_Y) * Quaternion(Degree(dr.z), Vector3::UNIT_Z);
+
+    this->syncWithSimThread();
     collision_box_t& coll_box = collision_boxes[free_collision_box];
 
     coll_box.enabled = true;
@@ -780,6 +866,8 @@ int Collisions::removeCollisionBox(int num)
     if (!coll_box.enabled)
         return 2;
 
+    this->syncWithSimThread();
+
     // disable the box
     coll_box.enabled = false;
 
@@ -805,6 +893,8 @@ int Collisions::removeCollisionBox(int num)
 int Collisions::addCollisionTri(Vector3 p1, Vector3 p2, Vector3 p3, ground_model_t* gm)
 {
     if (free_collision_tri >= max_col_tris) return -1;
+
+    this->syncWithSimThread();
     collision_tris[free_collision_tri].a=p1;
     collision_tris[free_collision_tri].b=p2;
     collision_tris[free_collision_tri].c=p3;
@@ -858,11 +948,16 @@ int Collisions::addCollisionTri(Vector3 p1, Vector3 p2, Vector3 p3, ground_model
 
 void Collisions::printStats()
 {
+    size_t memory = hashtable.capacity() * sizeof(hash_t) + cell_elements.capacity() * sizeof(int);
+
     LOG("COLL: Collision system statistics:");
     LOG("COLL: Cell size: "+TOSTRING((float)CELL_SIZE)+" m");
-    LOG("COLL: Hashtable occupation: "+TOSTRING(cells.size()));
+    LOG("COLL: Hashtable occupation: "+TOSTRING(hashtable_used)+" / "+TOSTRING(hashtable.size()));
     LOG("COLL: Hashtable collisions: "+TOSTRING(collision_count));
+    LOG("COLL: Cell elements: "+TOSTRING(cell_elements.size() - cell_elements_unused)+" ("+TOSTRING(cell_elements_unused)+" unused)");
     LOG("COLL: Largest cell: "+TOSTRING(largest_cellcount));
+    LOG("COLL: Index memory: "+TOSTRING(memory / 1024)+" KiB");
+    LOG("COLL: Average lookup: "+TOSTRING(lookup_ns)+" ns");
 }
 
 bool Collisions::envokeScriptCallback(collision_box_t *cbox, node_t *node)
@@ -874,13 +969,11 @@ bool Collisions::envokeScriptCallback(collision_box_t *cbox, node_t *node)
     if (!eventsources[cbox->eventsourcenum].enabled)
         return false;
     
-    std::lock_guard<std::mutex> lock(m_scriptcallback_mutex);
     // this prevents that the same callback gets called at 2k FPS all the time, serious hit on FPS ...
-    if (last_called_cbox != cbox)
+    if (last_called_cbox.exchange(cbox) != cbox)
     {
-        if (!ScriptEngine::getSingleton().envokeCallback(eventsources[cbox->eventsourcenum].scripthandler, &eventsources[cbox->eventsourcenum], node))
-            handled = true;
-        last_called_cbox = cbox;
+        // Physics threads only queue the event, ScriptEngine::framestep() passes it to the script
+        handled = ScriptEngine::getSingleton().queueCallback(eventsources[cbox->eventsourcenum].scripthandler, &eventsources[cbox->eventsourcenum], node);
     }
 #endif //USE_ANGELSCRIPT
 
@@ -899,13 +992,16 @@ bool Collisions::collisionCorrect(Vector3 *refpos, bool envokeScriptCallbacks)
     int refx, refz;
     unsigned int k;
 
-    Vector3 mapSize = gEnv->terrainManager->getMaxTerrainSize();
-    if (!(refpos->x>0 && refpos->x<mapSize.x && refpos->z>0 && refpos->z<mapSize.z)) return false;
+    if (gEnv->terrainManager)
+    {
+        Vector3 mapSize = gEnv->terrainManager->getMaxTerrainSize();
+        if (!(refpos->x>0 && refpos->x<mapSize.x && refpos->z>0 && refpos->z<mapSize.z)) return false;
+    }
 
     refx=(int)(refpos->x/(float)CELL_SIZE);
     refz=(int)(refpos->z/(float)CELL_SIZE);
-    cell_t *cell=hash_find(refx, refz);
-    if ( !cell ) return false;
+    cell_t cell;
+    if (!hash_find(refx, refz, cell)) return false;
 
     collision_tri_t *minctri=0;
     float minctridist=100.0;
@@ -913,11 +1009,11 @@ bool Collisions::collisionCorrect(Vector3 *refpos, bool envokeScriptCallbacks)
 
     bool isScriptCallbackEnvoked = false;
 
-    for (k=0; k<cell->size(); k++)
+    for (k=0; k<cell.size(); k++)
     {
-        if ((*cell)[k] != (int)UNUSED_CELLELEMENT && (*cell)[k]<MAX_COLLISION_BOXES)
+        if (cell[k] != (int)UNUSED_CELLELEMENT && cell[k]<MAX_COLLISION_BOXES)
         {
-            collision_box_t *cbox=&collision_boxes[(*cell)[k]];
+            collision_box_t *cbox=&collision_boxes[cell[k]];
             if ( !( (*refpos) > cbox->lo && (*refpos) < cbox->hi ) ) continue;
 
             if (cbox->refined || cbox->selfrotated)
@@ -986,7 +1082,7 @@ bool Collisions::collisionCorrect(Vector3 *refpos, bool envokeScriptCallbacks)
             }
         } else
         {
-            collision_tri_t *ctri=&collision_tris[(*cell)[k]-MAX_COLLISION_BOXES];
+            collision_tri_t *ctri=&collision_tris[cell[k]-MAX_COLLISION_BOXES];
             if (!ctri->enabled)
                 continue;
             // check if this tri is minimal
@@ -1049,6 +1145,7 @@ int Collisions::enableCollisionTri(int number, bool enable)
     if (number > free_collision_tri) 
         return -1;
 
+    this->syncWithSimThread();
     collision_tris[number].enabled = enable;
     
     return 0;
@@ -1056,27 +1153,113 @@ int Collisions::enableCollisionTri(int number, bool enable)
 
 bool Collisions::nodeCollision(node_t *node, bool contacted, float dt, float* nso, ground_model_t** ogm)
 {
-    bool smoky = false;
-    // float corrf=1.0;
-    Vector3 oripos = node->AbsPosition;
-    unsigned int k;
     // find the correct cell
     int refx = (int)(node->AbsPosition.x/CELL_SIZE);
     int refz = (int)(node->AbsPosition.z/CELL_SIZE);
-    cell_t *cell = hash_find(refx, refz);
+    cell_t cell;
+    bool cell_found = hash_find(refx, refz, cell);
     //LOG("Checking cell "+TOSTRING(refx)+" "+TOSTRING(refz)+" total indexes: "+TOSTRING(num_cboxes_index[refp]));
 
+    return nodeCollisionInCell(node, cell_found ? &cell : nullptr, contacted, dt, nso, ogm);
+}
+
+void Collisions::nodeCollisions(node_collision_t* queries, int count)
+{
+    struct cell_query_t
+    {
+        unsigned int cellid;
+        int cell_x;
+        int cell_z;
+        int index;
+    };
+
+    // scratch space, reused across calls; trucks are simulated in parallel
+    static thread_local std::vector<cell_query_t> order;
+    static thread_local std::vector<float> xs, zs, sorted_heights, heights;
+    static thread_local std::vector<cell_t> cells;
+
+    if (count <= 0)
+        return;
+
+    // sort the nodes by cell, so that nodes sharing a cell share the lookup
+    order.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        const Vector3& pos = queries[i].node->AbsPosition;
+        cell_query_t& q = order[i];
+        q.cell_x = (int)(pos.x/CELL_SIZE);
+        q.cell_z = (int)(pos.z/CELL_SIZE);
+        q.cellid = (q.cell_x << 16) + q.cell_z;
+        q.index = i;
+    }
+    std::sort(order.begin(), order.end(), [](const cell_query_t& a, const cell_query_t& b)
+        {
+            return a.cellid < b.cellid || (a.cellid == b.cellid && a.index < b.index);
+        });
+
+    cells.resize(count);
+    cell_t cell = { nullptr, 0 };
+    bool cell_found = false;
+    for (int j = 0; j < count; j++)
+    {
+        if (j == 0 || order[j].cellid != order[j - 1].cellid)
+        {
+            cell_found = hash_find(order[j].cell_x, order[j].cell_z, cell);
+        }
+        cells[order[j].index] = cell_found ? cell : cell_t{ nullptr, 0 };
+    }
+
+    // terrain heights, in the same spatial order
+    heights.resize(count);
+    if (hFinder)
+    {
+        xs.resize(count);
+        zs.resize(count);
+        sorted_heights.resize(count);
+        for (int j = 0; j < count; j++)
+        {
+            const Vector3& pos = queries[order[j].index].node->AbsPosition;
+            xs[j] = pos.x;
+            zs[j] = pos.z;
+        }
+        hFinder->getHeightsAt(xs.data(), zs.data(), sorted_heights.data(), count);
+        for (int j = 0; j < count; j++)
+        {
+            heights[order[j].index] = sorted_heights[j];
+        }
+    }
+
+    // resolve in node order, so events and results come out as from the per-node calls
+    for (int i = 0; i < count; i++)
+    {
+        node_collision_t& q = queries[i];
+        q.gm = nullptr;
+        q.ns = 0.0f;
+        bool contacted = hFinder && groundCollisionAt(q.node, heights[i], q.dt, &q.gm, &q.ns);
+        // don't mess with this construct, the binary operator is intentional!
+        q.contacted = contacted | nodeCollisionInCell(q.node, (cells[i].elements != nullptr) ? &cells[i] : nullptr, contacted, q.dt, &q.ns, &q.gm);
+    }
+}
+
+bool Collisions::nodeCollisionInCell(node_t *node, const cell_t* found_cell, bool contacted, float dt, float* nso, ground_model_t** ogm)
+{
+    bool smoky = false;
+    // float corrf=1.0;
+    Vector3 oripos = node->AbsPosition;
+    unsigned int k;
+
     collision_tri_t *minctri = 0;
     float minctridist = 100.0;
     Vector3 minctripoint;
 
-    if (cell)
+    if (found_cell)
     {
-        for (k=0; k<cell->size(); k++)
+        const cell_t& cell = *found_cell;
+        for (k=0; k<cell.size(); k++)
         {
-            if ((*cell)[k] != (int)UNUSED_CELLELEMENT && (*cell)[k] < MAX_COLLISION_BOXES)
+            if (cell[k] != (int)UNUSED_CELLELEMENT && cell[k] < MAX_COLLISION_BOXES)
             {
-                collision_box_t *cbox = &collision_boxes[(*cell)[k]];
+                collision_box_t *cbox = &collision_boxes[cell[k]];
                 if (node->AbsPosition > cbox->lo && node->AbsPosition < cbox->hi)
                 {
                     if (cbox->refined || cbox->selfrotated)
@@ -1179,7 +1362,7 @@ bool Collisions::nodeCollision(node_t *node, bool contacted, float dt, float* ns
             } else
             {
                 // tri collision
-                collision_tri_t *ctri=&collision_tris[(*cell)[k]-MAX_COLLISION_BOXES];
+                collision_tri_t *ctri=&collision_tris[cell[k]-MAX_COLLISION_BOXES];
                 // check if this tri is minimal
                 // transform
                 Vector3 point=ctri->forward*(node->AbsPosition-ctri->a);
@@ -1356,13 +1539,18 @@ bool Collisions::isInside(Vector3 pos, collision_box_t *cbox, float border)
 bool Collisions::groundCollision(node_t *node, float dt, ground_model_t** ogm, float *nso)
 {
     if (!hFinder) return false;
+    return groundCollisionAt(node, hFinder->getHeightAt(node->AbsPosition.x, node->AbsPosition.z), dt, ogm, nso);
+}
+
+bool Collisions::groundCollisionAt(node_t *node, float height, float dt, ground_model_t** ogm, float *nso)
+{
     if (landuse) *ogm = landuse->getGroundModelAt(node->AbsPosition.x, node->AbsPosition.z);
     // when landuse fails or we don't have it, use the default value
     if (!*ogm) *ogm = defaultgroundgm;
     last_used_ground_model = *ogm;
 
     // new ground collision code
-    Real v = hFinder->getHeightAt(node->AbsPosition.x, node->AbsPosition.z);
+    Real v = height;
     if (v > node->AbsPosition.y)
     {
         // collision!
@@ -1528,8 +1716,8 @@ int Collisions::createCollisionDebugVisualization()
         {
             int cellx = (int)(x/(float)CELL_SIZE);
             int cellz = (int)(z/(float)CELL_SIZE);
-            cell_t *cell=hash_find(cellx, cellz);
-            if (cell)
+            cell_t cell;
+            if (hash_find(cellx, cellz, cell))
             {
                 float groundheight = -9999;
                 float x2 = x+CELL_SIZE;
@@ -1552,7 +1740,7 @@ int Collisions::createCollisionDebugVisualization()
                 // ground height should fit
 
                 //int deep = 0;
-                int cc = (int)cell->size();
+                int cc = (int)cell.size();
                 float percent = cc / (float)CELL_BLOCKSIZE;
 
                 float percentd = percent;
@@ -1613,39 +1801,60 @@ int Collisions::createCollisionDebugVisualization()
     return 0;
 }
 
+const Collisions::collision_mesh_t& Collisions::getCollisionMesh(const Ogre::String& meshname)
+{
+    auto found = collision_meshes.find(meshname);
+    if (found != collision_meshes.end())
+        return found->second;
+
+    MeshPtr mesh = MeshManager::getSingleton().load(meshname, ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME);
+
+    size_t vertex_count,index_count;
+    Vector3* vertices;
+    unsigned* indices;
+
+    getMeshInformation(mesh.getPointer(),vertex_count,vertices,index_count,indices);
+
+    collision_mesh_t& cmesh = collision_meshes[meshname];
+    cmesh.vertices.assign(vertices, vertices + vertex_count);
+    cmesh.indices.assign(indices, indices + index_count);
+
+    delete[] vertices;
+    delete[] indices;
+    return cmesh;
+}
+
 int Collisions::addCollisionMesh(Ogre::String meshname, Ogre::Vector3 pos, Ogre::Quaternion q, Ogre::Vector3 scale, ground_model_t *gm, std::vector<int> *collTris)
 {
     // normal, non virtual collision box
-    Entity *ent = gEnv->sceneManager->createEntity(meshname);
-    ent->setMaterialName("tracks/debug/collision/mesh");
-
     if (!gm)
     {
         gm = getGroundModelByString("concrete");
     }
 
-    size_t vertex_count,index_count;
-    Vector3* vertices;
-    unsigned* indices;
+    const collision_mesh_t& cmesh = getCollisionMesh(meshname);
 
-    getMeshInformation(ent->getMesh().getPointer(),vertex_count,vertices,index_count,indices, pos, q, scale);
+    std::vector<Vector3> vertices(cmesh.vertices.size());
+    for (size_t i = 0; i < cmesh.vertices.size(); i++)
+    {
+        vertices[i] = (q * (cmesh.vertices[i] * scale)) + pos;
+    }
 
     //LOG(LML_NORMAL,"Vertices in mesh: %u",vertex_count);
     //LOG(LML_NORMAL,"Triangles in mesh: %u",index_count / 3);
-    for (int i=0; i<(int)index_count/3; i++)
+    const std::vector<unsigned>& indices = cmesh.indices;
+    for (int i=0; i<(int)indices.size()/3; i++)
     {
         int triID = addCollisionTri(vertices[indices[i*3]], vertices[indices[i*3+1]], vertices[indices[i*3+2]], gm);
         if (collTris)
             collTris->push_back(triID);
     }
 
-    delete[] vertices;
-    delete[] indices;
-    if (!debugMode)
-    {
-        gEnv->sceneManager->destroyEntity(ent);
-    } else
+    if (debugMode)
     {
+        Entity *ent = gEnv->sceneManager->createEntity(meshname);
+        ent->setMaterialName("tracks/debug/collision/mesh");
+
         SceneNode *n=gEnv->sceneManager->getRootSceneNode()->createChildSceneNode();
         n->attachObject(ent);
         n->setPosition(pos);
@@ -1787,6 +1996,49 @@ void Collisions::getMeshInformation(Mesh* mesh,size_t &vertex_count,Vector3* &ve
 
 void Collisions::finishLoadingTerrain()
 {
+    // Static geometry is complete: pack the cells tightly, in cell id order, into a table twice the
+    // number of used cells. Objects added later (scripts, roads) go to the end of the pool again.
+    this->syncWithSimThread();
+    size_t table_size = HASH_INITIAL_SIZE;
+    while (table_size < (size_t)hashtable_used * 2 + 1)
+    {
+        table_size *= 2;
+    }
+    hash_rebuild(table_size);
+
+    largest_cellcount = 0;
+    for (const hash_t& slot : hashtable)
+    {
+        if (slot.cellid != UNUSED_CELLID)
+        {
+            largest_cellcount = std::max(largest_cellcount, (int)slot.count);
+        }
+    }
+
+    // measure lookup latency on random cells across the terrain
+    Vector3 mapSize = gEnv->terrainManager->getMaxTerrainSize();
+    int max_cell_x = std::max(1, (int)(mapSize.x / CELL_SIZE));
+    int max_cell_z = std::max(1, (int)(mapSize.z / CELL_SIZE));
+    const int num_lookups = 100000;
+    unsigned int seed = 12345;
+    unsigned int found = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_lookups; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        int cell_x = (seed >> 8) % max_cell_x;
+        seed = seed * 1664525u + 1013904223u;
+        int cell_z = (seed >> 8) % max_cell_z;
+        cell_t cell;
+        if (hash_find(cell_x, cell_z, cell))
+        {
+            found += cell.size();
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start);
+    lookup_ns = elapsed.count() / (float)num_lookups;
+    LOG("COLL: Lookup benchmark: " + TOSTRING(num_lookups) + " lookups, " + TOSTRING(found) + " elements seen");
+
     if (debugMode)
     {
         SceneNode *debugsn = gEnv->sceneManager->getRootSceneNode()->createChildSceneNode();
@@ -33,7 +33,7 @@
 #include <OgreSceneNode.h>
 #include <OgreQuaternion.h>
 
-#include <mutex>
+#include <atomic>
 
 struct eventsource_t
 {
@@ -46,7 +46,18 @@ struct eventsource_t
     bool enabled;
 };
 
-typedef std::vector<int> cell_t;
+/// Contents of one collision grid cell: collision box indices and collision tri indices + MAX_COLLISION_BOXES.
+/// Points into Collisions' flat element storage; only valid until the next collision box/tri is added or removed.
+/// Those changes wait for the physics task (see Collisions::syncWithSimThread()), and script callbacks only
+/// queue their events during a physics pass, so a physics pass can hold cells.
+struct cell_t
+{
+    const int* elements;
+    unsigned int count;
+
+    unsigned int size() const { return count; }
+    int operator[](unsigned int i) const { return elements[i]; }
+};
 
 class Landusemap;
 
@@ -69,10 +80,13 @@ public:
 
 private:
 
+    /// Slot of the open-addressing cell table; the cell's elements are [begin, begin+count) in 'cell_elements'
     struct hash_t
     {
         unsigned int cellid;
-        cell_t* cell;
+        unsigned int begin;
+        unsigned int count;
+        unsigned int capacity; //!< Slots reserved at 'begin'; cells which outgrow it move to the end of 'cell_elements'
     };
 
     struct collision_tri_t
@@ -86,12 +100,18 @@ private:
         bool enabled;
     };
 
+    /// Untransformed geometry of a collision mesh, triangle list
+    struct collision_mesh_t
+    {
+        std::vector<Ogre::Vector3> vertices;
+        std::vector<unsigned> indices;
+    };
+
     static const int LATEST_GROUND_MODEL_VERSION = 3;
     static const int MAX_EVENT_SOURCE = 500;
 
-    // this is a power of two, change with caution
-    static const int HASH_POWER = 20;
-    static const int HASH_SIZE = 1 << HASH_POWER;
+    // initial size of the cell table, a power of two; grows with the number of used cells
+    static const int HASH_INITIAL_SIZE = 1 << 10;
 
     // how many elements per cell? power of 2 minus 2 is better
     static const int CELL_BLOCKSIZE = 126;
@@ -109,22 +129,28 @@ private:
 
     // collision boxes pool
     collision_box_t collision_boxes[MAX_COLLISION_BOXES];
-    collision_box_t* last_called_cbox;
+    std::atomic<collision_box_t*> last_called_cbox; //!< Last box which queued a script callback, written by physics threads
     int free_collision_box;
 
     // collision tris pool;
     collision_tri_t* collision_tris;
     int free_collision_tri;
 
-    // collision hashtable
-    hash_t hashtable[HASH_SIZE];
+    // collision hashtable: linear probing, at most half full
+    std::vector<hash_t> hashtable;
+    int hashtable_used;
 
-    // cell pool
-    std::vector<cell_t*> cells;
+    // cell pool: contents of all cells, back to back
+    std::vector<int> cell_elements;
+    size_t cell_elements_unused;   //!< Slots left behind by relocated cells
+    float lookup_ns;               //!< Average hash_find() time, measured in finishLoadingTerrain()
 
     // ground models
     std::map<Ogre::String, ground_model_t> ground_models;
 
+    // collision meshes, read from the vertex buffers once per mesh name
+    std::map<Ogre::String, collision_mesh_t> collision_meshes;
+
     // event sources
     eventsource_t eventsources[MAX_EVENT_SOURCE];
     int free_eventsource;
@@ -142,19 +168,25 @@ private:
     long max_col_tris;
     unsigned int hashmask;
 
+    /// Waits for the async physics task; must precede any change to boxes, tris or the cell table.
+    void syncWithSimThread();
+    bool isSimTaskRunning();
+
     void hash_add(int cell_x, int cell_z, int value);
     void hash_free(int cell_x, int cell_z, int value);
-    cell_t* hash_find(int cell_x, int cell_z);
+    bool hash_find(int cell_x, int cell_z, cell_t& cell);
+    bool groundCollisionAt(node_t* node, float height, float dt, ground_model_t** ogm, float* nso);
+    bool nodeCollisionInCell(node_t* node, const cell_t* cell, bool contacted, float dt, float* nso, ground_model_t** ogm);
     unsigned int hashfunc(unsigned int cellid);
+    void hash_rebuild(size_t table_size);
     void parseGroundConfig(Ogre::ConfigFile* cfg, Ogre::String groundModel = "");
 
+    const collision_mesh_t& getCollisionMesh(const Ogre::String& meshname);
+
     Ogre::Vector3 calcCollidedSide(const Ogre::Vector3& pos, const Ogre::Vector3& lo, const Ogre::Vector3& hi);
 
 public:
 
-    
-
-    std::mutex m_scriptcallback_mutex;
 
     bool forcecam;
     Ogre::Vector3 forcecampos;
@@ -176,6 +208,9 @@ public:
     bool isInside(Ogre::Vector3 pos, const Ogre::String& inst, const Ogre::String& box, float border = 0);
     bool isInside(Ogre::Vector3 pos, collision_box_t* cbox, float border = 0);
     bool nodeCollision(node_t* node, bool contacted, float dt, float* nso, ground_model_t** ogm);
+    /// Same as groundCollision() followed by nodeCollision() for each node, in order, but with
+    /// one terrain height query for the whole batch and one hash lookup per occupied cell.
+    void nodeCollisions(node_collision_t* queries, int count);
 
     void clearEventCache();
     void finishLoadingTerrain();
@@ -193,6 +228,8 @@ public:
     int loadDefaultModels();
     int loadGroundModelsConfigFile(Ogre::String filename);
     std::map<Ogre::String, ground_model_t>* getGroundModels() { return &ground_models; };
+    IHeightFinder* getHeightFinder() { return hFinder; };
+    void setHeightFinder(IHeightFinder* hfinder) { hFinder = hfinder; };
     void setupLandUse(const char* configfile);
     ground_model_t* getGroundModelByString(const Ogre::String name);
     ground_model_t* last_used_ground_model;
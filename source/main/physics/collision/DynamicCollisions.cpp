@@ -143,6 +143,9 @@ void interTruckCollisions(const float dt, PointColDetector &interPointCD,
         const int numtrucks,
         ground_model_t &submesh_ground_model)
 {
+    // Collect the triangles due for testing, then query them all in one traversal.
+    // Collision forces don't move any node, so the hits are the same as with per-triangle queries.
+    interPointCD.batch_queries.clear();
     for (int i=0; i<free_collcab; i++)
     {
         if (inter_collcabrate[i].rate > 0)
@@ -154,25 +157,34 @@ void interTruckCollisions(const float dt, PointColDetector &interPointCD,
         inter_collcabrate[i].rate = std::min(inter_collcabrate[i].distance, 12);
         inter_collcabrate[i].distance = 0;
 
+        int tmpv = collcabs[i]*3;
+        interPointCD.add_batch_query(nodes[cabs[tmpv]].AbsPosition
+                , nodes[cabs[tmpv+1]].AbsPosition
+                , nodes[cabs[tmpv+2]].AbsPosition, collrange, i);
+    }
+    interPointCD.query_batch();
+
+    for (int q=0; q<static_cast<int>(interPointCD.batch_queries.size()); q++)
+    {
+        const int i = interPointCD.batch_queries[q].tag;
+        const int hit_begin = interPointCD.batch_hit_offsets[q];
+        const int hit_end = interPointCD.batch_hit_offsets[q+1];
+
         int tmpv = collcabs[i]*3;
         const auto no = &nodes[cabs[tmpv]];
         const auto na = &nodes[cabs[tmpv+1]];
         const auto nb = &nodes[cabs[tmpv+2]];
 
-        interPointCD.query(no->AbsPosition
-                , na->AbsPosition
-                , nb->AbsPosition, collrange);
-
-        if (interPointCD.hit_count > 0)
+        if (hit_end > hit_begin)
         {
             // setup transformation of points to triangle local coordinates
             const Triangle triangle(na->AbsPosition, nb->AbsPosition, no->AbsPosition);
             const CartesianToTriangleTransform transform(triangle);
 
-            for (int h=0; h<interPointCD.hit_count; h++)
+            for (int h=hit_begin; h<hit_end; h++)
             {
-                const auto hitnodeid = interPointCD.hit_list[h]->nodeid;
-                const auto hittruckid = interPointCD.hit_list[h]->truckid;
+                const auto hitnodeid = interPointCD.batch_hit_list[h]->nodeid;
+                const auto hittruckid = interPointCD.batch_hit_list[h]->truckid;
                 const auto hitnode = &trucks[hittruckid]->nodes[hitnodeid];
                 const auto hittruck = trucks[hittruckid];
 
@@ -218,6 +230,8 @@ void intraTruckCollisions(const float dt, PointColDetector &intraPointCD,
         const float collrange,
         ground_model_t &submesh_ground_model)
 {
+    // Collect the triangles due for testing, then query them all in one traversal (see interTruckCollisions())
+    intraPointCD.batch_queries.clear();
     for (int i=0; i<free_collcab; i++)
     {
         if (intra_collcabrate[i].rate > 0)
@@ -232,26 +246,35 @@ void intraTruckCollisions(const float dt, PointColDetector &intraPointCD,
             intra_collcabrate[i].distance = 0;
         }
 
+        int tmpv = collcabs[i]*3;
+        intraPointCD.add_batch_query(nodes[cabs[tmpv]].AbsPosition
+                , nodes[cabs[tmpv+1]].AbsPosition
+                , nodes[cabs[tmpv+2]].AbsPosition, collrange, i);
+    }
+    intraPointCD.query_batch();
+
+    for (int q=0; q<static_cast<int>(intraPointCD.batch_queries.size()); q++)
+    {
+        const int i = intraPointCD.batch_queries[q].tag;
+        const int hit_begin = intraPointCD.batch_hit_offsets[q];
+        const int hit_end = intraPointCD.batch_hit_offsets[q+1];
+
         int tmpv = collcabs[i]*3;
         const auto no = &nodes[cabs[tmpv]];
         const auto na = &nodes[cabs[tmpv+1]];
         const auto nb = &nodes[cabs[tmpv+2]];
 
-        intraPointCD.query(no->AbsPosition
-                , na->AbsPosition
-                , nb->AbsPosition, collrange);
-
         bool collision = false;
 
-        if (intraPointCD.hit_count > 0)
+        if (hit_end > hit_begin)
         {
             // setup transformation of points to triangle local coordinates
             const Triangle triangle(na->AbsPosition, nb->AbsPosition, no->AbsPosition);
             const CartesianToTriangleTransform transform(triangle);
 
-            for (int h=0; h<intraPointCD.hit_count; h++)
+            for (int h=hit_begin; h<hit_end; h++)
             {
-                const auto hitnodeid = intraPointCD.hit_list[h]->nodeid;
+                const auto hitnodeid = intraPointCD.batch_hit_list[h]->nodeid;
                 const auto hitnode = &nodes[hitnodeid];
 
                 //ignore wheel/chassis self contact
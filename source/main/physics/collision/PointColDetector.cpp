@@ -22,22 +22,56 @@
 
 #include "Beam.h"
 
-// Microsoft Visual Studio 2010 doesn't have std::log2
-// Version macros: http://stackoverflow.com/a/70630
-#if defined(WIN32) && defined(_MSC_VER) && _MSC_VER >= 1600
-    double mini_log2(double n)
-    {
-        return log(n) / log(2.f);
-    }
-#   define LOG2(n) (mini_log2(n))
-#else
-#   define LOG2(n) (std::log2(n))
+#include <algorithm>
+
+#ifdef POINTCD_VALIDATE_QUERIES
+#   include "Application.h"
 #endif
 
 using namespace Ogre;
 
+const float PointColDetector::REBUILD_RATIO = 1.5f;
+
+static inline bool BoxesOverlap(const float amin[3], const float amax[3], const Vector3& bmin, const Vector3& bmax)
+{
+    return amin[0] <= bmax.x && amax[0] >= bmin.x
+        && amin[1] <= bmax.y && amax[1] >= bmin.y
+        && amin[2] <= bmax.z && amax[2] >= bmin.z;
+}
+
+static inline bool PointInBox(const float* point, const Vector3& bmin, const Vector3& bmax)
+{
+    return point[0] >= bmin.x && point[0] <= bmax.x
+        && point[1] >= bmin.y && point[1] <= bmax.y
+        && point[2] >= bmin.z && point[2] <= bmax.z;
+}
+
+static inline float SurfaceArea(const float bmin[3], const float bmax[3])
+{
+    const float dx = bmax[0] - bmin[0];
+    const float dy = bmax[1] - bmin[1];
+    const float dz = bmax[2] - bmin[2];
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+static void TriangleBounds(const Vector3 &vec1, const Vector3 &vec2, const Vector3 &vec3, float enlargeBB, Vector3& bbmin, Vector3& bbmax)
+{
+    Vector3 enlarge = Vector3(enlargeBB, enlargeBB, enlargeBB);
+
+    bbmin = vec1;
+    bbmin.makeFloor(vec2);
+    bbmin.makeFloor(vec3);
+    bbmin -= enlarge;
+
+    bbmax = vec1;
+    bbmax.makeCeil(vec2);
+    bbmax.makeCeil(vec3);
+    bbmax += enlarge;
+}
+
 PointColDetector::PointColDetector()
     : object_list_size(-1)
+    , bvh_built_cost(0.0f)
 {
 }
 
@@ -46,72 +80,73 @@ PointColDetector::~PointColDetector() {
 
 void PointColDetector::update(Beam* truck, bool ignorestate) {
     int contacters_size = 0;
+    bool structure_changed = false;
 
     if (truck && (ignorestate || truck->state < SLEEPING)) {
         m_trucks.resize(1, truck);
+        m_truck_ids.resize(1, 0);
         contacters_size += truck->free_contacter;
     } else {
         m_trucks.clear();
+        m_truck_ids.clear();
     }
 
     if (contacters_size != object_list_size) {
         object_list_size = contacters_size;
         update_structures_for_contacters();
+        structure_changed = true;
     }
 
-    kdtree[0].ref = NULL;
-    kdtree[0].begin = 0;
-    kdtree[0].end = -object_list_size;
+    update_bvh(structure_changed);
 }
 
 void PointColDetector::update(Beam* truck, Beam** trucks, const int numtrucks, bool ignorestate) {
-    bool update_required = false;
-    int contacters_size = 0;
-
+    // Brute-force partner search; the simulation loop gets its partners from BeamFactory's broad phase instead
+    std::vector<int> partners;
     if (truck && (ignorestate || truck->state < SLEEPING)) {
-        truck->collisionRelevant = false;
-        m_trucks.resize(numtrucks);
         for (int t = 0; t < numtrucks; t++) {
             if (t != truck->trucknum && trucks[t] && (ignorestate || trucks[t]->state < SLEEPING) && truck->boundingBox.intersects(trucks[t]->boundingBox)) {
-                update_required = update_required || (m_trucks[t] != trucks[t]);
-                m_trucks[t] = trucks[t];
-                truck->collisionRelevant = true;
-                contacters_size += trucks[t]->free_contacter;
-                if (truck->nodes[0].Velocity.squaredDistance(trucks[t]->nodes[0].Velocity) > 25)
-                {
-                    for (int i=0; i<truck->free_collcab; i++)
-                    {
-                        truck->intra_collcabrate[i].rate = 0;
-                        truck->inter_collcabrate[i].rate = 0;
-                    }
-                    for (int i=0; i<trucks[t]->free_collcab; i++)
-                    {
-                        trucks[t]->intra_collcabrate[i].rate = 0;
-                        trucks[t]->inter_collcabrate[i].rate = 0;
-                    }
-                }
-            } else {
-                m_trucks[t] = 0;
+                partners.push_back(t);
             }
         }
     } else {
+        truck = nullptr;
+    }
+
+    update(truck, trucks, partners);
+}
+
+void PointColDetector::update(Beam* truck, Beam** trucks, const std::vector<int>& partners) {
+    bool update_required = false;
+    int contacters_size = 0;
+
+    if (truck) {
+        truck->collisionRelevant = !partners.empty();
+        update_required = (partners != m_truck_ids);
+        m_trucks.resize(partners.size());
+        for (size_t p = 0; p < partners.size(); p++) {
+            update_required = update_required || (m_trucks[p] != trucks[partners[p]]);
+            m_trucks[p] = trucks[partners[p]];
+            contacters_size += m_trucks[p]->free_contacter;
+        }
+        m_truck_ids = partners;
+    } else {
+        update_required = !m_trucks.empty();
         m_trucks.clear();
+        m_truck_ids.clear();
     }
 
     if (update_required || contacters_size != object_list_size) {
         object_list_size = contacters_size;
         update_structures_for_contacters();
+        update_required = true;
     }
 
-    kdtree[0].ref = NULL;
-    kdtree[0].begin = 0;
-    kdtree[0].end = -object_list_size;
+    update_bvh(update_required);
 }
 
 void PointColDetector::update_structures_for_contacters() {
-    kdnode_t kdelem = {0.0f, 0, 0.0f, NULL, 0.0f, 0};
     hit_list.resize(object_list_size, NULL);
-    int exp_factor = std::max(0, (int) ceil(LOG2(object_list_size)) + 1);
 
     ref_list.clear();
     pointid_list.clear();
@@ -121,209 +156,251 @@ void PointColDetector::update_structures_for_contacters() {
 
     int refi = 0;
 
-    //Insert all contacters, into the list of points to consider when building the kdtree
+    //Insert all contacters, into the list of points to consider when building the hierarchy
     for (int t = 0; t < static_cast<int>(m_trucks.size()); t++) {
         if (m_trucks[t]) {
             for (int i = 0; i < m_trucks[t]->free_contacter; ++i) {
                 ref_list[refi].pidref = &pointid_list[refi];
-                pointid_list[refi].truckid = t;
+                pointid_list[refi].truckid = m_truck_ids[t];
                 pointid_list[refi].nodeid = m_trucks[t]->contacters[i].nodeid;
                 ref_list[refi].point = &(m_trucks[t]->nodes[pointid_list[refi].nodeid].AbsPosition.x);
                 refi++;
             }
         }
     }
-
-    kdtree.resize(pow(2.f, exp_factor), kdelem);
 }
 
-void PointColDetector::query(const Vector3 &vec1, const Vector3 &vec2, const Vector3 &vec3, float enlargeBB) {
-    Vector3 enlarge = Vector3(enlargeBB, enlargeBB, enlargeBB);
-
-    bbmin = vec1;
-      
-    bbmin.x = std::min(vec2.x, bbmin.x);
-    bbmin.x = std::min(vec3.x, bbmin.x);
-                                
-    bbmin.y = std::min(vec2.y, bbmin.y);
-    bbmin.y = std::min(vec3.y, bbmin.y);
-                                
-    bbmin.z = std::min(vec2.z, bbmin.z);
-    bbmin.z = std::min(vec3.z, bbmin.z);
-      
-    bbmin -= enlarge;
-     
-    bbmax = vec1;
-      
-    bbmax.x = std::max(bbmax.x, vec2.x);
-    bbmax.x = std::max(bbmax.x, vec3.x);
-                                     
-    bbmax.y = std::max(bbmax.y, vec2.y);
-    bbmax.y = std::max(bbmax.y, vec3.y);
-                                     
-    bbmax.z = std::max(bbmax.z, vec2.z);
-    bbmax.z = std::max(bbmax.z, vec3.z);
-      
-    bbmax += enlarge;
+void PointColDetector::update_bvh(bool structure_changed) {
+    if (structure_changed || bvh.empty()) {
+        build_bvh();
+        return;
+    }
 
-    hit_count = 0;
-    queryrec(0, 0);
+    // Nodes move every step, but mostly stay close to their neighbours; refitting keeps the tree valid.
+    // Once parts of the tree were torn apart (crash, articulated parts), the boxes overlap a lot and we rebuild.
+    const float cost = refit_bvh();
+    if (cost > REBUILD_RATIO * std::max(bvh_built_cost, 1e-4f)) {
+        build_bvh();
+    }
 }
 
-void PointColDetector::queryrec(int kdindex, int axis) {
-    for (;;) {
-        if (kdtree[kdindex].end < 0) {
-            build_kdtree_incr(axis, kdindex);
+void PointColDetector::build_bvh() {
+    bvh.clear();
+    bvh_built_cost = 0.0f;
+    if (object_list_size <= 0) {
+        return;
+    }
+
+    bvh.reserve(2 * (object_list_size / LEAF_SIZE + 1));
+    bvh.resize(1);
+    build_bvh_rec(0, 0, object_list_size);
+
+    for (const bvhnode_t& node : bvh) {
+        if (node.left >= 0) {
+            bvh_built_cost += SurfaceArea(node.bbmin, node.bbmax);
         }
+    }
+}
 
-        if (kdtree[kdindex].ref != NULL) {
-            float *point = kdtree[kdindex].ref->point;
-            if (point[0] >= bbmin.x && point[0] <= bbmax.x && point[1] >= bbmin.y && point[1] <= bbmax.y && point[2] >= bbmin.z && point[2] <= bbmax.z ) {
-                hit_list[hit_count] = kdtree[kdindex].ref->pidref;
-                hit_count++;
-            }
-            return;
+void PointColDetector::build_bvh_rec(int index, int begin, int end) {
+    float bmin[3] = { ref_list[begin].point[0], ref_list[begin].point[1], ref_list[begin].point[2] };
+    float bmax[3] = { bmin[0], bmin[1], bmin[2] };
+    for (int i = begin + 1; i < end; ++i) {
+        for (int a = 0; a < 3; ++a) {
+            bmin[a] = std::min(bmin[a], ref_list[i].point[a]);
+            bmax[a] = std::max(bmax[a], ref_list[i].point[a]);
         }
+    }
 
-        int newaxis;
-        int newindex;
+    for (int a = 0; a < 3; ++a) {
+        bvh[index].bbmin[a] = bmin[a];
+        bvh[index].bbmax[a] = bmax[a];
+    }
+    bvh[index].begin = begin;
+    bvh[index].end = end;
 
-        if (bbmax[axis] >= kdtree[kdindex].middle) {
-            if (bbmin[axis] > kdtree[kdindex].max) {
-                return;
-            }
+    if (end - begin <= LEAF_SIZE) {
+        bvh[index].left = -1;
+        return;
+    }
 
-            newaxis = axis + 1;
+    // Median split along the longest axis
+    int axis = 0;
+    if (bmax[1] - bmin[1] > bmax[axis] - bmin[axis]) axis = 1;
+    if (bmax[2] - bmin[2] > bmax[axis] - bmin[axis]) axis = 2;
 
-            if (newaxis >= 3) {
-                newaxis = 0;
-            }
+    const int median = begin + (end - begin) / 2;
+    std::nth_element(ref_list.begin() + begin, ref_list.begin() + median, ref_list.begin() + end,
+        [axis](const refelem_t& a, const refelem_t& b) { return a.point[axis] < b.point[axis]; });
 
-            newindex = kdindex + kdindex + 1;
+    const int left = static_cast<int>(bvh.size());
+    bvh[index].left = left;
+    bvh.resize(bvh.size() + 2);
+    build_bvh_rec(left, begin, median);
+    build_bvh_rec(left + 1, median, end);
+}
 
-            if (bbmin[axis] <= kdtree[kdindex].middle) {
-                queryrec(newindex, newaxis);
+float PointColDetector::refit_bvh() {
+    // Children are always stored after their parent, so a reverse sweep visits them first
+    float cost = 0.0f;
+    for (int i = static_cast<int>(bvh.size()) - 1; i >= 0; --i) {
+        bvhnode_t& node = bvh[i];
+        if (node.left < 0) {
+            const float* p = ref_list[node.begin].point;
+            for (int a = 0; a < 3; ++a) {
+                node.bbmin[a] = p[a];
+                node.bbmax[a] = p[a];
             }
-
-            kdindex = newindex + 1;
-            axis = newaxis;
-        }
-        else {
-            if (bbmax[axis] < kdtree[kdindex].min) {
-                return;
+            for (int k = node.begin + 1; k < node.end; ++k) {
+                p = ref_list[k].point;
+                for (int a = 0; a < 3; ++a) {
+                    node.bbmin[a] = std::min(node.bbmin[a], p[a]);
+                    node.bbmax[a] = std::max(node.bbmax[a], p[a]);
+                }
             }
-
-            kdindex = 2 * kdindex + 1;
-            axis++;
-
-            if (axis >= 3) {
-                axis = 0;
+        } else {
+            const bvhnode_t& l = bvh[node.left];
+            const bvhnode_t& r = bvh[node.left + 1];
+            for (int a = 0; a < 3; ++a) {
+                node.bbmin[a] = std::min(l.bbmin[a], r.bbmin[a]);
+                node.bbmax[a] = std::max(l.bbmax[a], r.bbmax[a]);
             }
+            cost += SurfaceArea(node.bbmin, node.bbmax);
         }
     }
+    return cost;
 }
 
-void PointColDetector::build_kdtree_incr(int axis, int index)
-{
-    int end = -kdtree[index].end;
-    kdtree[index].end = end;
-    int begin = kdtree[index].begin;
-    int median;
-    int slice_size = end - begin;
-    if (slice_size != 1) {
-        int newindex=index+index+1;
-        if (slice_size == 2) {
-            median = begin+1;
-            if (ref_list[begin].point[axis] > ref_list[median].point[axis]) {
-                std::swap(ref_list[begin], ref_list[median]);
-            }
-
-            kdtree[index].min = ref_list[begin].point[axis];
-            kdtree[index].max = ref_list[median].point[axis];
-            kdtree[index].middle = kdtree[index].max;
-            kdtree[index].ref = NULL;
+void PointColDetector::query(const Vector3 &vec1, const Vector3 &vec2, const Vector3 &vec3, float enlargeBB) {
+    TriangleBounds(vec1, vec2, vec3, enlargeBB, bbmin, bbmax);
 
-            axis++;
-            if (axis >= 3) {
-                axis = 0;
-            }
+    hit_count = 0;
+    if (bvh.empty()) {
+        return;
+    }
 
-            kdtree[newindex].ref = &ref_list[begin];
-            kdtree[newindex].middle = kdtree[newindex].ref->point[axis];
-            kdtree[newindex].min = kdtree[newindex].middle;
-            kdtree[newindex].max = kdtree[newindex].middle;
-            kdtree[newindex].end = median;
-            newindex++;
-
-            kdtree[newindex].ref = &ref_list[median];
-            kdtree[newindex].middle = kdtree[newindex].ref->point[axis];
-            kdtree[newindex].min = kdtree[newindex].middle;
-            kdtree[newindex].max = kdtree[newindex].middle;
-            kdtree[newindex].end = end;
-            return;
+    // Depth-first, left child first; the tree depth is log2 of the contacter count
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const bvhnode_t& node = bvh[stack[--top]];
+        if (!BoxesOverlap(node.bbmin, node.bbmax, bbmin, bbmax)) {
+            continue;
         }
-        else {
-            median = begin + (slice_size / 2);
-            partintwo(begin, median, end, axis, kdtree[index].min, kdtree[index].max);
+        if (node.left < 0) {
+            for (int k = node.begin; k < node.end; ++k) {
+                if (PointInBox(ref_list[k].point, bbmin, bbmax)) {
+                    hit_list[hit_count] = ref_list[k].pidref;
+                    hit_count++;
+                }
+            }
+        } else {
+            stack[top++] = node.left + 1;
+            stack[top++] = node.left;
         }
+    }
 
-        kdtree[index].middle = ref_list[median].point[axis];
-        kdtree[index].ref = NULL;
-
-        kdtree[newindex].begin = begin;
-        kdtree[newindex].end = -median;
+#ifdef POINTCD_VALIDATE_QUERIES
+    validate_hits(bbmin, bbmax, hit_list.data(), hit_count, "query()");
+#endif
+}
 
-        newindex++;
-        kdtree[newindex].begin = median;
-        kdtree[newindex].end = -end;
+void PointColDetector::add_batch_query(const Vector3 &vec1, const Vector3 &vec2, const Vector3 &vec3, const float enlargeBB, int tag) {
+    batchquery_t q;
+    TriangleBounds(vec1, vec2, vec3, enlargeBB, q.bbmin, q.bbmax);
+    q.tag = tag;
+    batch_queries.push_back(q);
+}
 
+void PointColDetector::query_batch() {
+    const int num_queries = static_cast<int>(batch_queries.size());
+    batch_hit_offsets.assign(num_queries + 1, 0);
+    batch_hit_list.clear();
+    batch_hits.clear();
+    if (bvh.empty() || num_queries == 0) {
+        return;
     }
-    else {
-        kdtree[index].ref = &ref_list[begin];
-        kdtree[index].middle = kdtree[index].ref->point[axis];
-        kdtree[index].min = kdtree[index].middle;
-        kdtree[index].max = kdtree[index].middle;
+
+    // Same traversal as query(), but every node carries the range of queries which overlap its parent.
+    // Queries which miss a node are dropped from the range handed down to its children.
+    struct entry_t { int node; int begin; int end; };
+    entry_t stack[64];
+    int top = 0;
+
+    batch_active.resize(num_queries);
+    for (int q = 0; q < num_queries; ++q) {
+        batch_active[q] = q;
     }
-}
+    stack[top++] = { 0, 0, num_queries };
 
-void PointColDetector::partintwo(const int start, const int median, const int end, const int axis, float &minex, float &maxex)
-{
-    int i, j, l, m;
-    int k = median;
-    l = start;
-    m = end - 1;
-
-    float x = ref_list[k].point[axis];
-    while (l < m) {
-        i = l;
-        j = m;
-        while (!(j < k || k < i)) {
-            while (ref_list[i].point[axis] < x) {
-                i++;
-            }
-            while (x < ref_list[j].point[axis]) {
-                j--;
-            }
+    while (top > 0) {
+        const entry_t e = stack[--top];
+        const bvhnode_t& node = bvh[e.node];
 
-            std::swap(ref_list[i], ref_list[j]);
-            i++;
-            j--;
+        const int begin = static_cast<int>(batch_active.size());
+        for (int k = e.begin; k < e.end; ++k) {
+            const int qi = batch_active[k];
+            if (BoxesOverlap(node.bbmin, node.bbmax, batch_queries[qi].bbmin, batch_queries[qi].bbmax)) {
+                batch_active.push_back(qi);
+            }
         }
-        if (j < k) {
-            l = i;
+        const int end = static_cast<int>(batch_active.size());
+        if (begin == end) {
+            continue;
         }
-        if (k < i) {
-            m = j;
+
+        if (node.left < 0) {
+            for (int k = node.begin; k < node.end; ++k) {
+                for (int a = begin; a < end; ++a) {
+                    const batchquery_t& q = batch_queries[batch_active[a]];
+                    if (PointInBox(ref_list[k].point, q.bbmin, q.bbmax)) {
+                        batch_hits.push_back({ batch_active[a], ref_list[k].pidref });
+                    }
+                }
+            }
+        } else {
+            stack[top++] = { node.left + 1, begin, end };
+            stack[top++] = { node.left, begin, end };
         }
-        x = ref_list[k].point[axis];
     }
 
-    minex = x;
-    maxex = x;
-    for (int i = start; i < median; ++i) {
-        minex = std::min(ref_list[i].point[axis], minex);
+    // Group the hits by query, keeping the traversal order within each query
+    for (const batchhit_t& hit : batch_hits) {
+        batch_hit_offsets[hit.query + 1]++;
+    }
+    for (int q = 0; q < num_queries; ++q) {
+        batch_hit_offsets[q + 1] += batch_hit_offsets[q];
+    }
+    batch_hit_list.resize(batch_hits.size());
+    batch_active.assign(batch_hit_offsets.begin(), batch_hit_offsets.end() - 1); // reused as fill cursors
+    for (const batchhit_t& hit : batch_hits) {
+        batch_hit_list[batch_active[hit.query]++] = hit.pidref;
+    }
+
+#ifdef POINTCD_VALIDATE_QUERIES
+    for (int q = 0; q < num_queries; ++q) {
+        validate_hits(batch_queries[q].bbmin, batch_queries[q].bbmax, batch_hit_list.data() + batch_hit_offsets[q],
+            batch_hit_offsets[q + 1] - batch_hit_offsets[q], "query_batch()");
     }
-    for (int i = median+1; i < end; ++i) {
-        maxex = std::max(maxex, ref_list[i].point[axis]);
+#endif
+}
+
+#ifdef POINTCD_VALIDATE_QUERIES
+void PointColDetector::validate_hits(const Vector3& qmin, const Vector3& qmax, pointid_t* const* hits, int count, const char* where) {
+    // Every contacter inside the box must be reported exactly once, in any order
+    std::vector<pointid_t*> expected;
+    for (int k = 0; k < object_list_size; ++k) {
+        if (PointInBox(ref_list[k].point, qmin, qmax)) {
+            expected.push_back(ref_list[k].pidref);
+        }
+    }
+    std::vector<pointid_t*> found(hits, hits + count);
+    std::sort(expected.begin(), expected.end());
+    std::sort(found.begin(), found.end());
+    if (found != expected) {
+        LOG(String("PointColDetector: ") + where + " found " + TOSTRING(found.size())
+            + " contacters, brute force found " + TOSTRING(expected.size()));
     }
 }
+#endif
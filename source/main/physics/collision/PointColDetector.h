@@ -21,6 +21,14 @@
 
 #include "RoRPrerequisites.h"
 
+// Checks every query against a brute-force scan of all contacters and logs mismatches to RoR.log; slow
+//#define POINTCD_VALIDATE_QUERIES
+
+/// Finds contacter nodes inside the bounding box of a triangle.
+///
+/// Contacters are kept in a bounding volume hierarchy which persists between physics steps:
+/// update() refits the boxes to the current node positions and only rebuilds the tree when
+/// the set of contacters changes or the refitted boxes got too loose.
 class PointColDetector : public ZeroedMemoryAllocator
 {
 public:
@@ -31,47 +39,84 @@ public:
         int truckid;
     };
 
+    /// One triangle of a batched query, see add_batch_query()
+    struct batchquery_t
+    {
+        Ogre::Vector3 bbmin;
+        Ogre::Vector3 bbmax;
+        int tag;                //!< Caller's index; not used by the detector
+    };
+
     std::vector<Ogre::Vector3>* object_list;
     std::vector<pointid_t*> hit_list;
     int hit_count;
 
+    std::vector<batchquery_t> batch_queries;   //!< Input of query_batch(); cleared by the caller
+    std::vector<int> batch_hit_offsets;        //!< Output of query_batch(); hits of query 'q' are [offsets[q], offsets[q+1]) in batch_hit_list
+    std::vector<pointid_t*> batch_hit_list;
+
     PointColDetector();
     ~PointColDetector();
 
     void update(Beam* truck, bool ignorestate = false);
     void update(Beam* truck, Beam** trucks, const int numtrucks, bool ignorestate = false);
+    /// Inter-truck update with the overlapping trucks already known (see BeamFactory::UpdateCollisionPairs())
+    /// @param partners Indices into 'trucks', ascending
+    void update(Beam* truck, Beam** trucks, const std::vector<int>& partners);
     void query(const Ogre::Vector3& vec1, const Ogre::Vector3& vec2, const Ogre::Vector3& vec3, const float enlargeBB = 0.0f);
 
+    void add_batch_query(const Ogre::Vector3& vec1, const Ogre::Vector3& vec2, const Ogre::Vector3& vec3, const float enlargeBB, int tag);
+    /// Runs all 'batch_queries' in a single traversal of the hierarchy.
+    /// Per query, hits come out in the same order as from query().
+    void query_batch();
+
 private:
 
+    static const int LEAF_SIZE = 4;              //!< Max. contacters per leaf
+    static const float REBUILD_RATIO;            //!< Rebuild when refitted boxes exceed the freshly built ones by this factor
+
     struct refelem_t
     {
         pointid_t* pidref;
         float* point;
     };
 
-    struct kdnode_t
+    struct bvhnode_t
     {
-        float min;
+        float bbmin[3];
+        float bbmax[3];
+        int left;            //!< First of two consecutive child nodes; -1 for leaves
+        int begin;           //!< Leaves: range in ref_list
         int end;
-        float max;
-        refelem_t* ref;
-        float middle;
-        int begin;
+    };
+
+    struct batchhit_t
+    {
+        int query;
+        pointid_t* pidref;
     };
 
     int object_list_size;
-    std::vector<Beam*> m_trucks;
+    std::vector<Beam*> m_trucks;                 //!< Trucks whose contacters are in the hierarchy
+    std::vector<int> m_truck_ids;                //!< Their pointid_t::truckid
 
     std::vector<refelem_t> ref_list;
     std::vector<pointid_t> pointid_list;
-    std::vector<kdnode_t> kdtree;
+    std::vector<bvhnode_t> bvh;
+    float bvh_built_cost;                        //!< Sum of internal node surface areas right after the last rebuild
+
+    std::vector<int> batch_active;               //!< query_batch() scratch: queries overlapping the visited nodes
+    std::vector<batchhit_t> batch_hits;          //!< query_batch() scratch: hits in traversal order
 
     Ogre::Vector3 bbmin;
     Ogre::Vector3 bbmax;
 
-    void queryrec(int kdindex, int axis);
-    void build_kdtree_incr(int axis, int index);
-    void partintwo(const int start, const int median, const int end, const int axis, float& minex, float& maxex);
     void update_structures_for_contacters();
+    void build_bvh();
+    void build_bvh_rec(int index, int begin, int end);
+    float refit_bvh();
+    void update_bvh(bool structure_changed);
+#ifdef POINTCD_VALIDATE_QUERIES
+    void validate_hits(const Ogre::Vector3& qmin, const Ogre::Vector3& qmax, pointid_t* const* hits, int count, const char* where);
+#endif
 };
@@ -48,8 +48,14 @@ inline float Buoyance::computeVolume(Vector3 o, Vector3 a, Vector3 b, Vector3 c)
 }
 
 //compute pressure and drag force on a submerged triangle
-Vector3 Buoyance::computePressureForceSub(Vector3 a, Vector3 b, Vector3 c, Vector3 vel, int type)
+Vector3 Buoyance::computePressureForceSub(const submerged_tri_t& tri, Vector3 water_vel)
 {
+    const Vector3& a = m_points[tri.a];
+    const Vector3& b = m_points[tri.b];
+    const Vector3& c = m_points[tri.c];
+    const float ha = m_heights[tri.a];
+    const float hb = m_heights[tri.b];
+    const float hc = m_heights[tri.c];
     //compute normal vector
     Vector3 normal = (b - a).crossProduct(c - a);
     float surf = normal.length();
@@ -58,12 +64,12 @@ Vector3 Buoyance::computePressureForceSub(Vector3 a, Vector3 b, Vector3 c, Vecto
     normal = normal / surf; //normalize
     surf = surf / 2.0; //surface
     float vol = 0.0;
-    if (type != BUOY_DRAGONLY)
+    if (tri.type != BUOY_DRAGONLY)
     {
         //compute pression prism points
-        Vector3 ap = a + (gEnv->terrainManager->getWater()->getHeightWaves(a) - a.y) * 9810 * normal;
-        Vector3 bp = b + (gEnv->terrainManager->getWater()->getHeightWaves(b) - b.y) * 9810 * normal;
-        Vector3 cp = c + (gEnv->terrainManager->getWater()->getHeightWaves(c) - c.y) * 9810 * normal;
+        Vector3 ap = a + (ha - a.y) * 9810 * normal;
+        Vector3 bp = b + (hb - b.y) * 9810 * normal;
+        Vector3 cp = c + (hc - c.y) * 9810 * normal;
         //find centroid
         Vector3 ctd = (a + b + c + ap + bp + cp) / 6.0;
         //compute volume
@@ -77,13 +83,11 @@ Vector3 Buoyance::computePressureForceSub(Vector3 a, Vector3 b, Vector3 c, Vecto
         vol += computeVolume(ctd, ap, cp, bp);
     };
     Vector3 drg = Vector3::ZERO;
-    if (type != BUOY_DRAGLESS)
+    if (tri.type != BUOY_DRAGLESS)
     {
         //now, the drag
         //take in account the wave speed
-        //compute center
-        Vector3 tc = (a + b + c) / 3.0;
-        vel = vel - gEnv->terrainManager->getWater()->getVelocity(tc);
+        Vector3 vel = tri.vel - water_vel;
         float vell = vel.length();
         if (vell > 0.01)
         {
@@ -100,11 +104,11 @@ Vector3 Buoyance::computePressureForceSub(Vector3 a, Vector3 b, Vector3 c, Vecto
                     Vector3 fxdir = fxl * normal;
                     if (fxdir.y < 0)
                         fxdir.y = -fxdir.y;
-                    if (gEnv->terrainManager->getWater()->getHeightWaves(a) - a.y < 0.1)
+                    if (ha - a.y < 0.1)
                         splashp->malloc(a, fxdir);
-                    else if (gEnv->terrainManager->getWater()->getHeightWaves(b) - b.y < 0.1)
+                    else if (hb - b.y < 0.1)
                         splashp->malloc(b, fxdir);
-                    else if (gEnv->terrainManager->getWater()->getHeightWaves(c) - c.y < 0.1)
+                    else if (hc - c.y < 0.1)
                         splashp->malloc(c, fxdir);
                 }
             }
@@ -116,13 +120,19 @@ Vector3 Buoyance::computePressureForceSub(Vector3 a, Vector3 b, Vector3 c, Vecto
     return vol * normal + drg;
 }
 
-//compute pressure and drag forces on a random triangle
-Vector3 Buoyance::computePressureForce(Vector3 a, Vector3 b, Vector3 c, Vector3 vel, int type)
+//cut a random triangle at the wave height and queue its submerged part(s)
+void Buoyance::addSubmergedParts(int pa, int pb, int pc, float wha, Vector3 vel, int type, node_t* node)
 {
-    float wha = gEnv->terrainManager->getWater()->getHeightWaves((a + b + c) / 3.0);
+    const Vector3 a = m_points[pa];
+    const Vector3 b = m_points[pb];
+    const Vector3 c = m_points[pc];
+    submerged_tri_t tri;
+    tri.vel = vel;
+    tri.node = node;
+    tri.type = type;
     //check if fully emerged
     if (a.y > wha && b.y > wha && c.y > wha)
-        return Vector3::ZERO;
+        return;
     //check if semi emerged
     if (a.y > wha || b.y > wha || c.y > wha)
     {
@@ -130,79 +140,184 @@ Vector3 Buoyance::computePressureForce(Vector3 a, Vector3 b, Vector3 c, Vector3
         //one dip
         if (a.y < wha && b.y > wha && c.y > wha)
         {
-            return computePressureForceSub(a, a + (wha - a.y) / (b.y - a.y) * (b - a), a + (wha - a.y) / (c.y - a.y) * (c - a), vel, type);
+            tri.a = pa; tri.b = addPoint(a + (wha - a.y) / (b.y - a.y) * (b - a)); tri.c = addPoint(a + (wha - a.y) / (c.y - a.y) * (c - a));
+            m_submerged.push_back(tri);
+            return;
         }
         if (b.y < wha && c.y > wha && a.y > wha)
         {
-            return computePressureForceSub(b, b + (wha - b.y) / (c.y - b.y) * (c - b), b + (wha - b.y) / (a.y - b.y) * (a - b), vel, type);
+            tri.a = pb; tri.b = addPoint(b + (wha - b.y) / (c.y - b.y) * (c - b)); tri.c = addPoint(b + (wha - b.y) / (a.y - b.y) * (a - b));
+            m_submerged.push_back(tri);
+            return;
         }
         if (c.y < wha && a.y > wha && b.y > wha)
         {
-            return computePressureForceSub(c, c + (wha - c.y) / (a.y - c.y) * (a - c), c + (wha - c.y) / (b.y - c.y) * (b - c), vel, type);
+            tri.a = pc; tri.b = addPoint(c + (wha - c.y) / (a.y - c.y) * (a - c)); tri.c = addPoint(c + (wha - c.y) / (b.y - c.y) * (b - c));
+            m_submerged.push_back(tri);
+            return;
         }
         //two dips
         if (a.y > wha && b.y < wha && c.y < wha)
         {
-            Vector3 tb = a + (wha - a.y) / (b.y - a.y) * (b - a);
-            Vector3 tc = a + (wha - a.y) / (c.y - a.y) * (c - a);
-            Vector3 f = computePressureForceSub(tb, b, tc, vel, type);
-            return f + computePressureForceSub(tc, b, c, vel, type);
+            const int tb = addPoint(a + (wha - a.y) / (b.y - a.y) * (b - a));
+            const int tc = addPoint(a + (wha - a.y) / (c.y - a.y) * (c - a));
+            tri.a = tb; tri.b = pb; tri.c = tc;
+            m_submerged.push_back(tri);
+            tri.a = tc; tri.b = pb; tri.c = pc;
+            m_submerged.push_back(tri);
+            return;
         }
         if (b.y > wha && c.y < wha && a.y < wha)
         {
-            Vector3 tc = b + (wha - b.y) / (c.y - b.y) * (c - b);
-            Vector3 ta = b + (wha - b.y) / (a.y - b.y) * (a - b);
-            Vector3 f = computePressureForceSub(tc, c, ta, vel, type);
-            return f + computePressureForceSub(ta, c, a, vel, type);
+            const int tc = addPoint(b + (wha - b.y) / (c.y - b.y) * (c - b));
+            const int ta = addPoint(b + (wha - b.y) / (a.y - b.y) * (a - b));
+            tri.a = tc; tri.b = pc; tri.c = ta;
+            m_submerged.push_back(tri);
+            tri.a = ta; tri.b = pc; tri.c = pa;
+            m_submerged.push_back(tri);
+            return;
         }
         if (c.y > wha && a.y < wha && b.y < wha)
         {
-            Vector3 ta = c + (wha - c.y) / (a.y - c.y) * (a - c);
-            Vector3 tb = c + (wha - c.y) / (b.y - c.y) * (b - c);
-            Vector3 f = computePressureForceSub(ta, a, tb, vel, type);
-            return f + computePressureForceSub(tb, a, b, vel, type);
+            const int ta = addPoint(c + (wha - c.y) / (a.y - c.y) * (a - c));
+            const int tb = addPoint(c + (wha - c.y) / (b.y - c.y) * (b - c));
+            tri.a = ta; tri.b = pa; tri.c = tb;
+            m_submerged.push_back(tri);
+            tri.a = tb; tri.b = pa; tri.c = pb;
+            m_submerged.push_back(tri);
+            return;
         }
-        return Vector3::ZERO;
     }
     else
     {
         //fully submerged case
-        return computePressureForceSub(a, b, c, vel, type);
+        tri.a = pa; tri.b = pb; tri.c = pc;
+        m_submerged.push_back(tri);
     }
 }
 
-void Buoyance::computeNodeForce(node_t* a, node_t* b, node_t* c, bool doUpdate, int type)
+void Buoyance::computeNodeForces(node_t* nodes, const int* cabs, const int* buoycabs, const int* buoycabtypes, int count, bool doUpdate)
 {
-    if (a->AbsPosition.y > gEnv->terrainManager->getWater()->getHeightWaves(a->AbsPosition) &&
-        b->AbsPosition.y > gEnv->terrainManager->getWater()->getHeightWaves(b->AbsPosition) &&
-        c->AbsPosition.y > gEnv->terrainManager->getWater()->getHeightWaves(c->AbsPosition))
-        return;
-
+    IWater* water = gEnv->terrainManager->getWater();
     update = doUpdate;
 
-    //compute center
-    Vector3 m = (a->AbsPosition + b->AbsPosition + c->AbsPosition) / 3.0;
+    // first batch: wave heights at the cab nodes (once per node) and at the centers of the 6 triangles each cab is split into
+    int max_node = -1;
+    for (int i = 0; i < count; i++)
+    {
+        for (int k = 0; k < 3; k++)
+            max_node = std::max(max_node, cabs[buoycabs[i] * 3 + k]);
+    }
+    m_node_points.assign(max_node + 1, -1);
+    m_points.clear();
+    for (int i = 0; i < count; i++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            const int n = cabs[buoycabs[i] * 3 + k];
+            if (m_node_points[n] < 0)
+            {
+                m_node_points[n] = (int)m_points.size();
+                m_points.push_back(nodes[n].AbsPosition);
+            }
+        }
+    }
+    const int first_center = (int)m_points.size();
+    for (int i = 0; i < count; i++)
+    {
+        int tmpv = buoycabs[i] * 3;
+        const Vector3& a = nodes[cabs[tmpv]].AbsPosition;
+        const Vector3& b = nodes[cabs[tmpv + 1]].AbsPosition;
+        const Vector3& c = nodes[cabs[tmpv + 2]].AbsPosition;
+        //compute center
+        Vector3 m = (a + b + c) / 3.0;
+        //suboptimal
+        Vector3 mab = (a + b) / 2.0;
+        Vector3 mbc = (b + c) / 2.0;
+        Vector3 mca = (c + a) / 2.0;
+        m_points.push_back((a + mab + m) / 3.0);
+        m_points.push_back((a + m + mca) / 3.0);
+        m_points.push_back((b + mbc + m) / 3.0);
+        m_points.push_back((b + m + mab) / 3.0);
+        m_points.push_back((c + mca + m) / 3.0);
+        m_points.push_back((c + m + mbc) / 3.0);
+    }
+    m_heights.resize(m_points.size());
+    water->getWavesBatch(m_points.data(), (int)m_points.size(), m_heights.data(), nullptr);
+
+    // the submerged parts share their corners with the cab nodes, the edge midpoints and the cab centers;
+    // the node heights are known by now, points added from here on go into the second batch
+    const int first_pending = (int)m_points.size();
+    m_submerged.clear();
+    for (int i = 0; i < count; i++)
+    {
+        int tmpv = buoycabs[i] * 3;
+        node_t* a = &nodes[cabs[tmpv]];
+        node_t* b = &nodes[cabs[tmpv + 1]];
+        node_t* c = &nodes[cabs[tmpv + 2]];
+        const int pa = m_node_points[cabs[tmpv]];
+        const int pb = m_node_points[cabs[tmpv + 1]];
+        const int pc = m_node_points[cabs[tmpv + 2]];
+        if (a->AbsPosition.y > m_heights[pa] &&
+            b->AbsPosition.y > m_heights[pb] &&
+            c->AbsPosition.y > m_heights[pc])
+            continue;
+
+        //compute center
+        Vector3 m = (a->AbsPosition + b->AbsPosition + c->AbsPosition) / 3.0;
 
 #if 0
-    //compute projected points
-	Vector3 tmp = b->Position - a->Position;
-	Vector3 mab = (tmp.dotProduct(m-a->Position) / tmp.squaredLength()) * tmp;
-	tmp = c->Position - b->Position;
-	Vector3 mbc = (tmp.dotProduct(m-b->Position) / tmp.squaredLength()) * tmp;
-	tmp = a->Position - c->Position;
-	Vector3 mca = (tmp.dotProduct(m-c->Position) / tmp.squaredLength()) * tmp;
+        //compute projected points
+		Vector3 tmp = b->Position - a->Position;
+		Vector3 mab = (tmp.dotProduct(m-a->Position) / tmp.squaredLength()) * tmp;
+		tmp = c->Position - b->Position;
+		Vector3 mbc = (tmp.dotProduct(m-b->Position) / tmp.squaredLength()) * tmp;
+		tmp = a->Position - c->Position;
+		Vector3 mca = (tmp.dotProduct(m-c->Position) / tmp.squaredLength()) * tmp;
 #endif
 
-    //suboptimal
-    Vector3 mab = (a->AbsPosition + b->AbsPosition) / 2.0;
-    Vector3 mbc = (b->AbsPosition + c->AbsPosition) / 2.0;
-    Vector3 mca = (c->AbsPosition + a->AbsPosition) / 2.0;
-    Vector3 vel = (a->Velocity + b->Velocity + c->Velocity) / 3.0;
+        //suboptimal
+        Vector3 mab = (a->AbsPosition + b->AbsPosition) / 2.0;
+        Vector3 mbc = (b->AbsPosition + c->AbsPosition) / 2.0;
+        Vector3 mca = (c->AbsPosition + a->AbsPosition) / 2.0;
+        Vector3 vel = (a->Velocity + b->Velocity + c->Velocity) / 3.0;
+
+        const float* wha = &m_heights[first_center + i * 6];
+        const int pm = addPoint(m);
+        const int pab = addPoint(mab);
+        const int pbc = addPoint(mbc);
+        const int pca = addPoint(mca);
+        const int type = buoycabtypes[i];
+        addSubmergedParts(pa, pab, pm, wha[0], vel, type, a);
+        addSubmergedParts(pa, pm, pca, wha[1], vel, type, a);
+        addSubmergedParts(pb, pbc, pm, wha[2], vel, type, b);
+        addSubmergedParts(pb, pm, pab, wha[3], vel, type, b);
+        addSubmergedParts(pc, pca, pm, wha[4], vel, type, c);
+        addSubmergedParts(pc, pm, pbc, wha[5], vel, type, c);
+    }
+
+    if (m_submerged.empty())
+        return;
+
+    // second batch: wave heights at the new corners, and wave velocity at the center of each submerged part
+    const int num_submerged = (int)m_submerged.size();
+    m_heights.resize(m_points.size());
+    water->getWavesBatch(m_points.data() + first_pending, (int)m_points.size() - first_pending, m_heights.data() + first_pending, nullptr);
+    m_centers.clear();
+    for (const submerged_tri_t& tri : m_submerged)
+    {
+        m_centers.push_back((m_points[tri.a] + m_points[tri.b] + m_points[tri.c]) / 3.0);
+    }
+    m_center_heights.resize(num_submerged);
+    m_velocities.resize(num_submerged);
+    water->getWavesBatch(m_centers.data(), num_submerged, m_center_heights.data(), m_velocities.data());
 
     //apply forces
-    a->Forces += computePressureForce(a->AbsPosition, mab, m, vel, type) + computePressureForce(a->AbsPosition, m, mca, vel, type);
-    b->Forces += computePressureForce(b->AbsPosition, mbc, m, vel, type) + computePressureForce(b->AbsPosition, m, mab, vel, type);
-    c->Forces += computePressureForce(c->AbsPosition, mca, m, vel, type) + computePressureForce(c->AbsPosition, m, mbc, vel, type);
+    for (int i = 0; i < num_submerged; i++)
+    {
+        const submerged_tri_t& tri = m_submerged[i];
+        tri.node->Forces += computePressureForceSub(tri, m_velocities[i]);
+    }
 }
 
 void Buoyance::setsink(int v)
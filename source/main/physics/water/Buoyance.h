@@ -22,6 +22,8 @@
 
 #include "RoRPrerequisites.h"
 
+#include <vector>
+
 class Buoyance
 {
 public:
@@ -29,7 +31,12 @@ public:
     Buoyance(DustPool* splash, DustPool* ripple);
     ~Buoyance();
 
-    void computeNodeForce(node_t *a, node_t *b, node_t *c, bool doUpdate, int type);
+    /// Applies pressure and drag forces of all buoyant cab triangles of a truck.
+    /// The wave heights and velocities it needs are evaluated in two batches, see IWater::getWavesBatch().
+    /// The waves don't change within a substep, so points of the first batch aren't evaluated again in the second.
+    /// @param cabs      Node indices, 3 per cab
+    /// @param buoycabs  Indices of the buoyant cabs, 'count' of them
+    void computeNodeForces(node_t* nodes, const int* cabs, const int* buoycabs, const int* buoycabtypes, int count, bool doUpdate);
 
     void setsink(int v);
 
@@ -37,17 +44,37 @@ public:
 
 private:
 
+    /// Part of a cab triangle below the water line; its forces go to 'node'
+    struct submerged_tri_t
+    {
+        int a, b, c;             //!< Corners, indices into m_points and m_heights
+        Ogre::Vector3 vel;
+        node_t* node;
+        int type;
+    };
+
     //compute tetrahedron volume
     inline float computeVolume(Ogre::Vector3 o, Ogre::Vector3 a, Ogre::Vector3 b, Ogre::Vector3 c);
 
-    //compute pressure and drag force on a submerged triangle
-    Ogre::Vector3 computePressureForceSub(Ogre::Vector3 a, Ogre::Vector3 b, Ogre::Vector3 c, Ogre::Vector3 vel, int type);
+    //compute pressure and drag force on a submerged triangle, with the wave heights at its corners from m_heights
+    Ogre::Vector3 computePressureForceSub(const submerged_tri_t& tri, Ogre::Vector3 water_vel);
     
-    //compute pressure and drag forces on a random triangle
-    Ogre::Vector3 computePressureForce(Ogre::Vector3 a, Ogre::Vector3 b, Ogre::Vector3 c, Ogre::Vector3 vel, int type);
+    //cut a random triangle (corners indexing m_points) at the wave height 'wha' and queue its submerged part(s)
+    void addSubmergedParts(int a, int b, int c, float wha, Ogre::Vector3 vel, int type, node_t* node);
+
+    int addPoint(const Ogre::Vector3& pos) { m_points.push_back(pos); return (int)m_points.size() - 1; }
     
     DustPool *splashp, *ripplep;
     int sink;
     bool update;
+
+    // scratch space, reused every call
+    std::vector<int> m_node_points;                //!< Node index -> index in m_points, or -1
+    std::vector<Ogre::Vector3> m_points;           //!< Wave height queries of both batches
+    std::vector<float> m_heights;                  //!< Results, same indices as m_points
+    std::vector<Ogre::Vector3> m_centers;          //!< Wave velocity queries, one per submerged part
+    std::vector<float> m_center_heights;
+    std::vector<Ogre::Vector3> m_velocities;
+    std::vector<submerged_tri_t> m_submerged;
 };
 
@@ -44,7 +44,7 @@ Screwprop::Screwprop(DustManager* dustman, node_t* nodes, int noderef, int nodeb
 
 void Screwprop::updateForces(int update)
 {
-    if (!gEnv->terrainManager->getWater())
+    if (!gEnv->terrainManager || !gEnv->terrainManager->getWater())
         return;
     float depth = gEnv->terrainManager->getWater()->getHeightWaves(nodes[noderef].AbsPosition) - nodes[noderef].AbsPosition.y;
     if (depth < 0)
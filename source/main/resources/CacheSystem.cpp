@@ -32,22 +32,303 @@
 #include "BeamEngine.h"
 #include "ErrorUtils.h"
 #include "GUIManager.h"
-#include "ImprovedConfigFile.h"
 #include "Language.h"
 #include "PlatformUtils.h"
+#include "RigDef_FileCache.h"
 #include "RigDef_Parser.h"
 #include "Settings.h"
 #include "SHA1.h"
 #include "SoundScriptManager.h"
 #include "TerrainManager.h"
 #include "Terrn2Fileformat.h"
+#include "ThreadPool.h"
 #include "Utils.h"
 
 #include "GUI_LoadingWindow.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+
 using namespace Ogre;
 using namespace RoR;
 
+// Binary cache file, see CacheSystem::writeGeneratedCache():
+// CacheFileHeader, CacheFileEntry[num_entries], CacheFileAuthor[num_authors],
+// uint32_t[num_string_refs], then 'strings_size' bytes of zero-terminated strings.
+// Strings are stored once and referenced by offset; lists (authors, section configs,
+// materials) by a range into their array.
+
+static const char CACHE_FILE_MAGIC[8] = { 'R', 'o', 'R', 'C', 'a', 'c', 'h', 'e' };
+
+#pragma pack(push, 1)
+
+struct CacheFileHeader
+{
+    char     magic[8];          //!< CACHE_FILE_MAGIC
+    uint32_t format;            //!< CACHE_FILE_FORMAT
+    char     shaone[64];        //!< Hash over the installed content, see CacheSystem::filenamesSHA1()
+    uint32_t num_entries;
+    uint32_t num_authors;
+    uint32_t num_string_refs;
+    uint32_t strings_size;
+};
+
+struct CacheFileRange
+{
+    uint32_t first;
+    uint32_t count;
+};
+
+struct CacheFileAuthor
+{
+    int32_t  id;
+    uint32_t type;
+    uint32_t name;
+    uint32_t email;
+};
+
+struct CacheFileEntry
+{
+    // Strings
+    uint32_t minitype;
+    uint32_t fname;
+    uint32_t fname_without_uid;
+    uint32_t dname;
+    uint32_t uniqueid;
+    uint32_t guid;
+    uint32_t fext;
+    uint32_t type;
+    uint32_t dirname;
+    uint32_t hash;
+    uint32_t filecachename;
+    uint32_t description;
+    uint32_t tags;
+
+    // Lists
+    CacheFileRange authors;
+    CacheFileRange sectionconfigs;
+    CacheFileRange materials;
+
+    int64_t  filetime;
+    int32_t  number;
+    int32_t  categoryid;
+    int32_t  addtimestamp;
+    int32_t  version;
+    int32_t  usagecounter;
+
+    // Truck details
+    int32_t  fileformatversion;
+    int32_t  nodecount;
+    int32_t  beamcount;
+    int32_t  shockcount;
+    int32_t  fixescount;
+    int32_t  hydroscount;
+    int32_t  wheelcount;
+    int32_t  propwheelcount;
+    int32_t  commandscount;
+    int32_t  flarescount;
+    int32_t  propscount;
+    int32_t  wingscount;
+    int32_t  turbopropscount;
+    int32_t  turbojetcount;
+    int32_t  rotatorscount;
+    int32_t  exhaustscount;
+    int32_t  flexbodiescount;
+    int32_t  materialflarebindingscount;
+    int32_t  soundsourcescount;
+    int32_t  managedmaterialscount;
+    float    truckmass;
+    float    loadmass;
+    float    minrpm;
+    float    maxrpm;
+    float    torque;
+    int32_t  driveable;
+    int32_t  numgears;
+    char     enginetype;
+    uint8_t  hasSubmeshs;
+    uint8_t  customtach;
+    uint8_t  custom_particles;
+    uint8_t  forwardcommands;
+    uint8_t  importcommands;
+    uint8_t  rollon;
+    uint8_t  rescuer;
+};
+
+#pragma pack(pop)
+
+/// Builds the string table and lists while writing the cache
+class CacheFileBuilder
+{
+public:
+    CacheFileBuilder()
+    {
+        AddString(""); // Offset 0 = empty string
+    }
+
+    uint32_t AddString(const String& str)
+    {
+        auto found = m_string_offsets.find(str);
+        if (found != m_string_offsets.end())
+            return found->second;
+
+        const uint32_t offset = (uint32_t)m_strings.size();
+        m_strings.insert(m_strings.end(), str.begin(), str.end());
+        m_strings.push_back('\0');
+        m_string_offsets.insert(std::make_pair(str, offset));
+        return offset;
+    }
+
+    template <typename CONTAINER> CacheFileRange AddStringList(const CONTAINER& list)
+    {
+        CacheFileRange range;
+        range.first = (uint32_t)string_refs.size();
+        range.count = (uint32_t)list.size();
+        for (const String& str : list)
+        {
+            string_refs.push_back(this->AddString(str));
+        }
+        return range;
+    }
+
+    CacheFileRange AddAuthors(const std::vector<AuthorInfo>& list)
+    {
+        CacheFileRange range;
+        range.first = (uint32_t)authors.size();
+        range.count = (uint32_t)list.size();
+        for (const AuthorInfo& author : list)
+        {
+            CacheFileAuthor a;
+            a.id    = author.id;
+            a.type  = this->AddString(author.type);
+            a.name  = this->AddString(author.name);
+            a.email = this->AddString(author.email);
+            authors.push_back(a);
+        }
+        return range;
+    }
+
+    const std::vector<char>& GetStrings() const { return m_strings; }
+
+    std::vector<CacheFileEntry>  entries;
+    std::vector<CacheFileAuthor> authors;
+    std::vector<uint32_t>        string_refs;
+
+private:
+    std::vector<char>                         m_strings;
+    std::unordered_map<std::string, uint32_t> m_string_offsets;
+};
+
+/// Validating view of a cache file read to memory
+class CacheFileView
+{
+public:
+    CacheFileView(): m_entries(nullptr), m_authors(nullptr), m_string_refs(nullptr), m_strings(nullptr)
+    {
+        memset(&m_header, 0, sizeof(m_header));
+    }
+
+    bool Load(const std::vector<char>& data)
+    {
+        if (data.size() < sizeof(CacheFileHeader))
+            return false;
+        memcpy(&m_header, &data[0], sizeof(CacheFileHeader));
+        if (memcmp(m_header.magic, CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC)) != 0 || m_header.format != CACHE_FILE_FORMAT)
+            return false;
+
+        const uint64_t size = sizeof(CacheFileHeader)
+            + (uint64_t)m_header.num_entries * sizeof(CacheFileEntry)
+            + (uint64_t)m_header.num_authors * sizeof(CacheFileAuthor)
+            + (uint64_t)m_header.num_string_refs * sizeof(uint32_t)
+            + m_header.strings_size;
+        if (size != data.size() || m_header.strings_size == 0 || data.back() != '\0')
+            return false;
+
+        const char* pos = &data[0] + sizeof(CacheFileHeader);
+        m_entries     = pos; pos += m_header.num_entries * sizeof(CacheFileEntry);
+        m_authors     = pos; pos += m_header.num_authors * sizeof(CacheFileAuthor);
+        m_string_refs = pos; pos += m_header.num_string_refs * sizeof(uint32_t);
+        m_strings     = pos;
+        return true;
+    }
+
+    const CacheFileHeader& GetHeader() const { return m_header; }
+
+    CacheFileEntry GetEntry(uint32_t index) const
+    {
+        CacheFileEntry e;
+        memcpy(&e, m_entries + index * sizeof(CacheFileEntry), sizeof(CacheFileEntry));
+        return e;
+    }
+
+    /// @return Empty string if the offset is invalid
+    const char* GetString(uint32_t offset) const
+    {
+        return (offset < m_header.strings_size) ? (m_strings + offset) : "";
+    }
+
+    bool IsValid(const CacheFileRange& range, uint32_t array_size) const
+    {
+        return range.first <= array_size && range.count <= array_size - range.first;
+    }
+
+    template <typename CONTAINER> void GetStringList(const CacheFileRange& range, CONTAINER& out) const
+    {
+        if (!this->IsValid(range, m_header.num_string_refs))
+            return;
+        for (uint32_t i = range.first; i < range.first + range.count; i++)
+        {
+            uint32_t offset;
+            memcpy(&offset, m_string_refs + i * sizeof(uint32_t), sizeof(uint32_t));
+            out.insert(out.end(), this->GetString(offset));
+        }
+    }
+
+    void GetAuthors(const CacheFileRange& range, std::vector<AuthorInfo>& out) const
+    {
+        if (!this->IsValid(range, m_header.num_authors))
+            return;
+        for (uint32_t i = range.first; i < range.first + range.count; i++)
+        {
+            CacheFileAuthor a;
+            memcpy(&a, m_authors + i * sizeof(CacheFileAuthor), sizeof(CacheFileAuthor));
+            AuthorInfo author;
+            author.id    = a.id;
+            author.type  = this->GetString(a.type);
+            author.name  = this->GetString(a.name);
+            author.email = this->GetString(a.email);
+            out.push_back(author);
+        }
+    }
+
+private:
+    CacheFileHeader m_header;
+    const char*     m_entries;
+    const char*     m_authors;
+    const char*     m_string_refs;
+    const char*     m_strings;
+};
+
+static bool ReadWholeFile(const String& path, std::vector<char>& out)
+{
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    bool ok = (size > 0);
+    if (ok)
+    {
+        out.resize(size);
+        ok = (fread(&out[0], 1, size, f) == (size_t)size);
+    }
+    fclose(f);
+    return ok;
+}
+
 // default constructor resets the data.
 CacheEntry::CacheEntry() :
     //authors
@@ -119,6 +400,9 @@ CacheSystem::CacheSystem() :
     , deletedFiles(0)
     , newFiles(0)
     , rgcounter(0)
+    , m_index_dirty(true)
+    , m_defer_parsing(false)
+    , m_pending_bytes(0)
 {
     // register the extensions
     known_extensions.push_back("machine");
@@ -166,7 +450,12 @@ void CacheSystem::Startup(bool force_check)
         validity = IsCacheValid();
     }
 
-    if (validity != CACHE_VALID)
+    if (validity != CACHE_VALID && App::app_headless.GetActive())
+    {
+        // Updating needs the loading window and thumbnail textures; use whatever was cached by a regular run
+        LOG("cache invalid, but it can't be updated in headless mode. Start the game normally once to update it.");
+    }
+    else if (validity != CACHE_VALID)
     {
         LOG("cache invalid, updating ...");
         // generate the cache
@@ -208,6 +497,7 @@ std::map<int, Category_Entry>* CacheSystem::getCategories()
 
 std::vector<CacheEntry>* CacheSystem::getEntries()
 {
+    m_index_dirty = true; // The caller may reorder or modify entries
     return &entries;
 }
 
@@ -234,28 +524,32 @@ bool CacheSystem::resourceExistsInAllGroups(Ogre::String filename)
 
 CacheSystem::CacheValidityState CacheSystem::IsCacheValid()
 {
-    String cfgfilename = getCacheConfigFilename(false);
-    ImprovedConfigFile cfg;
-    if (!resourceExistsInAllGroups(cfgfilename))
+    String path = getCacheConfigFilename(true);
+    CacheFileHeader header;
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f)
     {
-        LOG("unable to load config file: "+cfgfilename);
+        LOG("unable to load cache file: "+path);
         return CACHE_NEEDS_UPDATE_FULL;
     }
+    const bool read_ok = (fread(&header, sizeof(CacheFileHeader), 1, f) == 1);
+    fclose(f);
 
-    String group = ResourceGroupManager::getSingleton().findGroupContainingResource(cfgfilename);
-    DataStreamPtr stream = ResourceGroupManager::getSingleton().openResource(cfgfilename, group);
-    cfg.load(stream, "\t:=", false);
-    String shaone = cfg.GetString("shaone");
-    String cacheformat = cfg.GetString("cacheformat");
-
-    if (shaone == "" || shaone != currentSHA1)
+    if (!read_ok || memcmp(header.magic, CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC)) != 0)
+    {
+        LOG("* mod cache is not a binary cache file, regenerating new one ...");
+        return CACHE_NEEDS_UPDATE_FULL;
+    }
+    header.shaone[sizeof(header.shaone) - 1] = '\0';
+    if (header.shaone[0] == '\0' || currentSHA1 != header.shaone)
     {
         LOG("* mod cache is invalid (not up to date), regenerating new one ...");
         return CACHE_NEEDS_UPDATE_INCREMENTAL;
     }
-    if (cacheformat != String(CACHE_FILE_FORMAT))
+    if (header.format != CACHE_FILE_FORMAT)
     {
         entries.clear();
+        m_index_dirty = true;
         LOG("* mod cache has invalid format, trying to regenerate");
         return CACHE_NEEDS_UPDATE_INCREMENTAL;
     }
@@ -263,629 +557,111 @@ CacheSystem::CacheValidityState CacheSystem::IsCacheValid()
     return CACHE_VALID;
 }
 
-void CacheSystem::logBadTruckAttrib(const String& line, CacheEntry& t)
-{
-    LOG("Bad Mod attribute line: " + line + " in mod " + t.dname);
-}
-
-void CacheSystem::parseModAttribute(const String& line, CacheEntry& t)
-{
-    Ogre::StringVector params = StringUtil::split(line, "\x09\x0a=,");
-    String& attrib = params[0];
-    StringUtil::toLowerCase(attrib);
-    if (attrib == "number")
-    {
-        // Check params
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        t.number = StringConverter::parseInt(params[1]);
-    }
-    else if (attrib == "deleted")
-    {
-        // Check params
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        t.deleted = StringConverter::parseBool(params[1]);
-    }
-    else if (attrib == "usagecounter")
-    {
-        // Check params
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        t.usagecounter = StringConverter::parseInt(params[1]);
-    }
-    else if (attrib == "addtimestamp")
-    {
-        // Check params
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        t.addtimestamp = StringConverter::parseInt(params[1]);
-    }
-    else if (attrib == "minitype")
-    {
-        // Check params
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        t.minitype = params[1];
-    }
-    else if (attrib == "type")
-    {
-        // Check params
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        t.type = params[1];
-    }
-    else if (attrib == "dirname")
-    {
-        // Check params
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        t.dirname = params[1];
-    }
-    else if (attrib == "filecachename")
-    {
-        // Check params
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        t.filecachename = params[1];
-    }
-    else if (attrib == "fname")
-    {
-        // Check params
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        t.fname = params[1];
-    }
-    else if (attrib == "fname_without_uid")
-    {
-        // Check params
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        t.fname_without_uid = params[1];
-    }
-    else if (attrib == "fext")
-    {
-        // Check params
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        t.fext = params[1];
-    }
-    else if (attrib == "filetime")
-    {
-        // Check params
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        t.filetime = Ogre::StringConverter::parseLong(params[1]);
-    }
-    else if (attrib == "dname")
-    {
-        // Check params
-        if (params.size() < 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        t.dname = params[1];
-    }
-    else if (attrib == "hash")
-    {
-        // Check params
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        t.hash = params[1];
-    }
-    else if (attrib == "categoryid")
-    {
-        // Check params
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        t.categoryid = StringConverter::parseInt(params[1]);
-        category_usage[t.categoryid] = category_usage[t.categoryid] + 1;
-        if (categories.find(t.categoryid) != categories.end())
-        {
-            t.categoryname = categories[t.categoryid].title;
-        }
-        else
-        {
-            t.categoryid = -1;
-            t.categoryname = "Unsorted";
-        }
-    }
-    else if (attrib == "uniqueid")
-    {
-        // Check params
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        t.uniqueid = params[1];
-    }
-    else if (attrib == "guid")
-    {
-        // Check params
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        t.guid = params[1];
-        StringUtil::trim(t.guid);
-    }
-    else if (attrib == "version")
-    {
-        // Check params
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        t.version = StringConverter::parseInt(params[1]);
-    }
-    else if (attrib == "author")
-    {
-        // Check params
-        if (params.size() < 5)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        // Set
-        AuthorInfo ai;
-        ai.id = StringConverter::parseInt(params[2]);
-        ai.type = params[1];
-        ai.name = params[3];
-        ai.email = params[4];
-        t.authors.push_back(ai);
-    }
-    else if (attrib == "sectionconfig")
-    {
-        // Check params
-        if (params.size() < 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        t.sectionconfigs.push_back(params[1]);
-    }
-
-    // TRUCK detail parameters below
-    else if (attrib == "description")
-        if (params.size() < 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.description = deNormalizeText(params[1]);
-    else if (attrib == "tags")
-        if (params.size() < 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.tags = params[1];
-    else if (attrib == "fileformatversion")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.fileformatversion = StringConverter::parseInt(params[1]);
-    else if (attrib == "hasSubmeshs")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.hasSubmeshs = StringConverter::parseBool(params[1]);
-    else if (attrib == "nodecount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.nodecount = StringConverter::parseInt(params[1]);
-    else if (attrib == "beamcount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.beamcount = StringConverter::parseInt(params[1]);
-    else if (attrib == "shockcount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.shockcount = StringConverter::parseInt(params[1]);
-    else if (attrib == "fixescount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.fixescount = StringConverter::parseInt(params[1]);
-    else if (attrib == "hydroscount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.hydroscount = StringConverter::parseInt(params[1]);
-    else if (attrib == "wheelcount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.wheelcount = StringConverter::parseInt(params[1]);
-    else if (attrib == "propwheelcount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.propwheelcount = StringConverter::parseInt(params[1]);
-    else if (attrib == "commandscount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.commandscount = StringConverter::parseInt(params[1]);
-    else if (attrib == "flarescount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.flarescount = StringConverter::parseInt(params[1]);
-    else if (attrib == "propscount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.propscount = StringConverter::parseInt(params[1]);
-    else if (attrib == "wingscount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.wingscount = StringConverter::parseInt(params[1]);
-    else if (attrib == "turbopropscount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.turbopropscount = StringConverter::parseInt(params[1]);
-    else if (attrib == "turbojetcount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.turbojetcount = StringConverter::parseInt(params[1]);
-    else if (attrib == "rotatorscount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.rotatorscount = StringConverter::parseInt(params[1]);
-    else if (attrib == "exhaustscount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.exhaustscount = StringConverter::parseInt(params[1]);
-    else if (attrib == "flexbodiescount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.flexbodiescount = StringConverter::parseInt(params[1]);
-    else if (attrib == "materialflarebindingscount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.materialflarebindingscount = StringConverter::parseInt(params[1]);
-    else if (attrib == "soundsourcescount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.soundsourcescount = StringConverter::parseInt(params[1]);
-    else if (attrib == "managedmaterialscount")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.managedmaterialscount = StringConverter::parseInt(params[1]);
-    else if (attrib == "truckmass")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.truckmass = StringConverter::parseReal(params[1]);
-    else if (attrib == "loadmass")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.loadmass = StringConverter::parseReal(params[1]);
-    else if (attrib == "minrpm")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.minrpm = StringConverter::parseReal(params[1]);
-    else if (attrib == "maxrpm")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.maxrpm = StringConverter::parseReal(params[1]);
-    else if (attrib == "torque")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.torque = StringConverter::parseReal(params[1]);
-    else if (attrib == "customtach")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.customtach = StringConverter::parseBool(params[1]);
-    else if (attrib == "custom_particles")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.custom_particles = StringConverter::parseBool(params[1]);
-    else if (attrib == "forwardcommands")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.forwardcommands = StringConverter::parseBool(params[1]);
-    else if (attrib == "rollon")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.rollon = StringConverter::parseBool(params[1]);
-    else if (attrib == "rescuer")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.rescuer = StringConverter::parseBool(params[1]);
-    else if (attrib == "driveable")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.driveable = StringConverter::parseInt(params[1]);
-    else if (attrib == "numgears")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.numgears = StringConverter::parseInt(params[1]);
-    else if (attrib == "enginetype")
-        if (params.size() != 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-            t.enginetype = StringConverter::parseInt(params[1]);
-    else if (attrib == "materials")
-    {
-        if (params.size() < 2)
-        {
-            logBadTruckAttrib(line, t);
-            return;
-        }
-        else
-        {
-            String mat = params[1];
-            Ogre::StringVector ar = StringUtil::split(mat, " ");
-            for (Ogre::StringVector::iterator it = ar.begin(); it != ar.end(); it++)
-            {
-                t.materials.insert(*it);
-            }
-        }
-    }
-}
-
 bool CacheSystem::loadCache()
 {
     // Clear existing entries
     entries.clear();
+    m_index_dirty = true;
 
-    String cfgfilename = getCacheConfigFilename(false);
-
-    if (!resourceExistsInAllGroups(cfgfilename))
+    String path = getCacheConfigFilename(true);
+    std::vector<char> data;
+    CacheFileView file;
+    if (!ReadWholeFile(path, data))
     {
-        LOG("unable to load config file: "+cfgfilename);
+        LOG("unable to load cache file: "+path);
+        return false;
+    }
+    if (!file.Load(data))
+    {
+        LOG("invalid cache file: "+path);
         return false;
     }
-
-    String group = ResourceGroupManager::getSingleton().findGroupContainingResource(String(cfgfilename));
-    DataStreamPtr stream = ResourceGroupManager::getSingleton().openResource(cfgfilename, group);
 
     LOG("CacheSystem::loadCache");
 
-    CacheEntry t;
-    String line = "";
-    int mode = 0;
-
-    while (!stream->eof())
-    {
-        line = stream->getLine();
-
-        // Ignore blanks & comments
-        if (line.empty() || line.substr(0, 2) == "//")
-        {
-            continue;
+    const uint32_t num_entries = file.GetHeader().num_entries;
+    entries.reserve(num_entries);
+    for (uint32_t i = 0; i < num_entries; i++)
+    {
+        const CacheFileEntry e = file.GetEntry(i);
+        CacheEntry t;
+        t.resourceLoaded    = false;
+        t.deleted           = false;
+        t.changedornew      = false; // default upon loading
+
+        t.minitype          = file.GetString(e.minitype);
+        t.fname             = file.GetString(e.fname);
+        t.fname_without_uid = file.GetString(e.fname_without_uid);
+        t.dname             = file.GetString(e.dname);
+        t.uniqueid          = file.GetString(e.uniqueid);
+        t.guid              = file.GetString(e.guid);
+        t.fext              = file.GetString(e.fext);
+        t.type              = file.GetString(e.type);
+        t.dirname           = file.GetString(e.dirname);
+        t.hash              = file.GetString(e.hash);
+        t.filecachename     = file.GetString(e.filecachename);
+        t.description       = file.GetString(e.description);
+        t.tags              = file.GetString(e.tags);
+
+        file.GetAuthors(e.authors, t.authors);
+        file.GetStringList(e.sectionconfigs, t.sectionconfigs);
+        file.GetStringList(e.materials, t.materials);
+
+        t.filetime          = (std::time_t)e.filetime;
+        t.number            = e.number;
+        t.addtimestamp      = e.addtimestamp;
+        t.version           = e.version;
+        t.usagecounter      = e.usagecounter;
+
+        t.categoryid = e.categoryid;
+        auto category = categories.find(t.categoryid);
+        if (category != categories.end())
+        {
+            t.categoryname = category->second.title;
         }
-
-        // Skip these
-        if (StringUtil::startsWith(line, "shaone=") || StringUtil::startsWith(line, "modcount=") || StringUtil::startsWith(line, "cacheformat="))
+        else
         {
-            continue;
+            t.categoryid = -1;
+            t.categoryname = "Unsorted";
         }
 
-        if (mode == 0)
-        {
-            // No current entry
-            if (line == "mod")
-            {
-                mode = 1;
-                t = CacheEntry();
-                t.resourceLoaded = false;
-                t.deleted = false;
-                t.changedornew = false; // default upon loading
-                // Skip to and over next {
-                stream->skipLine("{");
-            }
-        }
-        else if (mode == 1)
-        {
-            // Already in mod
-            if (line == "}")
-            {
-                // Finished
-                if (!t.deleted)
-                {
-                    entries.push_back(t);
-                }
-                mode = 0;
-            }
-            else
-            {
-                parseModAttribute(line, t);
-            }
-        }
+        t.fileformatversion          = e.fileformatversion;
+        t.nodecount                  = e.nodecount;
+        t.beamcount                  = e.beamcount;
+        t.shockcount                 = e.shockcount;
+        t.fixescount                 = e.fixescount;
+        t.hydroscount                = e.hydroscount;
+        t.wheelcount                 = e.wheelcount;
+        t.propwheelcount             = e.propwheelcount;
+        t.commandscount              = e.commandscount;
+        t.flarescount                = e.flarescount;
+        t.propscount                 = e.propscount;
+        t.wingscount                 = e.wingscount;
+        t.turbopropscount            = e.turbopropscount;
+        t.turbojetcount              = e.turbojetcount;
+        t.rotatorscount              = e.rotatorscount;
+        t.exhaustscount              = e.exhaustscount;
+        t.flexbodiescount            = e.flexbodiescount;
+        t.materialflarebindingscount = e.materialflarebindingscount;
+        t.soundsourcescount          = e.soundsourcescount;
+        t.managedmaterialscount      = e.managedmaterialscount;
+        t.truckmass                  = e.truckmass;
+        t.loadmass                   = e.loadmass;
+        t.minrpm                     = e.minrpm;
+        t.maxrpm                     = e.maxrpm;
+        t.torque                     = e.torque;
+        t.driveable                  = e.driveable;
+        t.numgears                   = e.numgears;
+        t.enginetype                 = e.enginetype;
+        t.hasSubmeshs                = (e.hasSubmeshs != 0);
+        t.customtach                 = (e.customtach != 0);
+        t.custom_particles           = (e.custom_particles != 0);
+        t.forwardcommands            = (e.forwardcommands != 0);
+        t.importcommands             = (e.importcommands != 0);
+        t.rollon                     = (e.rollon != 0);
+        t.rescuer                    = (e.rescuer != 0);
+
+        entries.push_back(t);
     }
     return true;
 }
@@ -914,6 +690,7 @@ String CacheSystem::getVirtualPath(String path)
 int CacheSystem::incrementalCacheUpdate()
 {
     entries.clear();
+    m_index_dirty = true;
 
     if (!loadCache())
     //error loading cache!
@@ -924,33 +701,30 @@ int CacheSystem::incrementalCacheUpdate()
     auto* loading_win = RoR::App::GetGuiManager()->GetLoadingWindow();
     loading_win->setProgress(20, _L("incremental check: deleted and changed files"));
     std::vector<CacheEntry> changed_entries;
-    UTFString tmp = "";
-    String fn = "";
-    int counter = 0;
-    for (std::vector<CacheEntry>::iterator it = entries.begin(); it != entries.end(); it++ , counter++)
-    {
-        int progress = ((float)counter / (float)(entries.size())) * 100;
-        tmp = _L("incremental check: deleted and changed files\n") + ANSI_TO_UTF(it->type) + _L(": ") + ANSI_TO_UTF(it->fname);
-        loading_win->setProgress(progress, tmp);
-        // check whether the file exists
-        if (it->type == "Zip")
-            fn = getRealPath(it->dirname);
-        else if (it->type == "FileSystem")
-            fn = getRealPath(it->dirname + "/" + it->fname);
 
-        if ((it->type == "FileSystem" || it->type == "Zip") && ! RoR::PlatformUtils::FileExists(fn.c_str()))
+    // check all files on the thread pool, then process the results in order
+    enum FileState { FILE_UNCHANGED, FILE_MISSING, FILE_CHANGED };
+    std::vector<String> paths(entries.size());
+    std::vector<FileState> states(entries.size(), FILE_UNCHANGED);
+    auto check_file = [this, &paths, &states](int index)
+    {
+        const CacheEntry& entry = entries[index];
+        String& fn = paths[index];
+        if (entry.type == "Zip")
+            fn = getRealPath(entry.dirname);
+        else if (entry.type == "FileSystem")
+            fn = getRealPath(entry.dirname + "/" + entry.fname);
+        else
+            return;
+
+        // check whether the file exists
+        if (!RoR::PlatformUtils::FileExists(fn.c_str()))
         {
-            LOG("- "+fn+" is not existing");
-            tmp = _L("incremental check: deleted and changed files\n") + ANSI_TO_UTF(it->fname) + _L(" not existing");
-            loading_win->setProgress(20, tmp);
-            removeFileFromFileCache(it);
-            it->deleted = true;
-            // do not try: entries.erase(it)
-            deletedFiles++;
-            continue;
+            states[index] = FILE_MISSING;
+            return;
         }
         // check whether it changed
-        if (it->type == "Zip")
+        if (entry.type == "Zip")
         {
             // check file time, if that fails, fall back to sha1 (needed for platforms where filetime is not yet implemented!
             bool check = false;
@@ -964,22 +738,38 @@ int CacheSystem::incrementalCacheUpdate()
                 sha1.HashFile(const_cast<char*>(fn.c_str()));
                 sha1.Final();
                 sha1.ReportHash(hash, RoR::CSHA1::REPORT_HEX_SHORT);
-                check = (it->hash != String(hash));
+                check = (entry.hash != String(hash));
             }
             else
             {
                 // faster file time check
-                check = (it->filetime != ft);
+                check = (entry.filetime != ft);
             }
 
             if (check)
-            {
-                changedFiles++;
-                LOG("- "+fn+" changed");
-                it->changedornew = true;
-                it->deleted = true; // see below
-                changed_entries.push_back(*it);
-            }
+                states[index] = FILE_CHANGED;
+        }
+    };
+    runParallel(static_cast<int>(entries.size()), check_file, _L("incremental check: deleted and changed files\n"));
+
+    for (std::vector<CacheEntry>::iterator it = entries.begin(); it != entries.end(); it++)
+    {
+        const size_t index = it - entries.begin();
+        if (states[index] == FILE_MISSING)
+        {
+            LOG("- "+paths[index]+" is not existing");
+            removeFileFromFileCache(it);
+            it->deleted = true;
+            // do not try: entries.erase(it)
+            deletedFiles++;
+        }
+        else if (states[index] == FILE_CHANGED)
+        {
+            changedFiles++;
+            LOG("- "+paths[index]+" changed");
+            it->changedornew = true;
+            it->deleted = true; // see below
+            changed_entries.push_back(*it);
         }
     }
 
@@ -1013,6 +803,8 @@ int CacheSystem::incrementalCacheUpdate()
     loading_win->setProgress(80, _L("incremental check: new files\n"));
     checkForNewKnownFiles();
 
+    processPendingFiles();
+
     LOG("* incremental check (5/5): duplicates ...");
     loading_win->setProgress(90, _L("incremental check: duplicates\n"));
     for (std::vector<CacheEntry>::iterator it = entries.begin(); it != entries.end(); it++)
@@ -1107,213 +899,207 @@ int CacheSystem::incrementalCacheUpdate()
 
 CacheEntry* CacheSystem::getEntry(int modid)
 {
-    for (std::vector<CacheEntry>::iterator it = entries.begin(); it != entries.end(); it++)
+    updateIndex();
+    auto found = m_entries_by_number.find(modid);
+    if (found != m_entries_by_number.end())
+        return &entries[found->second];
+    return 0;
+}
+
+CacheEntry* CacheSystem::getEntryByGUID(Ogre::String guid)
+{
+    updateIndex();
+    StringUtil::trim(guid);
+    StringUtil::toLowerCase(guid);
+    auto found = m_entries_by_guid.find(guid);
+    if (found != m_entries_by_guid.end())
+        return &entries[found->second];
+    return 0;
+}
+
+void CacheSystem::updateIndex()
+{
+    if (!m_index_dirty)
+        return;
+
+    m_entries_by_number.clear();
+    m_entries_by_fname.clear();
+    m_entries_by_name.clear();
+    m_entries_by_name_lower.clear();
+    m_entries_by_guid.clear();
+    m_entries_by_category.clear();
+    for (size_t i = 0; i < entries.size(); i++)
     {
-        if (modid == it->number)
-            return &(*it);
+        addEntryToIndex(i);
     }
-    return 0;
+    m_index_dirty = false;
+}
+
+void CacheSystem::addEntryToIndex(size_t index)
+{
+    // emplace() keeps an existing mapping, so lookups find the first matching entry, like the linear searches did
+    const CacheEntry& entry = entries[index];
+    m_entries_by_number.emplace(entry.number, index);
+    m_entries_by_fname.emplace(entry.fname, index);
+    m_entries_by_name.emplace(entry.fname, index);
+    m_entries_by_name.emplace(entry.fname_without_uid, index);
+
+    String name_lower = entry.fname;
+    StringUtil::toLowerCase(name_lower);
+    m_entries_by_name_lower.emplace(name_lower, index);
+    name_lower = entry.fname_without_uid;
+    StringUtil::toLowerCase(name_lower);
+    m_entries_by_name_lower.emplace(name_lower, index);
+
+    if (!entry.guid.empty())
+    {
+        String guid = entry.guid;
+        StringUtil::trim(guid);
+        StringUtil::toLowerCase(guid);
+        m_entries_by_guid.emplace(guid, index);
+    }
+
+    m_entries_by_category[entry.categoryid].push_back(index);
 }
 
 void CacheSystem::generateCache(bool forcefull)
 {
     this->modcounter = 0;
 
+    // hashing and reading the files' details is spread over all cores, see runParallel()
+    const int num_threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (RoR::App::app_multithread.GetActive() && num_threads > 1)
+    {
+        m_thread_pool = std::unique_ptr<ThreadPool>(new ThreadPool(num_threads));
+        LOG("Using " + TOSTRING(num_threads) + " threads to update the cache");
+    }
+    m_defer_parsing = true;
+
     // see if we can avoid a full regeneration
     if (forcefull || incrementalCacheUpdate())
     {
         loadAllZips();
+        processPendingFiles();
 
         writeGeneratedCache();
     }
+
+    // the parsed truck definitions live in the same directory, keep them from piling up
+    RigDef::FileCache::PruneSnapshots();
+
+    m_defer_parsing = false;
+    m_thread_pool.reset();
 }
 
-Ogre::String CacheSystem::formatInnerEntry(int counter, CacheEntry t)
-{
-    String result = "";
-    result += "\tnumber=" + TOSTRING(counter) + "\n"; // always count linear!
-    result += "\tdeleted=" + TOSTRING(t.deleted) + "\n";
-    if (!t.deleted)
-    {
-        // this ensures that we wont break the format with empty ("") values
-        if (t.minitype.empty())
-            t.minitype = "unknown";
-        if (t.type.empty())
-            t.type = "unknown";
-        if (t.dirname.empty())
-            t.dirname = "unknown";
-        if (t.fname.empty())
-            t.fname = "unknown";
-        if (t.fext.empty())
-            t.fext = "unknown";
-        if (t.dname.empty())
-            t.dname = "unknown";
-        if (t.hash.empty())
-            t.hash = "none";
-        if (t.uniqueid.empty())
-            t.uniqueid = "no-uid";
-        if (t.guid.empty())
-            t.guid = "no-guid";
-        if (t.fname_without_uid.empty())
-            t.fname_without_uid = "unknown";
-        if (t.filecachename.empty())
-            t.filecachename = "none";
-
-        result += "\tusagecounter=" + TOSTRING(t.usagecounter) + "\n";
-        result += "\taddtimestamp=" + TOSTRING(t.addtimestamp) + "\n";
-        result += "\tminitype=" + t.minitype + "\n";
-        result += "\ttype=" + t.type + "\n";
-        result += "\tdirname=" + t.dirname + "\n";
-        result += "\tfname=" + t.fname + "\n";
-        result += "\tfname_without_uid=" + t.fname_without_uid + "\n";
-        result += "\tfext=" + t.fext + "\n";
-        result += "\tfiletime=" + TOSTRING((long)t.filetime) + "\n";
-        result += "\tdname=" + t.dname + "\n";
-        result += "\thash=" + t.hash + "\n";
-        result += "\tcategoryid=" + TOSTRING(t.categoryid) + "\n";
-        result += "\tuniqueid=" + t.uniqueid + "\n";
-        result += "\tguid=" + t.guid + "\n";
-        result += "\tversion=" + TOSTRING(t.version) + "\n";
-        result += "\tfilecachename=" + t.filecachename + "\n";
-        //result += "\tnumauthors="+TOSTRING(t.authors.size())+"\n";
-
-        if (t.authors.size() > 0)
+void CacheSystem::runParallel(int count, const std::function<void(int)>& func, Ogre::UTFString text)
+{
+    if (count < 1)
+        return;
+
+    auto* loading_win = RoR::App::GetGuiManager()->GetLoadingWindow();
+    if (!m_thread_pool)
+    {
+        for (int i = 0; i < count; i++)
         {
-            for (int i = 0; i < (int)t.authors.size(); i++)
-            {
-                if (t.authors[i].type.empty())
-                    t.authors[i].type = "unknown";
-                if (t.authors[i].name.empty())
-                    t.authors[i].name = "unknown";
-                if (t.authors[i].email.empty())
-                    t.authors[i].email = "unknown";
-                result += "\tauthor=" + (t.authors[i].type) +
-                    "," + TOSTRING(t.authors[i].id) +
-                    "," + (t.authors[i].name) + "," + (t.authors[i].email) + "\n";
-            }
+            loading_win->setProgress((i * 100) / count, text + TOSTRING(i) + "/" + TOSTRING(count));
+            func(i);
         }
+        return;
+    }
 
-        // now add the truck details if existing
-        if (t.description != "")
-            result += "\tdescription=" + normalizeText(t.description) + "\n";
-        if (t.tags != "")
-            result += "\ttags=" + t.tags + "\n";
-        if (t.fileformatversion != 0)
-            result += "\tfileformatversion=" + TOSTRING(t.fileformatversion) + "\n";
-        if (t.hasSubmeshs)
-            result += "\thasSubmeshs=1\n";
-        if (t.nodecount != 0)
-            result += "\tnodecount=" + TOSTRING(t.nodecount) + "\n";
-        if (t.beamcount != 0)
-            result += "\tbeamcount=" + TOSTRING(t.beamcount) + "\n";
-        if (t.shockcount != 0)
-            result += "\tshockcount=" + TOSTRING(t.shockcount) + "\n";
-        if (t.fixescount != 0)
-            result += "\tfixescount=" + TOSTRING(t.fixescount) + "\n";
-        if (t.hydroscount != 0)
-            result += "\thydroscount=" + TOSTRING(t.hydroscount) + "\n";
-        if (t.wheelcount != 0)
-            result += "\twheelcount=" + TOSTRING(t.wheelcount) + "\n";
-        if (t.propwheelcount != 0)
-            result += "\tpropwheelcount=" + TOSTRING(t.propwheelcount) + "\n";
-        if (t.commandscount != 0)
-            result += "\tcommandscount=" + TOSTRING(t.commandscount) + "\n";
-        if (t.flarescount != 0)
-            result += "\tflarescount=" + TOSTRING(t.flarescount) + "\n";
-        if (t.propscount != 0)
-            result += "\tpropscount=" + TOSTRING(t.propscount) + "\n";
-        if (t.wingscount != 0)
-            result += "\twingscount=" + TOSTRING(t.wingscount) + "\n";
-        if (t.turbopropscount != 0)
-            result += "\tturbopropscount=" + TOSTRING(t.turbopropscount) + "\n";
-        if (t.turbojetcount != 0)
-            result += "\tturbojetcount=" + TOSTRING(t.turbojetcount) + "\n";
-        if (t.rotatorscount != 0)
-            result += "\trotatorscount=" + TOSTRING(t.rotatorscount) + "\n";
-        if (t.exhaustscount != 0)
-            result += "\texhaustscount=" + TOSTRING(t.exhaustscount) + "\n";
-        if (t.flexbodiescount != 0)
-            result += "\tflexbodiescount=" + TOSTRING(t.flexbodiescount) + "\n";
-        if (t.materialflarebindingscount != 0)
-            result += "\tmaterialflarebindingscount=" + TOSTRING(t.materialflarebindingscount) + "\n";
-        if (t.soundsourcescount != 0)
-            result += "\tsoundsourcescount=" + TOSTRING(t.soundsourcescount) + "\n";
-        if (t.managedmaterialscount != 0)
-            result += "\tmanagedmaterialscount=" + TOSTRING(t.managedmaterialscount) + "\n";
-        if (t.truckmass > 1)
-            result += "\ttruckmass=" + TOSTRING(t.truckmass) + "\n";
-        if (t.loadmass > 1)
-            result += "\tloadmass=" + TOSTRING(t.loadmass) + "\n";
-        if (t.minrpm > 1)
-            result += "\tminrpm=" + TOSTRING(t.minrpm) + "\n";
-        if (t.maxrpm > 1)
-            result += "\tmaxrpm=" + TOSTRING(t.maxrpm) + "\n";
-        if (t.torque > 1)
-            result += "\ttorque=" + TOSTRING(t.torque) + "\n";
-        if (t.customtach)
-            result += "\tcustomtach=1\n";
-        if (t.custom_particles)
-            result += "\tcustom_particles=1\n";
-        if (t.forwardcommands)
-            result += "\tforwardcommands=1\n";
-        if (t.importcommands)
-            result += "\timportcommands=1\n";
-        if (t.rollon)
-            result += "\trollon=1\n";
-        if (t.rescuer)
-            result += "\trescuer=1\n";
-        if (t.driveable != 0)
-            result += "\tdriveable=" + TOSTRING(t.driveable) + "\n";
-        if (t.numgears != 0)
-            result += "\tnumgears=" + TOSTRING(t.numgears) + "\n";
-        if (t.enginetype != 0)
-            result += "\tenginetype=" + TOSTRING(t.enginetype) + "\n";
-        if (t.materials.size())
+    // The pool does the work, this thread keeps the loading window alive
+    std::atomic<int> num_done(0);
+    auto task = m_thread_pool->RunTask([this, count, &func, &num_done]()
+    {
+        m_thread_pool->ParallelFor(0, count, 1, [&func, &num_done](int begin, int end)
         {
-            String matStr = "";
-            for (std::set<Ogre::String>::iterator it = t.materials.begin(); it != t.materials.end(); it++)
+            for (int i = begin; i < end; i++)
             {
-                matStr += *it + " ";
+                func(i);
+                num_done++;
             }
-            result += "\tmaterials=" + matStr + "\n";
-        }
-
-        if (t.sectionconfigs.size() > 0)
-        {
-            for (int i = 0; i < (int)t.sectionconfigs.size(); i++)
-                result += "\tsectionconfig=" + t.sectionconfigs[i] + "\n";
-        }
+        });
+    });
+    while (!task->is_finished())
+    {
+        const int done = num_done.load();
+        loading_win->setProgress((done * 100) / count, text + TOSTRING(done) + "/" + TOSTRING(count));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
     }
-
-    return result;
+    task->join();
 }
 
-Ogre::String CacheSystem::normalizeText(Ogre::String text)
+void CacheSystem::processPendingFiles()
 {
-    String result = "";
-    Ogre::StringVector str = Ogre::StringUtil::split(text, "\n");
-    for (Ogre::StringVector::iterator it = str.begin(); it != str.end(); it++)
-        result += *it + "$";
-    return result;
+    if (m_pending_files.empty())
+        return;
+
+    runParallel(static_cast<int>(m_pending_files.size()), [this](int index)
+    {
+        this->fillDetailInfo(m_pending_files[index]);
+    }, _L("reading content details\n"));
+
+    // add the entries in the order the files were found, so the result doesn't depend on the threads
+    for (PendingFile& file : m_pending_files)
+    {
+        if (!file.report.empty())
+            Ogre::LogManager::getSingleton().logMessage(file.report);
+        if (!file.valid)
+            continue;
+        entries.push_back(file.entry);
+        if (!m_index_dirty)
+            addEntryToIndex(entries.size() - 1);
+    }
+    m_pending_files.clear();
+    m_pending_fnames.clear();
+    m_pending_bytes = 0;
 }
 
-Ogre::String CacheSystem::deNormalizeText(Ogre::String text)
+void CacheSystem::fillDetailInfo(PendingFile& file)
 {
-    String result = "";
-    Ogre::StringVector str = Ogre::StringUtil::split(text, "$");
-    for (Ogre::StringVector::iterator it = str.begin(); it != str.end(); it++)
-        result += *it + "\n";
-    return result;
+    try
+    {
+        DataStreamPtr ds(OGRE_NEW MemoryDataStream(&file.content[0], file.content.size(), false, true));
+        if (file.entry.fext == "terrn2")
+        {
+            fillTerrainDetailInfo(file.entry, ds, file.entry.fname);
+        }
+        else
+        {
+            file.entry.dname = ds->getLine();
+            fillTruckDetailInfo(file.entry, ds, file.entry.fname, file.report);
+        }
+        file.valid = true;
+    }
+    catch (Ogre::Exception& e)
+    {
+        file.report += "error while reading '" + file.entry.fname + "': " + e.getFullDescription();
+    }
+    catch (std::exception& e)
+    {
+        file.report += "error while reading '" + file.entry.fname + "': " + e.what();
+    }
+    file.content.clear();
 }
 
-Ogre::String CacheSystem::formatEntry(int counter, CacheEntry t)
+void CacheSystem::hashZips(const std::vector<Ogre::String>& zippaths)
 {
-    String result = "mod\n";
-    result += "{\n";
-    result += formatInnerEntry(counter, t);
-    result += "}\n\n";
+    std::vector<String> hashes(zippaths.size());
+    runParallel(static_cast<int>(zippaths.size()), [this, &zippaths, &hashes](int index)
+    {
+        char hash[256] = {};
+        String realzipPath = getRealPath(zippaths[index]);
+        RoR::CSHA1 sha1;
+        sha1.HashFile(const_cast<char*>(realzipPath.c_str()));
+        sha1.Final();
+        sha1.ReportHash(hash, RoR::CSHA1::REPORT_HEX_SHORT);
+        hashes[index] = hash;
+    }, _L("hashing archives\n"));
 
-    return result;
+    for (size_t i = 0; i < zippaths.size(); i++)
+    {
+        zipHashes[getVirtualPath(zippaths[i])] = hashes[i];
+    }
 }
 
 void CacheSystem::writeGeneratedCache()
@@ -1321,29 +1107,114 @@ void CacheSystem::writeGeneratedCache()
     String path = getCacheConfigFilename(true);
     LOG("writing cache to file ("+path+")...");
 
-    FILE* f = fopen(path.c_str(), "w");
+    CacheFileBuilder builder;
+    int counter = 0;
+    for (const CacheEntry& t : entries)
+    {
+        if (t.deleted)
+            continue;
+
+        CacheFileEntry e;
+        memset(&e, 0, sizeof(CacheFileEntry));
+        e.minitype          = builder.AddString(t.minitype);
+        e.fname             = builder.AddString(t.fname);
+        e.fname_without_uid = builder.AddString(t.fname_without_uid);
+        e.dname             = builder.AddString(t.dname);
+        e.uniqueid          = builder.AddString(t.uniqueid);
+        e.guid              = builder.AddString(t.guid);
+        e.fext              = builder.AddString(t.fext);
+        e.type              = builder.AddString(t.type);
+        e.dirname           = builder.AddString(t.dirname);
+        e.hash              = builder.AddString(t.hash);
+        e.filecachename     = builder.AddString(t.filecachename);
+        e.description       = builder.AddString(t.description);
+        e.tags              = builder.AddString(t.tags);
+
+        e.authors           = builder.AddAuthors(t.authors);
+        e.sectionconfigs    = builder.AddStringList(t.sectionconfigs);
+        e.materials         = builder.AddStringList(t.materials);
+
+        e.filetime          = (int64_t)t.filetime;
+        e.number            = counter++; // always count linear!
+        e.categoryid        = t.categoryid;
+        e.addtimestamp      = t.addtimestamp;
+        e.version           = t.version;
+        e.usagecounter      = t.usagecounter;
+
+        e.fileformatversion          = t.fileformatversion;
+        e.nodecount                  = t.nodecount;
+        e.beamcount                  = t.beamcount;
+        e.shockcount                 = t.shockcount;
+        e.fixescount                 = t.fixescount;
+        e.hydroscount                = t.hydroscount;
+        e.wheelcount                 = t.wheelcount;
+        e.propwheelcount             = t.propwheelcount;
+        e.commandscount              = t.commandscount;
+        e.flarescount                = t.flarescount;
+        e.propscount                 = t.propscount;
+        e.wingscount                 = t.wingscount;
+        e.turbopropscount            = t.turbopropscount;
+        e.turbojetcount              = t.turbojetcount;
+        e.rotatorscount              = t.rotatorscount;
+        e.exhaustscount              = t.exhaustscount;
+        e.flexbodiescount            = t.flexbodiescount;
+        e.materialflarebindingscount = t.materialflarebindingscount;
+        e.soundsourcescount          = t.soundsourcescount;
+        e.managedmaterialscount      = t.managedmaterialscount;
+        e.truckmass                  = t.truckmass;
+        e.loadmass                   = t.loadmass;
+        e.minrpm                     = t.minrpm;
+        e.maxrpm                     = t.maxrpm;
+        e.torque                     = t.torque;
+        e.driveable                  = t.driveable;
+        e.numgears                   = t.numgears;
+        e.enginetype                 = t.enginetype;
+        e.hasSubmeshs                = t.hasSubmeshs;
+        e.customtach                 = t.customtach;
+        e.custom_particles           = t.custom_particles;
+        e.forwardcommands            = t.forwardcommands;
+        e.importcommands             = t.importcommands;
+        e.rollon                     = t.rollon;
+        e.rescuer                    = t.rescuer;
+
+        builder.entries.push_back(e);
+    }
+
+    CacheFileHeader header;
+    memset(&header, 0, sizeof(CacheFileHeader));
+    memcpy(header.magic, CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC));
+    header.format          = CACHE_FILE_FORMAT;
+    strncpy(header.shaone, currentSHA1.c_str(), sizeof(header.shaone) - 1);
+    header.num_entries     = (uint32_t)builder.entries.size();
+    header.num_authors     = (uint32_t)builder.authors.size();
+    header.num_string_refs = (uint32_t)builder.string_refs.size();
+    header.strings_size    = (uint32_t)builder.GetStrings().size();
+
+    FILE* f = fopen(path.c_str(), "wb");
     if (!f)
     {
         ErrorUtils::ShowError(_L("Fatal Error: Unable to write cache to disk"), _L("Unable to write file.\nPlease ensure the parent directories exists and that you have write access to this location:\n") + path);
         exit(1337);
     }
-    fprintf(f, "shaone=%s\n", const_cast<char*>(currentSHA1.c_str()));
-    fprintf(f, "modcount=%d\n", (int)entries.size());
-    fprintf(f, "cacheformat=%s\n", CACHE_FILE_FORMAT);
+    bool ok = fwrite(&header, sizeof(CacheFileHeader), 1, f) == 1;
+    if (ok && !builder.entries.empty())
+        ok = fwrite(&builder.entries[0], sizeof(CacheFileEntry), builder.entries.size(), f) == builder.entries.size();
+    if (ok && !builder.authors.empty())
+        ok = fwrite(&builder.authors[0], sizeof(CacheFileAuthor), builder.authors.size(), f) == builder.authors.size();
+    if (ok && !builder.string_refs.empty())
+        ok = fwrite(&builder.string_refs[0], sizeof(uint32_t), builder.string_refs.size(), f) == builder.string_refs.size();
+    if (ok)
+        ok = fwrite(&builder.GetStrings()[0], 1, builder.GetStrings().size(), f) == builder.GetStrings().size();
 
-    // mods
-    std::vector<CacheEntry>::iterator it;
-    int counter = 0;
-    for (it = entries.begin(); it != entries.end(); it++)
+    // close
+    ok = (fclose(f) == 0) && ok; // Buffered data is flushed here, so this can fail too
+    if (!ok)
     {
-        if (it->deleted)
-            continue;
-        fprintf(f, "%s", formatEntry(counter, *it).c_str());
-        counter++;
+        // A truncated cache would fail the size checks on load anyway; don't leave it behind
+        remove(path.c_str());
+        LOG("...failed! Unable to write cache to disk, it will be regenerated on next start: " + path);
+        return;
     }
-
-    // close
-    fclose(f);
     LOG("...done!");
 }
 
@@ -1417,8 +1288,6 @@ void CacheSystem::addFile(String filename, String archiveType, String archiveDir
 {
     LOG("Preparing to add " + filename);
 
-    //read first line
-    CacheEntry entry;
     if (!resourceExistsInAllGroups(filename))
         return;
 
@@ -1427,20 +1296,15 @@ void CacheSystem::addFile(String filename, String archiveType, String archiveDir
     {
         try
         {
-            //LOG("Read to add "+String(entry.dname)+" filename "+String(filename));
-            DataStreamPtr ds = ResourceGroupManager::getSingleton().openResource(filename, group);
-
-            if (ext == "terrn2")
-            {
-                fillTerrainDetailInfo(entry, ds, filename);
-            }
-            else
+            // read the file while its archive is loaded, the details are extracted later, see processPendingFiles()
+            PendingFile file;
             {
-                entry.dname = ds->getLine();
-                fillTruckDetailInfo(entry, ds, filename);
+                DataStreamPtr ds = ResourceGroupManager::getSingleton().openResource(filename, group);
+                file.content = ds->getAsString();
+                // ds closes automatically, so do _not_ close it explicitly below
             }
 
-            // ds closes automatically, so do _not_ close it explicitly below
+            CacheEntry& entry = file.entry;
             entry.fname = filename;
             entry.fname_without_uid = stripUIDfromString(filename);
             entry.fext = ext;
@@ -1463,8 +1327,12 @@ void CacheSystem::addFile(String filename, String archiveType, String archiveDir
             if (entry.hash == "")
             // fallback if no hash was found
                 entry.hash = "none";
-            // read in author and category
-            entries.push_back(entry);
+
+            m_pending_bytes += file.content.size();
+            m_pending_fnames.insert(entry.fname);
+            m_pending_files.push_back(file);
+            if (!m_defer_parsing || m_pending_bytes > MAX_PENDING_BYTES)
+                processPendingFiles();
         }
         catch (Ogre::Exception& e)
         {
@@ -1483,10 +1351,11 @@ void CacheSystem::addFile(String filename, String archiveType, String archiveDir
     }
 }
 
-void CacheSystem::fillTruckDetailInfo(CacheEntry& entry, Ogre::DataStreamPtr stream, Ogre::String file_name)
+void CacheSystem::fillTruckDetailInfo(CacheEntry& entry, Ogre::DataStreamPtr stream, Ogre::String file_name, Ogre::String& report_out)
 {
     /* LOAD AND PARSE THE VEHICLE */
     RigDef::Parser parser;
+    parser.SetResourceChecksEnabled(false); // Runs on worker threads, while the archive isn't loaded
     parser.Prepare();
     parser.ProcessOgreStream(stream.getPointer());
     parser.Finalize();
@@ -1523,7 +1392,7 @@ void CacheSystem::fillTruckDetailInfo(CacheEntry& entry, Ogre::DataStreamPtr str
             report << "\tMessage: " << iter->message << std::endl;
         }
 
-        Ogre::LogManager::getSingleton().logMessage(report.str());
+        report_out = report.str(); // Logged by processPendingFiles()
     }
 
     /* RETRIEVE DATA */
@@ -1890,12 +1759,9 @@ void CacheSystem::parseFilesOneRG(Ogre::String ext, Ogre::String rg)
 
 bool CacheSystem::isFileInEntries(Ogre::String filename)
 {
-    for (std::vector<CacheEntry>::iterator it = entries.begin(); it != entries.end(); ++it)
-    {
-        if (it->fname == filename)
-            return true;
-    }
-    return false;
+    updateIndex();
+    return m_entries_by_fname.find(filename) != m_entries_by_fname.end()
+        || m_pending_fnames.find(filename) != m_pending_fnames.end();
 }
 
 void CacheSystem::generateZipList()
@@ -1920,15 +1786,27 @@ bool CacheSystem::isDirectoryUsedInEntries(Ogre::String directory)
     String dira = directory;
     dira = getVirtualPath(dira);
 
-    for (std::vector<CacheEntry>::iterator it = entries.begin(); it != entries.end(); it++)
+    auto is_used = [this, &dira](const CacheEntry& entry)
     {
-        if (it->type != "FileSystem")
-            continue;
-        String dirb = getVirtualPath(it->dirname);
+        if (entry.type != "FileSystem")
+            return false;
+        String dirb = getVirtualPath(entry.dirname);
         if (dira == dirb)
             return true;
         if (dira.substr(0, dirb.size()) == dirb) // check if it is a subdirectory
             return true;
+        return false;
+    };
+
+    for (const CacheEntry& entry : entries)
+    {
+        if (is_used(entry))
+            return true;
+    }
+    for (const PendingFile& file : m_pending_files)
+    {
+        if (is_used(file.entry))
+            return true;
     }
     return false;
 }
@@ -2053,7 +1931,11 @@ void CacheSystem::fillTerrainDetailInfo(CacheEntry& entry, Ogre::DataStreamPtr d
 
 int CacheSystem::getCategoryUsage(int category)
 {
-    return category_usage[category];
+    updateIndex();
+    auto found = m_entries_by_category.find(category);
+    if (found != m_entries_by_category.end())
+        return (int)found->second.size();
+    return 0;
 }
 
 void CacheSystem::readCategoryTitles()
@@ -2108,12 +1990,11 @@ bool CacheSystem::checkResourceLoaded(Ogre::String& filename)
 
 CacheEntry CacheSystem::getResourceInfo(Ogre::String& filename)
 {
-    CacheEntry def;
-    std::vector<CacheEntry>::iterator it;
-    for (it = entries.begin(); it != entries.end(); it++)
-        if (it->fname == filename || it->fname_without_uid == filename)
-            return *it;
-    return def;
+    updateIndex();
+    auto found = m_entries_by_name.find(filename);
+    if (found != m_entries_by_name.end())
+        return entries[found->second];
+    return CacheEntry();
 }
 
 bool CacheSystem::checkResourceLoaded(Ogre::String& filename, Ogre::String& group)
@@ -2125,28 +2006,22 @@ bool CacheSystem::checkResourceLoaded(Ogre::String& filename, Ogre::String& grou
         return true;
     }
 
-    std::vector<CacheEntry>::iterator it;
-
-    for (it = entries.begin(); it != entries.end(); it++)
+    // case insensitive comparison
+    updateIndex();
+    String filename_lower = filename;
+    StringUtil::toLowerCase(filename_lower);
+    auto found = m_entries_by_name_lower.find(filename_lower);
+    if (found != m_entries_by_name_lower.end())
     {
-        // case insensitive comparison
-        String fname = it->fname;
-        String filename_lower = filename;
-        String fname_without_uid_lower = it->fname_without_uid;
-        StringUtil::toLowerCase(fname);
-        StringUtil::toLowerCase(filename_lower);
-        StringUtil::toLowerCase(fname_without_uid_lower);
-        if (fname == filename_lower || fname_without_uid_lower == filename_lower)
-        {
-            // we found the file, load it
-            filename = it->fname;
-            bool res = checkResourceLoaded(*it);
-            bool exists = ResourceGroupManager::getSingleton().resourceExistsInAnyGroup(filename);
-            if (!exists)
-                return false;
-            group = ResourceGroupManager::getSingleton().findGroupContainingResource(filename);
-            return res;
-        }
+        // we found the file, load it
+        const CacheEntry& entry = entries[found->second];
+        filename = entry.fname;
+        bool res = checkResourceLoaded(entry);
+        bool exists = ResourceGroupManager::getSingleton().resourceExistsInAnyGroup(filename);
+        if (!exists)
+            return false;
+        group = ResourceGroupManager::getSingleton().findGroupContainingResource(filename);
+        return res;
     }
     return false;
 }
@@ -2167,7 +2042,8 @@ bool CacheSystem::checkResourceLoaded(CacheEntry t)
             String name = "General-Reloaded-" + TOSTRING(rgcountera);
             ResourceGroupManager::getSingleton().addResourceLocation(t.dirname, t.type, name);
             loaded[t.dirname] = true;
-            ResourceGroupManager::getSingleton().initialiseResourceGroup(name);
+            if (!App::app_headless.GetActive()) // Headless mode only reads the truck file, no need to parse the materials and particles
+                ResourceGroupManager::getSingleton().initialiseResourceGroup(name);
             return true;
         }
         catch (Ogre::Exception& e)
@@ -2267,20 +2143,30 @@ void CacheSystem::loadSingleZip(String zippath, int cfactor, bool unload, bool o
 #endif
 
     String realzipPath = getRealPath(zippath);
-    char hash[256] = {};
+    String hash;
 
-    RoR::CSHA1 sha1;
-    sha1.HashFile(const_cast<char*>(realzipPath.c_str()));
-    sha1.Final();
-    sha1.ReportHash(hash, RoR::CSHA1::REPORT_HEX_SHORT);
-    zipHashes[getVirtualPath(zippath)] = hash;
+    auto found = zipHashes.find(getVirtualPath(zippath));
+    if (found != zipHashes.end())
+    {
+        hash = found->second; // see hashZips()
+    }
+    else
+    {
+        char hashbuf[256] = {};
+        RoR::CSHA1 sha1;
+        sha1.HashFile(const_cast<char*>(realzipPath.c_str()));
+        sha1.Final();
+        sha1.ReportHash(hashbuf, RoR::CSHA1::REPORT_HEX_SHORT);
+        hash = hashbuf;
+        zipHashes[getVirtualPath(zippath)] = hash;
+    }
 
     String compr = "";
     if (cfactor > 99)
         compr = "(No Compression)";
     else if (cfactor > 0)
         compr = "(Compression: " + TOSTRING(cfactor) + ")";
-    LOG("Adding archive " + realzipPath + " (hash: "+String(hash)+") " + compr);
+    LOG("Adding archive " + realzipPath + " (hash: "+hash+") " + compr);
 
     rgcounter++;
     String rgname = "General-" + TOSTRING(rgcounter);
@@ -2338,6 +2224,15 @@ void CacheSystem::loadAllZipsInResourceGroup(String group)
     std::map<String, bool> loadedZips;
     ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
     FileInfoListPtr files = rgm.findResourceFileInfo(group, "*.zip");
+
+    // hash all archives up front, in parallel
+    std::vector<String> zippaths;
+    for (const Ogre::FileInfo& file : *files)
+    {
+        zippaths.push_back(file.archive->getName() + "/" + file.filename);
+    }
+    hashZips(zippaths);
+
     FileInfoList::iterator iterFiles = files->begin();
     size_t i = 0, filecount = files->size();
     for (; iterFiles != files->end(); ++iterFiles , i++)
@@ -2398,6 +2293,17 @@ void CacheSystem::loadAllZips()
 void CacheSystem::checkForNewZipsInResourceGroup(String group)
 {
     FileInfoListPtr files = ResourceGroupManager::getSingleton().findResourceFileInfo(group, "*.zip");
+
+    // hash the new archives up front, in parallel
+    std::vector<String> zippaths;
+    for (const Ogre::FileInfo& file : *files)
+    {
+        String zippath = file.archive->getName() + "/" + file.filename;
+        if (!isZipUsedInEntries(zippath))
+            zippaths.push_back(zippath);
+    }
+    hashZips(zippaths);
+
     FileInfoList::iterator iterFiles = files->begin();
     size_t i = 0, filecount = files->size();
     for (; iterFiles != files->end(); ++iterFiles , i++)
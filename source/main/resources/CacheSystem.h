@@ -29,9 +29,12 @@
 #include "RoRPrerequisites.h"
 
 #include <Ogre.h>
+#include <functional>
+#include <memory>
+#include <unordered_map>
 
 #define CACHE_FILE "mods.cache"
-#define CACHE_FILE_FORMAT "6"
+#define CACHE_FILE_FORMAT 7
 
 // 60*60*24 = one day
 #define CACHE_FILE_FRESHNESS 86400
@@ -171,6 +174,7 @@ public:
 
     int getCategoryUsage(int category);
     CacheEntry *getEntry(int modid);
+    CacheEntry *getEntryByGUID(Ogre::String guid);
 
     int getTimeStamp();
 
@@ -205,14 +209,35 @@ protected:
     void addFile(Ogre::FileInfo f, Ogre::String ext);	// adds a file to entries
     void addFile(Ogre::String filename, Ogre::String archiveType, Ogre::String archiveDirectory, Ogre::String ext);
 
+    /// File found while generating the cache; waits for its details to be read, see processPendingFiles()
+    struct PendingFile
+    {
+        PendingFile(): valid(false) {}
+
+        CacheEntry   entry;
+        Ogre::String content;   //!< The file, read while its archive was loaded
+        Ogre::String report;    //!< Parser messages, logged when the entry is added
+        bool         valid;
+    };
+
+    static const size_t MAX_PENDING_BYTES = 64 * 1024 * 1024; //!< Limits memory used by pending files
+
     // reads all advanced information out of the entry's file
+    void fillDetailInfo(PendingFile& file);   // thread-safe
     void fillTerrainDetailInfo(CacheEntry &entry, Ogre::DataStreamPtr ds, Ogre::String fname);
-    void fillTruckDetailInfo(CacheEntry &entry, Ogre::DataStreamPtr ds, Ogre::String fname);
+    void fillTruckDetailInfo(CacheEntry &entry, Ogre::DataStreamPtr ds, Ogre::String fname, Ogre::String& report_out);
+
+    /// Reads the details of all pending files in parallel, then adds them to the entries in the order they were found
+    void processPendingFiles();
+    void hashZips(const std::vector<Ogre::String>& zippaths); // hashes archives in parallel, for loadSingleZip()
+
+    /// Calls 'func' for indices [0, count) on the thread pool, or serially without one; shows progress meanwhile
+    void runParallel(int count, const std::function<void(int)>& func, Ogre::UTFString text);
 
     /// Checks if update is needed
     CacheValidityState IsCacheValid();
     Ogre::String filenamesSHA1();             // generates the hash over the whole content
-    bool loadCache();                         // loads cache config file, new format
+    bool loadCache();                         // loads the binary cache file
     Ogre::String getCacheConfigFilename(bool full); // returns filename of the cache file
     int incrementalCacheUpdate();             // tries to update parts of the Cache only
 
@@ -227,11 +252,11 @@ protected:
     Ogre::String detectFilesMiniType(Ogre::String filename);
     void removeFileFromFileCache(std::vector<CacheEntry>::iterator it);
     void generateCache(bool forcefull=false);
-    Ogre::String formatEntry(int counter, CacheEntry t);
-    Ogre::String formatInnerEntry(int counter, CacheEntry t);
     void updateSingleTruckEntryCache(int number, CacheEntry t);
-    void parseModAttribute(const Ogre::String& line, CacheEntry& t);
-    void logBadTruckAttrib(const Ogre::String& line, CacheEntry& t);
+
+    /// Lookup tables into 'entries'; rebuilt on demand after the vector was replaced or handed out
+    void updateIndex();
+    void addEntryToIndex(size_t index);
 
     void readCategoryTitles();
 
@@ -244,9 +269,6 @@ protected:
     Ogre::String getRealPath(Ogre::String path);
     Ogre::String getVirtualPath(Ogre::String path);
 
-    Ogre::String normalizeText(Ogre::String text);
-    Ogre::String deNormalizeText(Ogre::String text);
-    
     void checkForNewFiles(Ogre::String ext);
 
     void checkForNewContent();
@@ -277,11 +299,26 @@ protected:
 
     std::vector<CacheEntry> entries; //!< this holds all files
 
+    // indexes into 'entries'
+    std::unordered_map<int, size_t>                 m_entries_by_number;
+    std::unordered_map<Ogre::String, size_t>        m_entries_by_fname;      //!< fname
+    std::unordered_map<Ogre::String, size_t>        m_entries_by_name;       //!< fname and fname_without_uid
+    std::unordered_map<Ogre::String, size_t>        m_entries_by_name_lower; //!< fname and fname_without_uid, lowercase
+    std::unordered_map<Ogre::String, size_t>        m_entries_by_guid;       //!< guid, trimmed and lowercase
+    std::unordered_map<int, std::vector<size_t>>    m_entries_by_category;
+    bool                                            m_index_dirty;
+
+    // cache generation
+    std::unique_ptr<ThreadPool>                     m_thread_pool;    //!< Only exists while generating the cache
+    bool                                            m_defer_parsing;  //!< Collect files in 'm_pending_files'?
+    std::vector<PendingFile>                        m_pending_files;
+    std::set<Ogre::String>                          m_pending_fnames;
+    size_t                                          m_pending_bytes;
+
     std::map<Ogre::String, Ogre::String> zipHashes;
 
     // categories
     std::map<int, Category_Entry> categories;
-    std::map<int, int> category_usage;
     std::set<Ogre::String> zipCacheList;
 
 };
@@ -295,6 +295,26 @@ bool ContentManager::init(void)
     return true;
 }
 
+void ContentManager::InitHeadless()
+{
+    LOG("RoR|ContentManager: Loading filesystems (headless)");
+
+    // config, flat; ground and inertia models
+    ResourceGroupManager::getSingleton().addResourceLocation(std::string(RoR::App::sys_config_dir.GetActive()), "FileSystem", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+
+    // the content, as in init(). Ogre indexes a location when it's added, so its files
+    // can be opened without initialising the group (which would parse all scripts in it).
+    std::string content_base = std::string(App::sys_user_dir.GetActive()) + PATH_SLASH;
+    ResourceGroupManager::getSingleton().addResourceLocation(content_base + "packs", "FileSystem", "Packs", true);
+    ResourceGroupManager::getSingleton().addResourceLocation(content_base + "mods", "FileSystem", "Packs", true);
+
+    ResourceGroupManager::getSingleton().addResourceLocation(content_base + "vehicles", "FileSystem", "VehicleFolders");
+    ResourceGroupManager::getSingleton().addResourceLocation(content_base + "terrains", "FileSystem", "TerrainFolders");
+
+    exploreFolders("VehicleFolders", false);
+    exploreFolders("TerrainFolders", false);
+}
+
 Ogre::DataStreamPtr ContentManager::resourceLoading(const Ogre::String& name, const Ogre::String& group, Ogre::Resource* resource)
 {
     return Ogre::DataStreamPtr();
@@ -339,7 +359,7 @@ void ContentManager::exploreZipFolders(Ogre::String rg)
     // DO NOT initialize ...
 }
 
-void ContentManager::exploreFolders(Ogre::String rg)
+void ContentManager::exploreFolders(Ogre::String rg, bool initialise)
 {
     ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
 
@@ -355,6 +375,8 @@ void ContentManager::exploreFolders(Ogre::String rg)
         String fullpath = iterFiles->archive->getName() + PATH_SLASH;
         rgm.addResourceLocation(fullpath + iterFiles->filename, "FileSystem", rg);
     }
+    if (!initialise)
+        return;
     LOG("initialiseResourceGroups: "+rg);
     try
     {
@@ -87,6 +87,11 @@ public:
 
     bool init(void);
 
+    /// Headless mode: instead of init(), registers only what the simulation reads (config files,
+    /// vehicle/terrain folders and packs). No resource group is initialised, so no materials,
+    /// overlays, particles or sounds are set up.
+    void InitHeadless();
+
     inline RoR::SkinManager* GetSkinManager() const { return m_skin_manager; }
 
     void InitManagedMaterials();
@@ -95,7 +100,7 @@ public:
 
 protected:
 
-    void exploreFolders(Ogre::String rg);
+    void exploreFolders(Ogre::String rg, bool initialise = true);
     void exploreZipFolders(Ogre::String rg);
 
     // implementation for resource loading listener
@@ -0,0 +1,198 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RigDef_FileCache.h"
+
+#include "Application.h"
+#include "RigDef_FileSnapshot.h"
+#include "RoRPrerequisites.h"
+#include "SHA1.h"
+
+#include <OgreFileSystem.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <vector>
+
+namespace RigDef {
+
+FileCache::FileCache(size_t capacity):
+    m_capacity(capacity)
+{}
+
+std::string FileCache::MakeKey(std::string const & file_name, std::string const & content, bool check_beams)
+{
+    RoR::CSHA1 sha1;
+    if (!content.empty())
+    {
+        sha1.UpdateHash(reinterpret_cast<uint8_t*>(const_cast<char*>(content.data())), static_cast<uint32_t>(content.size()));
+    }
+    sha1.Final();
+    uint8_t hash[20];
+    sha1.GetHash(hash);
+
+    // The name matters too: the parser reports it and the file extension affects validation
+    std::string key(reinterpret_cast<char*>(hash), sizeof(hash));
+    key += check_beams ? '1' : '0';
+    key += file_name;
+    return key;
+}
+
+std::string FileCache::GetSnapshotPath(std::string const & key)
+{
+    if (RoR::App::sys_cache_dir.IsActiveEmpty())
+    {
+        return "";
+    }
+
+    // The key holds the file name, so hash it again for a name that's safe on any filesystem
+    RoR::CSHA1 sha1;
+    sha1.UpdateHash(reinterpret_cast<uint8_t*>(const_cast<char*>(key.data())), static_cast<uint32_t>(key.size()));
+    sha1.Final();
+    uint8_t hash[20];
+    sha1.GetHash(hash);
+
+    char hex[sizeof(hash) * 2 + 1];
+    for (size_t i = 0; i < sizeof(hash); ++i)
+    {
+        sprintf(hex + i * 2, "%02x", hash[i]);
+    }
+    return std::string(RoR::App::sys_cache_dir.GetActive()) + PATH_SLASH + "rigdef_" + hex + ".dat";
+}
+
+std::shared_ptr<const FileCache::Entry> FileCache::Find(std::string const & file_name, std::string const & content, bool check_beams)
+{
+    std::string key = MakeKey(file_name, content, check_beams);
+    auto found = m_index.find(key);
+    if (found != m_index.end())
+    {
+        m_lru.splice(m_lru.begin(), m_lru, found->second); // Iterators stay valid
+        return found->second->second;
+    }
+
+    std::string path = GetSnapshotPath(key);
+    if (path.empty())
+    {
+        return nullptr;
+    }
+    std::shared_ptr<Entry> entry = std::make_shared<Entry>();
+    FileSnapshot::ResultCode result = FileSnapshot::Load(path, key, *entry);
+    if (result != FileSnapshot::RESULT_CODE_OK)
+    {
+        if (result != FileSnapshot::RESULT_CODE_ERR_FOPEN_FAILED) // No snapshot yet is the usual case
+        {
+            RoR::LogFormat("[RoR|RigDef] Not using snapshot '%s' of '%s': %s", path.c_str(), file_name.c_str(), FileSnapshot::ResultCodeToString(result));
+        }
+        return nullptr;
+    }
+
+    this->Insert(key, entry);
+    return entry;
+}
+
+void FileCache::Add(std::string const & file_name, std::string const & content, bool check_beams, std::shared_ptr<const Entry> entry)
+{
+    std::string key = MakeKey(file_name, content, check_beams);
+    this->Insert(key, entry);
+
+    std::string path = GetSnapshotPath(key);
+    if (!path.empty())
+    {
+        FileSnapshot::ResultCode result = FileSnapshot::Save(path, key, *entry);
+        if (result != FileSnapshot::RESULT_CODE_OK)
+        {
+            RoR::LogFormat("[RoR|RigDef] Could not save snapshot '%s' of '%s': %s", path.c_str(), file_name.c_str(), FileSnapshot::ResultCodeToString(result));
+        }
+    }
+}
+
+void FileCache::Insert(std::string const & key, std::shared_ptr<const Entry> entry)
+{
+    auto found = m_index.find(key);
+    if (found != m_index.end())
+    {
+        found->second->second = entry;
+        m_lru.splice(m_lru.begin(), m_lru, found->second);
+        return;
+    }
+
+    m_lru.emplace_front(key, entry);
+    m_index.emplace(key, m_lru.begin());
+    while (m_lru.size() > m_capacity)
+    {
+        m_index.erase(m_lru.back().first);
+        m_lru.pop_back();
+    }
+}
+
+void FileCache::Clear()
+{
+    m_index.clear();
+    m_lru.clear();
+}
+
+void FileCache::PruneSnapshots(size_t max_count)
+{
+    if (RoR::App::sys_cache_dir.IsActiveEmpty())
+    {
+        return;
+    }
+
+    std::string dir = RoR::App::sys_cache_dir.GetActive();
+    Ogre::FileSystemArchiveFactory fsa_factory;
+#ifdef ROR_USE_OGRE_1_9
+    Ogre::Archive* fsa = fsa_factory.createInstance(dir, true);
+#else
+    Ogre::Archive* fsa = fsa_factory.createInstance(dir);
+#endif
+
+    Ogre::StringVectorPtr names = fsa->find("rigdef_*.dat", false);
+    std::vector<std::pair<std::time_t, std::string>> snapshots; // Modification time, name
+    snapshots.reserve(names->size());
+    for (std::string const & name : *names)
+    {
+        snapshots.emplace_back(fsa->getModifiedTime(name), name);
+    }
+    fsa_factory.destroyInstance(fsa);
+
+    if (snapshots.size() <= max_count)
+    {
+        return;
+    }
+
+    // Newest first; a snapshot is rewritten whenever its truck gets parsed again
+    std::sort(snapshots.begin(), snapshots.end(), std::greater<std::pair<std::time_t, std::string>>());
+    size_t num_removed = 0;
+    for (size_t i = max_count; i < snapshots.size(); ++i)
+    {
+        std::string path = dir + PATH_SLASH + snapshots[i].second;
+        if (remove(path.c_str()) == 0)
+        {
+            ++num_removed;
+        }
+    }
+    RoR::LogFormat("[RoR|RigDef] Removed %u of %u truck definition snapshots from the cache directory",
+        static_cast<unsigned>(num_removed), static_cast<unsigned>(snapshots.size()));
+}
+
+} // namespace RigDef
@@ -0,0 +1,90 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// @file
+/// @brief Cache of parsed and validated truck definitions, for quick respawn: in memory, backed by snapshots on disk.
+
+#pragma once
+
+#include "RigDef_Prerequisites.h"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace RigDef {
+
+/// Least-recently-used cache of validated truck definitions, keyed by the SHA1 of the truck file content.
+/// Entries are shared with spawned actors, which must not modify them.
+/// Every added entry is also saved as a binary snapshot (see RigDef::FileSnapshot) in the cache directory,
+/// so definitions seen in earlier sessions skip parsing too. Only the newest snapshots are kept, see PruneSnapshots().
+class FileCache
+{
+public:
+
+    struct Entry
+    {
+        Entry(): num_errors(0), num_warnings(0), num_other(0) {}
+
+        std::shared_ptr<File> file;
+        std::string           report;       ///< Parser and validator messages
+        int                   num_errors;
+        int                   num_warnings;
+        int                   num_other;
+    };
+
+    static const size_t DEFAULT_CAPACITY = 30;
+    static const size_t MAX_SNAPSHOTS    = 200;
+
+    explicit FileCache(size_t capacity = DEFAULT_CAPACITY);
+
+    /// Looks in memory first, then for a snapshot on disk.
+    /// @param check_beams Validator setting the entry was created with
+    /// @return Cached entry, or nullptr.
+    std::shared_ptr<const Entry> Find(std::string const & file_name, std::string const & content, bool check_beams);
+
+    /// Adds an entry, evicts the least recently used one if full and saves the snapshot.
+    void Add(std::string const & file_name, std::string const & content, bool check_beams, std::shared_ptr<const Entry> entry);
+
+    void   Clear();
+
+    /// Deletes all but the 'max_count' most recently written snapshots from the cache directory.
+    /// Snapshots of edited or uninstalled trucks are never looked up again, so this is what bounds the disk use.
+    static void PruneSnapshots(size_t max_count = MAX_SNAPSHOTS);
+    size_t GetNumEntries() const { return m_lru.size(); }
+
+private:
+
+    typedef std::list<std::pair<std::string, std::shared_ptr<const Entry>>> LruList; ///< Most recently used first
+
+    static std::string MakeKey(std::string const & file_name, std::string const & content, bool check_beams);
+    static std::string GetSnapshotPath(std::string const & key); ///< Empty if there's no cache directory
+
+    void Insert(std::string const & key, std::shared_ptr<const Entry> entry);
+
+    LruList                                            m_lru;
+    std::unordered_map<std::string, LruList::iterator> m_index;
+    size_t                                             m_capacity;
+};
+
+} // namespace RigDef
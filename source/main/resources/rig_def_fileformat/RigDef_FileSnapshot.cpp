@@ -0,0 +1,1289 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RigDef_FileSnapshot.h"
+
+#include "RigDef_File.h"
+#include "RoRVersion.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace RigDef {
+
+const char* FileSnapshot::SIGNATURE = "RoR RigDef snapshot";
+
+// ================================================================================================
+// Archives
+// SnapshotWriter and SnapshotReader have the same Value() interface, so that one Transfer()
+// function per struct (below) lists its fields for both directions.
+// ================================================================================================
+
+/// Fresh objects to read into; Node::Range and File::Module have no default constructor
+template<typename T> static T MakeValue()                      { return T(); }
+template<> Node::Range MakeValue<Node::Range>()                { return Node::Range(Node::Ref()); }
+template<typename T> static std::shared_ptr<T> MakeShared()    { return std::make_shared<T>(); }
+template<> std::shared_ptr<File::Module> MakeShared<File::Module>() { return std::make_shared<File::Module>(""); }
+
+class SnapshotWriter
+{
+public:
+    explicit SnapshotWriter(FILE* file): m_file(file) {}
+
+    template<typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value>::type
+    Value(T& v)                      { this->Raw(&v, sizeof(T)); }
+
+    void Value(std::string& s)         { this->WriteCount(s.size()); this->Raw(s.data(), s.size()); }
+    void Value(Ogre::Vector3& v)       { this->Raw(v.ptr(), sizeof(Ogre::Real) * 3); }
+    void Value(Ogre::ColourValue& c)   { this->Raw(c.ptr(), sizeof(float) * 4); }
+
+    template<typename T, size_t N>
+    void Value(T (&arr)[N])            { for (size_t i = 0; i < N; ++i) { this->Value(arr[i]); } }
+
+    template<typename T>
+    void Value(std::vector<T>& v)      { this->WriteCount(v.size()); for (T& elem : v) { this->Value(elem); } }
+
+    template<typename T>
+    void Value(std::list<T>& l)        { this->WriteCount(l.size()); for (T& elem : l) { this->Value(elem); } }
+
+    template<typename T>
+    void Value(std::map<std::string, T>& m)
+    {
+        this->WriteCount(m.size());
+        for (auto& elem : m)
+        {
+            std::string key = elem.first;
+            this->Value(key);
+            this->Value(elem.second);
+        }
+    }
+
+    /// 0 = null, otherwise 1 + index of the object; the object's contents follow its first occurrence.
+    template<typename T>
+    void Value(std::shared_ptr<T>& ptr)
+    {
+        uint32_t id = 0;
+        if (ptr != nullptr)
+        {
+            auto found = m_shared.find(ptr.get());
+            if (found != m_shared.end())
+            {
+                id = found->second;
+            }
+            else
+            {
+                id = static_cast<uint32_t>(m_shared.size()) + 1;
+                m_shared.insert(std::make_pair(ptr.get(), id));
+                this->Raw(&id, sizeof(id));
+                this->Value(*ptr);
+                return;
+            }
+        }
+        this->Raw(&id, sizeof(id));
+    }
+
+    template<typename T>
+    typename std::enable_if<std::is_class<T>::value>::type
+    Value(T& obj)                      { Transfer(*this, obj); }
+
+private:
+    void WriteCount(size_t count)
+    {
+        uint32_t count32 = static_cast<uint32_t>(count);
+        this->Raw(&count32, sizeof(count32));
+    }
+
+    void Raw(const void* source, size_t length)
+    {
+        if (length != 0 && fwrite(source, length, 1, m_file) != 1)
+        {
+            throw FileSnapshot::RESULT_CODE_FWRITE_OUTPUT_INCOMPLETE;
+        }
+    }
+
+    FILE*                           m_file;
+    std::map<const void*, uint32_t> m_shared;
+};
+
+class SnapshotReader
+{
+public:
+    SnapshotReader(FILE* file, size_t file_size): m_file(file), m_file_size(file_size) {}
+
+    template<typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value>::type
+    Value(T& v)                      { this->Raw(&v, sizeof(T)); }
+
+    void Value(std::string& s)
+    {
+        s.resize(this->ReadCount());
+        if (!s.empty())
+        {
+            this->Raw(&s[0], s.size());
+        }
+    }
+
+    void Value(Ogre::Vector3& v)       { this->Raw(v.ptr(), sizeof(Ogre::Real) * 3); }
+    void Value(Ogre::ColourValue& c)   { this->Raw(c.ptr(), sizeof(float) * 4); }
+
+    template<typename T, size_t N>
+    void Value(T (&arr)[N])            { for (size_t i = 0; i < N; ++i) { this->Value(arr[i]); } }
+
+    template<typename T>
+    void Value(std::vector<T>& v)
+    {
+        const size_t count = this->ReadCount();
+        v.clear();
+        v.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            v.push_back(MakeValue<T>());
+            this->Value(v.back());
+        }
+    }
+
+    template<typename T>
+    void Value(std::list<T>& l)
+    {
+        const size_t count = this->ReadCount();
+        l.clear();
+        for (size_t i = 0; i < count; ++i)
+        {
+            l.push_back(MakeValue<T>());
+            this->Value(l.back());
+        }
+    }
+
+    template<typename T>
+    void Value(std::map<std::string, T>& m)
+    {
+        const size_t count = this->ReadCount();
+        m.clear();
+        for (size_t i = 0; i < count; ++i)
+        {
+            std::string key;
+            this->Value(key);
+            T value = MakeValue<T>();
+            this->Value(value);
+            m.insert(std::make_pair(key, value));
+        }
+    }
+
+    template<typename T>
+    void Value(std::shared_ptr<T>& ptr)
+    {
+        uint32_t id = 0;
+        this->Raw(&id, sizeof(id));
+        if (id == 0)
+        {
+            ptr.reset();
+        }
+        else if (id <= m_shared.size())
+        {
+            if (*m_shared[id - 1].first != typeid(T))
+            {
+                throw FileSnapshot::RESULT_CODE_ERR_INVALID_DATA;
+            }
+            ptr = std::static_pointer_cast<T>(m_shared[id - 1].second);
+        }
+        else if (id == m_shared.size() + 1)
+        {
+            std::shared_ptr<T> obj = MakeShared<T>();
+            m_shared.push_back(std::make_pair(&typeid(T), std::static_pointer_cast<void>(obj)));
+            this->Value(*obj);
+            ptr = obj;
+        }
+        else
+        {
+            throw FileSnapshot::RESULT_CODE_ERR_INVALID_DATA;
+        }
+    }
+
+    template<typename T>
+    typename std::enable_if<std::is_class<T>::value>::type
+    Value(T& obj)                      { Transfer(*this, obj); }
+
+private:
+    size_t ReadCount()
+    {
+        uint32_t count = 0;
+        this->Raw(&count, sizeof(count));
+        if (count > m_file_size) // Every element takes at least a byte; don't allocate for garbage
+        {
+            throw FileSnapshot::RESULT_CODE_ERR_INVALID_DATA;
+        }
+        return count;
+    }
+
+    void Raw(void* dest, size_t length)
+    {
+        if (length != 0 && fread(dest, length, 1, m_file) != 1)
+        {
+            throw FileSnapshot::RESULT_CODE_FREAD_OUTPUT_INCOMPLETE;
+        }
+    }
+
+    FILE*                                                          m_file;
+    size_t                                                         m_file_size;
+    std::vector<std::pair<const std::type_info*, std::shared_ptr<void>>> m_shared;
+};
+
+// ================================================================================================
+// Fields
+// Keep in sync with RigDef_File.h and RigDef_Node.h, and bump FileSnapshot::FILE_FORMAT_VERSION.
+// ================================================================================================
+
+static void Transfer(SnapshotWriter& ar, Node::Id& id)
+{
+    uint8_t type = id.IsTypeNumbered() ? 1 : (id.IsTypeNamed() ? 2 : 0);
+    unsigned int num = id.Num();
+    std::string str = id.Str();
+    ar.Value(type);
+    ar.Value(num);
+    ar.Value(str);
+}
+
+static void Transfer(SnapshotReader& ar, Node::Id& id)
+{
+    uint8_t type = 0;
+    unsigned int num = 0;
+    std::string str;
+    ar.Value(type);
+    ar.Value(num);
+    ar.Value(str);
+    if      (type == 1) { id = Node::Id(num); }
+    else if (type == 2) { id = Node::Id(str); }
+    else                { id.Invalidate();    }
+}
+
+static void Transfer(SnapshotWriter& ar, Node::Ref& ref)
+{
+    std::string id = ref.Str();
+    unsigned int num = ref.Num();
+    unsigned int flags = ref.GetFlags();
+    unsigned int line = ref.GetLineNumber();
+    ar.Value(id);
+    ar.Value(num);
+    ar.Value(flags);
+    ar.Value(line);
+}
+
+static void Transfer(SnapshotReader& ar, Node::Ref& ref)
+{
+    std::string id;
+    unsigned int num = 0, flags = 0, line = 0;
+    ar.Value(id);
+    ar.Value(num);
+    ar.Value(flags);
+    ar.Value(line);
+    ref = Node::Ref(id, num, flags, line);
+}
+
+template<typename A> static void Transfer(A& ar, Node::Range& r)
+{
+    ar.Value(r.start);
+    ar.Value(r.end);
+}
+
+template<typename A> static void Transfer(A& ar, CameraSettings& c)
+{
+    ar.Value(c.mode);
+    ar.Value(c.cinecam_index);
+}
+
+template<typename A> static void Transfer(A& ar, NodeDefaults& d)
+{
+    ar.Value(d.load_weight);
+    ar.Value(d.friction);
+    ar.Value(d.volume);
+    ar.Value(d.surface);
+    ar.Value(d.options);
+}
+
+template<typename A> static void Transfer(A& ar, BeamDefaultsScale& s)
+{
+    ar.Value(s.springiness);
+    ar.Value(s.damping_constant);
+    ar.Value(s.deformation_threshold_constant);
+    ar.Value(s.breaking_threshold_constant);
+}
+
+template<typename A> static void Transfer(A& ar, BeamDefaults& d)
+{
+    ar.Value(d.springiness);
+    ar.Value(d.damping_constant);
+    ar.Value(d.deformation_threshold);
+    ar.Value(d.breaking_threshold);
+    ar.Value(d.visual_beam_diameter);
+    ar.Value(d.beam_material_name);
+    ar.Value(d.plastic_deform_coef);
+    ar.Value(d._enable_advanced_deformation);
+    ar.Value(d._is_plastic_deform_coef_user_defined);
+    ar.Value(d._is_user_defined);
+    ar.Value(d.scale);
+}
+
+template<typename A> static void Transfer(A& ar, Node& n)
+{
+    ar.Value(n.id);
+    ar.Value(n.position);
+    ar.Value(n.options);
+    ar.Value(n.load_weight_override);
+    ar.Value(n._has_load_weight_override);
+    ar.Value(n.node_defaults);
+    ar.Value(n.beam_defaults);
+    ar.Value(n.detacher_group);
+}
+
+template<typename A> static void Transfer(A& ar, Inertia& i)
+{
+    ar.Value(i.start_delay_factor);
+    ar.Value(i.stop_delay_factor);
+    ar.Value(i.start_function);
+    ar.Value(i.stop_function);
+}
+
+template<typename A> static void Transfer(A& ar, ManagedMaterialsOptions& o)
+{
+    ar.Value(o.double_sided);
+}
+
+template<typename A> static void Transfer(A& ar, Globals& g)
+{
+    ar.Value(g.dry_mass);
+    ar.Value(g.cargo_mass);
+    ar.Value(g.material_name);
+}
+
+template<typename A> static void Transfer(A& ar, GuiSettings& g)
+{
+    ar.Value(g.tacho_material);
+    ar.Value(g.speedo_material);
+    ar.Value(g.speedo_highest_kph);
+    ar.Value(g.use_max_rpm);
+    ar.Value(g.help_material);
+    ar.Value(g.interactive_overview_map_mode);
+    ar.Value(g.dashboard_layouts);
+    ar.Value(g.rtt_dashboard_layouts);
+}
+
+template<typename A> static void Transfer(A& ar, Airbrake& a)
+{
+    ar.Value(a.reference_node);
+    ar.Value(a.x_axis_node);
+    ar.Value(a.y_axis_node);
+    ar.Value(a.aditional_node);
+    ar.Value(a.offset);
+    ar.Value(a.width);
+    ar.Value(a.height);
+    ar.Value(a.max_inclination_angle);
+    ar.Value(a.texcoord_x1);
+    ar.Value(a.texcoord_x2);
+    ar.Value(a.texcoord_y1);
+    ar.Value(a.texcoord_y2);
+    ar.Value(a.lift_coefficient);
+}
+
+template<typename A> static void Transfer(A& ar, Animation::MotorSource& m)
+{
+    ar.Value(m.source);
+    ar.Value(m.motor);
+}
+
+template<typename A> static void Transfer(A& ar, Animation& a)
+{
+    ar.Value(a.ratio);
+    ar.Value(a.lower_limit);
+    ar.Value(a.upper_limit);
+    ar.Value(a.source);
+    ar.Value(a.motor_sources);
+    ar.Value(a.mode);
+    ar.Value(a.event);
+}
+
+template<typename A> static void Transfer(A& ar, Axle& a)
+{
+    ar.Value(a.wheels);
+    ar.Value(a.options);
+}
+
+template<typename A> static void Transfer(A& ar, Beam& b)
+{
+    ar.Value(b.nodes);
+    ar.Value(b.options);
+    ar.Value(b.extension_break_limit);
+    ar.Value(b._has_extension_break_limit);
+    ar.Value(b.detacher_group);
+    ar.Value(b.defaults);
+}
+
+template<typename A> static void Transfer(A& ar, Camera& c)
+{
+    ar.Value(c.center_node);
+    ar.Value(c.back_node);
+    ar.Value(c.left_node);
+}
+
+template<typename A> static void Transfer(A& ar, CameraRail& c)
+{
+    ar.Value(c.nodes);
+}
+
+template<typename A> static void Transfer(A& ar, Cinecam& c)
+{
+    ar.Value(c.position);
+    ar.Value(c.nodes);
+    ar.Value(c.spring);
+    ar.Value(c.damping);
+    ar.Value(c.beam_defaults);
+    ar.Value(c.node_defaults);
+}
+
+template<typename A> static void Transfer(A& ar, CollisionBox& c)
+{
+    ar.Value(c.nodes);
+}
+
+template<typename A> static void Transfer(A& ar, CruiseControl& c)
+{
+    ar.Value(c.min_speed);
+    ar.Value(c.autobrake);
+}
+
+template<typename A> static void Transfer(A& ar, Author& a)
+{
+    ar.Value(a.type);
+    ar.Value(a.forum_account_id);
+    ar.Value(a.name);
+    ar.Value(a.email);
+    ar.Value(a._has_forum_account);
+}
+
+template<typename A> static void Transfer(A& ar, Fileinfo& f)
+{
+    ar.Value(f.unique_id);
+    ar.Value(f.category_id);
+    ar.Value(f.file_version);
+}
+
+template<typename A> static void Transfer(A& ar, Engine& e)
+{
+    ar.Value(e.shift_down_rpm);
+    ar.Value(e.shift_up_rpm);
+    ar.Value(e.torque);
+    ar.Value(e.global_gear_ratio);
+    ar.Value(e.reverse_gear_ratio);
+    ar.Value(e.neutral_gear_ratio);
+    ar.Value(e.gear_ratios);
+}
+
+template<typename A> static void Transfer(A& ar, Engoption& e)
+{
+    ar.Value(e.inertia);
+    ar.Value(e.type);
+    ar.Value(e.clutch_force);
+    ar.Value(e.shift_time);
+    ar.Value(e.clutch_time);
+    ar.Value(e.post_shift_time);
+    ar.Value(e.idle_rpm);
+    ar.Value(e.stall_rpm);
+    ar.Value(e.max_idle_mixture);
+    ar.Value(e.min_idle_mixture);
+}
+
+template<typename A> static void Transfer(A& ar, Engturbo& e)
+{
+    ar.Value(e.version);
+    ar.Value(e.tinertiaFactor);
+    ar.Value(e.nturbos);
+    ar.Value(e.param1);
+    ar.Value(e.param2);
+    ar.Value(e.param3);
+    ar.Value(e.param4);
+    ar.Value(e.param5);
+    ar.Value(e.param6);
+    ar.Value(e.param7);
+    ar.Value(e.param8);
+    ar.Value(e.param9);
+    ar.Value(e.param10);
+    ar.Value(e.param11);
+}
+
+template<typename A> static void Transfer(A& ar, Exhaust& e)
+{
+    ar.Value(e.reference_node);
+    ar.Value(e.direction_node);
+    ar.Value(e.material_name);
+}
+
+template<typename A> static void Transfer(A& ar, ExtCamera& e)
+{
+    ar.Value(e.mode);
+    ar.Value(e.node);
+}
+
+template<typename A> static void Transfer(A& ar, Brakes& b)
+{
+    ar.Value(b.default_braking_force);
+    ar.Value(b.parking_brake_force);
+}
+
+template<typename A> static void Transfer(A& ar, AntiLockBrakes& a)
+{
+    ar.Value(a.regulation_force);
+    ar.Value(a.min_speed);
+    ar.Value(a.pulse_per_sec);
+    ar.Value(a.attr_is_on);
+    ar.Value(a.attr_no_dashboard);
+    ar.Value(a.attr_no_toggle);
+}
+
+template<typename A> static void Transfer(A& ar, TractionControl& t)
+{
+    ar.Value(t.regulation_force);
+    ar.Value(t.wheel_slip);
+    ar.Value(t.fade_speed);
+    ar.Value(t.pulse_per_sec);
+    ar.Value(t.attr_is_on);
+    ar.Value(t.attr_no_dashboard);
+    ar.Value(t.attr_no_toggle);
+}
+
+template<typename A> static void Transfer(A& ar, SlopeBrake& s)
+{
+    ar.Value(s.regulating_force);
+    ar.Value(s.attach_angle);
+    ar.Value(s.release_angle);
+}
+
+template<typename A> static void Transfer(A& ar, WheelDetacher& w)
+{
+    ar.Value(w.wheel_id);
+    ar.Value(w.detacher_group);
+}
+
+template<typename A> static void Transfer(A& ar, BaseWheel& w)
+{
+    ar.Value(w.width);
+    ar.Value(w.num_rays);
+    ar.Value(w.nodes);
+    ar.Value(w.rigidity_node);
+    ar.Value(w.braking);
+    ar.Value(w.propulsion);
+    ar.Value(w.reference_arm_node);
+    ar.Value(w.mass);
+    ar.Value(w.node_defaults);
+    ar.Value(w.beam_defaults);
+}
+
+template<typename A> static void Transfer(A& ar, Wheel& w)
+{
+    Transfer(ar, static_cast<BaseWheel&>(w));
+    ar.Value(w.radius);
+    ar.Value(w.springiness);
+    ar.Value(w.damping);
+    ar.Value(w.face_material_name);
+    ar.Value(w.band_material_name);
+}
+
+template<typename A> static void Transfer(A& ar, BaseWheel2& w)
+{
+    Transfer(ar, static_cast<BaseWheel&>(w));
+    ar.Value(w.rim_radius);
+    ar.Value(w.tyre_radius);
+    ar.Value(w.tyre_springiness);
+    ar.Value(w.tyre_damping);
+}
+
+template<typename A> static void Transfer(A& ar, Wheel2& w)
+{
+    Transfer(ar, static_cast<BaseWheel2&>(w));
+    ar.Value(w.face_material_name);
+    ar.Value(w.band_material_name);
+    ar.Value(w.rim_springiness);
+    ar.Value(w.rim_damping);
+}
+
+template<typename A> static void Transfer(A& ar, MeshWheel& w)
+{
+    Transfer(ar, static_cast<BaseWheel&>(w));
+    ar.Value(w.side);
+    ar.Value(w.mesh_name);
+    ar.Value(w.material_name);
+    ar.Value(w.rim_radius);
+    ar.Value(w.tyre_radius);
+    ar.Value(w.spring);
+    ar.Value(w.damping);
+    ar.Value(w._is_meshwheel2);
+}
+
+template<typename A> static void Transfer(A& ar, Flare2& f)
+{
+    ar.Value(f.reference_node);
+    ar.Value(f.node_axis_x);
+    ar.Value(f.node_axis_y);
+    ar.Value(f.offset);
+    ar.Value(f.type);
+    ar.Value(f.control_number);
+    ar.Value(f.blink_delay_milis);
+    ar.Value(f.size);
+    ar.Value(f.material_name);
+}
+
+template<typename A> static void Transfer(A& ar, Flexbody& f)
+{
+    ar.Value(f.reference_node);
+    ar.Value(f.x_axis_node);
+    ar.Value(f.y_axis_node);
+    ar.Value(f.offset);
+    ar.Value(f.rotation);
+    ar.Value(f.mesh_name);
+    ar.Value(f.animations);
+    ar.Value(f.node_list_to_import);
+    ar.Value(f.node_list);
+    ar.Value(f.camera_settings);
+}
+
+template<typename A> static void Transfer(A& ar, FlexBodyWheel& w)
+{
+    Transfer(ar, static_cast<BaseWheel2&>(w));
+    ar.Value(w.side);
+    ar.Value(w.rim_springiness);
+    ar.Value(w.rim_damping);
+    ar.Value(w.rim_mesh_name);
+    ar.Value(w.tyre_mesh_name);
+}
+
+template<typename A> static void Transfer(A& ar, Fusedrag& f)
+{
+    ar.Value(f.autocalc);
+    ar.Value(f.front_node);
+    ar.Value(f.rear_node);
+    ar.Value(f.approximate_width);
+    ar.Value(f.airfoil_name);
+    ar.Value(f.area_coefficient);
+}
+
+template<typename A> static void Transfer(A& ar, Hook& h)
+{
+    ar.Value(h.node);
+    ar.Value(h.flags);
+    ar.Value(h.option_hook_range);
+    ar.Value(h.option_speed_coef);
+    ar.Value(h.option_max_force);
+    ar.Value(h.option_hookgroup);
+    ar.Value(h.option_lockgroup);
+    ar.Value(h.option_timer);
+    ar.Value(h.option_min_range_meters);
+}
+
+template<typename A> static void Transfer(A& ar, Shock& s)
+{
+    ar.Value(s.nodes);
+    ar.Value(s.spring_rate);
+    ar.Value(s.damping);
+    ar.Value(s.short_bound);
+    ar.Value(s.long_bound);
+    ar.Value(s.precompression);
+    ar.Value(s.options);
+    ar.Value(s.beam_defaults);
+    ar.Value(s.detacher_group);
+}
+
+template<typename A> static void Transfer(A& ar, Shock2& s)
+{
+    ar.Value(s.nodes);
+    ar.Value(s.spring_in);
+    ar.Value(s.damp_in);
+    ar.Value(s.progress_factor_spring_in);
+    ar.Value(s.progress_factor_damp_in);
+    ar.Value(s.spring_out);
+    ar.Value(s.damp_out);
+    ar.Value(s.progress_factor_spring_out);
+    ar.Value(s.progress_factor_damp_out);
+    ar.Value(s.short_bound);
+    ar.Value(s.long_bound);
+    ar.Value(s.precompression);
+    ar.Value(s.options);
+    ar.Value(s.beam_defaults);
+    ar.Value(s.detacher_group);
+}
+
+template<typename A> static void Transfer(A& ar, SkeletonSettings& s)
+{
+    ar.Value(s.visibility_range_meters);
+    ar.Value(s.beam_thickness_meters);
+}
+
+template<typename A> static void Transfer(A& ar, Hydro& h)
+{
+    ar.Value(h.nodes);
+    ar.Value(h.lenghtening_factor);
+    ar.Value(h.options);
+    ar.Value(h.inertia);
+    ar.Value(h.inertia_defaults);
+    ar.Value(h.beam_defaults);
+    ar.Value(h.detacher_group);
+}
+
+template<typename A> static void Transfer(A& ar, AeroAnimator& a)
+{
+    ar.Value(a.flags);
+    ar.Value(a.motor);
+}
+
+template<typename A> static void Transfer(A& ar, Animator& a)
+{
+    ar.Value(a.nodes);
+    ar.Value(a.lenghtening_factor);
+    ar.Value(a.flags);
+    ar.Value(a.short_limit);
+    ar.Value(a.long_limit);
+    ar.Value(a.aero_animator);
+    ar.Value(a.inertia_defaults);
+    ar.Value(a.beam_defaults);
+    ar.Value(a.detacher_group);
+}
+
+template<typename A> static void Transfer(A& ar, Command2& c)
+{
+    ar.Value(c._format_version);
+    ar.Value(c.nodes);
+    ar.Value(c.shorten_rate);
+    ar.Value(c.lengthen_rate);
+    ar.Value(c.max_contraction);
+    ar.Value(c.max_extension);
+    ar.Value(c.contract_key);
+    ar.Value(c.extend_key);
+    ar.Value(c.description);
+    ar.Value(c.inertia);
+    ar.Value(c.affect_engine);
+    ar.Value(c.needs_engine);
+    ar.Value(c.plays_sound);
+    ar.Value(c.beam_defaults);
+    ar.Value(c.inertia_defaults);
+    ar.Value(c.detacher_group);
+    ar.Value(c.option_i_invisible);
+    ar.Value(c.option_r_rope);
+    ar.Value(c.option_c_auto_center);
+    ar.Value(c.option_f_not_faster);
+    ar.Value(c.option_p_1press);
+    ar.Value(c.option_o_1press_center);
+}
+
+template<typename A> static void Transfer(A& ar, Rotator& r)
+{
+    ar.Value(r.axis_nodes);
+    ar.Value(r.base_plate_nodes);
+    ar.Value(r.rotating_plate_nodes);
+    ar.Value(r.rate);
+    ar.Value(r.spin_left_key);
+    ar.Value(r.spin_right_key);
+    ar.Value(r.inertia);
+    ar.Value(r.inertia_defaults);
+    ar.Value(r.engine_coupling);
+    ar.Value(r.needs_engine);
+}
+
+template<typename A> static void Transfer(A& ar, Rotator2& r)
+{
+    Transfer(ar, static_cast<Rotator&>(r));
+    ar.Value(r.rotating_force);
+    ar.Value(r.tolerance);
+    ar.Value(r.description);
+}
+
+template<typename A> static void Transfer(A& ar, Trigger& t)
+{
+    ar.Value(t.nodes);
+    ar.Value(t.contraction_trigger_limit);
+    ar.Value(t.expansion_trigger_limit);
+    ar.Value(t.options);
+    ar.Value(t.boundary_timer);
+    ar.Value(t.beam_defaults);
+    ar.Value(t.detacher_group);
+    ar.Value(t.shortbound_trigger_action);
+    ar.Value(t.longbound_trigger_action);
+}
+
+template<typename A> static void Transfer(A& ar, Lockgroup& l)
+{
+    ar.Value(l.number);
+    ar.Value(l.nodes);
+}
+
+template<typename A> static void Transfer(A& ar, ManagedMaterial& m)
+{
+    ar.Value(m.name);
+    ar.Value(m.type);
+    ar.Value(m.options);
+    ar.Value(m.diffuse_map);
+    ar.Value(m.damaged_diffuse_map);
+    ar.Value(m.specular_map);
+}
+
+template<typename A> static void Transfer(A& ar, MaterialFlareBinding& m)
+{
+    ar.Value(m.flare_number);
+    ar.Value(m.material_name);
+}
+
+template<typename A> static void Transfer(A& ar, NodeCollision& n)
+{
+    ar.Value(n.node);
+    ar.Value(n.radius);
+}
+
+template<typename A> static void Transfer(A& ar, Particle& p)
+{
+    ar.Value(p.emitter_node);
+    ar.Value(p.reference_node);
+    ar.Value(p.particle_system_name);
+}
+
+template<typename A> static void Transfer(A& ar, Pistonprop& p)
+{
+    ar.Value(p.reference_node);
+    ar.Value(p.axis_node);
+    ar.Value(p.blade_tip_nodes);
+    ar.Value(p.couple_node);
+    ar.Value(p.turbine_power_kW);
+    ar.Value(p.pitch);
+    ar.Value(p.airfoil);
+}
+
+template<typename A> static void Transfer(A& ar, Prop::DashboardSpecial& d)
+{
+    ar.Value(d.offset);
+    ar.Value(d._offset_is_set);
+    ar.Value(d.rotation_angle);
+    ar.Value(d.mesh_name);
+}
+
+template<typename A> static void Transfer(A& ar, Prop::BeaconSpecial& b)
+{
+    ar.Value(b.flare_material_name);
+    ar.Value(b.color);
+}
+
+template<typename A> static void Transfer(A& ar, Prop& p)
+{
+    ar.Value(p.reference_node);
+    ar.Value(p.x_axis_node);
+    ar.Value(p.y_axis_node);
+    ar.Value(p.offset);
+    ar.Value(p.rotation);
+    ar.Value(p.mesh_name);
+    ar.Value(p.animations);
+    ar.Value(p.camera_settings);
+    ar.Value(p.special);
+    ar.Value(p.special_prop_beacon);
+    ar.Value(p.special_prop_dashboard);
+}
+
+template<typename A> static void Transfer(A& ar, RailGroup& r)
+{
+    ar.Value(r.id);
+    ar.Value(r.node_list);
+}
+
+template<typename A> static void Transfer(A& ar, Ropable& r)
+{
+    ar.Value(r.node);
+    ar.Value(r.group);
+    ar.Value(r.has_multilock);
+}
+
+template<typename A> static void Transfer(A& ar, Rope& r)
+{
+    ar.Value(r.root_node);
+    ar.Value(r.end_node);
+    ar.Value(r.invisible);
+    ar.Value(r.beam_defaults);
+    ar.Value(r.detacher_group);
+}
+
+template<typename A> static void Transfer(A& ar, Screwprop& s)
+{
+    ar.Value(s.prop_node);
+    ar.Value(s.back_node);
+    ar.Value(s.top_node);
+    ar.Value(s.power);
+}
+
+template<typename A> static void Transfer(A& ar, SlideNode& s)
+{
+    ar.Value(s.slide_node);
+    ar.Value(s.rail_node_ranges);
+    ar.Value(s.spring_rate);
+    ar.Value(s.break_force);
+    ar.Value(s.tolerance);
+    ar.Value(s.railgroup_id);
+    ar.Value(s._railgroup_id_set);
+    ar.Value(s.attachment_rate);
+    ar.Value(s.max_attachment_distance);
+    ar.Value(s._break_force_set);
+    ar.Value(s.constraint_flags);
+}
+
+template<typename A> static void Transfer(A& ar, SoundSource& s)
+{
+    ar.Value(s.node);
+    ar.Value(s.sound_script_name);
+}
+
+template<typename A> static void Transfer(A& ar, SoundSource2& s)
+{
+    Transfer(ar, static_cast<SoundSource&>(s));
+    ar.Value(s.mode);
+    ar.Value(s.cinecam_index);
+}
+
+template<typename A> static void Transfer(A& ar, SpeedLimiter& s)
+{
+    ar.Value(s.max_speed);
+    ar.Value(s.is_enabled);
+}
+
+template<typename A> static void Transfer(A& ar, Cab& c)
+{
+    ar.Value(c.nodes);
+    ar.Value(c.options);
+}
+
+template<typename A> static void Transfer(A& ar, Texcoord& t)
+{
+    ar.Value(t.node);
+    ar.Value(t.u);
+    ar.Value(t.v);
+}
+
+template<typename A> static void Transfer(A& ar, Submesh& s)
+{
+    ar.Value(s.backmesh);
+    ar.Value(s.texcoords);
+    ar.Value(s.cab_triangles);
+}
+
+template<typename A> static void Transfer(A& ar, Tie& t)
+{
+    ar.Value(t.root_node);
+    ar.Value(t.max_reach_length);
+    ar.Value(t.auto_shorten_rate);
+    ar.Value(t.min_length);
+    ar.Value(t.max_length);
+    ar.Value(t.is_invisible);
+    ar.Value(t.max_stress);
+    ar.Value(t.beam_defaults);
+    ar.Value(t.detacher_group);
+    ar.Value(t.group);
+}
+
+template<typename A> static void Transfer(A& ar, TorqueCurve::Sample& s)
+{
+    ar.Value(s.power);
+    ar.Value(s.torque_percent);
+}
+
+template<typename A> static void Transfer(A& ar, TorqueCurve& t)
+{
+    ar.Value(t.samples);
+    ar.Value(t.predefined_func_name);
+}
+
+template<typename A> static void Transfer(A& ar, Turbojet& t)
+{
+    ar.Value(t.front_node);
+    ar.Value(t.back_node);
+    ar.Value(t.side_node);
+    ar.Value(t.is_reversable);
+    ar.Value(t.dry_thrust);
+    ar.Value(t.wet_thrust);
+    ar.Value(t.front_diameter);
+    ar.Value(t.back_diameter);
+    ar.Value(t.nozzle_length);
+}
+
+template<typename A> static void Transfer(A& ar, Turboprop2& t)
+{
+    ar.Value(t.reference_node);
+    ar.Value(t.axis_node);
+    ar.Value(t.blade_tip_nodes);
+    ar.Value(t.turbine_power_kW);
+    ar.Value(t.airfoil);
+    ar.Value(t.couple_node);
+    ar.Value(t._format_version);
+}
+
+template<typename A> static void Transfer(A& ar, VideoCamera& v)
+{
+    ar.Value(v.reference_node);
+    ar.Value(v.left_node);
+    ar.Value(v.bottom_node);
+    ar.Value(v.alt_reference_node);
+    ar.Value(v.alt_orientation_node);
+    ar.Value(v.offset);
+    ar.Value(v.rotation);
+    ar.Value(v.field_of_view);
+    ar.Value(v.texture_width);
+    ar.Value(v.texture_height);
+    ar.Value(v.min_clip_distance);
+    ar.Value(v.max_clip_distance);
+    ar.Value(v.camera_role);
+    ar.Value(v.camera_mode);
+    ar.Value(v.material_name);
+    ar.Value(v.camera_name);
+}
+
+template<typename A> static void Transfer(A& ar, Wing& w)
+{
+    ar.Value(w.nodes);
+    ar.Value(w.tex_coords);
+    ar.Value(w.control_surface);
+    ar.Value(w.chord_point);
+    ar.Value(w.min_deflection);
+    ar.Value(w.max_deflection);
+    ar.Value(w.airfoil);
+    ar.Value(w.efficacy_coef);
+}
+
+template<typename A> static void Transfer(A& ar, File::Module& m)
+{
+    ar.Value(m.name);
+    ar.Value(m.help_panel_material_name);
+    ar.Value(m.contacter_nodes);
+    ar.Value(m.airbrakes);
+    ar.Value(m.animators);
+    ar.Value(m.anti_lock_brakes);
+    ar.Value(m.axles);
+    ar.Value(m.beams);
+    ar.Value(m.brakes);
+    ar.Value(m.cameras);
+    ar.Value(m.camera_rails);
+    ar.Value(m.collision_boxes);
+    ar.Value(m.cinecam);
+    ar.Value(m.commands_2);
+    ar.Value(m.cruise_control);
+    ar.Value(m.contacters);
+    ar.Value(m.engine);
+    ar.Value(m.engoption);
+    ar.Value(m.engturbo);
+    ar.Value(m.exhausts);
+    ar.Value(m.ext_camera);
+    ar.Value(m.fixes);
+    ar.Value(m.flares_2);
+    ar.Value(m.flexbodies);
+    ar.Value(m.flex_body_wheels);
+    ar.Value(m.fusedrag);
+    ar.Value(m.globals);
+    ar.Value(m.gui_settings);
+    ar.Value(m.hooks);
+    ar.Value(m.hydros);
+    ar.Value(m.lockgroups);
+    ar.Value(m.managed_materials);
+    ar.Value(m.material_flare_bindings);
+    ar.Value(m.mesh_wheels);
+    ar.Value(m.nodes);
+    ar.Value(m.node_collisions);
+    ar.Value(m.particles);
+    ar.Value(m.pistonprops);
+    ar.Value(m.props);
+    ar.Value(m.railgroups);
+    ar.Value(m.ropables);
+    ar.Value(m.ropes);
+    ar.Value(m.rotators);
+    ar.Value(m.rotators_2);
+    ar.Value(m.screwprops);
+    ar.Value(m.shocks);
+    ar.Value(m.shocks_2);
+    ar.Value(m.skeleton_settings);
+    ar.Value(m.slidenodes);
+    ar.Value(m.slope_brake);
+    ar.Value(m.soundsources);
+    ar.Value(m.soundsources2);
+    ar.Value(m.speed_limiter);
+    ar.Value(m.submeshes_ground_model_name);
+    ar.Value(m.submeshes);
+    ar.Value(m.ties);
+    ar.Value(m.torque_curve);
+    ar.Value(m.traction_control);
+    ar.Value(m.triggers);
+    ar.Value(m.turbojets);
+    ar.Value(m.turboprops_2);
+    ar.Value(m.videocameras);
+    ar.Value(m.wheeldetachers);
+    ar.Value(m.wheels);
+    ar.Value(m.wheels_2);
+    ar.Value(m.wings);
+}
+
+template<typename A> static void Transfer(A& ar, File& f)
+{
+    ar.Value(f.file_format_version);
+    ar.Value(f.guid);
+    ar.Value(f.description);
+    ar.Value(f.hide_in_chooser);
+    ar.Value(f.enable_advanced_deformation);
+    ar.Value(f.slide_nodes_connect_instantly);
+    ar.Value(f.rollon);
+    ar.Value(f.forward_commands);
+    ar.Value(f.import_commands);
+    ar.Value(f.lockgroup_default_nolock);
+    ar.Value(f.rescuer);
+    ar.Value(f.disable_default_sounds);
+    ar.Value(f.name);
+    ar.Value(f.collision_range);
+    ar.Value(f.minimum_mass);
+    ar.Value(f._minimum_mass_set);
+    ar.Value(f.root_module);
+    ar.Value(f.modules);
+    ar.Value(f.authors);
+    ar.Value(f.file_info);
+}
+
+template<typename A> static void Transfer(A& ar, FileCache::Entry& e)
+{
+    ar.Value(e.file);
+    ar.Value(e.report);
+    ar.Value(e.num_errors);
+    ar.Value(e.num_warnings);
+    ar.Value(e.num_other);
+}
+
+// ================================================================================================
+// FileSnapshot
+// ================================================================================================
+
+FileSnapshot::ResultCode FileSnapshot::Save(std::string const & path, std::string const & key, FileCache::Entry const & entry)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return RESULT_CODE_ERR_FOPEN_FAILED;
+    }
+
+    ResultCode result = RESULT_CODE_OK;
+    try
+    {
+        SnapshotWriter ar(file);
+        std::string signature = SIGNATURE;
+        unsigned int format_version = FILE_FORMAT_VERSION;
+        std::string build_version = ROR_VERSION_STRING;
+        std::string cache_key = key;
+        ar.Value(signature);
+        ar.Value(format_version);
+        ar.Value(build_version);
+        ar.Value(cache_key);
+        ar.Value(const_cast<FileCache::Entry&>(entry)); // The writer only reads
+    }
+    catch (ResultCode code)
+    {
+        result = code;
+    }
+
+    if (fclose(file) != 0 && result == RESULT_CODE_OK)
+    {
+        result = RESULT_CODE_FWRITE_OUTPUT_INCOMPLETE;
+    }
+    if (result != RESULT_CODE_OK)
+    {
+        remove(path.c_str());
+    }
+    return result;
+}
+
+FileSnapshot::ResultCode FileSnapshot::Load(std::string const & path, std::string const & key, FileCache::Entry & entry)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return RESULT_CODE_ERR_FOPEN_FAILED;
+    }
+
+    ResultCode result = RESULT_CODE_OK;
+    try
+    {
+        fseek(file, 0, SEEK_END);
+        const long file_size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        if (file_size <= 0)
+        {
+            throw RESULT_CODE_FREAD_OUTPUT_INCOMPLETE;
+        }
+
+        SnapshotReader ar(file, static_cast<size_t>(file_size));
+        std::string signature, build_version, cache_key;
+        unsigned int format_version = 0;
+        ar.Value(signature);
+        if (signature != SIGNATURE)
+        {
+            throw RESULT_CODE_ERR_SIGNATURE_MISMATCH;
+        }
+        ar.Value(format_version);
+        ar.Value(build_version);
+        if (format_version != FILE_FORMAT_VERSION || build_version != ROR_VERSION_STRING)
+        {
+            throw RESULT_CODE_ERR_VERSION_MISMATCH;
+        }
+        ar.Value(cache_key);
+        if (cache_key != key)
+        {
+            throw RESULT_CODE_ERR_KEY_MISMATCH;
+        }
+
+        ar.Value(entry);
+        if (entry.file == nullptr || entry.file->root_module == nullptr)
+        {
+            throw RESULT_CODE_ERR_INVALID_DATA;
+        }
+    }
+    catch (ResultCode code)
+    {
+        result = code;
+    }
+
+    fclose(file);
+    return result;
+}
+
+const char* FileSnapshot::ResultCodeToString(ResultCode code)
+{
+    switch (code)
+    {
+    case RESULT_CODE_OK:                        return "OK";
+    case RESULT_CODE_ERR_FOPEN_FAILED:          return "could not open file";
+    case RESULT_CODE_ERR_SIGNATURE_MISMATCH:    return "signature mismatch";
+    case RESULT_CODE_ERR_VERSION_MISMATCH:      return "version mismatch";
+    case RESULT_CODE_ERR_KEY_MISMATCH:          return "cache key mismatch";
+    case RESULT_CODE_ERR_INVALID_DATA:          return "invalid data";
+    case RESULT_CODE_FREAD_OUTPUT_INCOMPLETE:   return "file incomplete";
+    case RESULT_CODE_FWRITE_OUTPUT_INCOMPLETE:  return "write failed";
+    default:                                    return "";
+    }
+}
+
+} // namespace RigDef
@@ -0,0 +1,66 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// @file
+/// @brief Binary snapshots of validated truck definitions in the cache directory, see RigDef::FileCache.
+
+#pragma once
+
+#include "RigDef_FileCache.h"
+
+#include <string>
+
+namespace RigDef {
+
+/// Reads and writes a RigDef::FileCache::Entry (validated RigDef::File plus its loading report) as a binary file.
+/// Every struct is written field by field; shared pointers are written once and re-linked on load,
+/// so defaults shared between nodes/beams and the module list come back shared as before.
+///
+/// Layout: signature, FILE_FORMAT_VERSION, build version, cache key (see FileCache), then the entry.
+/// A snapshot whose header doesn't match exactly is not loaded and the caller parses the truck file instead.
+class FileSnapshot
+{
+public:
+    enum ResultCode
+    {
+        RESULT_CODE_OK,
+        RESULT_CODE_ERR_FOPEN_FAILED,
+        RESULT_CODE_ERR_SIGNATURE_MISMATCH,
+        RESULT_CODE_ERR_VERSION_MISMATCH,
+        RESULT_CODE_ERR_KEY_MISMATCH,
+        RESULT_CODE_ERR_INVALID_DATA,
+        RESULT_CODE_FREAD_OUTPUT_INCOMPLETE,
+        RESULT_CODE_FWRITE_OUTPUT_INCOMPLETE
+    };
+
+    static const char*        SIGNATURE;
+    static const unsigned int FILE_FORMAT_VERSION = 1; ///< Bump on any change to the structs in RigDef_File.h
+
+    /// Writes the snapshot; a partially written file is deleted.
+    static ResultCode Save(std::string const & path, std::string const & key, FileCache::Entry const & entry);
+
+    /// @param key Must match the key the snapshot was saved with.
+    static ResultCode Load(std::string const & path, std::string const & key, FileCache::Entry & entry);
+
+    static const char* ResultCodeToString(ResultCode code);
+};
+
+} // namespace RigDef
@@ -39,6 +39,10 @@
 #include <OgreStringVector.h>
 #include <OgreStringConverter.h>
 
+#include <climits>
+#include <cstdint>
+#include <cstring>
+
 namespace RigDef
 {
 
@@ -62,13 +66,307 @@ inline bool StrEqualsNocase(std::string const & s1, std::string const & s2)
     return true;
 }
 
+inline bool StrEqualsNocase(const char* s1, const char* s2)
+{
+    for (; (*s1 != '\0') && (*s2 != '\0'); ++s1, ++s2)
+    {
+        if (tolower(*s1) != tolower(*s2)) { return false; }
+    }
+    return (*s1 == *s2);
+}
+
 #define STR_PARSE_INT(_STR_)  Ogre::StringConverter::parseInt(_STR_)
 
 #define STR_PARSE_REAL(_STR_) Ogre::StringConverter::parseReal(_STR_)
 
 #define STR_PARSE_BOOL(_STR_) Ogre::StringConverter::parseBool(_STR_)
 
-Parser::Parser()
+// -------------------------------------------------------------------------- //
+// Keyword lookup                                                             //
+// -------------------------------------------------------------------------- //
+
+enum KeywordShape
+{
+    KEYWORD_SHAPE_BLOCK,           ///< Keyword alone on the line
+    KEYWORD_SHAPE_INLINE,          ///< Keyword, whitespace, values
+    KEYWORD_SHAPE_INLINE_TOLERANT, ///< Keyword, whitespace or comma, values
+};
+
+struct KeywordDef
+{
+    const char*  name;
+    KeywordShape shape;
+};
+
+// The table is expanded from the keyword regex definition, so that both stay in sync with File::Keyword.
+#undef  E_KEYWORD_BLOCK
+#undef  E_KEYWORD_INLINE
+#undef  E_KEYWORD_INLINE_TOLERANT
+#define E_KEYWORD_BLOCK(_NAME_)            { _NAME_, KEYWORD_SHAPE_BLOCK },
+#define E_KEYWORD_INLINE(_NAME_)           { _NAME_, KEYWORD_SHAPE_INLINE },
+#define E_KEYWORD_INLINE_TOLERANT(_NAME_)  { _NAME_, KEYWORD_SHAPE_INLINE_TOLERANT },
+
+static const KeywordDef KEYWORD_DEFS[] =
+{
+    { nullptr, KEYWORD_SHAPE_BLOCK }, // File::Keyword starts at 1
+    IDENTIFY_KEYWORD_REGEX_STRING
+};
+
+static_assert(sizeof(KEYWORD_DEFS) / sizeof(KeywordDef) == File::KEYWORD_WINGS + 1, "Keyword table doesn't match File::Keyword");
+
+inline char ToLowerAscii(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (c - 'A' + 'a') : c;
+}
+
+inline bool IsKeywordChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || (c == '_');
+}
+
+/// Perfect hash table of lowercase keyword names; the seed is searched on construction so that no two keywords collide.
+class KeywordHashTable
+{
+public:
+    static const uint32_t NUM_SLOTS = 2048; // Power of 2
+
+    KeywordHashTable()
+    {
+        for (m_seed = 2166136261u; !this->TryBuild(); ++m_seed) {}
+    }
+
+    uint32_t GetSeed() const { return m_seed; }
+
+    /// FNV-1a step, case insensitive
+    static uint32_t Step(uint32_t hash, char c) { return (hash ^ static_cast<uint8_t>(ToLowerAscii(c))) * 16777619u; }
+
+    /// @return The only keyword which can have this hash, or 0
+    unsigned Lookup(uint32_t hash) const { return m_slots[hash & (NUM_SLOTS - 1)]; }
+
+private:
+    bool TryBuild()
+    {
+        memset(m_slots, 0, sizeof(m_slots));
+        for (unsigned k = 1; k < sizeof(KEYWORD_DEFS) / sizeof(KeywordDef); ++k)
+        {
+            uint32_t hash = m_seed;
+            for (const char* c = KEYWORD_DEFS[k].name; *c != '\0'; ++c)
+            {
+                hash = Step(hash, *c);
+            }
+            uint8_t& slot = m_slots[hash & (NUM_SLOTS - 1)];
+            if (slot != 0)
+            {
+                return false;
+            }
+            slot = static_cast<uint8_t>(k);
+        }
+        return true;
+    }
+
+    uint32_t m_seed;
+    uint8_t  m_slots[NUM_SLOTS];
+};
+
+/// Equivalent of matching the line against IDENTIFY_KEYWORD_REGEX_STRING, without the regex.
+/// @param exact_case Output: false if the keyword only matched when ignoring lettercase.
+static File::Keyword FindKeyword(const char* line, bool& exact_case)
+{
+    static const KeywordHashTable hash_table; // Thread-safe init; cache generation parses in parallel.
+
+    // Keyword names are unique identifiers, so the leading identifier determines the only candidate
+    uint32_t hash = hash_table.GetSeed();
+    const char* name_end = line;
+    while (IsKeywordChar(*name_end))
+    {
+        hash = KeywordHashTable::Step(hash, *name_end);
+        ++name_end;
+    }
+    const unsigned index = hash_table.Lookup(hash);
+    if (index == 0)
+    {
+        return File::KEYWORD_INVALID;
+    }
+
+    const KeywordDef& def = KEYWORD_DEFS[index];
+    exact_case = true;
+    const char* c = line;
+    const char* n = def.name;
+    for (; (c != name_end) && (*n != '\0'); ++c, ++n)
+    {
+        if (*c != *n)
+        {
+            if (ToLowerAscii(*c) != ToLowerAscii(*n))
+            {
+                return File::KEYWORD_INVALID;
+            }
+            exact_case = false;
+        }
+    }
+    if ((c != name_end) || (*n != '\0'))
+    {
+        return File::KEYWORD_INVALID;
+    }
+
+    // Check what follows the name, like the regex does
+    const char* rest = name_end;
+    if (def.shape == KEYWORD_SHAPE_BLOCK)
+    {
+        while (IsWhitespace(*rest))
+        {
+            ++rest;
+        }
+        return (*rest == '\0') ? File::Keyword(index) : File::KEYWORD_INVALID;
+    }
+    if (!IsWhitespace(*rest) && !((def.shape == KEYWORD_SHAPE_INLINE_TOLERANT) && (*rest == ',')))
+    {
+        return File::KEYWORD_INVALID;
+    }
+    for (; *rest != '\0'; ++rest)
+    {
+        if ((*rest == '\r') || (*rest == '\n'))
+        {
+            return File::KEYWORD_INVALID;
+        }
+    }
+    return File::Keyword(index);
+}
+
+// -------------------------------------------------------------------------- //
+// Number parsing                                                             //
+// -------------------------------------------------------------------------- //
+
+inline bool IsDigit(char c)
+{
+    return (c >= '0') && (c <= '9');
+}
+
+/// Parses plain decimal numbers ("-12.5", ".5", "3e4") with exactly the result strtod() would give.
+/// @return False if the text has any other form, trailing characters or needs more precision; use strtod() then.
+static bool ParseSimpleFloat(const char* start, const char* end, double& out)
+{
+    static const double POW10[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    const char* c = start;
+    bool negative = false;
+    if ((c != end) && ((*c == '-') || (*c == '+')))
+    {
+        negative = (*c == '-');
+        ++c;
+    }
+
+    uint64_t mantissa = 0;
+    int num_significant = 0;
+    int exponent = 0;
+    bool any_digit = false;
+    bool in_fraction = false;
+    for (; c != end; ++c)
+    {
+        if ((*c == '.') && !in_fraction)
+        {
+            in_fraction = true;
+            continue;
+        }
+        if (!IsDigit(*c))
+        {
+            break;
+        }
+        any_digit = true;
+        if (in_fraction)
+        {
+            --exponent;
+        }
+        if ((mantissa == 0) && (*c == '0'))
+        {
+            continue; // Leading zero
+        }
+        if (++num_significant > 19)
+        {
+            return false;
+        }
+        mantissa = (mantissa * 10) + (*c - '0');
+    }
+    if (!any_digit)
+    {
+        return false;
+    }
+
+    if ((c != end) && ((*c == 'e') || (*c == 'E')))
+    {
+        ++c;
+        bool exp_negative = false;
+        if ((c != end) && ((*c == '-') || (*c == '+')))
+        {
+            exp_negative = (*c == '-');
+            ++c;
+        }
+        if ((c == end) || !IsDigit(*c))
+        {
+            return false; // strtod() stops before the 'e'
+        }
+        int exp_value = 0;
+        for (; (c != end) && IsDigit(*c); ++c)
+        {
+            if (exp_value > 1000)
+            {
+                return false;
+            }
+            exp_value = (exp_value * 10) + (*c - '0');
+        }
+        exponent += exp_negative ? -exp_value : exp_value;
+    }
+    if (c != end)
+    {
+        return false;
+    }
+
+    // Both the mantissa and the power of 10 are exact doubles, so a single multiplication/division rounds correctly
+    if ((mantissa > (1ull << 53)) || (exponent < -22) || (exponent > 22))
+    {
+        return false;
+    }
+    double value = static_cast<double>(mantissa);
+    value = (exponent < 0) ? (value / POW10[-exponent]) : (value * POW10[exponent]);
+    out = negative ? -value : value;
+    return true;
+}
+
+/// Same result as STR_PARSE_INT() (Ogre::StringConverter::parseInt()), without constructing a string stream.
+static int ParseIntLikeStream(const char* str)
+{
+    const char* c = str;
+    while (isspace(static_cast<unsigned char>(*c)))
+    {
+        ++c;
+    }
+    bool negative = false;
+    if ((*c == '-') || (*c == '+'))
+    {
+        negative = (*c == '-');
+        ++c;
+    }
+    if (!IsDigit(*c))
+    {
+        return 0;
+    }
+    int64_t value = 0;
+    for (; IsDigit(*c); ++c)
+    {
+        value = (value * 10) + (*c - '0');
+        if (value > static_cast<int64_t>(INT_MAX) + 1)
+        {
+            return 0; // Out of range; the stream fails and parseInt() returns the default.
+        }
+    }
+    if (negative)
+    {
+        value = -value;
+    }
+    return (value > INT_MAX) ? 0 : static_cast<int>(value);
+}
+
+Parser::Parser():
+    m_check_resources(true)
 {
     // Push defaults 
     m_ror_default_inertia = std::shared_ptr<Inertia>(new Inertia);
@@ -106,7 +404,6 @@ void Parser::ProcessCurrentLine()
 
     bool line_finished = false;
     bool scan_for_keyword = true;
-    std::string line = m_current_line;
 
     // Prepare for switching file section 
     Ogre::String const & current_module_name = m_current_module->name;
@@ -124,7 +421,7 @@ void Parser::ProcessCurrentLine()
     // NOTE: Please maintain alphabetical order 
     if (scan_for_keyword)
     {
-        File::Keyword keyword = IdentifyKeyword(line);
+        File::Keyword keyword = IdentifyKeyword(m_current_line);
         switch (keyword)
         {
             case (File::KEYWORD_INVALID): // No new section 
@@ -167,7 +464,7 @@ void Parser::ProcessCurrentLine()
                 }
                 else
                 {
-                    AddMessage(line, Message::TYPE_ERROR, "Misplaced sub-directive 'backmesh' (belongs in section 'submesh'), ignoring...");
+                    AddMessage(m_current_line, Message::TYPE_ERROR, "Misplaced sub-directive 'backmesh' (belongs in section 'submesh'), ignoring...");
                 }
                 line_finished = true;
                 break;
@@ -186,7 +483,7 @@ void Parser::ProcessCurrentLine()
                 new_subsection = File::SUBSECTION__SUBMESH__CAB;
                 if (m_current_section != File::SECTION_SUBMESH)
                 {
-                    AddMessage(line, Message::TYPE_WARNING, "Misplaced sub-section 'cab' (belongs in section 'submesh'), falling back to classic unsafe parsing method.");
+                    AddMessage(m_current_line, Message::TYPE_WARNING, "Misplaced sub-section 'cab' (belongs in section 'submesh'), falling back to classic unsafe parsing method.");
                     new_section = File::SECTION_SUBMESH;
                 }
                 line_finished = true;
@@ -245,7 +542,7 @@ void Parser::ProcessCurrentLine()
             case (File::KEYWORD_DISABLEDEFAULTSOUNDS):
                 if (! current_module_is_root)
                 {
-                    AddMessage(line, Message::TYPE_WARNING, "Directive 'disabledefaultsounds' has global effect and should not appear in a module");
+                    AddMessage(m_current_line, Message::TYPE_WARNING, "Directive 'disabledefaultsounds' has global effect and should not appear in a module");
                 }
                 m_definition->disable_default_sounds = true;
                 line_finished = true;
@@ -254,7 +551,7 @@ void Parser::ProcessCurrentLine()
             case (File::KEYWORD_ENABLE_ADVANCED_DEFORMATION):
                 if (! current_module_is_root)
                 {
-                    AddMessage(line, Message::TYPE_WARNING, "Directive 'enable_advanced_deformation' has global effect and should not appear in a module");
+                    AddMessage(m_current_line, Message::TYPE_WARNING, "Directive 'enable_advanced_deformation' has global effect and should not appear in a module");
                 }
                 m_definition->enable_advanced_deformation = true;
                 line_finished = true;
@@ -304,7 +601,7 @@ void Parser::ProcessCurrentLine()
             case (File::KEYWORD_FILEFORMATVERSION):
                 if (! current_module_is_root)
                 {
-                    AddMessage(line, Message::TYPE_WARNING, "Inline section 'fileformatversion' has global effect and should not appear in a module");
+                    AddMessage(m_current_line, Message::TYPE_WARNING, "Inline section 'fileformatversion' has global effect and should not appear in a module");
                 }
                 ParseFileFormatVersion();
                 line_finished = true;
@@ -348,7 +645,7 @@ void Parser::ProcessCurrentLine()
             case (File::KEYWORD_FORWARDCOMMANDS):
                 if (! current_module_is_root)
                 {
-                    AddMessage(line, Message::TYPE_WARNING, "Directive 'forwardcommands' has global effect and should not appear in a module");
+                    AddMessage(m_current_line, Message::TYPE_WARNING, "Directive 'forwardcommands' has global effect and should not appear in a module");
                 }
                 m_definition->forward_commands = true;
                 line_finished = true;
@@ -382,7 +679,7 @@ void Parser::ProcessCurrentLine()
             case (File::KEYWORD_HIDE_IN_CHOOSER):
                 if (! current_module_is_root)
                 {
-                    AddMessage(line, Message::TYPE_WARNING, "Directive 'hideInChooser' has global effect and should not appear in a module");
+                    AddMessage(m_current_line, Message::TYPE_WARNING, "Directive 'hideInChooser' has global effect and should not appear in a module");
                 }
                 m_definition->hide_in_chooser = true;
                 line_finished = true;
@@ -416,7 +713,7 @@ void Parser::ProcessCurrentLine()
             case (File::KEYWORD_LOCKGROUP_DEFAULT_NOLOCK):
                 if (! current_module_is_root)
                 {
-                    AddMessage(line, Message::TYPE_WARNING, "Directive 'lockgroup_default_nolock' has global effect and should not appear in a module");
+                    AddMessage(m_current_line, Message::TYPE_WARNING, "Directive 'lockgroup_default_nolock' has global effect and should not appear in a module");
                 }
                 m_definition->lockgroup_default_nolock = true;
                 line_finished = true;
@@ -490,14 +787,14 @@ void Parser::ProcessCurrentLine()
             case (File::KEYWORD_RESCUER):
                 if (! current_module_is_root)
                 {
-                    AddMessage(line, Message::TYPE_WARNING, "Directive 'rescuer' has global effect and should not appear in a module");
+                    AddMessage(m_current_line, Message::TYPE_WARNING, "Directive 'rescuer' has global effect and should not appear in a module");
                 }
                 m_definition->rescuer = true;
                 line_finished = true;
                 break;
 
             case (File::KEYWORD_RIGIDIFIERS):
-                AddMessage(line, Message::TYPE_WARNING, "Rigidifiers are not supported, ignoring...");
+                AddMessage(m_current_line, Message::TYPE_WARNING, "Rigidifiers are not supported, ignoring...");
                 new_section = File::SECTION_NONE;
                 line_finished = true;
                 break;
@@ -505,7 +802,7 @@ void Parser::ProcessCurrentLine()
             case (File::KEYWORD_ROLLON):
                 if (! current_module_is_root)
                 {
-                    AddMessage(line, Message::TYPE_WARNING, "Directive 'rollon' has global effect and should not appear in a module");
+                    AddMessage(m_current_line, Message::TYPE_WARNING, "Directive 'rollon' has global effect and should not appear in a module");
                 }
                 m_definition->rollon = true;
                 line_finished = true;
@@ -538,7 +835,7 @@ void Parser::ProcessCurrentLine()
 
             case (File::KEYWORD_SECTION):
                 {
-                    std::pair<bool, Ogre::String> result = GetModuleName(line);
+                    std::pair<bool, Ogre::String> result = GetModuleName(m_current_line);
                     if (result.first)
                     {
                         new_module_name = result.second;
@@ -601,7 +898,7 @@ void Parser::ProcessCurrentLine()
             case (File::KEYWORD_SLIDENODE_CONNECT_INSTANTLY):
                 if (! current_module_is_root)
                 {
-                    AddMessage(line, Message::TYPE_WARNING, "Directive 'slidenode_connect_instantly' has global effect and should not appear in a module");
+                    AddMessage(m_current_line, Message::TYPE_WARNING, "Directive 'slidenode_connect_instantly' has global effect and should not appear in a module");
                 }
                 m_definition->slide_nodes_connect_instantly = true;
                 line_finished = true;
@@ -652,7 +949,7 @@ void Parser::ProcessCurrentLine()
                 new_subsection = File::SUBSECTION__SUBMESH__TEXCOORDS;
                 if (m_current_section != File::SECTION_SUBMESH)
                 {
-                    AddMessage(line, Message::TYPE_WARNING, "Misplaced sub-section 'texcoords' (belongs in section 'submesh'), falling back to classic unsafe parsing method.");
+                    AddMessage(m_current_line, Message::TYPE_WARNING, "Misplaced sub-section 'texcoords' (belongs in section 'submesh'), falling back to classic unsafe parsing method.");
                     new_section = File::SECTION_SUBMESH;
                 }
                 line_finished = true;
@@ -730,7 +1027,7 @@ void Parser::ProcessCurrentLine()
     if (new_section != File::SECTION_INVALID)
     {
         // Exit sections 
-        _ExitSections(line);
+        _ExitSections(m_current_line);
         
         // Enter sections 
         if (new_section == File::SECTION_SUBMESH)
@@ -769,7 +1066,7 @@ void Parser::ProcessCurrentLine()
         {
             if (current_module_is_root)
             {
-                AddMessage(line, Message::TYPE_ERROR, "Misplaced keyword 'end_section', ignoring...");
+                AddMessage(m_current_line, Message::TYPE_ERROR, "Misplaced keyword 'end_section', ignoring...");
             }
             else
             {
@@ -780,7 +1077,7 @@ void Parser::ProcessCurrentLine()
         {
             if (current_module_name == new_module_name)
             {
-                AddMessage(line, Message::TYPE_ERROR, "Attempt to re-enter current module, ignoring...");
+                AddMessage(m_current_line, Message::TYPE_ERROR, "Attempt to re-enter current module, ignoring...");
             }
             else
             {
@@ -816,7 +1113,7 @@ void Parser::ProcessCurrentLine()
             break;
 
         case (File::SECTION_TRUCK_NAME):
-            m_definition->name = Ogre::String(line);
+            m_definition->name = Ogre::String(m_current_line);
             Ogre::StringUtil::trim(m_definition->name);
             m_current_section = File::SECTION_NONE;
             line_finished = true;
@@ -1759,10 +2056,10 @@ void Parser::ParseSubmesh()
         if (m_num_args > 3)
         {
             cab.options = 0;
-            std::string options_str = this->GetArgStr(3);
-            for (unsigned int i = 0; i < options_str.length(); i++)
+            const char* options_str = m_args[3].start;
+            for (int i = 0; i < m_args[3].length; i++)
             {
-                switch (options_str.at(i))
+                switch (options_str[i])
                 {
                 case 'c': cab.options |=  Cab::OPTION_c_CONTACT;                               break;
                 case 'b': cab.options |=  Cab::OPTION_b_BUOYANT;                               break;
@@ -1775,7 +2072,7 @@ void Parser::ParseSubmesh()
 
                 default:
                     char msg[200] = "";
-                    snprintf(msg, 200, "'submesh/cab' Ignoring invalid option '%c'...", options_str.at(i));
+                    snprintf(msg, 200, "'submesh/cab' Ignoring invalid option '%c'...", options_str[i]);
                     this->AddMessage(Message::TYPE_WARNING, msg);
                     break;
                 }
@@ -1833,7 +2130,10 @@ void Parser::ParseFlexbody()
         // * Pair of node numbers:" 123 - 456 ". Whitespace is optional.
 
         char setdef[LINE_BUFFER_LENGTH] = ""; // strtok() is destructive, we need own buffer.
-        strncpy(setdef, m_current_line + 6, LINE_BUFFER_LENGTH - 6); // Cut away "forset"
+        if (strnlen(m_current_line, 6) == 6) // Only the current line is terminated, the buffer isn't cleared.
+        {
+            strncpy(setdef, m_current_line + 6, LINE_BUFFER_LENGTH - 6); // Cut away "forset"
+        }
         const char* item = std::strtok(setdef, ",");
 
         // TODO: Add error reporting
@@ -2900,9 +3200,8 @@ void Parser::ParseShock2()
     shock_2.options = 0u;
     if (m_num_args > 13)
     {
-        std::string options_str = this->GetArgStr(13);
-        auto itor = options_str.begin();
-        auto endi = options_str.end();
+        const char* itor = m_args[13].start;
+        const char* endi = m_args[13].start + m_args[13].length;
         while (itor != endi)
         {
             char c = *itor++; // ++
@@ -2950,9 +3249,8 @@ void Parser::ParseShock()
     shock.options = 0u;
     if (m_num_args > 7)
     {
-        std::string options_str = this->GetArgStr(7);
-        auto itor = options_str.begin();
-        auto endi = options_str.end();
+        const char* itor = m_args[7].start;
+        const char* endi = m_args[7].start + m_args[7].length;
         while (itor != endi)
         {
             char c = *itor++;
@@ -2996,7 +3294,7 @@ Node::Ref Parser::_ParseNodeRef(std::string const & node_id_str)
     if (m_sequential_importer.IsEnabled())
     {
         // Import of legacy fileformatversion
-        int node_id_num = STR_PARSE_INT(node_id_str);
+        int node_id_num = ParseIntLikeStream(node_id_str.c_str());
         if (node_id_num < 0)
         {
             std::stringstream msg;
@@ -3493,19 +3791,22 @@ void Parser::ParseManagedMaterials()
         return;
     }
 
-    if (!RoR::App::GetCacheSystem()->resourceExistsInAllGroups(managed_mat.diffuse_map))
-    {
-        this->AddMessage(Message::TYPE_WARNING, "Missing texture file: " + managed_mat.diffuse_map);
-    }
-    if (managed_mat.HasDamagedDiffuseMap() && !RoR::App::GetCacheSystem()->resourceExistsInAllGroups(managed_mat.damaged_diffuse_map))
-    {
-        this->AddMessage(Message::TYPE_WARNING, "Missing texture file: " + managed_mat.damaged_diffuse_map);
-        managed_mat.damaged_diffuse_map = "-";
-    }
-    if (managed_mat.HasSpecularMap() && !RoR::App::GetCacheSystem()->resourceExistsInAllGroups(managed_mat.specular_map))
+    if (m_check_resources)
     {
-        this->AddMessage(Message::TYPE_WARNING, "Missing texture file: " + managed_mat.specular_map);
-        managed_mat.specular_map = "-";
+        if (!RoR::App::GetCacheSystem()->resourceExistsInAllGroups(managed_mat.diffuse_map))
+        {
+            this->AddMessage(Message::TYPE_WARNING, "Missing texture file: " + managed_mat.diffuse_map);
+        }
+        if (managed_mat.HasDamagedDiffuseMap() && !RoR::App::GetCacheSystem()->resourceExistsInAllGroups(managed_mat.damaged_diffuse_map))
+        {
+            this->AddMessage(Message::TYPE_WARNING, "Missing texture file: " + managed_mat.damaged_diffuse_map);
+            managed_mat.damaged_diffuse_map = "-";
+        }
+        if (managed_mat.HasSpecularMap() && !RoR::App::GetCacheSystem()->resourceExistsInAllGroups(managed_mat.specular_map))
+        {
+            this->AddMessage(Message::TYPE_WARNING, "Missing texture file: " + managed_mat.specular_map);
+            managed_mat.specular_map = "-";
+        }
     }
 
     m_current_module->managed_materials.push_back(managed_mat);
@@ -3568,8 +3869,8 @@ void Parser::ParseBeams()
     // Flags 
     if (m_num_args > 2)
     {
-        std::string options_str = this->GetArgStr(2);
-        for (auto itor = options_str.begin(); itor != options_str.end(); ++itor)
+        const char* options_end = m_args[2].start + m_args[2].length;
+        for (const char* itor = m_args[2].start; itor != options_end; ++itor)
         {
                  if (*itor == 'v') { continue; } // Dummy flag
             else if (*itor == 'i') { beam.options |= Beam::OPTION_i_INVISIBLE; } 
@@ -3775,7 +4076,7 @@ void Parser::AddMessage(std::string const & line, Message::Type type, std::strin
     }
 }
 
-File::Keyword Parser::IdentifyKeyword(Ogre::String const & line)
+File::Keyword Parser::IdentifyKeyword(const char* line)
 {
     // Quick check - keyword always starts with ASCII letter
     char c = line[0]; // Note: line comes in trimmed
@@ -3784,19 +4085,9 @@ File::Keyword Parser::IdentifyKeyword(Ogre::String const & line)
         return File::KEYWORD_INVALID;
     }
 
-    // Search with correct lettercase
-    std::smatch results;
-    std::regex_search(line, results, Regexes::IDENTIFY_KEYWORD_RESPECT_CASE); // Always returns true.
-    File::Keyword keyword = FindKeywordMatch(results);
-    if (keyword != File::KEYWORD_INVALID)
-    {
-        return keyword;
-    }
-
-    // Search and ignore lettercase
-    std::regex_search(line, results, Regexes::IDENTIFY_KEYWORD_IGNORE_CASE); // Always returns true.
-    keyword = FindKeywordMatch(results);
-    if (keyword != File::KEYWORD_INVALID)
+    bool exact_case = true;
+    File::Keyword keyword = FindKeyword(line, exact_case);
+    if ((keyword != File::KEYWORD_INVALID) && !exact_case)
     {
         this->AddMessage(line, Message::TYPE_WARNING, 
             "Keyword has invalid lettercase. Correct form is: " + std::string(File::KeywordToString(keyword)));
@@ -3804,23 +4095,6 @@ File::Keyword Parser::IdentifyKeyword(Ogre::String const & line)
     return keyword;
 }
 
-File::Keyword Parser::FindKeywordMatch(std::smatch& search_results)
-{
-    // The 'results' array contains a complete match at positon [0] and sub-matches starting with [1], 
-    //    so we get exact positions in Regexes::IDENTIFY_KEYWORD, which again match File::Keyword enum members
-        
-    for (unsigned int i = 1; i < search_results.size(); i++)
-    {
-        std::ssub_match sub  = search_results[i];
-        if (sub.matched)
-        {
-            // Build enum value directly from result offset 
-            return File::Keyword(i);
-        }
-    }
-    return File::KEYWORD_INVALID;
-}
-
 void Parser::Prepare()
 {
     m_current_section = File::SECTION_TRUCK_NAME;
@@ -4062,6 +4336,12 @@ Flare2::Type Parser::GetArgFlareType(int index)
 
 float Parser::GetArgFloat(int index)
 {
+    double simple_res = 0.0;
+    if (ParseSimpleFloat(m_args[index].start, m_args[index].start + m_args[index].length, simple_res))
+    {
+        return static_cast<float>(simple_res);
+    }
+
     errno = 0;
     char* out_end = nullptr;
     float res = std::strtod(m_args[index].start, &out_end);
@@ -4226,7 +4506,7 @@ void Parser::ProcessOgreStream(Ogre::DataStream* stream)
 void Parser::ProcessRawLine(const char* raw_line_buf)
 {
     const char* raw_start = raw_line_buf;
-    const char* raw_end = raw_line_buf + strnlen(raw_line_buf, LINE_BUFFER_LENGTH);
+    const char* raw_end = raw_line_buf + strnlen(raw_line_buf, LINE_BUFFER_LENGTH - 1);
 
     // Trim leading whitespace
     while (IsWhitespace(*raw_start) && (raw_start != raw_end))
@@ -4242,9 +4522,8 @@ void Parser::ProcessRawLine(const char* raw_line_buf)
     }
 
     // Sanitize UTF-8
-    memset(m_current_line, 0, LINE_BUFFER_LENGTH);
-    char* out_start = m_current_line;
-    utf8::replace_invalid(raw_start, raw_end, out_start, '?');
+    char* out_end = utf8::replace_invalid(raw_start, raw_end, m_current_line, '?');
+    *out_end = '\0';
 
     // Process
     this->ProcessCurrentLine();
@@ -126,6 +126,9 @@ public:
 
     SequentialImporter* GetSequentialImporter() { return &m_sequential_importer; }
 
+    /// Disables looking up referenced resources (textures) in Ogre's resource groups; required when parsing on worker threads.
+    void SetResourceChecksEnabled(bool enabled) { m_check_resources = enabled; }
+
     std::string ProcessMessagesToString();
 
     int GetMessagesNumErrors()   const { return m_messages_num_errors;   }
@@ -337,10 +340,7 @@ protected:
     void _CheckInvalidTrailingText(Ogre::String const & line, std::smatch const & results, unsigned int index);
 
     /// Keyword scan function. 
-    File::Keyword IdentifyKeyword(Ogre::String const & line);
-
-    /// Keyword scan utility function. 
-    File::Keyword FindKeywordMatch(std::smatch& search_results);
+    File::Keyword IdentifyKeyword(const char* line);
 
     /// Adds a message to parser report.
     void AddMessage(std::string const & line, Message::Type type, std::string const & message);
@@ -414,6 +414,7 @@ protected:
     SequentialImporter                   m_sequential_importer;
 
     std::shared_ptr<RigDef::File>        m_definition;
+    bool                                 m_check_resources;
     std::list<Message>                   m_messages;
     int                                  m_messages_num_errors;
     int                                  m_messages_num_warnings;
@@ -188,6 +188,7 @@ namespace Regexes
 // -------------------------------------------------------------------------- //
 
 // IMPORTANT! If you add a value here, you must also modify File::Keywords enum, it relies on positions in this regex
+// NOTE: Parser::IdentifyKeyword() doesn't run the regex, it expands this list into a keyword table.
 #define IDENTIFY_KEYWORD_REGEX_STRING                             \
     /* E_KEYWORD_BLOCK("advdrag") ~~ Not supported yet */         \
     E_KEYWORD_INLINE_TOLERANT("add_animation")  /* Position 1 */  \
@@ -297,9 +298,6 @@ namespace Regexes
     E_KEYWORD_BLOCK("wheels2")                                    \
     E_KEYWORD_BLOCK("wings")
 
-DEFINE_REGEX(            IDENTIFY_KEYWORD_RESPECT_CASE, IDENTIFY_KEYWORD_REGEX_STRING )
-DEFINE_REGEX_IGNORECASE( IDENTIFY_KEYWORD_IGNORE_CASE,  IDENTIFY_KEYWORD_REGEX_STRING )
-
 DEFINE_REGEX( POSITIVE_DECIMAL_NUMBER, E_POSITIVE_DECIMAL_NUMBER );
 
 DEFINE_REGEX( NEGATIVE_DECIMAL_NUMBER, E_NEGATIVE_DECIMAL_NUMBER );
@@ -81,7 +81,9 @@ ScriptEngine::ScriptEngine(Collisions *coll) :
     , engine(0)
     , eventCallbackFunctionPtr(-1)
     , eventMask(0)
+    , fireEventFunctionPtr(-1)
     , frameStepFunctionPtr(-1)
+    , callbackQueue(CALLBACK_QUEUE_SIZE)
     , scriptHash()
     , scriptLog(0)
     , scriptName()
@@ -105,8 +107,12 @@ ScriptEngine::ScriptEngine(Collisions *coll) :
 ScriptEngine::~ScriptEngine()
 {
     // Clean up
-    if (engine)  engine->Release();
+    for (AngelScript::asIScriptContext* ctx : contextPool)
+    {
+        ctx->Release();
+    }
     if (context) context->Release();
+    if (engine)  engine->Release();
 }
 
 
@@ -588,6 +594,8 @@ void ScriptEngine::msgCallback(const AngelScript::asSMessageInfo *msg)
 
 int ScriptEngine::framestep(Real dt)
 {
+    dispatchCallbacks();
+
     // Check if we need to execute any strings
     std::vector<String> tmpQueue;
     stringExecutionQueue.pull(tmpQueue);
@@ -600,50 +608,78 @@ int ScriptEngine::framestep(Real dt)
     // framestep stuff below
     if (frameStepFunctionPtr<=0) return 1;
     if (!engine) return 0;
-    if (!context) context = engine->CreateContext();
-    context->Prepare(frameStepFunctionPtr);
+    AngelScript::asIScriptContext *ctx = acquireContext();
+    ctx->Prepare(frameStepFunctionPtr);
 
     // Set the function arguments
-    context->SetArgFloat(0, dt);
+    ctx->SetArgFloat(0, dt);
 
     //SLOG("Executing framestep()");
-    int r = context->Execute();
+    int r = ctx->Execute();
     if ( r == AngelScript::asEXECUTION_FINISHED )
     {
       // The return value is only valid if the execution finished successfully
-        AngelScript::asDWORD ret = context->GetReturnDWord();
+        AngelScript::asDWORD ret = ctx->GetReturnDWord();
     }
+    releaseContext(ctx);
     return 0;
 }
 
 int ScriptEngine::fireEvent(std::string instanceName, float intensity)
 {
     if (!engine) return 0;
-    AngelScript::asIScriptModule *mod = engine->GetModule(moduleName, AngelScript::asGM_CREATE_IF_NOT_EXISTS);
-    int functionPtr = mod->GetFunctionIdByDecl("void fireEvent(string, float)"); // TODO: this shouldn't be hard coded --neorej16
-    if (functionPtr<0) return 0;
-    if (!context) context = engine->CreateContext();
-    context->Prepare(functionPtr);
+    if (fireEventFunctionPtr<0) return 0;
+    AngelScript::asIScriptContext *ctx = acquireContext();
+    ctx->Prepare(fireEventFunctionPtr);
 
     // Set the function arguments
-    std::string *instance_name = new std::string(instanceName);
-    context->SetArgObject(0, &instanceName);
-    context->SetArgFloat (1, intensity);
+    ctx->SetArgObject(0, &instanceName);
+    ctx->SetArgFloat (1, intensity);
 
-    int r = context->Execute();
+    int r = ctx->Execute();
     if ( r == AngelScript::asEXECUTION_FINISHED )
     {
       // The return value is only valid if the execution finished successfully
-        AngelScript::asDWORD ret = context->GetReturnDWord();
+        AngelScript::asDWORD ret = ctx->GetReturnDWord();
     }
-    delete(instance_name);
+    releaseContext(ctx);
 
     return 0;
 }
 
-int ScriptEngine::envokeCallback(int functionPtr, eventsource_t *source, node_t *node, int type)
+bool ScriptEngine::queueCallback(int functionPtr, eventsource_t *source, node_t *node, int type)
 {
-    if (!engine) return 0;
+    queued_callback_t cb;
+    cb.functionPtr = functionPtr;
+    cb.source = source;
+    cb.node_id = (node) ? node->id : -1;
+    cb.type = type;
+    return callbackQueue.push(cb);
+}
+
+void ScriptEngine::discardCallbacks()
+{
+    queued_callback_t cb;
+    while (callbackQueue.pop(cb))
+    {
+    }
+}
+
+void ScriptEngine::dispatchCallbacks()
+{
+    // Take a snapshot first; callbacks queued meanwhile wait for the next frame
+    callbackBatch.clear();
+    callbackQueue.pull(callbackBatch);
+    for (const queued_callback_t& cb : callbackBatch)
+    {
+        envokeCallback(cb);
+    }
+}
+
+void ScriptEngine::envokeCallback(const queued_callback_t& cb)
+{
+    if (!engine) return;
+    int functionPtr = cb.functionPtr;
     if (functionPtr <= 0 && defaultEventCallbackFunctionPtr > 0)
     {
         // use the default event handler instead then
@@ -651,32 +687,51 @@ int ScriptEngine::envokeCallback(int functionPtr, eventsource_t *source, node_t
     } else if (functionPtr <= 0)
     {
         // no default callback available, discard the event
-        return 0;
+        return;
     }
-    if (!context) context = engine->CreateContext();
-    context->Prepare(functionPtr);
-
-    // Set the function arguments
-    std::string *instance_name = new std::string(source->instancename);
-    std::string *boxname = new std::string(source->boxname);
-    context->SetArgDWord (0, type);
-    context->SetArgObject(1, instance_name);
-    context->SetArgObject(2, boxname);
-    if (node)
-        context->SetArgDWord (3, node->id);
-    else
-        context->SetArgDWord (3, -1); // conversion from 'int' to 'AngelScript::asDWORD', signed/unsigned mismatch!
-
-    int r = context->Execute();
+    AngelScript::asIScriptContext *ctx = acquireContext();
+    ctx->Prepare(functionPtr);
+
+    // Set the function arguments; the strings are only read during Execute()
+    callbackInstanceName.assign(cb.source->instancename);
+    callbackBoxName.assign(cb.source->boxname);
+    ctx->SetArgDWord (0, cb.type);
+    ctx->SetArgObject(1, &callbackInstanceName);
+    ctx->SetArgObject(2, &callbackBoxName);
+    ctx->SetArgDWord (3, (AngelScript::asDWORD)cb.node_id);
+
+    int r = ctx->Execute();
     if ( r == AngelScript::asEXECUTION_FINISHED )
     {
       // The return value is only valid if the execution finished successfully
-        AngelScript::asDWORD ret = context->GetReturnDWord();
+        AngelScript::asDWORD ret = ctx->GetReturnDWord();
     }
-    delete(instance_name);
-    delete(boxname);
+    releaseContext(ctx);
+}
 
-    return 0;
+AngelScript::asIScriptContext* ScriptEngine::acquireContext()
+{
+    if (!context) context = engine->CreateContext();
+    const int state = context->GetState();
+    if (state != AngelScript::asEXECUTION_ACTIVE && state != AngelScript::asEXECUTION_SUSPENDED)
+        return context;
+
+    if (!contextPool.empty())
+    {
+        AngelScript::asIScriptContext *ctx = contextPool.back();
+        contextPool.pop_back();
+        return ctx;
+    }
+    AngelScript::asIScriptContext *ctx = engine->CreateContext();
+    ctx->SetExceptionCallback(AngelScript::asMETHOD(ScriptEngine,ExceptionCallback), this, AngelScript::asCALL_THISCALL);
+    return ctx;
+}
+
+void ScriptEngine::releaseContext(AngelScript::asIScriptContext *ctx)
+{
+    if (ctx == context) return;
+    ctx->Unprepare();
+    contextPool.push_back(ctx);
 }
 
 void ScriptEngine::queueStringForExecution(const String command)
@@ -741,6 +796,10 @@ int ScriptEngine::addFunction(const String &arg)
             if (defaultEventCallbackFunctionPtr < 0) defaultEventCallbackFunctionPtr = funcId;
             callbacks["defaultEventCallback"].push_back(funcId);
         }
+        else if ( funcId == mod->GetFunctionIdByDecl("void fireEvent(string, float)") )
+        {
+            if (fireEventFunctionPtr < 0) fireEventFunctionPtr = funcId;
+        }
         else if ( funcId == mod->GetFunctionIdByDecl("void on_terrain_loading(string lines)") )
         {	
             callbacks["on_terrain_loading"].push_back(funcId);
@@ -803,6 +862,8 @@ int ScriptEngine::deleteFunction(const String &arg)
             eventCallbackFunctionPtr = -1;
         if ( defaultEventCallbackFunctionPtr == id )
             defaultEventCallbackFunctionPtr = -1;
+        if ( fireEventFunctionPtr == id )
+            fireEventFunctionPtr = -1;
     }
     else
     {
@@ -867,19 +928,20 @@ void ScriptEngine::triggerEvent(int eventnum, int value)
     if (eventMask & eventnum)
     {
         // script registered for that event, so sent it
-        if (!context) context = engine->CreateContext();
-        context->Prepare(eventCallbackFunctionPtr);
+        AngelScript::asIScriptContext *ctx = acquireContext();
+        ctx->Prepare(eventCallbackFunctionPtr);
 
         // Set the function arguments
-        context->SetArgDWord(0, eventnum);
-        context->SetArgDWord(1, value);
+        ctx->SetArgDWord(0, eventnum);
+        ctx->SetArgDWord(1, value);
 
-        int r = context->Execute();
+        int r = ctx->Execute();
         if ( r == AngelScript::asEXECUTION_FINISHED )
         {
           // The return value is only valid if the execution finished successfully
-            AngelScript::asDWORD ret = context->GetReturnDWord();
+            AngelScript::asDWORD ret = ctx->GetReturnDWord();
         }
+        releaseContext(ctx);
         return;
     }
 }
@@ -949,6 +1011,8 @@ int ScriptEngine::loadScript(String _scriptName)
     defaultEventCallbackFunctionPtr = mod->GetFunctionIdByDecl("void defaultEventCallback(int, string, string, int)");
     if (defaultEventCallbackFunctionPtr > 0) callbacks["defaultEventCallback"].push_back(defaultEventCallbackFunctionPtr);
 
+    fireEventFunctionPtr = mod->GetFunctionIdByDecl("void fireEvent(string, float)");
+
     int cb = mod->GetFunctionIdByDecl("void on_terrain_loading(string lines)");
     if (cb > 0) callbacks["on_terrain_loading"].push_back(cb);
 
@@ -32,6 +32,7 @@
 #include "RoRPrerequisites.h"
 
 #include "InterThreadStoreVector.h"
+#include "LockFreeQueue.h"
 #include "Singleton.h"
 
 #include "scriptdictionary/scriptdictionary.h"
@@ -136,7 +137,17 @@ public:
 
     int fireEvent(std::string instanceName, float intensity);
 
-    int envokeCallback(int functionPtr, eventsource_t* source, node_t* node = 0, int type = 0);
+    /**
+     * Queues a collision box event; it's passed to the script by the next framestep().
+     * Safe to call from any thread.
+     * @return false if the queue is full and the event was dropped
+     */
+    bool queueCallback(int functionPtr, eventsource_t* source, node_t* node = 0, int type = 0);
+
+    /**
+     * Drops all queued events, call this before their event sources go away.
+     */
+    void discardCallbacks();
 
     AngelScript::asIScriptEngine* getEngine() { return engine; };
 
@@ -172,12 +183,39 @@ protected:
     int wheelEventFunctionPtr; //!< script function pointer
     int eventCallbackFunctionPtr; //!< script function pointer to the event callback function
     int defaultEventCallbackFunctionPtr; //!< script function pointer for spawner events
+    int fireEventFunctionPtr; //!< script function pointer to the fireEvent function
     Ogre::String scriptName;
     Ogre::String scriptHash;
     std::map<std::string, std::vector<int>> callbacks;
 
     InterThreadStoreVector<Ogre::String> stringExecutionQueue; //!< The string execution queue \see queueStringForExecution
 
+    struct queued_callback_t
+    {
+        int functionPtr;
+        eventsource_t* source;
+        int node_id;
+        int type;
+    };
+
+    static const size_t CALLBACK_QUEUE_SIZE = 1024;
+
+    LockFreeQueue<queued_callback_t> callbackQueue; //!< Collision box events from the physics threads \see queueCallback
+    std::vector<queued_callback_t> callbackBatch; //!< Events being dispatched by the current framestep()
+    std::vector<AngelScript::asIScriptContext*> contextPool; //!< Idle contexts for calls made while 'context' is busy
+    std::string callbackInstanceName; //!< Argument storage reused by every envokeCallback()
+    std::string callbackBoxName;
+
+    /**
+     * Returns 'context', or a pooled one if a script is running in it already (i.e. nested calls).
+     * Hand it back with releaseContext() after execution.
+     */
+    AngelScript::asIScriptContext* acquireContext();
+    void releaseContext(AngelScript::asIScriptContext* ctx);
+
+    void dispatchCallbacks();
+    void envokeCallback(const queued_callback_t& cb);
+
     static const char* moduleName;
 
     /**
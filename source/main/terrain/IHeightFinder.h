@@ -31,6 +31,15 @@ public:
     }
 
     virtual float getHeightAt(float x, float z) = 0;
+
+    /// Batched getHeightAt(); implementations override this to avoid a virtual call per point
+    virtual void getHeightsAt(const float* x, const float* z, float* heights, int count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            heights[i] = getHeightAt(x[i], z[i]);
+        }
+    }
     virtual Ogre::Vector3 getNormalAt(float x, float y, float z, float precision = 0.1f) = 0;
 };
 
@@ -32,6 +32,8 @@
 
 #include <OgreTerrainGroup.h>
 
+#include <algorithm>
+
 using namespace Ogre;
 
 #define XZSTR(X,Z)   String("[") + TOSTRING(X) + String(",") + TOSTRING(Z) + String("]")
@@ -172,6 +174,19 @@ float TerrainGeometryManager::getHeightAt(float x, float z)
         return getHeightAtWorldPosition(x, z);
 }
 
+void TerrainGeometryManager::getHeightsAt(const float* x, const float* z, float* heights, int count)
+{
+    if (m_terrain_is_flat)
+    {
+        std::fill(heights, heights + count, 0.0f);
+        return;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        heights[i] = getHeightAtWorldPosition(x[i], z[i]);
+    }
+}
+
 Ogre::Vector3 TerrainGeometryManager::getNormalAt(float x, float y, float z, float precision)
 {
     Ogre::Vector3 left(-precision, getHeightAt(x - precision, z) - y, 0.0f);
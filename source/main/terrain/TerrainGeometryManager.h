@@ -40,6 +40,7 @@ public:
     Ogre::TerrainGroup* getTerrainGroup() { return m_ogre_terrain_group; };
 
     float getHeightAt(float x, float z);
+    void getHeightsAt(const float* x, const float* z, float* heights, int count);
     float getHeightAtPoint(long x, long z);
     float getHeightAtTerrainPosition(float x, float z);
     float getHeightAtWorldPosition(float x, float z);
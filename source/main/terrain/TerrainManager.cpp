@@ -188,8 +188,6 @@ void TerrainManager::loadTerrain(String filename)
     PROGRESS_WINDOW(90, _L("Loading Terrain Objects"));
     loadTerrainObjects();
 
-    collisions->printStats();
-
     // bake the decals
     //finishTerrainDecal();
 
@@ -204,6 +202,7 @@ void TerrainManager::loadTerrain(String filename)
     }
 
     collisions->finishLoadingTerrain();
+    collisions->printStats();
     LOG(" ===== TERRAIN LOADING DONE " + filename);
 }
 
@@ -67,6 +67,7 @@ inline float getTerrainHeight(Real x, Real z, void* unused = 0)
 TerrainObjectManager::TerrainObjectManager(TerrainManager* terrainManager) :
     background_loading(BSETTING("Background Loading", false)),
     use_rt_shader_system(BSETTING("Use RTShader System", false)),
+    batch_static_objects(BSETTING("Batch Static Objects", false)),
     terrainManager(terrainManager)
 {
     //prepare for baking
@@ -698,6 +699,12 @@ void TerrainObjectManager::postLoad()
     {
         bakesg->build();
         bakeNode->detachAllObjects();
+        // batched objects live in child nodes, see loadObject()
+        Node::ChildNodeIterator it = bakeNode->getChildIterator();
+        while (it.hasMoreElements())
+        {
+            static_cast<SceneNode*>(it.getNext())->detachAllObjects();
+        }
         // crash under linux:
         //bakeNode->removeAndDestroyAllChildren();
     }
@@ -759,6 +766,84 @@ void TerrainObjectManager::unloadObject(const String& instancename)
     obj.enabled = false;
 }
 
+TerrainObjectManager::odef_t* TerrainObjectManager::loadObjectDefinition(const Ogre::String& name)
+{
+    auto found = odefs.find(name);
+    if (found != odefs.end())
+        return &found->second;
+
+    String odefgroup = "";
+    String odefname = name + ".odef";
+
+    bool odefFound = false;
+
+    bool exists = ResourceGroupManager::getSingleton().resourceExistsInAnyGroup(odefname);
+    if (exists)
+    {
+        odefgroup = ResourceGroupManager::getSingleton().findGroupContainingResource(odefname);
+        odefFound = true;
+    }
+
+    if (!RoR::App::GetCacheSystem()->checkResourceLoaded(odefname, odefgroup))
+        if (!odefFound)
+        {
+            LOG("Error while loading Terrain: could not find required .odef file: " + odefname + ". Ignoring entry.");
+            return nullptr;
+        }
+
+    DataStreamPtr ds = ResourceGroupManager::getSingleton().openResource(odefname, odefgroup);
+
+    char mesh[1024] = {};
+    char line[1024] = {};
+
+    odef_t def;
+    def.scale = Vector3::ZERO;
+    def.batchable = true;
+
+    ds->readLine(mesh, 1023);
+    if (String(mesh) == "LOD")
+    {
+        // LOD line is obsolete
+        ds->readLine(mesh, 1023);
+    }
+    def.mesh = mesh;
+
+    //scale
+    ds->readLine(line, 1023);
+    sscanf(line, "%f, %f, %f", &def.scale.x, &def.scale.y, &def.scale.z);
+
+    while (!ds->eof())
+    {
+        size_t ll = ds->readLine(line, 1023);
+
+        // little workaround to trim it
+        String line_str = String(line);
+        Ogre::StringUtil::trim(line_str);
+        RoR::Utils::SanitizeUtf8String(line_str);
+
+        if (ll == 0 || line[0] == '/' || line[0] == ';')
+            continue;
+
+        if (line_str == "end")
+            break;
+
+        // anything which moves, animates or attaches more than the mesh to the scene node
+        static const char* const dynamic_commands[] = {"movable", "playanimation", "particleSystem", "sound", "spotlight", "pointlight", "drawTextOnMeshTexture"};
+        for (const char* cmd : dynamic_commands)
+        {
+            if (!strncmp(cmd, line_str.c_str(), strlen(cmd)))
+                def.batchable = false;
+        }
+
+        def.lines.push_back(line_str);
+    }
+
+    if (def.mesh == "none")
+        def.batchable = false;
+
+    return &(odefs[name] = def);
+}
+
 void TerrainObjectManager::loadObject(const Ogre::String& name, const Ogre::Vector3& pos, const Ogre::Vector3& rot, Ogre::SceneNode* bakeNode, const Ogre::String& instancename, const Ogre::String& type, bool enable_collisions /* = true */, int scripthandler /* = -1 */, bool uniquifyMaterial /* = false */)
 {
     if (type == "grid")
@@ -778,14 +863,18 @@ void TerrainObjectManager::loadObject(const Ogre::String& name, const Ogre::Vect
     if (name.empty())
         return;
 
-    char mesh[1024] = {};
-    char line[1024] = {};
+    odef_t* def = loadObjectDefinition(name);
+    if (!def)
+        return;
+
+    const String odefname = name + ".odef";
+    const String& mesh = def->mesh;
     char collmesh[1024] = {};
     Vector3 l(Vector3::ZERO);
     Vector3 h(Vector3::ZERO);
     Vector3 dr(Vector3::ZERO);
     Vector3 fc(Vector3::ZERO);
-    Vector3 sc(Vector3::ZERO);
+    Vector3 sc = def->scale;
     Vector3 sr(Vector3::ZERO);
     bool forcecam = false;
     bool ismovable = false;
@@ -794,46 +883,18 @@ void TerrainObjectManager::loadObject(const Ogre::String& name, const Ogre::Vect
 
     Quaternion rotation = Quaternion(Degree(rot.x), Vector3::UNIT_X) * Quaternion(Degree(rot.y), Vector3::UNIT_Y) * Quaternion(Degree(rot.z), Vector3::UNIT_Z);
 
-    // try to load with UID first!
-    String odefgroup = "";
-    String odefname = name + ".odef";
-
-    bool odefFound = false;
-
-    bool exists = ResourceGroupManager::getSingleton().resourceExistsInAnyGroup(odefname);
-    if (exists)
-    {
-        odefgroup = ResourceGroupManager::getSingleton().findGroupContainingResource(odefname);
-        odefFound = true;
-    }
-
-    if (!RoR::App::GetCacheSystem()->checkResourceLoaded(odefname, odefgroup))
-        if (!odefFound)
-        {
-            LOG("Error while loading Terrain: could not find required .odef file: " + odefname + ". Ignoring entry.");
-            return;
-        }
-
-    DataStreamPtr ds = ResourceGroupManager::getSingleton().openResource(odefname, odefgroup);
-
-    ds->readLine(mesh, 1023);
-    if (String(mesh) == "LOD")
-    {
-        // LOD line is obsolete
-        ds->readLine(mesh, 1023);
-    }
-
-    //scale
-    ds->readLine(line, 1023);
-    sscanf(line, "%f, %f, %f", &sc.x, &sc.y, &sc.z);
     String entity_name = "object" + TOSTRING(objcounter) + "(" + name + ")";
     RoR::Utils::SanitizeUtf8String(entity_name);
     objcounter++;
 
-    SceneNode* tenode = gEnv->sceneManager->getRootSceneNode()->createChildSceneNode();
+    // Anonymous static objects from the .tobj file are baked into static geometry in postLoad(), scripts can't address them anyway
+    const bool bake = batch_static_objects && def->batchable && bakeNode == this->bakeNode && bakesg == nullptr
+        && instancename.empty() && !uniquifyMaterial && !background_loading;
+
+    SceneNode* tenode = bake ? bakeNode->createChildSceneNode() : gEnv->sceneManager->getRootSceneNode()->createChildSceneNode();
 
     MeshObject* mo = nullptr;
-    if (String(mesh) != "none")
+    if (mesh != "none")
     {
         mo = new MeshObject(mesh, entity_name, tenode, background_loading);
         meshObjects.push_back(mo);
@@ -880,21 +941,10 @@ void TerrainObjectManager::loadObject(const Ogre::String& name, const Ogre::Vect
     // everything is of concrete by default
     ground_model_t* gm = gEnv->collisions->getGroundModelByString("concrete");
     char eventname[256] = {};
-    while (!ds->eof())
+    for (const String& line_str : def->lines)
     {
-        size_t ll = ds->readLine(line, 1023);
-
-        // little workaround to trim it
-        String line_str = String(line);
-        Ogre::StringUtil::trim(line_str);
-        RoR::Utils::SanitizeUtf8String(line_str);
-
         const char* ptline = line_str.c_str();
-        if (ll == 0 || line[0] == '/' || line[0] == ';')
-            continue;
 
-        if (!strcmp("end", ptline))
-            break;
         if (!strcmp("movable", ptline))
         {
             ismovable = true;
@@ -106,6 +106,7 @@ protected:
 
     bool background_loading;
     bool use_rt_shader_system;
+    bool batch_static_objects;
 
 #ifdef USE_PAGED
     typedef struct
@@ -137,6 +138,19 @@ protected:
 
     std::map<std::string, loadedObject_t> loadedObjects;
 
+    /// Contents of an .odef file, read once per object name
+    typedef struct odef_t
+    {
+        Ogre::String mesh;
+        Ogre::Vector3 scale;
+        std::vector<Ogre::String> lines; //!< Trimmed lines between the header and 'end', without comments
+        bool batchable; //!< Only static visuals and collisions, may be baked into static geometry
+    } odef_t;
+
+    std::map<Ogre::String, odef_t> odefs;
+
+    odef_t* loadObjectDefinition(const Ogre::String& name);
+
     std::vector<object_t> objects;
 
     void proceduralTests();
@@ -19,18 +19,21 @@ along with Rigs of Rods.  If not, see <http://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <stdexcept>
 #include <vector>
 
+class ThreadPool;
 
-/** /brief Handle for a task executed by ThreadPool
+/** \brief Handle for a task executed by ThreadPool
  *
  * Returned by ThreadPool instance when submitting a new task to run.
  * Provides a thin wrapper around the callable object which implements the actual task.
@@ -42,44 +45,31 @@ class Task
 {
     friend class ThreadPool;
     public:
-    /// Block the current thread and wait for the associated task to finish.
-    void join() const
-    {
-        // Wait until the tasks is_finished property is set to true by the ThreadPool instance.
-        // Three possible scenarios:
-        // 1) Execution of task has not started yet
-        //    - locks task_mutex
-        //    - is_finished will be false
-        //    - therefore unlocks task_mutex again and waits until signaled by thread pool
-        //    - then is_finished will be true (except in case of spurious wakeups for which the waiting continues)
-        // 2) Task is being executed
-        //    - will try to lock task_mutex, but will fail
-        //    - task_mutex is locked while the task is still running
-        //    - is_finished will be true after aquiring the lock
-        // 3) Task has already finished execution
-        //    - locks task_mutex
-        //    - is_finished will be true
-        std::unique_lock<std::mutex> lock(m_task_mutex);
-        m_finish_cv.wait(lock, [this]{ return m_is_finished; });
-    }
+    /// Wait for the associated task to finish.
+    /// While waiting, the calling thread helps out by executing other pending tasks of the pool.
+    inline void join() const;
+
+    /// Check whether the task has finished without blocking.
+    bool is_finished() const { return m_pending.load(std::memory_order_acquire) == 0; }
 
     private:
     // Only constructable by friend class ThreadPool
-    Task(std::function<void()> task_func) : m_task_func(task_func) {}
+    Task(ThreadPool* pool) : m_pool(pool), m_pending(1) {}
     Task(Task &) = delete;
     Task & operator=(Task &) = delete;
 
-    bool m_is_finished = false;                   ///< Indicates whether the task execution has finished.
-    mutable std::condition_variable m_finish_cv;  ///< Used to signal the current thread when the task has finished.
-    mutable std::mutex m_task_mutex;              ///< Mutex which is locked while the task is running.
-    const std::function<void()> m_task_func;      ///< Callable object which implements the task to execute.
+    ThreadPool* const m_pool;        ///< Pool which executes the task.
+    std::atomic<int>  m_pending;     ///< Drops to zero when the task has finished.
 };
 
 /** \brief Facilitates execution of (small) tasks on separate threads.
  *
- * Implements a "rent-a-thread" model where each submitted task is assigned to one of several worker threads managed by the thread pool instance.
- * This is especially useful for short running tasks as it avoids the runtime cost of creating and launching a new thread. Notice, there
- * still is a certain overhead present due to the synchronization of threads required in the internal implementation.
+ * Implements a work-stealing scheduler: every worker thread owns a job queue. A thread pushes and pops
+ * jobs at the back of its own queue (LIFO, cache friendly) and, when it runs dry, steals from the front
+ * of the other queues (FIFO, oldest = usually biggest chunk of work). Completion is tracked with atomic
+ * counters instead of a mutex/condition variable per task, and a thread waiting for work to finish
+ * (join(), Parallelize(), ParallelFor()) keeps executing pending jobs instead of going to sleep.
+ * Threads only block on the shared condition variable when there's nothing left to run.
  *
  * Usage example 1:
  * \code
@@ -97,6 +87,12 @@ class Task
  *  tp.Parallelize({task1, task2});  // Run tasks in parallel and wait until all have finished
  * \endcode
  *
+ * Usage example 3:
+ * \code
+ *  ThreadPool tp;
+ *  tp.ParallelFor(0, num_items, 1, [&](int begin, int end) { for (int i = begin; i < end; ++i) Work(i); });
+ * \endcode
+ *
  * \see Task
  */
 class ThreadPool {
@@ -109,62 +105,51 @@ public:
     {
         if (num_threads < 1) { throw std::invalid_argument("Number of threads is zero or negative."); }
 
-        // Generic function (to be run on a separate thread) within which submitted tasks
+        for (int i = 0; i < num_threads; ++i) {
+            m_queues.emplace_back(new WorkerQueue());
+        }
+
+        // Generic function (to be run on a separate thread) within which submitted jobs
         // are executed. It implements an endless loop (only returning when the ThreadPool
-        // instance itself is destructed) which constantly checks the task queue, grabbing
-        // and executing the frontmost task while the queue is not empty.
-        auto thread_body = [this]{ 
+        // instance itself is destructed) which runs jobs from the own queue, steals from
+        // the other queues and sleeps when all of them are empty.
+        auto thread_body = [this](int index) {
+            CurrentWorker() = WorkerId{this, index};
             while (true) {
-                // Get next task from queue (synchronized access via taskqueue_mutex).
-                // If the queue is empty wait until either
-                //   - being signaled about an available task.
-                //   - the terminate flag is true (i.e. the ThreadPool instance is being destructed).
-                //     In this case return from the running thread.
-                std::unique_lock<std::mutex> queue_lock(m_taskqueue_mutex);
-                while (m_taskqueue.empty()) {
-                    if (m_terminate.load()) { return; }
-                    m_task_available_cv.wait(queue_lock);
-                }
-                const auto current_task = m_taskqueue.front();
-                m_taskqueue.pop();
-                queue_lock.unlock();
-
-                // Execute the actual task and signal the associated Task instance when finished.
-                {
-                    std::lock_guard<std::mutex> task_lock(current_task->m_task_mutex);
-                    current_task->m_task_func();
-                    current_task->m_is_finished = true;
-                }
-                current_task->m_finish_cv.notify_all();
+                if (this->TryRunJob()) { continue; }
+
+                std::unique_lock<std::mutex> lock(m_sleep_mutex);
+                m_num_sleeping++;
+                m_wakeup_cv.wait(lock, [this]{ return m_num_queued.load() > 0 || m_terminate.load(); });
+                m_num_sleeping--;
+                if (m_terminate.load() && m_num_queued.load() == 0) { return; }
             }
         };
 
         // Launch the specified number of threads
         for (int i = 0; i < num_threads; ++i) {
-            m_threads.emplace_back(thread_body);
+            m_threads.emplace_back(thread_body, i);
         }
     }
 
     ~ThreadPool() {
         // Indicate termination and signal potential waiting threads to wake up.
         // Then wait for all threads to finish their work and return properly.
-        m_terminate = true;
-        m_task_available_cv.notify_all();
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            m_terminate = true;
+        }
+        m_wakeup_cv.notify_all();
         for (auto &t : m_threads) { t.join(); }
     }
 
+    /// Number of worker threads
+    int GetNumThreads() const { return static_cast<int>(m_threads.size()); }
+
     /// Submit new asynchronous task to thread pool and return Task handle to allow for synchronization.
     std::shared_ptr<Task> RunTask(const std::function<void()> &task_func) {
-        // Wrap provided task callable object in task handle. Then append it to the task queue and
-        // notify a waiting worker thread (if any) about the newly available task
-        auto task = std::shared_ptr<Task>(new Task(task_func));
-        {
-            std::lock_guard<std::mutex> lock(m_taskqueue_mutex);
-            m_taskqueue.push(task);
-        }
-        m_task_available_cv.notify_one();
-
-        // Return task handle for later synchronization
+        auto task = std::shared_ptr<Task>(new Task(this));
+        this->PushJob(Job(task_func, &task->m_pending, task));
         return task;
     }
 
@@ -173,25 +158,185 @@ public:
     {
         if (task_funcs.empty()) return;
 
-        // Launch all provided tasks (except for the first) in parallel and store the associated handles
-        auto it = begin(task_funcs);
-        const auto first_task = it++;
-        std::vector<std::shared_ptr<Task>> handles;
-        for(; it != end(task_funcs); ++it)
-        { 
-            handles.push_back(RunTask(*it));
+        // Launch all provided tasks (except for the first) in parallel
+        std::atomic<int> pending(static_cast<int>(task_funcs.size()) - 1);
+        for (size_t i = 1; i < task_funcs.size(); ++i) {
+            this->PushJob(Job(task_funcs[i], &pending));
+        }
+
+        // Run the first task locally on the current thread, then help out until all are done
+        task_funcs[0]();
+        this->WaitFor(pending);
+    }
+
+    /** \brief Run 'body' over the index range [begin, end) in parallel and wait until it has finished.
+     *
+     * The range is cut into chunks of 'grain' indices which are handed out dynamically, so threads
+     * which finish early pick up the remaining chunks. The calling thread participates.
+     *
+     * @param body Called as body(chunk_begin, chunk_end); must be safe to run concurrently for disjoint chunks.
+     */
+    void ParallelFor(int begin, int end, int grain, const std::function<void(int, int)> &body)
+    {
+        if (end <= begin) return;
+        grain = std::max(1, grain);
+        const int num_chunks = (end - begin + grain - 1) / grain;
+        if (num_chunks == 1) { body(begin, end); return; }
+
+        std::atomic<int> next_chunk(0);
+        auto worker_func = [&]() {
+            for (int c = next_chunk.fetch_add(1); c < num_chunks; c = next_chunk.fetch_add(1)) {
+                const int chunk_begin = begin + c * grain;
+                body(chunk_begin, std::min(end, chunk_begin + grain));
+            }
+        };
+
+        // One helper job per additional thread that can possibly be kept busy
+        const int num_helpers = std::min(num_chunks, this->GetNumThreads() + 1) - 1;
+        std::atomic<int> pending(num_helpers);
+        for (int i = 0; i < num_helpers; ++i) {
+            this->PushJob(Job(worker_func, &pending));
+        }
+
+        worker_func();
+        this->WaitFor(pending);
+    }
+
+private:
+    friend class Task;
+
+    /// Unit of work stored in worker queues
+    struct Job
+    {
+        Job() : pending(nullptr) {}
+        Job(const std::function<void()> &f, std::atomic<int>* p, std::shared_ptr<Task> t = nullptr)
+            : func(f), pending(p), owner(t) {}
+
+        std::function<void()> func;
+        std::atomic<int>*     pending;  ///< Completion counter to decrement once 'func' has returned.
+        std::shared_ptr<Task> owner;    ///< Keeps the handle of asynchronous tasks alive until they finish.
+    };
+
+    struct WorkerQueue
+    {
+        std::mutex      mutex;  ///< Held only for push/pop, never while running a job.
+        std::deque<Job> jobs;
+    };
+
+    struct WorkerId
+    {
+        ThreadPool* pool;
+        int         index;
+    };
+
+    /// Identifies the pool and queue owned by the calling thread ({nullptr, -1} for non-worker threads).
+    static WorkerId& CurrentWorker()
+    {
+        static thread_local WorkerId id = {nullptr, -1};
+        return id;
+    }
+
+    /// Index of the calling thread's own queue, or -1 if it's not a worker of this pool.
+    int GetOwnQueueIndex() const
+    {
+        const WorkerId& id = CurrentWorker();
+        return (id.pool == this) ? id.index : -1;
+    }
+
+    void PushJob(Job job)
+    {
+        // Workers feed their own queue; outside threads spread their jobs round-robin
+        int index = this->GetOwnQueueIndex();
+        if (index < 0) {
+            index = static_cast<int>(m_next_queue.fetch_add(1) % m_queues.size());
         }
+        {
+            std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+            m_queues[index]->jobs.push_back(std::move(job));
+        }
+        m_num_queued.fetch_add(1);
+        if (m_num_sleeping.load() > 0) {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            m_wakeup_cv.notify_one();
+        }
+    }
 
-        // Run the first task locally on the current thread
-        (*first_task)();
+    /// Pop a job from the own queue or steal one from another. Returns false if all queues are empty.
+    bool TryPopJob(Job& out)
+    {
+        if (m_num_queued.load() == 0) { return false; }
 
-        // Synchronize, i.e. wait for all parallelized tasks to complete
-        for(const auto &h : handles) { h->join(); }
+        const int own = this->GetOwnQueueIndex();
+        if (own >= 0) {
+            std::lock_guard<std::mutex> lock(m_queues[own]->mutex);
+            if (!m_queues[own]->jobs.empty()) {
+                out = std::move(m_queues[own]->jobs.back());
+                m_queues[own]->jobs.pop_back();
+                m_num_queued.fetch_sub(1);
+                return true;
+            }
+        }
+
+        const int num_queues = static_cast<int>(m_queues.size());
+        const int start = (own >= 0) ? own + 1 : 0;
+        for (int i = 0; i < num_queues; ++i) {
+            WorkerQueue& victim = *m_queues[(start + i) % num_queues];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.jobs.empty()) {
+                out = std::move(victim.jobs.front());
+                victim.jobs.pop_front();
+                m_num_queued.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
     }
 
-    std::atomic_bool m_terminate{false};            ///< Indicates destruction of ThreadPool instance to worker threads
+    /// Execute one pending job, if any.
+    bool TryRunJob()
+    {
+        Job job;
+        if (!this->TryPopJob(job)) { return false; }
+
+        job.func();
+        if (job.pending->fetch_sub(1) == 1 && m_num_sleeping.load() > 0) {
+            // Wake up threads blocked in WaitFor()
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            m_wakeup_cv.notify_all();
+        }
+        return true;
+    }
+
+    /// Block until 'pending' drops to zero, executing other jobs in the meantime.
+    void WaitFor(const std::atomic<int>& pending)
+    {
+        int idle_rounds = 0;
+        while (pending.load(std::memory_order_acquire) > 0) {
+            if (this->TryRunJob()) {
+                idle_rounds = 0;
+            } else if (++idle_rounds < 64) {
+                std::this_thread::yield(); // The remaining jobs are being run by other threads; they're usually short.
+            } else {
+                std::unique_lock<std::mutex> lock(m_sleep_mutex);
+                m_num_sleeping++;
+                m_wakeup_cv.wait_for(lock, std::chrono::milliseconds(1),
+                    [&]{ return pending.load() == 0 || m_num_queued.load() > 0; });
+                m_num_sleeping--;
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;  ///< One job queue per worker thread
     std::vector<std::thread> m_threads;             ///< Collection of worker threads to run tasks
-    std::queue<std::shared_ptr<Task>> m_taskqueue;  ///< Queue of submitted tasks pending for execution
-    std::mutex m_taskqueue_mutex;                   ///< Protects task queue from concurrent access.
-    std::condition_variable m_task_available_cv;    ///< Used to signal threads that a new task was submitted and is ready to run.
+    std::atomic<int>         m_num_queued{0};       ///< Total of jobs in all queues; a hint for idle threads.
+    std::atomic<unsigned>    m_next_queue{0};       ///< Round-robin queue selector for submissions from outside threads.
+    std::atomic<int>         m_num_sleeping{0};     ///< Threads blocked on 'm_wakeup_cv'
+    std::atomic_bool         m_terminate{false};    ///< Indicates destruction of ThreadPool instance to worker threads
+    std::mutex               m_sleep_mutex;         ///< Guards sleeping on 'm_wakeup_cv'
+    std::condition_variable  m_wakeup_cv;           ///< Signals new jobs, finished waits and termination.
 };
+
+inline void Task::join() const
+{
+    m_pool->WaitFor(m_pending);
+}
@@ -0,0 +1,124 @@
+/*
+    This source file is part of Rigs of Rods
+    Copyright 2005-2012 Pierre-Michel Ricordel
+    Copyright 2007-2012 Thomas Fischer
+    Copyright 2016-2017 Petr Ohlidal & contributors
+
+    For more information, see http://www.rigsofrods.org/
+
+    Rigs of Rods is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3, as
+    published by the Free Software Foundation.
+
+    Rigs of Rods is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Rigs of Rods. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// @file
+/// @brief Bounded lock-free queue: any number of producer threads, one consumer thread.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/// Fixed capacity; push() fails instead of blocking when the queue is full.
+/// Each slot carries a sequence number which tells whether it is free for the
+/// producer of a given position, or published for the consumer.
+template <class T>
+class LockFreeQueue
+{
+public:
+
+    /// @param capacity Number of slots, rounded up to a power of two
+    explicit LockFreeQueue(size_t capacity)
+        : m_enqueue_pos(0)
+        , m_dequeue_pos(0)
+    {
+        size_t size = 2;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        m_mask = size - 1;
+        m_slots = std::vector<slot_t>(size);
+        for (size_t i = 0; i < size; i++)
+        {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /// Producers: @return False if the queue is full
+    bool push(const T& v)
+    {
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        slot_t* slot;
+        for (;;)
+        {
+            slot = &m_slots[pos & m_mask];
+            const size_t seq = slot->sequence.load(std::memory_order_acquire);
+            const ptrdiff_t diff = (ptrdiff_t)seq - (ptrdiff_t)pos;
+            if (diff == 0)
+            {
+                if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = v;
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer: @return False if the queue is empty
+    bool pop(T& v)
+    {
+        slot_t* slot = &m_slots[m_dequeue_pos & m_mask];
+        const size_t seq = slot->sequence.load(std::memory_order_acquire);
+        if ((ptrdiff_t)seq - (ptrdiff_t)(m_dequeue_pos + 1) < 0)
+            return false;
+        v = slot->value;
+        slot->sequence.store(m_dequeue_pos + m_mask + 1, std::memory_order_release);
+        m_dequeue_pos++;
+        return true;
+    }
+
+    /// Consumer: moves everything queued so far to the end of 'res'
+    int pull(std::vector<T>& res)
+    {
+        int results = 0;
+        T v;
+        while (pop(v))
+        {
+            res.push_back(v);
+            results++;
+        }
+        return results;
+    }
+
+private:
+
+    struct slot_t
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::vector<slot_t> m_slots;
+    size_t m_mask;
+    alignas(64) std::atomic<size_t> m_enqueue_pos;
+    alignas(64) size_t m_dequeue_pos;
+};
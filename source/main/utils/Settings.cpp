@@ -70,7 +70,9 @@ enum {
     OPT_INCLUDEPATH,
     OPT_ADVLOG,
     OPT_NOCACHE,
-    OPT_JOINMPSERVER
+    OPT_JOINMPSERVER,
+    OPT_HEADLESS,
+    OPT_STATESTREAM
 };
 
 // option array
@@ -92,6 +94,8 @@ CSimpleOpt::SOption cmdline_options[] = {
     { OPT_INCLUDEPATH,    ("-includepath"), SO_REQ_SEP },
     { OPT_NOCACHE,        ("-nocache"),     SO_NONE    },
     { OPT_JOINMPSERVER,   ("-joinserver"),  SO_REQ_CMB },
+    { OPT_HEADLESS,       ("-headless"),    SO_NONE    },
+    { OPT_STATESTREAM,    ("-statestream"), SO_REQ_SEP },
     SO_END_OF_OPTIONS
 };
 
@@ -108,6 +112,8 @@ void ShowCommandLineUsage()
             "-version shows the version information"    "\n"
             "-enter enters the selected truck"          "\n"
             "-userpath <path> sets the user directory"  "\n"
+            "-headless simulates -truck on flat ground without graphics, sound or GUI" "\n"
+            "-statestream <file> writes the -headless truck state every frame" "\n"
             "For example: RoR.exe -map oahu -truck semi"));
 }
 
@@ -327,6 +333,14 @@ void Settings::ProcessCommandLine(int argc, char *argv[])
         {
             SETTINGS.setSetting("USE_OGRE_CONFIG", "Yes");
         } 
+        else if (args.OptionId() == OPT_HEADLESS) 
+        {
+            App::app_headless.SetActive(true);
+        } 
+        else if (args.OptionId() == OPT_STATESTREAM) 
+        {
+            App::sim_state_stream.SetActive(args.OptionArg());
+        } 
         else if (args.OptionId() == OPT_JOINMPSERVER) 
         {
             std::string server_args = args.OptionArg();
@@ -593,6 +607,10 @@ static const char* CONF_MP_PORTAL_URL   = "Multiplayer portal URL";
 // Sim
 static const char* CONF_SIM_GEARBOX     = "GearboxMode";
 static const char* CONF_SIM_MULTITHREAD = "Multi-threading";
+static const char* CONF_SIM_BEAM_SIMD   = "SIMD Beams";
+static const char* CONF_SIM_BEAM_PARALLEL = "Parallel Beams";
+static const char* CONF_SIM_DETERMINISTIC = "Deterministic Physics";
+static const char* CONF_SIM_HEADLESS_RATE = "Headless Update Rate";
 // Input-Output
 static const char* CONF_FF_ENABLED      = "Force Feedback";
 static const char* CONF_FF_CAMERA       = "Force Feedback Camera";
@@ -656,6 +674,8 @@ static const char* CONF_SCREENSHOT_FMT  = "Screenshot Format";
 static const char* CONF_REPLAY_MODE     = "Replay mode";
 static const char* CONF_REPLAY_LENGTH   = "Replay length";
 static const char* CONF_REPLAY_STEPPING = "Replay Steps per second";
+static const char* CONF_REPLAY_MEMORY   = "Replay Memory (MB)";
+static const char* CONF_REPLAY_RECORD   = "Replay Recording";
 static const char* CONF_POS_STORAGE     = "Position Storage";
 static const char* CONF_LANGUAGE_SHORT  = "Language Short";
 
@@ -679,6 +699,10 @@ bool Settings::ParseGlobalVarSetting(std::string const & k, std::string const &
     // Sim
     if (k == CONF_SIM_GEARBOX     ) { App__SetSimGearboxMode             (S(v)); return true; }
     if (k == CONF_SIM_MULTITHREAD ) { App::app_multithread     .SetActive(B(v)); return true; }
+    if (k == CONF_SIM_BEAM_SIMD   ) { App::sim_beam_simd       .SetActive(B(v)); return true; }
+    if (k == CONF_SIM_BEAM_PARALLEL) { App::sim_beam_parallel  .SetActive(B(v)); return true; }
+    if (k == CONF_SIM_DETERMINISTIC) { App::sim_deterministic  .SetActive(B(v)); return true; }
+    if (k == CONF_SIM_HEADLESS_RATE) { App::sim_headless_rate  .SetActive(I(v)); return true; }
     // Input&Output
     if (k == CONF_FF_ENABLED      ) { App::io_ffb_enabled      .SetActive(B(v)); return true; }
     if (k == CONF_FF_CAMERA       ) { App::io_ffb_camera_gain  .SetActive(F(v)); return true; }
@@ -742,6 +766,8 @@ bool Settings::ParseGlobalVarSetting(std::string const & k, std::string const &
     if (k == CONF_REPLAY_MODE     ) { App::sim_replay_enabled       .SetActive(B(v)); return true; }
     if (k == CONF_REPLAY_LENGTH   ) { App::sim_replay_length        .SetActive(I(v)); return true; }
     if (k == CONF_REPLAY_STEPPING ) { App::sim_replay_stepping      .SetActive(I(v)); return true; }
+    if (k == CONF_REPLAY_MEMORY   ) { App::sim_replay_memory        .SetActive(I(v)); return true; }
+    if (k == CONF_REPLAY_RECORD   ) { App::sim_replay_record        .SetActive(B(v)); return true; }
     if (k == CONF_POS_STORAGE     ) { App::sim_position_storage     .SetActive(B(v)); return true; }
     if (k == CONF_LANGUAGE_SHORT  ) { App::app_locale               .SetActive(S(v)); return true; }
 
@@ -949,6 +975,10 @@ void Settings::SaveSettings()
     f << "; Simulation"                                                          << endl;
     f << CONF_SIM_GEARBOX     << "=" << _(App__SimGearboxToStr               ()) << endl;
     f << CONF_SIM_MULTITHREAD << "=" << B(App::app_multithread.GetActive     ()) << endl;
+    f << CONF_SIM_BEAM_SIMD   << "=" << B(App::sim_beam_simd.GetActive       ()) << endl;
+    f << CONF_SIM_BEAM_PARALLEL << "=" << B(App::sim_beam_parallel.GetActive ()) << endl;
+    f << CONF_SIM_DETERMINISTIC << "=" << B(App::sim_deterministic.GetActive ()) << endl;
+    f << CONF_SIM_HEADLESS_RATE << "=" << _(App::sim_headless_rate.GetActive ()) << endl;
     f                                                                            << endl;
     f << "; Input/Output"                                                        << endl;
     f << CONF_FF_ENABLED      << "=" << B(App::io_ffb_enabled.GetActive      ()) << endl;
@@ -1016,6 +1046,8 @@ void Settings::SaveSettings()
     f << CONF_REPLAY_MODE     << "=" << B(App::sim_replay_enabled       .GetActive()) << endl;
     f << CONF_REPLAY_LENGTH   << "=" << _(App::sim_replay_length        .GetActive()) << endl;
     f << CONF_REPLAY_STEPPING << "=" << _(App::sim_replay_stepping      .GetActive()) << endl;
+    f << CONF_REPLAY_MEMORY   << "=" << _(App::sim_replay_memory        .GetActive()) << endl;
+    f << CONF_REPLAY_RECORD   << "=" << B(App::sim_replay_record        .GetActive()) << endl;
     f << CONF_POS_STORAGE     << "=" << B(App::sim_position_storage     .GetActive()) << endl;
     f << CONF_LANGUAGE_SHORT  << "=" << _(App::app_locale               .GetActive()) << endl;
 
@@ -1042,6 +1074,7 @@ bool Settings::SetupAllPaths()
     buf.Clear() << App::sys_user_dir.GetActive() << PATH_SLASH << "config";             App::sys_config_dir    .SetActive(buf);
     buf.Clear() << App::sys_user_dir.GetActive() << PATH_SLASH << "cache";              App::sys_cache_dir     .SetActive(buf);
     buf.Clear() << App::sys_user_dir.GetActive() << PATH_SLASH << "screenshots";        App::sys_screenshot_dir.SetActive(buf);
+    buf.Clear() << App::sys_user_dir.GetActive() << PATH_SLASH << "replays";            App::sys_replays_dir   .SetActive(buf);
 
     // Resources dir
     buf.Clear() << App::sys_process_dir.GetActive() << PATH_SLASH << "resources";
@@ -0,0 +1,157 @@
+
+// Whole-truck physics benchmark: spawns 1, 10 and 50 copies of a truck on stub terrain
+// through the headless simulation host (no render window, sound or GUI) and measures
+// one physics frame per iteration. Per-stage times are reported as counters, in
+// milliseconds per frame summed over all threads. Flexbodies are not built headless,
+// so they have no counter; the in-game '/benchmark' command times them.
+//
+// Usage: Bench_Physics [--benchmark_* options] <truck file | scenario file> [truck counts...]
+// The truck must be in the mod cache of a regular run. For the scenario file format,
+// see source/main/physics/PhysicsBenchmark.h. Build with ROR_BUILD_BENCHMARKS.
+
+#include "benchmark/benchmark.h"
+
+#include "Application.h"
+#include "BeamFactory.h"
+#include "Collisions.h"
+#include "GlobalEnvironment.h"
+#include "HeadlessSimulation.h"
+#include "PhysicsBenchmark.h"
+#include "PlatformUtils.h"
+#include "Settings.h"
+
+#include <OgreLogManager.h>
+#include <OgreStringConverter.h>
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+GlobalEnvironment* gEnv;         // Defined in main.cpp for the game, which is not part of this executable
+GlobalEnvironment  gEnvInstance;
+
+using namespace RoR;
+
+static PhysicsBenchmarkScenario g_scenario;
+static HeadlessSimulation       g_host;
+
+static void BM_PhysicsFrame(benchmark::State& state)
+{
+    BeamFactory& factory = *g_host.GetBeamFactory();
+    Collisions& collisions = *gEnv->collisions;
+
+    std::unique_ptr<IHeightFinder> ground;
+    if (g_scenario.heightmap)
+        ground.reset(new HeightmapHeightFinder());
+    else
+        ground.reset(new FlatHeightFinder());
+    IHeightFinder* prev_ground = collisions.getHeightFinder();
+    const bool prev_forced_active = factory.AreTrucksForcedActive();
+    collisions.setHeightFinder(ground.get());
+    factory.setTrucksForcedActive(true); // Nothing may fall asleep during the measurement
+
+    std::vector<Beam*> trucks;
+    std::string error;
+    if (PhysicsBenchmark::SpawnTrucks(factory, *ground, g_scenario, static_cast<int>(state.range(0)), trucks, error))
+    {
+        // Let the trucks settle on the ground before measuring
+        PhysicsBenchmark::Result result;
+        std::memset(&result, 0, sizeof(PhysicsBenchmark::Result));
+        PhysicsBenchmark::SimulateFrames(factory, g_scenario.frame_time, 50, result);
+        PhysicsBenchmark::CollectStageTimes(trucks, result);
+
+        std::memset(&result, 0, sizeof(PhysicsBenchmark::Result));
+        for (auto _ : state)
+        {
+            PhysicsBenchmark::SimulateFrames(factory, g_scenario.frame_time, 1, result);
+        }
+        PhysicsBenchmark::CollectStageTimes(trucks, result);
+
+        for (int s = 0; s < PHYSICS_STAGE_COUNT; s++)
+        {
+            if (s == PHYSICS_STAGE_FLEXBODIES)
+                continue; // Not built in headless mode; a 0 would read as "free"
+            state.counters[PhysicsBenchmark::GetStageName(static_cast<PhysicsStage>(s))] =
+                benchmark::Counter(result.stages[s] * 1000.0, benchmark::Counter::kAvgIterations);
+        }
+    }
+    else
+    {
+        state.SkipWithError(error.c_str());
+    }
+
+    PhysicsBenchmark::RemoveTrucks(factory, trucks);
+    factory.setTrucksForcedActive(prev_forced_active);
+    collisions.setHeightFinder(prev_ground);
+}
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv); // Removes the --benchmark_* options
+    if (argc < 2)
+    {
+        std::printf("Usage: %s [--benchmark_* options] <truck file | scenario file> [truck counts...]\n", argv[0]);
+        return 1;
+    }
+
+    std::string error;
+    if (PlatformUtils::FileExists(argv[1]))
+    {
+        if (!g_scenario.LoadFile(argv[1], error))
+        {
+            std::printf("Cannot load benchmark scenario: %s\n", error.c_str());
+            return 1;
+        }
+    }
+    else
+    {
+        g_scenario.truck = argv[1];
+    }
+    if (argc > 2)
+    {
+        g_scenario.truck_counts.clear();
+        for (int i = 2; i < argc; i++)
+        {
+            g_scenario.truck_counts.push_back(Ogre::StringConverter::parseInt(argv[i]));
+        }
+    }
+
+    // Same as main(), minus the command line
+    gEnv = &gEnvInstance;
+    if (System::DetectBasePaths() != 0)
+    {
+        std::printf("Cannot detect the program and user directories\n");
+        return 1;
+    }
+    GStr<300> logs_dir;
+    logs_dir << App::sys_user_dir.GetActive() << PATH_SLASH << "logs";
+    if (!PlatformUtils::FolderExists(logs_dir.ToCStr()))
+        PlatformUtils::CreateFolder(logs_dir.ToCStr());
+    App::sys_logs_dir.SetActive(logs_dir);
+    GStr<300> log_path;
+    log_path << logs_dir << PATH_SLASH << "Bench_Physics.log";
+    Ogre::LogManager* log_manager = OGRE_NEW Ogre::LogManager();
+    log_manager->createLog(Ogre::String(log_path), true, false); // Keep the console for the benchmark's table
+    if (!Settings::SetupAllPaths())
+    {
+        std::printf("Resources folder not found. Check if correctly installed.\n");
+        return 1;
+    }
+    Settings::getSingleton().LoadRoRCfg();
+
+    g_host.Startup();
+
+    auto* bench = benchmark::RegisterBenchmark("BM_PhysicsFrame", BM_PhysicsFrame);
+    for (int count : g_scenario.truck_counts)
+    {
+        bench->Arg(count);
+    }
+    bench->Unit(benchmark::kMillisecond)->UseRealTime(); // Stages run on the thread pool
+
+    std::printf("Physics benchmark: '%s', frames of %.4f s, %s terrain\n",
+        g_scenario.truck.c_str(), g_scenario.frame_time, g_scenario.heightmap ? "heightmap" : "flat");
+    benchmark::RunSpecifiedBenchmarks();
+
+    g_host.Shutdown();
+    return 0;
+}
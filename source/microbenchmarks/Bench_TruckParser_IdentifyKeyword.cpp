@@ -1841,6 +1841,135 @@ static void Bench_sol2b_SwitchPreCond(benchmark::State& state)
 }
 BENCHMARK(Bench_sol2b_SwitchPreCond);
 
+// ################################# Solution 3 - perfect hash ######################################
+// Mirrors RigDef::Parser::IdentifyKeyword(): hash the leading identifier, verify the only candidate.
+
+#include <cstdint>
+#include <cstring>
+
+enum KeywordShape { KEYWORD_SHAPE_BLOCK, KEYWORD_SHAPE_INLINE, KEYWORD_SHAPE_INLINE_TOLERANT };
+
+struct KeywordDef
+{
+    const char*  name;
+    KeywordShape shape;
+};
+
+#undef  E_KEYWORD_BLOCK
+#undef  E_KEYWORD_INLINE
+#undef  E_KEYWORD_INLINE_TOLERANT
+#define E_KEYWORD_BLOCK(_NAME_)            { _NAME_, KEYWORD_SHAPE_BLOCK },
+#define E_KEYWORD_INLINE(_NAME_)           { _NAME_, KEYWORD_SHAPE_INLINE },
+#define E_KEYWORD_INLINE_TOLERANT(_NAME_)  { _NAME_, KEYWORD_SHAPE_INLINE_TOLERANT },
+
+static const KeywordDef KEYWORD_DEFS[] = { { nullptr, KEYWORD_SHAPE_BLOCK }, IDENTIFY_KEYWORD_REGEX_STRING };
+
+inline char ToLowerAscii(char c) { return (c >= 'A' && c <= 'Z') ? (c - 'A' + 'a') : c; }
+
+inline bool IsKeywordChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || (c == '_');
+}
+
+inline bool IsBlank(char c) { return (c == ' ') || (c == '\t'); }
+
+inline uint32_t HashStep(uint32_t hash, char c) { return (hash ^ static_cast<uint8_t>(ToLowerAscii(c))) * 16777619u; }
+
+static const uint32_t NUM_SLOTS = 2048;
+static uint32_t hash_seed;
+static uint8_t  hash_slots[NUM_SLOTS];
+
+bool TryBuildHashTable()
+{
+    memset(hash_slots, 0, sizeof(hash_slots));
+    for (unsigned k = 1; k < sizeof(KEYWORD_DEFS) / sizeof(KeywordDef); ++k)
+    {
+        uint32_t hash = hash_seed;
+        for (const char* c = KEYWORD_DEFS[k].name; *c != '\0'; ++c)
+        {
+            hash = HashStep(hash, *c);
+        }
+        uint8_t& slot = hash_slots[hash & (NUM_SLOTS - 1)];
+        if (slot != 0)
+        {
+            return false;
+        }
+        slot = static_cast<uint8_t>(k);
+    }
+    return true;
+}
+
+void PrepareBench_sol3()
+{
+    for (hash_seed = 2166136261u; !TryBuildHashTable(); ++hash_seed) {}
+}
+
+unsigned IdentifyKeywordHash(const char* line)
+{
+    uint32_t hash = hash_seed;
+    const char* name_end = line;
+    while (IsKeywordChar(*name_end))
+    {
+        hash = HashStep(hash, *name_end);
+        ++name_end;
+    }
+    const unsigned index = hash_slots[hash & (NUM_SLOTS - 1)];
+    if (index == 0)
+    {
+        return KEYWORD_INVALID;
+    }
+    const KeywordDef& def = KEYWORD_DEFS[index];
+    const char* c = line;
+    const char* n = def.name;
+    for (; (c != name_end) && (*n != '\0'); ++c, ++n)
+    {
+        if (ToLowerAscii(*c) != ToLowerAscii(*n))
+        {
+            return KEYWORD_INVALID;
+        }
+    }
+    if ((c != name_end) || (*n != '\0'))
+    {
+        return KEYWORD_INVALID;
+    }
+    const char* rest = name_end;
+    if (def.shape == KEYWORD_SHAPE_BLOCK)
+    {
+        while (IsBlank(*rest))
+        {
+            ++rest;
+        }
+        return (*rest == '\0') ? index : KEYWORD_INVALID;
+    }
+    if (!IsBlank(*rest) && !((def.shape == KEYWORD_SHAPE_INLINE_TOLERANT) && (*rest == ',')))
+    {
+        return KEYWORD_INVALID;
+    }
+    return index;
+}
+
+static void Bench_sol3__PerfectHash(benchmark::State& state)
+{
+    while (state.KeepRunning()) 
+    {
+        int count = sizeof(trucklines)/sizeof(const char*);
+        for (int i = 0; i < count; ++i)
+        {
+            // precondition
+            char c = trucklines[i][0];
+            if (! ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')))
+            {
+                keyword = (int) KEYWORD_INVALID;
+                continue;
+            }
+            // precondition
+
+            keyword = (int) IdentifyKeywordHash(trucklines[i]);
+        }
+    }
+}
+BENCHMARK(Bench_sol3__PerfectHash);
+
 int main(int argc, char** argv)
 {
     using namespace std;
@@ -1848,6 +1977,7 @@ int main(int argc, char** argv)
     // prepare
     cout << "Preparing..." << endl;
     PrepareBench_sol1();
+    PrepareBench_sol3();
 
 
     // benchmark